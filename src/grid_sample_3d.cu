@@ -2,223 +2,976 @@
 
 #include "grid_sample_3d.h"
 #include "grid_sample_3d.cuh"
+#include "grid_sample_3d_profile.h"
 
+#include <stdint.h>
 #include <stdlib.h>
 
-#define NUM_THREADS 128
+#include <algorithm>
+#include <vector>
 
 using half = __half;
+using bfloat16 = __nv_bfloat16;
 
-inline int get_num_blocks(int n) {
-    return (n + NUM_THREADS - 1) / NUM_THREADS;
-}
+// gridDim.y limit, caps the number of channel slices
+#define MAX_CHANNEL_SLICES 65535
+// gridDim.x limit
+#define MAX_GRID_BLOCKS 2147483647
+
+// Launch shape of a tactic over `voxels` output voxels: blockSize threads per block, enough blocks
+// for voxelsPerThread voxels per thread, and one gridDim.y slice per channelsPerThread channels
+// (`C` = 0 for the channels-last kernels, which always cover every channel).
+struct TacticLaunch {
+    dim3 blocks;
+    dim3 threads;
+    size_t channels_per_thread;
+
+    TacticLaunch(const GridSample3DTactic& tactic, size_t voxels, size_t C) {
+        const size_t block = tactic.blockSize > 0 ? tactic.blockSize : 128;
+        const size_t per_thread = tactic.voxelsPerThread > 0 ? tactic.voxelsPerThread : 1;
+        channels_per_thread = tactic.channelsPerThread > 0 && C > 0 ? tactic.channelsPerThread : (C > 0 ? C : 1);
+        channels_per_thread = std::max(channels_per_thread, (C + MAX_CHANNEL_SLICES - 1) / MAX_CHANNEL_SLICES);
+        const size_t slices = C > 0 ? (C + channels_per_thread - 1) / channels_per_thread : 1;
+        // the kernels grid-stride, so capping gridDim.x at its limit only adds voxels per thread
+        const size_t num_blocks = std::min<size_t>((voxels + block * per_thread - 1) / (block * per_thread), MAX_GRID_BLOCKS);
+        threads = dim3(static_cast<unsigned int>(block));
+        blocks = dim3(static_cast<unsigned int>(std::max<size_t>(num_blocks, 1)), static_cast<unsigned int>(slices));
+    }
+};
+
+// Clipped (Border/Reflection) coordinates always land inside the volume, so the bounds tests fold away.
+template <GridSample3DPaddingMode padding_mode>
+struct ClippedToVolume {
+    static constexpr bool value = padding_mode != GridSample3DPaddingMode::Zeros;
+};
+
+// Coordinate sources: where the kernels get the normalized (x, y, z) of output voxel (n, d, h, w) from.
+// Whatever the grid element type, coordinates leave the source as fp32 and all index and weight
+// math is done in fp32.
+
+// An explicit N x D x H x W x 3 grid tensor of grid_t (float, or the input type).
+template <typename grid_t, GridSample3DGridKind grid_kind = GridSample3DGridKind::Absolute>
+struct GridCoords {
+    static constexpr GridSample3DGridKind kind = grid_kind;
+
+    const grid_t* grid;
+    size_t stride_N, stride_D, stride_H, stride_W, stride_XYZ;
+
+    __device__ void operator()(size_t n, size_t d, size_t h, size_t w, float& x, float& y, float& z) const {
+        const grid_t* grid_NDHW_offset = grid + n * stride_N + d * stride_D + h * stride_H + w * stride_W;
+        x = to_float(*grid_NDHW_offset);
+        y = to_float(*(grid_NDHW_offset + stride_XYZ));
+        z = to_float(*(grid_NDHW_offset + 2 * stride_XYZ));
+    }
+};
+
+// F.affine_grid evaluated in place from theta (N x 3 x 4), so no grid is read at all.
+template <typename grid_t, bool align_corners>
+struct AffineCoords {
+    static constexpr GridSample3DGridKind kind = GridSample3DGridKind::Absolute;
+
+    const grid_t* theta;
+    int D, H, W;
+
+    __device__ void operator()(size_t n, size_t d, size_t h, size_t w, float& x, float& y, float& z) const {
+        float theta_N[12];
+        for (int i = 0; i < 12; i++) {
+            theta_N[i] = to_float(theta[n * 12 + i]);
+        }
+        affine_grid_coords(theta_N,
+                           affine_grid_base<align_corners>(static_cast<int>(w), W),
+                           affine_grid_base<align_corners>(static_cast<int>(h), H),
+                           affine_grid_base<align_corners>(static_cast<int>(d), D),
+                           x, y, z);
+    }
+};
+
+// Value policies: how the kernels read input elements as fp32 and store the fp32 results.
 
+// float/half/bf16 tensors, the output of the input type.
 template <typename scalar_t>
+struct ConvertValues {
+    using input_t = scalar_t;
+    using output_t = scalar_t;
+
+    __device__ float load(input_t v, size_t) const {
+        return to_float(v);
+    }
+
+    __device__ output_t store(float v, size_t) const {
+        return from_float<output_t>(v);
+    }
+
+    // what nearest sampling writes for a sampled element
+    __device__ output_t copy(input_t v, size_t) const {
+        return v;
+    }
+};
+
+// int8/uint8 input dequantized per tensor or per channel; the output is requantized
+// (output_t == q_t) or fp16.
+template <typename q_t, typename out_t>
+struct DequantizeValues {
+    using input_t = q_t;
+    using output_t = out_t;
+
+    GridSample3DQuantization input_quantization;
+    GridSample3DQuantization output_quantization;
+
+    __device__ float load(input_t v, size_t c) const {
+        return dequantize_value(v, input_quantization, c);
+    }
+
+    __device__ output_t store(float v, size_t c) const {
+        return quantize_value<output_t>(v, output_quantization, c);
+    }
+
+    __device__ output_t copy(input_t v, size_t c) const {
+        return store(load(v, c), c);
+    }
+};
+
+// Integer label maps (class IDs): nearest sampling only, values are copied without any arithmetic
+// and out-of-bounds voxels get label 0.
+template <typename label_t>
+struct LabelValues {
+    using input_t = label_t;
+    using output_t = label_t;
+
+    __device__ output_t store(float, size_t) const {
+        return output_t(0);
+    }
+
+    __device__ output_t copy(input_t v, size_t) const {
+        return v;
+    }
+};
+
+// Out-of-bounds value of channels [c_begin, c_end) of an NCDHW voxel, for Outside tiles of the bounds prepass.
+template <typename Values>
+__device__ void zero_channels(Values values, typename Values::output_t* output, size_t c_begin, size_t c_end, size_t stride_C) {
+    for (size_t c = c_begin; c < c_end; c++) {
+        *output = values.store(0.f, c);
+        output += stride_C;
+    }
+}
+
+// Output voxel switched off by the optional N x D_grid x H_grid x W_grid mask; written as zeros
+// like the voxels of an Outside tile.
+__device__ inline bool masked_out(const uint8_t* mask, size_t n, size_t d, size_t h, size_t w,
+                                  size_t D_grid, size_t H_grid, size_t W_grid) {
+    return mask != nullptr && mask[((n * D_grid + d) * H_grid + h) * W_grid + w] == 0;
+}
+
+template <typename Values, typename Coords, GridSample3DPaddingMode padding_mode, bool align_corners, typename index_t>
 __global__ void grid_sample_3d_nearest_kernel(
-    const scalar_t* input,
-    const scalar_t* grid,
-    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
-    size_t input_stride_N, size_t input_stride_C, size_t input_stride_D, size_t input_stride_H, size_t input_stride_W,
-    size_t D_grid, size_t H_grid, size_t W_grid,
-    size_t grid_stride_N, size_t grid_stride_D, size_t grid_stride_H, size_t grid_stride_W, size_t grid_stride_XYZ,
-    size_t output_stride_N, size_t output_stride_C, size_t output_stride_D, size_t output_stride_H, size_t output_stride_W,
-    bool align_corners,
-    GridSample3DPaddingMode padding_mode,
-    scalar_t* output    
+    const typename Values::input_t* input,
+    Values values,
+    Coords coords,
+    index_t N, index_t C, index_t D_in, index_t H_in, index_t W_in,
+    index_t input_stride_N, index_t input_stride_C, index_t input_stride_D, index_t input_stride_H, index_t input_stride_W,
+    index_t D_grid, index_t H_grid, index_t W_grid,
+    index_t output_stride_N, index_t output_stride_C, index_t output_stride_D, index_t output_stride_H, index_t output_stride_W,
+    index_t channels_per_thread,
+    GridSample3DBricks bricks,
+    const GridSample3DTileClass* tile_class,
+    const uint8_t* mask,
+    typename Values::output_t* output
 ) {
-    unsigned int tid = blockIdx.x * blockDim.x + threadIdx.x;
+    using scalar_t = typename Values::input_t;
+    using output_t = typename Values::output_t;
 
-    if(tid >= N * D_grid * H_grid * W_grid) {
-        return;
+    // blockIdx.y selects the slice of channels_per_thread channels
+    const index_t c_begin = blockIdx.y * channels_per_thread;
+    const index_t c_end = min(C, c_begin + channels_per_thread);
+    // grid-stride over the traversal order of the output voxels, about tactic.voxelsPerThread per thread
+    const index_t total = static_cast<index_t>(bricks.count(N));
+    for (index_t tid = static_cast<index_t>(blockIdx.x) * blockDim.x + threadIdx.x; tid < total; tid += static_cast<index_t>(blockDim.x) * gridDim.x) {
+        index_t n, d, h, w;
+        if(!bricks.voxel<index_t>(tid, n, d, h, w)) {
+            continue;
+        }
+
+        const scalar_t* input_N_offset = input + n * input_stride_N;
+        output_t* output_N_offset = output + n * output_stride_N;
+        const GridSample3DTileClass tile = tile_class != nullptr ? tile_class[tid / GRID_SAMPLE_3D_BOUNDS_TILE] : GridSample3DTileClass::Mixed;
+        if(tile == GridSample3DTileClass::Outside || masked_out(mask, n, d, h, w, D_grid, H_grid, W_grid)) {
+            zero_channels(values, output_N_offset + c_begin * output_stride_C + d * output_stride_D + h * output_stride_H + w * output_stride_W,
+                          c_begin, c_end, output_stride_C);
+            continue;
+        }
+
+        float x, y, z;
+        coords(n, d, h, w, x, y, z);
+
+        float ix = compute_index<Coords::kind, padding_mode, align_corners>(x, w, W_grid, W_in);
+        float iy = compute_index<Coords::kind, padding_mode, align_corners>(y, h, H_grid, H_in);
+        float iz = compute_index<Coords::kind, padding_mode, align_corners>(z, d, D_grid, D_in);
+
+        int ix_nearest = static_cast<int>(::roundf(ix));
+        int iy_nearest = static_cast<int>(::roundf(iy));
+        int iz_nearest = static_cast<int>(::roundf(iz));
+        const bool inside = ClippedToVolume<padding_mode>::value || tile == GridSample3DTileClass::Inside ||
+                            (ix_nearest >= 0 && ix_nearest < W_in && iy_nearest >= 0 && iy_nearest < H_in && iz_nearest >= 0 && iz_nearest < D_in);
+
+        scalar_t *input_NC_offset = const_cast<scalar_t *>(input_N_offset) + c_begin * input_stride_C;
+        output_t *output_NCDHW_offset = output_N_offset + c_begin * output_stride_C + d * output_stride_D + h * output_stride_H + w * output_stride_W;
+        for (index_t c = c_begin; c < c_end; c++) {
+            if(inside) {
+                *output_NCDHW_offset = values.copy(input_NC_offset[ix_nearest * input_stride_W + iy_nearest * input_stride_H + iz_nearest * input_stride_D], c);
+            } else {
+                *output_NCDHW_offset = values.store(0.f, c);
+            }
+            input_NC_offset += input_stride_C;
+            output_NCDHW_offset += output_stride_C;
+        }
     }
+}
+
+template <typename Values, typename Coords, GridSample3DPaddingMode padding_mode, bool align_corners, typename index_t>
+__global__ void grid_sample_3d_bilinear_kernel(
+    const typename Values::input_t* input,
+    Values values,
+    Coords coords,
+    index_t N, index_t C, index_t D_in, index_t H_in, index_t W_in,
+    index_t input_stride_N, index_t input_stride_C, index_t input_stride_D, index_t input_stride_H, index_t input_stride_W,
+    index_t D_grid, index_t H_grid, index_t W_grid,
+    index_t output_stride_N, index_t output_stride_C, index_t output_stride_D, index_t output_stride_H, index_t output_stride_W,
+    index_t channels_per_thread,
+    GridSample3DBricks bricks,
+    const GridSample3DTileClass* tile_class,
+    const uint8_t* mask,
+    typename Values::output_t* output
+) {
+    using scalar_t = typename Values::input_t;
+    using output_t = typename Values::output_t;
+
+    // blockIdx.y selects the slice of channels_per_thread channels
+    const index_t c_begin = blockIdx.y * channels_per_thread;
+    const index_t c_end = min(C, c_begin + channels_per_thread);
+    // grid-stride over the traversal order of the output voxels, about tactic.voxelsPerThread per thread
+    const index_t total = static_cast<index_t>(bricks.count(N));
+    for (index_t tid = static_cast<index_t>(blockIdx.x) * blockDim.x + threadIdx.x; tid < total; tid += static_cast<index_t>(blockDim.x) * gridDim.x) {
+        index_t n, d, h, w;
+        if(!bricks.voxel<index_t>(tid, n, d, h, w)) {
+            continue;
+        }
 
-    auto n = tid / (D_grid * H_grid * W_grid);
-    auto d = (tid / (H_grid * W_grid)) % D_grid;
-    auto h = (tid / W_grid) % H_grid;
-    auto w = tid % W_grid;
+        const scalar_t* input_N_offset = input + n * input_stride_N;
+        output_t* output_N_offset = output + n * output_stride_N;
+        const GridSample3DTileClass tile = tile_class != nullptr ? tile_class[tid / GRID_SAMPLE_3D_BOUNDS_TILE] : GridSample3DTileClass::Mixed;
+        if(tile == GridSample3DTileClass::Outside || masked_out(mask, n, d, h, w, D_grid, H_grid, W_grid)) {
+            zero_channels(values, output_N_offset + c_begin * output_stride_C + d * output_stride_D + h * output_stride_H + w * output_stride_W,
+                          c_begin, c_end, output_stride_C);
+            continue;
+        }
 
-    const scalar_t* input_N_offset = input + n * input_stride_N;
-    const scalar_t* grid_N_offset = grid + n * grid_stride_N;
-    scalar_t* output_N_offset = output + n * output_stride_N;
+        float x, y, z;
+        coords(n, d, h, w, x, y, z);
 
-    const scalar_t* grid_NDHW_offset = grid_N_offset + d * grid_stride_D + h * grid_stride_H + w * grid_stride_W;
-    const scalar_t x = *grid_NDHW_offset;
-    const scalar_t y = *(grid_NDHW_offset + grid_stride_XYZ);
-    const scalar_t z = *(grid_NDHW_offset + 2 * grid_stride_XYZ);
+        float ix = compute_index<Coords::kind, padding_mode, align_corners>(x, w, W_grid, W_in);
+        float iy = compute_index<Coords::kind, padding_mode, align_corners>(y, h, H_grid, H_in);
+        float iz = compute_index<Coords::kind, padding_mode, align_corners>(z, d, D_grid, D_in);
 
-    scalar_t ix = compute_index(x, W_in, padding_mode, align_corners);
-    scalar_t iy = compute_index(y, H_in, padding_mode, align_corners);
-    scalar_t iz = compute_index(z, D_in, padding_mode, align_corners);    
+        int x0 = static_cast<int>(::floorf(ix));
+        int y0 = static_cast<int>(::floorf(iy));
+        int z0 = static_cast<int>(::floorf(iz));
+        int x1 = x0 + 1;
+        int y1 = y0 + 1;
+        int z1 = z0 + 1;
 
-    int ix_nearest = static_cast<int>(::roundf(ix));
-    int iy_nearest = static_cast<int>(::roundf(iy));
-    int iz_nearest = static_cast<int>(::roundf(iz));
+        float v000 = (ix                     - x0) * (iy - y0)                     * (iz - z0);
+        float v100 = (static_cast<float>(x1) - ix) * (iy - y0)                     * (iz - z0);
+        float v010 = (ix - x0)                     * (static_cast<float>(y1) - iy) * (iz - z0);
+        float v110 = (static_cast<float>(x1) - ix) * (static_cast<float>(y1) - iy) * (iz - z0);
+        float v001 = (ix - x0)                     * (iy - y0)                     * (static_cast<float>(z1) - iz);
+        float v101 = (static_cast<float>(x1) - ix) * (iy - y0)                     * (static_cast<float>(z1) - iz);
+        float v011 = (ix - x0)                     * (static_cast<float>(y1) - iy) * (static_cast<float>(z1) - iz);
+        float v111 = (static_cast<float>(x1) - ix) * (static_cast<float>(y1) - iy) * (static_cast<float>(z1) - iz);
+
+        // corner bounds are resolved once per voxel instead of once per channel; with clipped
+        // coordinates only the high corner can fall off the far edge
+        constexpr bool clipped = ClippedToVolume<padding_mode>::value;
+        const bool vx0 = clipped || (x0 >= 0 && x0 < W_in);
+        const bool vy0 = clipped || (y0 >= 0 && y0 < H_in);
+        const bool vz0 = clipped || (z0 >= 0 && z0 < D_in);
+        const bool vx1 = x1 >= 0 && x1 < W_in;
+        const bool vy1 = y1 >= 0 && y1 < H_in;
+        const bool vz1 = z1 >= 0 && z1 < D_in;
+
+        scalar_t *input_NC_offset = const_cast<scalar_t *>(input_N_offset) + c_begin * input_stride_C;
+        output_t *output_NCDHW_offset = output_N_offset + c_begin * output_stride_C + d * output_stride_D + h * output_stride_H + w * output_stride_W;
+
+        // every corner of an Inside tile is in the volume: same sum without the checks
+        if(tile == GridSample3DTileClass::Inside) {
+            for(index_t c = c_begin; c < c_end; c++) {
+                auto corner = [&](int x, int y, int z) {
+                    return values.load(input_NC_offset[x * input_stride_W + y * input_stride_H + z * input_stride_D], c);
+                };
+                float value = 0.f;
+                value += v000 * corner(x1, y1, z1);
+                value += v100 * corner(x0, y1, z1);
+                value += v010 * corner(x1, y0, z1);
+                value += v110 * corner(x0, y0, z1);
+                value += v001 * corner(x1, y1, z0);
+                value += v101 * corner(x0, y1, z0);
+                value += v011 * corner(x1, y0, z0);
+                value += v111 * corner(x0, y0, z0);
+                *output_NCDHW_offset = values.store(value, c);
+                input_NC_offset += input_stride_C;
+                output_NCDHW_offset += output_stride_C;
+            }
+            continue;
+        }
+
+        for(index_t c = c_begin; c < c_end; c++) {
+            float value = 0.f;
+            if(vx1 && vy1 && vz1) {
+                value += v000 * values.load(input_NC_offset[x1 * input_stride_W + y1 * input_stride_H + z1 * input_stride_D], c);
+            }
+            if(vx0 && vy1 && vz1) {
+                value += v100 * values.load(input_NC_offset[x0 * input_stride_W + y1 * input_stride_H + z1 * input_stride_D], c);
+            }
+            if(vx1 && vy0 && vz1) {
+                value += v010 * values.load(input_NC_offset[x1 * input_stride_W + y0 * input_stride_H + z1 * input_stride_D], c);
+            }
+            if(vx0 && vy0 && vz1) {
+                value += v110 * values.load(input_NC_offset[x0 * input_stride_W + y0 * input_stride_H + z1 * input_stride_D], c);
+            }
+            if(vx1 && vy1 && vz0) {
+                value += v001 * values.load(input_NC_offset[x1 * input_stride_W + y1 * input_stride_H + z0 * input_stride_D], c);
+            }
+            if(vx0 && vy1 && vz0) {
+                value += v101 * values.load(input_NC_offset[x0 * input_stride_W + y1 * input_stride_H + z0 * input_stride_D], c);
+            }
+            if(vx1 && vy0 && vz0) {
+                value += v011 * values.load(input_NC_offset[x1 * input_stride_W + y0 * input_stride_H + z0 * input_stride_D], c);
+            }
+            if(vx0 && vy0 && vz0) {
+                value += v111 * values.load(input_NC_offset[x0 * input_stride_W + y0 * input_stride_H + z0 * input_stride_D], c);
+            }
+            *output_NCDHW_offset = values.store(value, c);
+            input_NC_offset += input_stride_C;
+            output_NCDHW_offset += output_stride_C;
 
-    scalar_t *input_NC_offset = const_cast<scalar_t *>(input_N_offset);
-    scalar_t *output_NCDHW_offset = output_N_offset + d * output_stride_D + h * output_stride_H + w * output_stride_W;
-    for (auto c = 0; c < C; c++) {
-        if(ix_nearest >= 0 && ix_nearest < W_in && iy_nearest >= 0 && iy_nearest < H_in && iz_nearest >= 0 && iz_nearest < D_in) {
-            *output_NCDHW_offset = input_NC_offset[ix_nearest * input_stride_W + iy_nearest * input_stride_H + iz_nearest * input_stride_D];
-        } else {
-            *output_NCDHW_offset = static_cast<scalar_t>(0);
         }
     }
 }
 
+// A pack of channels moved with one 16-byte load or store.
 template <typename scalar_t>
-__global__ void grid_sample_3d_bilinear_kernel(
-    const scalar_t* input,
-    const scalar_t* grid,
+struct ChannelPack;
+
+template <>
+struct ChannelPack<float> {
+    using type = float4;
+    static constexpr int size = 4;
+};
+
+template <>
+struct ChannelPack<half> {
+    using type = uint4;
+    static constexpr int size = 8;
+};
+
+template <>
+struct ChannelPack<bfloat16> {
+    using type = uint4;
+    static constexpr int size = 8;
+};
+
+template <>
+struct ChannelPack<int32_t> {
+    using type = uint4;
+    static constexpr int size = 4;
+};
+
+template <>
+struct ChannelPack<int8_t> {
+    using type = uint4;
+    static constexpr int size = 16;
+};
+
+template <>
+struct ChannelPack<uint8_t> {
+    using type = uint4;
+    static constexpr int size = 16;
+};
+
+// Channels-last (NDHWC / NDHWC8) kernels: the channels of a voxel are contiguous, so every corner
+// is read as packs of channels instead of one scattered load per channel.
+// Same for a channels-last voxel, written pack by pack with `vectorized`.
+template <bool vectorized, typename Values>
+__device__ void zero_voxel(Values values, typename Values::output_t* output, size_t C, size_t pitch) {
+    using output_t = typename Values::output_t;
+    if constexpr (vectorized) {
+        using OutPack = typename ChannelPack<output_t>::type;
+        constexpr int PACK = ChannelPack<output_t>::size;
+        for (size_t c = 0; c < pitch; c += PACK) {
+            OutPack pack;
+            output_t* v = reinterpret_cast<output_t*>(&pack);
+            for (int j = 0; j < PACK; j++) {
+                v[j] = values.store(0.f, c + j);
+            }
+            *reinterpret_cast<OutPack*>(output + c) = pack;
+        }
+    } else {
+        for (size_t c = 0; c < C; c++) {
+            output[c] = values.store(0.f, c);
+        }
+    }
+}
+
+// `pitch` is the distance between two voxels; with `vectorized` it is a multiple of the pack size
+// and the whole pitch (including NDHWC8 padding) is processed pack by pack. Only used when input
+// and output packs hold the same number of channels.
+template <typename Values, typename Coords, bool vectorized, GridSample3DPaddingMode padding_mode, bool align_corners>
+__global__ void grid_sample_3d_bilinear_channels_last_kernel(
+    const typename Values::input_t* input,
+    Values values,
+    Coords coords,
     size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
-    size_t input_stride_N, size_t input_stride_C, size_t input_stride_D, size_t input_stride_H, size_t input_stride_W,
+    size_t pitch,
     size_t D_grid, size_t H_grid, size_t W_grid,
-    size_t grid_stride_N, size_t grid_stride_D, size_t grid_stride_H, size_t grid_stride_W, size_t grid_stride_XYZ,
-    size_t output_stride_N, size_t output_stride_C, size_t output_stride_D, size_t output_stride_H, size_t output_stride_W,
-    bool align_corners,
-    GridSample3DPaddingMode padding_mode,
-    scalar_t* output
+    GridSample3DBricks bricks,
+    const GridSample3DTileClass* tile_class,
+    const uint8_t* mask,
+    typename Values::output_t* output
 ) {
+    using scalar_t = typename Values::input_t;
+    using output_t = typename Values::output_t;
 
-    unsigned int tid = blockIdx.x * blockDim.x + threadIdx.x;
+    // grid-stride over the traversal order of the output voxels, about tactic.voxelsPerThread per thread
+    const size_t total = bricks.count(N);
+    for (size_t tid = static_cast<size_t>(blockIdx.x) * blockDim.x + threadIdx.x; tid < total; tid += static_cast<size_t>(blockDim.x) * gridDim.x) {
+        size_t n, d, h, w;
+        if(!bricks.voxel(tid, n, d, h, w)) {
+            continue;
+        }
 
-    if(tid >= N * D_grid * H_grid * W_grid) {
-        return;
+        output_t* output_NDHW_offset = output + (((n * D_grid + d) * H_grid + h) * W_grid + w) * pitch;
+        const GridSample3DTileClass tile = tile_class != nullptr ? tile_class[tid / GRID_SAMPLE_3D_BOUNDS_TILE] : GridSample3DTileClass::Mixed;
+        if(tile == GridSample3DTileClass::Outside || masked_out(mask, n, d, h, w, D_grid, H_grid, W_grid)) {
+            zero_voxel<vectorized>(values, output_NDHW_offset, C, pitch);
+            continue;
+        }
+
+        float gx, gy, gz;
+        coords(n, d, h, w, gx, gy, gz);
+        float ix = compute_index<Coords::kind, padding_mode, align_corners>(gx, w, W_grid, W_in);
+        float iy = compute_index<Coords::kind, padding_mode, align_corners>(gy, h, H_grid, H_in);
+        float iz = compute_index<Coords::kind, padding_mode, align_corners>(gz, d, D_grid, D_in);
+
+        int x0 = static_cast<int>(::floorf(ix));
+        int y0 = static_cast<int>(::floorf(iy));
+        int z0 = static_cast<int>(::floorf(iz));
+
+        const scalar_t* input_N_offset = input + n * D_in * H_in * W_in * pitch;
+        const scalar_t* corner[8];
+        float weight[8];
+        int k = 0;
+        for (int dz = 1; dz >= 0; dz--) {
+            for (int dy = 1; dy >= 0; dy--) {
+                for (int dx = 1; dx >= 0; dx--, k++) {
+                    int x = x0 + dx, y = y0 + dy, z = z0 + dz;
+                    bool inside = tile == GridSample3DTileClass::Inside ||
+                                  (x >= 0 && x < W_in && y >= 0 && y < H_in && z >= 0 && z < D_in);
+                    corner[k] = inside ? input_N_offset + ((z * H_in + y) * W_in + x) * pitch : nullptr;
+                    weight[k] = (dx ? ix - x0 : x0 + 1 - ix) * (dy ? iy - y0 : y0 + 1 - iy) * (dz ? iz - z0 : z0 + 1 - iz);
+                }
+            }
+        }
+
+        if constexpr (vectorized) {
+            using InPack = typename ChannelPack<scalar_t>::type;
+            using OutPack = typename ChannelPack<output_t>::type;
+            constexpr int PACK = ChannelPack<scalar_t>::size;
+            for (size_t c = 0; c < pitch; c += PACK) {
+                float value[PACK] = {};
+                for (int k = 0; k < 8; k++) {
+                    if (corner[k]) {
+                        InPack pack = *reinterpret_cast<const InPack*>(corner[k] + c);
+                        const scalar_t* v = reinterpret_cast<const scalar_t*>(&pack);
+                        for (int j = 0; j < PACK; j++) {
+                            value[j] += weight[k] * values.load(v[j], c + j);
+                        }
+                    }
+                }
+                OutPack pack;
+                output_t* v = reinterpret_cast<output_t*>(&pack);
+                for (int j = 0; j < PACK; j++) {
+                    v[j] = values.store(value[j], c + j);
+                }
+                *reinterpret_cast<OutPack*>(output_NDHW_offset + c) = pack;
+            }
+        } else {
+            for (size_t c = 0; c < C; c++) {
+                float value = 0.f;
+                for (int k = 0; k < 8; k++) {
+                    if (corner[k]) {
+                        value += weight[k] * values.load(corner[k][c], c);
+                    }
+                }
+                output_NDHW_offset[c] = values.store(value, c);
+            }
+        }
     }
+}
+
+template <typename Values, typename Coords, bool vectorized, GridSample3DPaddingMode padding_mode, bool align_corners>
+__global__ void grid_sample_3d_nearest_channels_last_kernel(
+    const typename Values::input_t* input,
+    Values values,
+    Coords coords,
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    size_t pitch,
+    size_t D_grid, size_t H_grid, size_t W_grid,
+    GridSample3DBricks bricks,
+    const GridSample3DTileClass* tile_class,
+    const uint8_t* mask,
+    typename Values::output_t* output
+) {
+    using scalar_t = typename Values::input_t;
+    using output_t = typename Values::output_t;
 
-    auto n = tid / (D_grid * H_grid * W_grid);
-    auto d = (tid / (H_grid * W_grid)) % D_grid;
-    auto h = (tid / W_grid) % H_grid;
-    auto w = tid % W_grid;
+    // grid-stride over the traversal order of the output voxels, about tactic.voxelsPerThread per thread
+    const size_t total = bricks.count(N);
+    for (size_t tid = static_cast<size_t>(blockIdx.x) * blockDim.x + threadIdx.x; tid < total; tid += static_cast<size_t>(blockDim.x) * gridDim.x) {
+        size_t n, d, h, w;
+        if(!bricks.voxel(tid, n, d, h, w)) {
+            continue;
+        }
 
-    const scalar_t* input_N_offset = input + n * input_stride_N;
-    const scalar_t* grid_N_offset = grid + n * grid_stride_N;
-    scalar_t* output_N_offset = output + n * output_stride_N;
+        output_t* output_NDHW_offset = output + (((n * D_grid + d) * H_grid + h) * W_grid + w) * pitch;
+        const GridSample3DTileClass tile = tile_class != nullptr ? tile_class[tid / GRID_SAMPLE_3D_BOUNDS_TILE] : GridSample3DTileClass::Mixed;
+        if(tile == GridSample3DTileClass::Outside || masked_out(mask, n, d, h, w, D_grid, H_grid, W_grid)) {
+            zero_voxel<vectorized>(values, output_NDHW_offset, C, pitch);
+            continue;
+        }
 
-    const scalar_t* grid_NDHW_offset = grid_N_offset + d * grid_stride_D + h * grid_stride_H + w * grid_stride_W;
-    const scalar_t x = *grid_NDHW_offset;
-    const scalar_t y = *(grid_NDHW_offset + grid_stride_XYZ);
-    const scalar_t z = *(grid_NDHW_offset + 2 * grid_stride_XYZ);
+        float gx, gy, gz;
+        coords(n, d, h, w, gx, gy, gz);
+        float ix = compute_index<Coords::kind, padding_mode, align_corners>(gx, w, W_grid, W_in);
+        float iy = compute_index<Coords::kind, padding_mode, align_corners>(gy, h, H_grid, H_in);
+        float iz = compute_index<Coords::kind, padding_mode, align_corners>(gz, d, D_grid, D_in);
 
-    scalar_t ix = compute_index(x, W_in, padding_mode, align_corners);
-    scalar_t iy = compute_index(y, H_in, padding_mode, align_corners);
-    scalar_t iz = compute_index(z, D_in, padding_mode, align_corners);
-    
-    int x0 = static_cast<int>(floor(ix));
-    int y0 = static_cast<int>(floor(iy));
-    int z0 = static_cast<int>(floor(iz));
-    int x1 = x0 + 1;
-    int y1 = y0 + 1;
-    int z1 = z0 + 1;
+        int x = static_cast<int>(::roundf(ix));
+        int y = static_cast<int>(::roundf(iy));
+        int z = static_cast<int>(::roundf(iz));
+        bool inside = ClippedToVolume<padding_mode>::value || tile == GridSample3DTileClass::Inside ||
+                      (x >= 0 && x < W_in && y >= 0 && y < H_in && z >= 0 && z < D_in);
+        const scalar_t* source = inside ? input + n * D_in * H_in * W_in * pitch + ((z * H_in + y) * W_in + x) * pitch : input;
 
-    scalar_t v000 = (ix                        - x0) * (iy - y0)                        * (iz - z0);
-    scalar_t v100 = (static_cast<scalar_t>(x1) - ix) * (iy - y0)                        * (iz - z0);
-    scalar_t v010 = (ix - x0)                        * (static_cast<scalar_t>(y1) - iy) * (iz - z0);
-    scalar_t v110 = (static_cast<scalar_t>(x1) - ix) * (static_cast<scalar_t>(y1) - iy) * (iz - z0);
-    scalar_t v001 = (ix - x0)                        * (iy - y0)                        * (static_cast<scalar_t>(z1) - iz);
-    scalar_t v101 = (static_cast<scalar_t>(x1) - ix) * (iy - y0)                        * (static_cast<scalar_t>(z1) - iz);
-    scalar_t v011 = (ix - x0)                        * (static_cast<scalar_t>(y1) - iy) * (static_cast<scalar_t>(z1) - iz);
-    scalar_t v111 = (static_cast<scalar_t>(x1) - ix) * (static_cast<scalar_t>(y1) - iy) * (static_cast<scalar_t>(z1) - iz);
+        if constexpr (vectorized) {
+            using InPack = typename ChannelPack<scalar_t>::type;
+            using OutPack = typename ChannelPack<output_t>::type;
+            constexpr int PACK = ChannelPack<scalar_t>::size;
+            for (size_t c = 0; c < pitch; c += PACK) {
+                InPack in = {};
+                if (inside) {
+                    in = *reinterpret_cast<const InPack*>(source + c);
+                }
+                const scalar_t* u = reinterpret_cast<const scalar_t*>(&in);
+                OutPack pack;
+                output_t* v = reinterpret_cast<output_t*>(&pack);
+                for (int j = 0; j < PACK; j++) {
+                    v[j] = inside ? values.copy(u[j], c + j) : values.store(0.f, c + j);
+                }
+                *reinterpret_cast<OutPack*>(output_NDHW_offset + c) = pack;
+            }
+        } else {
+            for (size_t c = 0; c < C; c++) {
+                output_NDHW_offset[c] = inside ? values.copy(source[c], c) : values.store(0.f, c);
+            }
+        }
+    }
+}
 
-    scalar_t *input_NC_offset = const_cast<scalar_t *>(input_N_offset);
-    scalar_t *output_NCDHW_offset = output_N_offset + d * output_stride_D + h * output_stride_H + w * output_stride_W;
+// Bucketed sampling (GridSample3DBucketing): the kernels below fill the workspace with the bucket
+// order of the output voxels and then the sampling kernels walk that order. Every step checks the
+// use-order flag on the device, so Auto never needs a host round trip.
 
-    for(auto c = 0; c < C; c++) {
-        scalar_t value = static_cast<scalar_t>(0);
-        if(x1 >= 0 && x1 < W_in && y1 >= 0 && y1 < H_in && z1 >= 0 && z1 < D_in) {
-            value += v000 * input_NC_offset[x1 * input_stride_W + y1 * input_stride_H + z1 * input_stride_D];   
+// Auto: sets *use_order when more than a quarter of the sampled neighbour pairs jump. One block.
+template <typename Coords, GridSample3DPaddingMode padding_mode, bool align_corners>
+__global__ void grid_sample_3d_bucket_coherence_kernel(
+    Coords coords,
+    size_t N, size_t D_in, size_t H_in, size_t W_in,
+    size_t D_grid, size_t H_grid, size_t W_grid,
+    int32_t* use_order
+) {
+    __shared__ unsigned int jumps;
+    if(threadIdx.x == 0) {
+        jumps = 0;
+    }
+    __syncthreads();
+    for(size_t s = threadIdx.x; s < GRID_SAMPLE_3D_BUCKET_SAMPLES && W_grid > 1; s += blockDim.x) {
+        size_t n, d, h, w;
+        grid_sample_3d_bucket_sample(s, N, D_grid, H_grid, W_grid, n, d, h, w);
+        float index[2][3];
+        for(int k = 0; k < 2; k++) {
+            float x, y, z;
+            coords(n, d, h, w + k, x, y, z);
+            index[k][0] = compute_index<Coords::kind, padding_mode, align_corners>(x, static_cast<int>(w + k), static_cast<int>(W_grid), static_cast<int>(W_in));
+            index[k][1] = compute_index<Coords::kind, padding_mode, align_corners>(y, static_cast<int>(h), static_cast<int>(H_grid), static_cast<int>(H_in));
+            index[k][2] = compute_index<Coords::kind, padding_mode, align_corners>(z, static_cast<int>(d), static_cast<int>(D_grid), static_cast<int>(D_in));
         }
-        if(x0 >= 0 && x0 < W_in && y1 >= 0 && y1 < H_in && z1 >= 0 && z1 < D_in) {
-            value += v100 * input_NC_offset[x0 * input_stride_W + y1 * input_stride_H + z1 * input_stride_D];
+        if(grid_sample_3d_bucket_jump(index[0][0], index[0][1], index[0][2], index[1][0], index[1][1], index[1][2])) {
+            atomicAdd(&jumps, 1u);
         }
-        if(x1 >= 0 && x1 < W_in && y0 >= 0 && y0 < H_in && z1 >= 0 && z1 < D_in) {
-            value += v010 * input_NC_offset[x1 * input_stride_W + y0 * input_stride_H + z1 * input_stride_D];
+    }
+    __syncthreads();
+    if(threadIdx.x == 0) {
+        *use_order = jumps * 4 > GRID_SAMPLE_3D_BUCKET_SAMPLES;
+    }
+}
+
+// Counts the voxels of every bucket (scatter = false), or places every voxel at the next free slot
+// of its bucket (scatter = true, offsets holding the exclusive scan of the counts).
+template <typename Coords, GridSample3DPaddingMode padding_mode, bool align_corners, bool scatter>
+__global__ void grid_sample_3d_bucket_kernel(
+    Coords coords,
+    size_t N, size_t D_grid, size_t H_grid, size_t W_grid,
+    GridSample3DBuckets buckets,
+    const int32_t* use_order,
+    uint32_t* offsets,
+    uint32_t* order
+) {
+    if(!*use_order) {
+        return;
+    }
+    const size_t total = N * D_grid * H_grid * W_grid;
+    for(size_t tid = static_cast<size_t>(blockIdx.x) * blockDim.x + threadIdx.x; tid < total;
+        tid += static_cast<size_t>(gridDim.x) * blockDim.x) {
+        const size_t n = tid / (D_grid * H_grid * W_grid);
+        const size_t d = (tid / (H_grid * W_grid)) % D_grid;
+        const size_t h = (tid / W_grid) % H_grid;
+        const size_t w = tid % W_grid;
+        float x, y, z;
+        coords(n, d, h, w, x, y, z);
+        const float ix = compute_index<Coords::kind, padding_mode, align_corners>(x, static_cast<int>(w), static_cast<int>(W_grid), buckets.W);
+        const float iy = compute_index<Coords::kind, padding_mode, align_corners>(y, static_cast<int>(h), static_cast<int>(H_grid), buckets.H);
+        const float iz = compute_index<Coords::kind, padding_mode, align_corners>(z, static_cast<int>(d), static_cast<int>(D_grid), buckets.D);
+        const size_t b = n * buckets.count() + buckets.bucket(ix, iy, iz);
+        if(scatter) {
+            order[atomicAdd(&offsets[b], 1u)] = static_cast<uint32_t>(tid);
+        } else {
+            atomicAdd(&offsets[b], 1u);
         }
-        if(x0 >= 0 && x0 < W_in && y0 >= 0 && y0 < H_in && z1 >= 0 && z1 < D_in) {
-            value += v110 * input_NC_offset[x0 * input_stride_W + y0 * input_stride_H + z1 * input_stride_D];
+    }
+}
+
+// Exclusive scan of the `count` bucket counts in place. One block of BUCKET_SCAN_THREADS threads,
+// each scanning a contiguous range.
+#define BUCKET_SCAN_THREADS 1024
+
+__global__ void grid_sample_3d_bucket_scan_kernel(uint32_t* offsets, size_t count, const int32_t* use_order) {
+    __shared__ uint32_t sums[BUCKET_SCAN_THREADS];
+    if(!*use_order) {
+        return;
+    }
+    const size_t per_thread = (count + blockDim.x - 1) / blockDim.x;
+    const size_t begin = min(count, threadIdx.x * per_thread);
+    const size_t end = min(count, begin + per_thread);
+    uint32_t sum = 0;
+    for(size_t i = begin; i < end; i++) {
+        sum += offsets[i];
+    }
+    sums[threadIdx.x] = sum;
+    __syncthreads();
+    if(threadIdx.x == 0) {
+        uint32_t run = 0;
+        for(unsigned int t = 0; t < blockDim.x; t++) {
+            const uint32_t v = sums[t];
+            sums[t] = run;
+            run += v;
         }
-        if(x1 >= 0 && x1 < W_in && y1 >= 0 && y1 < H_in && z0 >= 0 && z0 < D_in) {
-            value += v001 * input_NC_offset[x1 * input_stride_W + y1 * input_stride_H + z0 * input_stride_D];
+    }
+    __syncthreads();
+    uint32_t run = sums[threadIdx.x];
+    for(size_t i = begin; i < end; i++) {
+        const uint32_t v = offsets[i];
+        offsets[i] = run;
+        run += v;
+    }
+}
+
+// Queues the bucket sort of the output voxels into `workspace` and points `bricks` at the order.
+// Returns false (sampling stays in output order) when bucketing is off, there is no workspace or
+// the output has too many voxels for 32-bit order entries.
+template <typename Modes, typename Coords>
+static bool bucket_outputs(
+    Coords coords,
+    size_t N, size_t D_in, size_t H_in, size_t W_in,
+    size_t D_grid, size_t H_grid, size_t W_grid,
+    GridSample3DBucketing bucketing,
+    void* workspace,
+    cudaStream_t stream,
+    GridSample3DBricks& bricks
+) {
+    const size_t voxels = N * D_grid * H_grid * W_grid;
+    if(bucketing == GridSample3DBucketing::Off || workspace == nullptr || voxels > UINT32_MAX) {
+        return false;
+    }
+    const GridSample3DBuckets buckets = grid_sample_3d_buckets(D_in, H_in, W_in);
+    const size_t count = N * buckets.count();
+    const GridSample3DBucketWorkspace layout(count, voxels);
+    char* base = static_cast<char*>(workspace);
+    int32_t* use_order = reinterpret_cast<int32_t*>(base);
+    uint32_t* offsets = reinterpret_cast<uint32_t*>(base + layout.offsets_at);
+    uint32_t* order = reinterpret_cast<uint32_t*>(base + layout.order_at);
+
+    if(bucketing == GridSample3DBucketing::Auto) {
+        grid_sample_3d_bucket_coherence_kernel<Coords, Modes::padding, Modes::align_corners><<<1, 256, 0, stream>>>(
+            coords, N, D_in, H_in, W_in, D_grid, H_grid, W_grid, use_order);
+    } else {
+        // any non-zero flag; a memset keeps the call capturable into a CUDA graph, unlike a copy
+        // from pageable host memory
+        cudaMemsetAsync(use_order, 1, sizeof(int32_t), stream);
+    }
+    cudaMemsetAsync(offsets, 0, count * sizeof(uint32_t), stream);
+    const dim3 threads(256);
+    const dim3 blocks(static_cast<unsigned int>(std::min<size_t>((voxels + 255) / 256, 65535)));
+    grid_sample_3d_bucket_kernel<Coords, Modes::padding, Modes::align_corners, false><<<blocks, threads, 0, stream>>>(
+        coords, N, D_grid, H_grid, W_grid, buckets, use_order, offsets, order);
+    grid_sample_3d_bucket_scan_kernel<<<1, BUCKET_SCAN_THREADS, 0, stream>>>(offsets, count, use_order);
+    grid_sample_3d_bucket_kernel<Coords, Modes::padding, Modes::align_corners, true><<<blocks, threads, 0, stream>>>(
+        coords, N, D_grid, H_grid, W_grid, buckets, use_order, offsets, order);
+
+    bricks.order = order;
+    bricks.use_order = use_order;
+    bricks.ordered = voxels;
+    return true;
+}
+
+// Bounds prepass (GridSample3DTactic::tileBounds): one block of GRID_SAMPLE_3D_BOUNDS_TILE threads
+// per tile (grid-stride over the tiles) reduces the box around the source indices of the tile's
+// voxels, in the order the sampling kernels visit them, and stores the tile class. Masked-out
+// voxels are left out of the box, so a tile with none left is Outside.
+template <typename Coords, typename Modes>
+__global__ void grid_sample_3d_tile_bounds_kernel(
+    Coords coords,
+    size_t N, size_t D_in, size_t H_in, size_t W_in,
+    size_t D_grid, size_t H_grid, size_t W_grid,
+    GridSample3DBricks bricks,
+    size_t tiles,
+    const uint8_t* mask,
+    GridSample3DTileClass* tile_class
+) {
+    __shared__ float lo[3][GRID_SAMPLE_3D_BOUNDS_TILE];
+    __shared__ float hi[3][GRID_SAMPLE_3D_BOUNDS_TILE];
+    const size_t total = bricks.count(N);
+    for(size_t t = blockIdx.x; t < tiles; t += gridDim.x) {
+        GridSample3DIndexBox box;
+        const size_t tid = t * GRID_SAMPLE_3D_BOUNDS_TILE + threadIdx.x;
+        size_t n, d, h, w;
+        if(tid < total && bricks.voxel(tid, n, d, h, w) && !masked_out(mask, n, d, h, w, D_grid, H_grid, W_grid)) {
+            float x, y, z;
+            coords(n, d, h, w, x, y, z);
+            box.add(compute_index<Coords::kind, Modes::padding, Modes::align_corners>(x, w, W_grid, W_in),
+                    compute_index<Coords::kind, Modes::padding, Modes::align_corners>(y, h, H_grid, H_in),
+                    compute_index<Coords::kind, Modes::padding, Modes::align_corners>(z, d, D_grid, D_in));
         }
-        if(x0 >= 0 && x0 < W_in && y1 >= 0 && y1 < H_in && z0 >= 0 && z0 < D_in) {
-            value += v101 * input_NC_offset[x0 * input_stride_W + y1 * input_stride_H + z0 * input_stride_D];
+        // also the barrier that makes the previous tile's reads of lo/hi complete
+        const bool nan = __syncthreads_or(box.nan);
+        for(int a = 0; a < 3; a++) {
+            lo[a][threadIdx.x] = box.lo[a];
+            hi[a][threadIdx.x] = box.hi[a];
         }
-        if(x1 >= 0 && x1 < W_in && y0 >= 0 && y0 < H_in && z0 >= 0 && z0 < D_in) {
-            value += v011 * input_NC_offset[x1 * input_stride_W + y0 * input_stride_H + z0 * input_stride_D];
+        __syncthreads();
+        for(unsigned int stride = GRID_SAMPLE_3D_BOUNDS_TILE / 2; stride > 0; stride /= 2) {
+            if(threadIdx.x < stride) {
+                for(int a = 0; a < 3; a++) {
+                    lo[a][threadIdx.x] = fminf(lo[a][threadIdx.x], lo[a][threadIdx.x + stride]);
+                    hi[a][threadIdx.x] = fmaxf(hi[a][threadIdx.x], hi[a][threadIdx.x + stride]);
+                }
+            }
+            __syncthreads();
         }
-        if(x0 >= 0 && x0 < W_in && y0 >= 0 && y0 < H_in && z0 >= 0 && z0 < D_in) {
-            value += v111 * input_NC_offset[x0 * input_stride_W + y0 * input_stride_H + z0 * input_stride_D];
+        if(threadIdx.x == 0) {
+            GridSample3DIndexBox tile;
+            for(int a = 0; a < 3; a++) {
+                tile.lo[a] = lo[a][0];
+                tile.hi[a] = hi[a][0];
+            }
+            tile.nan = nan;
+            tile_class[t] = tile.classify(Modes::interpolation, static_cast<int>(W_in), static_cast<int>(H_in), static_cast<int>(D_in));
         }
-        *output_NCDHW_offset = value;
-        input_NC_offset += input_stride_C;
-        output_NCDHW_offset += output_stride_C;
-          
     }
-    
 }
 
-template <typename scalar_t>
-int grid_sample_3d_cuda(
-    const scalar_t* input,
-    const scalar_t* grid,
+// Queues the bounds prepass into its part of `workspace` and returns the tile classes the
+// sampling kernels read; nullptr (per-voxel checks only) without tileBounds or a workspace.
+template <typename Modes, typename Coords>
+static const GridSample3DTileClass* classify_tiles(
+    Coords coords,
+    size_t N, size_t D_in, size_t H_in, size_t W_in,
+    size_t D_grid, size_t H_grid, size_t W_grid,
+    const GridSample3DBricks& bricks,
+    const GridSample3DTactic& tactic,
+    void* workspace,
+    const uint8_t* mask,
+    cudaStream_t stream
+) {
+    if(!tactic.tileBounds || workspace == nullptr) {
+        return nullptr;
+    }
+    const GridSample3DWorkspace layout(tactic, N, D_in, H_in, W_in, D_grid, H_grid, W_grid);
+    GridSample3DTileClass* tile_class = reinterpret_cast<GridSample3DTileClass*>(static_cast<char*>(workspace) + layout.tiles_at);
+    const dim3 blocks(static_cast<unsigned int>(std::min<size_t>(std::max<size_t>(layout.tiles, 1), 65535)));
+    grid_sample_3d_tile_bounds_kernel<Coords, Modes><<<blocks, GRID_SAMPLE_3D_BOUNDS_TILE, 0, stream>>>(
+        coords, N, D_in, H_in, W_in, D_grid, H_grid, W_grid, bricks, layout.tiles, mask, tile_class);
+    return tile_class;
+}
+
+template <typename Values, typename Modes, bool vectorized, typename Coords>
+static void launch_channels_last_kernel(
+    const typename Values::input_t* input,
+    Values values,
+    Coords coords,
     size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    size_t pitch,
     size_t D_grid, size_t H_grid, size_t W_grid,
-    bool align_corners,
-    GridSample3DInterpolationMode interpolationMode,
-    GridSample3DPaddingMode paddingMode,
-    scalar_t* output,
+    const GridSample3DBricks& bricks,
+    const GridSample3DTileClass* tile_class,
+    const uint8_t* mask,
+    typename Values::output_t* output,
+    cudaStream_t stream,
+    const GridSample3DTactic& tactic
+) {
+    TacticLaunch launch(tactic, bricks.count(N), 0);
+    dim3 dimBlock = launch.threads;
+    dim3 dimGrid = launch.blocks;
+
+    if constexpr (Modes::interpolation == GridSample3DInterpolationMode::Bilinear) {
+        grid_sample_3d_bilinear_channels_last_kernel<Values, Coords, vectorized, Modes::padding, Modes::align_corners>
+            <<<dimGrid, dimBlock, 0, stream>>>(
+            input, values, coords, N, C, D_in, H_in, W_in, pitch, D_grid, H_grid, W_grid, bricks, tile_class, mask, output);
+    } else {
+        grid_sample_3d_nearest_channels_last_kernel<Values, Coords, vectorized, Modes::padding, Modes::align_corners>
+            <<<dimGrid, dimBlock, 0, stream>>>(
+            input, values, coords, N, C, D_in, H_in, W_in, pitch, D_grid, H_grid, W_grid, bricks, tile_class, mask, output);
+    }
+}
+
+// NCDHW kernels with index_t (uint32_t or size_t) index math.
+template <typename Values, typename Modes, typename index_t, typename Coords>
+static void launch_ncdhw_kernel(
+    const typename Values::input_t* input,
+    Values values,
+    Coords coords,
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    const GridSample3DStrides& input_strides,
+    size_t D_grid, size_t H_grid, size_t W_grid,
+    const GridSample3DStrides& output_strides,
+    const TacticLaunch& launch,
+    const GridSample3DBricks& bricks,
+    const GridSample3DTileClass* tile_class,
+    const uint8_t* mask,
+    typename Values::output_t* output,
     cudaStream_t stream
 ) {
-    
-    size_t totalThreads = N * D_grid * W_grid * H_grid;
-    dim3 dimBlock(NUM_THREADS);
-    dim3 dimGrid(get_num_blocks(totalThreads));
-
-    size_t input_stride_N = C * D_in * H_in * W_in;
-    size_t input_stride_C = D_in * H_in * W_in;
-    size_t input_stride_D = H_in * W_in;
-    size_t input_stride_H = W_in;
-    size_t input_stride_W = 1;
-
-    size_t grid_stride_N = D_grid * H_grid * W_grid * 3;
-    size_t grid_stride_D = H_grid * W_grid * 3;
-    size_t grid_stride_H = W_grid * 3;
-    size_t grid_stride_W = 3;
-    size_t grid_stride_XYZ = 1;
-
-    size_t output_stride_N = C * D_grid * H_grid * W_grid;
-    size_t output_stride_C = D_grid * H_grid * W_grid;
-    size_t output_stride_D = H_grid * W_grid;
-    size_t output_stride_H = W_grid;
-    size_t output_stride_W = 1;
-
-    if(interpolationMode == GridSample3DInterpolationMode::Bilinear) {
-        grid_sample_3d_bilinear_kernel<scalar_t><<<dimGrid, dimBlock, 0, stream>>>(
+    const index_t input_stride_N = static_cast<index_t>(input_strides.N);
+    const index_t input_stride_C = static_cast<index_t>(input_strides.C);
+    const index_t input_stride_D = static_cast<index_t>(input_strides.D);
+    const index_t input_stride_H = static_cast<index_t>(input_strides.H);
+    const index_t input_stride_W = static_cast<index_t>(input_strides.W);
+
+    const index_t output_stride_N = static_cast<index_t>(output_strides.N);
+    const index_t output_stride_C = static_cast<index_t>(output_strides.C);
+    const index_t output_stride_D = static_cast<index_t>(output_strides.D);
+    const index_t output_stride_H = static_cast<index_t>(output_strides.H);
+    const index_t output_stride_W = static_cast<index_t>(output_strides.W);
+
+    if constexpr (Modes::interpolation == GridSample3DInterpolationMode::Bilinear) {
+        grid_sample_3d_bilinear_kernel<Values, Coords, Modes::padding, Modes::align_corners, index_t><<<launch.blocks, launch.threads, 0, stream>>>(
             input,
-            grid,
-            N, C, D_in, H_in, W_in,
+            values,
+            coords,
+            static_cast<index_t>(N), static_cast<index_t>(C),
+            static_cast<index_t>(D_in), static_cast<index_t>(H_in), static_cast<index_t>(W_in),
             input_stride_N, input_stride_C, input_stride_D, input_stride_H, input_stride_W,
-            D_grid, H_grid, W_grid,
-            grid_stride_N, grid_stride_D, grid_stride_H, grid_stride_W, grid_stride_XYZ,
+            static_cast<index_t>(D_grid), static_cast<index_t>(H_grid), static_cast<index_t>(W_grid),
             output_stride_N, output_stride_C, output_stride_D, output_stride_H, output_stride_W,
-            align_corners,
-            paddingMode,
+            static_cast<index_t>(launch.channels_per_thread),
+            bricks,
+            tile_class,
+            mask,
             output
         );
-    } else if(interpolationMode == GridSample3DInterpolationMode::Nearest) {
-        grid_sample_3d_nearest_kernel<scalar_t><<<dimGrid, dimBlock, 0, stream>>>(
+    } else {
+        grid_sample_3d_nearest_kernel<Values, Coords, Modes::padding, Modes::align_corners, index_t><<<launch.blocks, launch.threads, 0, stream>>>(
             input,
-            grid,
-            N, C, D_in, H_in, W_in,
+            values,
+            coords,
+            static_cast<index_t>(N), static_cast<index_t>(C),
+            static_cast<index_t>(D_in), static_cast<index_t>(H_in), static_cast<index_t>(W_in),
             input_stride_N, input_stride_C, input_stride_D, input_stride_H, input_stride_W,
-            D_grid, H_grid, W_grid,
-            grid_stride_N, grid_stride_D, grid_stride_H, grid_stride_W, grid_stride_XYZ,
+            static_cast<index_t>(D_grid), static_cast<index_t>(H_grid), static_cast<index_t>(W_grid),
             output_stride_N, output_stride_C, output_stride_D, output_stride_H, output_stride_W,
-            align_corners,
-            paddingMode,
+            static_cast<index_t>(launch.channels_per_thread),
+            bricks,
+            tile_class,
+            mask,
             output
-        );        
+        );
+    }
+}
+
+// Launches the kernels specialized on the value policy, the sampling modes and the coordinate source.
+template <typename Values, typename Modes, typename Coords>
+static int grid_sample_3d_launch_coords(
+    const typename Values::input_t* input,
+    Values values,
+    Coords coords,
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    size_t D_grid, size_t H_grid, size_t W_grid,
+    typename Values::output_t* output,
+    cudaStream_t stream,
+    GridSample3DLayout layout,
+    const GridSample3DTactic& tactic,
+    void* workspace,
+    const uint8_t* mask
+) {
+    using scalar_t = typename Values::input_t;
+    using output_t = typename Values::output_t;
+
+    GridSample3DBricks bricks = grid_sample_3d_cuda_bricks(tactic, D_grid, H_grid, W_grid);
+    bucket_outputs<Modes>(coords, N, D_in, H_in, W_in, D_grid, H_grid, W_grid, tactic.bucketing, workspace, stream, bricks);
+    const GridSample3DTileClass* tile_class = classify_tiles<Modes>(coords, N, D_in, H_in, W_in, D_grid, H_grid, W_grid,
+                                                                    bricks, tactic, workspace, mask, stream);
+
+    if(layout != GridSample3DLayout::NCDHW) {
+        constexpr int PACK = ChannelPack<scalar_t>::size;
+        constexpr bool packable = PACK == ChannelPack<output_t>::size;
+        size_t pitch = grid_sample_3d_channel_pitch(layout, C);
+        bool aligned = reinterpret_cast<uintptr_t>(input) % 16 == 0 && reinterpret_cast<uintptr_t>(output) % 16 == 0;
+        if(packable && pitch % PACK == 0 && aligned) {
+            launch_channels_last_kernel<Values, Modes, packable>(input, values, coords, N, C, D_in, H_in, W_in, pitch,
+                                                                 D_grid, H_grid, W_grid, bricks, tile_class, mask, output, stream, tactic);
+        } else {
+            launch_channels_last_kernel<Values, Modes, false>(input, values, coords, N, C, D_in, H_in, W_in, pitch,
+                                                              D_grid, H_grid, W_grid, bricks, tile_class, mask, output, stream, tactic);
+        }
+        cudaError_t err = cudaGetLastError();
+        if(err != cudaSuccess) {
+            grid_sample_3d_log(GridSample3DLogSeverity::Error, "Error in grid_sample_3d_cuda: %s", cudaGetErrorString(err));
+        }
+        return err != cudaSuccess;
+    }
+
+    TacticLaunch launch(tactic, bricks.count(N), C);
+    const GridSample3DStrides input_strides = grid_sample_3d_contiguous_strides(C, D_in, H_in, W_in);
+    const GridSample3DStrides output_strides = grid_sample_3d_contiguous_strides(C, D_grid, H_grid, W_grid);
+
+    // 32-bit index math whenever every index fits, the 64-bit instantiation for larger tensors
+    if(grid_sample_3d_index_fits_32bit(N, C, D_in, H_in, W_in, D_grid, H_grid, W_grid, bricks.count(N))) {
+        launch_ncdhw_kernel<Values, Modes, uint32_t>(input, values, coords, N, C, D_in, H_in, W_in, input_strides,
+                                                     D_grid, H_grid, W_grid, output_strides,
+                                                     launch, bricks, tile_class, mask, output, stream);
     } else {
-        return 1;
+        launch_ncdhw_kernel<Values, Modes, size_t>(input, values, coords, N, C, D_in, H_in, W_in, input_strides,
+                                                   D_grid, H_grid, W_grid, output_strides,
+                                                   launch, bricks, tile_class, mask, output, stream);
     }
 
     // cudaDeviceSynchronize();
@@ -226,33 +979,1821 @@ int grid_sample_3d_cuda(
 
     cudaError_t err = cudaGetLastError();
     if(err != cudaSuccess) {
-        printf("Error in grid_sample_3d_cuda: %s\n", cudaGetErrorString(err));
+        grid_sample_3d_log(GridSample3DLogSeverity::Error, "Error in grid_sample_3d_cuda: %s", cudaGetErrorString(err));
     }
 
-    return cudaGetLastError() != cudaSuccess;
+    return err != cudaSuccess;
 }
 
-// template specialization
-template int grid_sample_3d_cuda<float>(
-    const float* input,
-    const float* grid,
+// One entry of the launcher table: coordinates read from an N x D x H x W x 3 grid of the given kind.
+template <typename scalar_t, typename grid_t, typename Modes, GridSample3DGridKind grid_kind>
+static int grid_sample_3d_launch(
+    const void* input,
+    const void* grid_,
     size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
     size_t D_grid, size_t H_grid, size_t W_grid,
-    bool align_corners,
-    GridSample3DInterpolationMode interpolationMode,
-    GridSample3DPaddingMode paddingMode,
-    float* output,
-    cudaStream_t stream
-);
+    void* output,
+    cudaStream_t stream,
+    GridSample3DLayout layout,
+    const GridSample3DTactic& tactic,
+    void* workspace,
+    const uint8_t* mask
+) {
+    GridCoords<grid_t, grid_kind> coords;
+    coords.grid = static_cast<const grid_t*>(grid_);
+    coords.stride_N = D_grid * H_grid * W_grid * 3;
+    coords.stride_D = H_grid * W_grid * 3;
+    coords.stride_H = W_grid * 3;
+    coords.stride_W = 3;
+    coords.stride_XYZ = 1;
+    return grid_sample_3d_launch_coords<ConvertValues<scalar_t>, Modes>(static_cast<const scalar_t*>(input),
+                                                                        ConvertValues<scalar_t>{}, coords,
+                                                                        N, C, D_in, H_in, W_in, D_grid, H_grid, W_grid,
+                                                                        static_cast<scalar_t*>(output), stream, layout, tactic, workspace, mask);
+}
 
-template int grid_sample_3d_cuda<half>(
-    const half* input,
-    const half* grid,
+// grid_sample_3d_strided_cuda: the NCDHW kernels with the strides of the views instead of contiguous ones.
+template <typename scalar_t, typename grid_t, typename Modes>
+static int grid_sample_3d_strided_launch(
+    const scalar_t* input,
+    const GridSample3DStrides& input_strides,
+    const grid_t* grid,
+    const GridSample3DGridStrides& grid_strides,
     size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
     size_t D_grid, size_t H_grid, size_t W_grid,
-    bool align_corners,
-    GridSample3DInterpolationMode interpolationMode,
-    GridSample3DPaddingMode paddingMode,
-    half* output,
-    cudaStream_t stream
-);
\ No newline at end of file
+    scalar_t* output,
+    const GridSample3DStrides& output_strides,
+    cudaStream_t stream,
+    const GridSample3DTactic& tactic,
+    void* workspace,
+    const uint8_t* mask
+) {
+    GridCoords<grid_t, GridSample3DGridKind::Absolute> coords;
+    coords.grid = grid;
+    coords.stride_N = grid_strides.N;
+    coords.stride_D = grid_strides.D;
+    coords.stride_H = grid_strides.H;
+    coords.stride_W = grid_strides.W;
+    coords.stride_XYZ = grid_strides.XYZ;
+
+    GridSample3DBricks bricks = grid_sample_3d_cuda_bricks(tactic, D_grid, H_grid, W_grid);
+    bucket_outputs<Modes>(coords, N, D_in, H_in, W_in, D_grid, H_grid, W_grid, tactic.bucketing, workspace, stream, bricks);
+    const GridSample3DTileClass* tile_class = classify_tiles<Modes>(coords, N, D_in, H_in, W_in, D_grid, H_grid, W_grid,
+                                                                    bricks, tactic, workspace, mask, stream);
+    TacticLaunch launch(tactic, bricks.count(N), C);
+
+    if(grid_sample_3d_strided_index_fits_32bit(N, C, D_in, H_in, W_in, input_strides, D_grid, H_grid, W_grid,
+                                               grid_strides, output_strides, bricks.count(N))) {
+        launch_ncdhw_kernel<ConvertValues<scalar_t>, Modes, uint32_t>(input, ConvertValues<scalar_t>{}, coords,
+                                                                      N, C, D_in, H_in, W_in, input_strides,
+                                                                      D_grid, H_grid, W_grid, output_strides,
+                                                                      launch, bricks, tile_class, mask, output, stream);
+    } else {
+        launch_ncdhw_kernel<ConvertValues<scalar_t>, Modes, size_t>(input, ConvertValues<scalar_t>{}, coords,
+                                                                    N, C, D_in, H_in, W_in, input_strides,
+                                                                    D_grid, H_grid, W_grid, output_strides,
+                                                                    launch, bricks, tile_class, mask, output, stream);
+    }
+
+    cudaError_t err = cudaGetLastError();
+    if(err != cudaSuccess) {
+        grid_sample_3d_log(GridSample3DLogSeverity::Error, "Error in grid_sample_3d_strided_cuda: %s", cudaGetErrorString(err));
+    }
+    return err != cudaSuccess;
+}
+
+// One entry of the affine launcher table: the `grid` argument is theta (N x 3 x 4).
+template <typename scalar_t, typename grid_t, typename Modes>
+static int grid_sample_3d_affine_launch(
+    const void* input,
+    const void* theta,
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    size_t D_grid, size_t H_grid, size_t W_grid,
+    void* output,
+    cudaStream_t stream,
+    GridSample3DLayout layout,
+    const GridSample3DTactic& tactic,
+    void* workspace,
+    const uint8_t* mask
+) {
+    AffineCoords<grid_t, Modes::align_corners> coords;
+    coords.theta = static_cast<const grid_t*>(theta);
+    coords.D = static_cast<int>(D_grid);
+    coords.H = static_cast<int>(H_grid);
+    coords.W = static_cast<int>(W_grid);
+    return grid_sample_3d_launch_coords<ConvertValues<scalar_t>, Modes>(static_cast<const scalar_t*>(input),
+                                                                        ConvertValues<scalar_t>{}, coords,
+                                                                        N, C, D_in, H_in, W_in, D_grid, H_grid, W_grid,
+                                                                        static_cast<scalar_t*>(output), stream, layout, tactic, workspace, mask);
+}
+
+// One entry of the quantized launcher table: int8/uint8 input, coordinates from a grid.
+template <typename q_t, typename out_t, typename grid_t, typename Modes, GridSample3DGridKind grid_kind>
+static int grid_sample_3d_quantized_launch(
+    const void* input,
+    const GridSample3DQuantization& inputQuantization,
+    const void* grid_,
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    size_t D_grid, size_t H_grid, size_t W_grid,
+    void* output,
+    const GridSample3DQuantization& outputQuantization,
+    cudaStream_t stream,
+    GridSample3DLayout layout,
+    const GridSample3DTactic& tactic,
+    void* workspace,
+    const uint8_t* mask
+) {
+    // the per-channel parameters cover C channels, not the NDHWC8 padding
+    if(layout == GridSample3DLayout::NDHWC8) {
+        grid_sample_3d_log(GridSample3DLogSeverity::Error, "Error in grid_sample_3d_quantized_cuda: NDHWC8 layout is not supported");
+        return 1;
+    }
+    GridCoords<grid_t, grid_kind> coords;
+    coords.grid = static_cast<const grid_t*>(grid_);
+    coords.stride_N = D_grid * H_grid * W_grid * 3;
+    coords.stride_D = H_grid * W_grid * 3;
+    coords.stride_H = W_grid * 3;
+    coords.stride_W = 3;
+    coords.stride_XYZ = 1;
+    DequantizeValues<q_t, out_t> values{inputQuantization, outputQuantization};
+    return grid_sample_3d_launch_coords<DequantizeValues<q_t, out_t>, Modes>(static_cast<const q_t*>(input), values, coords,
+                                                                             N, C, D_in, H_in, W_in, D_grid, H_grid, W_grid,
+                                                                             static_cast<out_t*>(output), stream, layout, tactic, workspace, mask);
+}
+
+// One entry of the label-map launcher table (nearest modes only).
+template <typename label_t, typename grid_t, typename Modes, GridSample3DGridKind grid_kind>
+static int grid_sample_3d_labels_launch(
+    const void* input,
+    const void* grid_,
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    size_t D_grid, size_t H_grid, size_t W_grid,
+    void* output,
+    cudaStream_t stream,
+    GridSample3DLayout layout,
+    const GridSample3DTactic& tactic,
+    void* workspace,
+    const uint8_t* mask
+) {
+    static_assert(Modes::interpolation == GridSample3DInterpolationMode::Nearest, "label maps are sampled with nearest");
+    GridCoords<grid_t, grid_kind> coords;
+    coords.grid = static_cast<const grid_t*>(grid_);
+    coords.stride_N = D_grid * H_grid * W_grid * 3;
+    coords.stride_D = H_grid * W_grid * 3;
+    coords.stride_H = W_grid * 3;
+    coords.stride_W = 3;
+    coords.stride_XYZ = 1;
+    return grid_sample_3d_launch_coords<LabelValues<label_t>, Modes>(static_cast<const label_t*>(input),
+                                                                     LabelValues<label_t>{}, coords,
+                                                                     N, C, D_in, H_in, W_in, D_grid, H_grid, W_grid,
+                                                                     static_cast<label_t*>(output), stream, layout, tactic, workspace, mask);
+}
+
+template <typename scalar_t, typename grid_t, typename Modes>
+static GridSample3DCudaLauncher select_grid_launcher(GridSample3DGridKind gridKind, bool affine) {
+    if(affine) {
+        return grid_sample_3d_affine_launch<scalar_t, grid_t, Modes>;
+    }
+    switch(gridKind) {
+    case GridSample3DGridKind::Absolute:
+        return grid_sample_3d_launch<scalar_t, grid_t, Modes, GridSample3DGridKind::Absolute>;
+    case GridSample3DGridKind::DisplacementVoxels:
+        return grid_sample_3d_launch<scalar_t, grid_t, Modes, GridSample3DGridKind::DisplacementVoxels>;
+    case GridSample3DGridKind::DisplacementNormalized:
+        return grid_sample_3d_launch<scalar_t, grid_t, Modes, GridSample3DGridKind::DisplacementNormalized>;
+    }
+    return nullptr;
+}
+
+// The grid is either fp32 or of the input type; other pairs are not instantiated.
+template <typename scalar_t, typename Modes>
+static GridSample3DCudaLauncher select_grid_type(GridSample3DDataType gridDataType, GridSample3DGridKind gridKind,
+                                                 bool affine) {
+    if(gridDataType == GridSample3DDataType::GFLOAT) {
+        return select_grid_launcher<scalar_t, float, Modes>(gridKind, affine);
+    }
+    if(gridDataType == GridSample3DDataTypeOf<scalar_t>::value) {
+        return select_grid_launcher<scalar_t, scalar_t, Modes>(gridKind, affine);
+    }
+    return nullptr;
+}
+
+template <typename q_t, typename out_t, typename grid_t, typename Modes>
+static GridSample3DQuantizedCudaLauncher select_quantized_grid_launcher(GridSample3DGridKind gridKind) {
+    switch(gridKind) {
+    case GridSample3DGridKind::Absolute:
+        return grid_sample_3d_quantized_launch<q_t, out_t, grid_t, Modes, GridSample3DGridKind::Absolute>;
+    case GridSample3DGridKind::DisplacementVoxels:
+        return grid_sample_3d_quantized_launch<q_t, out_t, grid_t, Modes, GridSample3DGridKind::DisplacementVoxels>;
+    case GridSample3DGridKind::DisplacementNormalized:
+        return grid_sample_3d_quantized_launch<q_t, out_t, grid_t, Modes, GridSample3DGridKind::DisplacementNormalized>;
+    }
+    return nullptr;
+}
+
+// The output is requantized to q_t or fp16, the grid is fp32 or fp16.
+template <typename q_t, typename Modes>
+static GridSample3DQuantizedCudaLauncher select_quantized_types(
+    GridSample3DDataType outputDataType,
+    GridSample3DDataType gridDataType,
+    GridSample3DGridKind gridKind
+) {
+    const bool float_grid = gridDataType == GridSample3DDataType::GFLOAT;
+    if(!float_grid && gridDataType != GridSample3DDataType::GHALF) {
+        return nullptr;
+    }
+    if(outputDataType == GridSample3DDataTypeOf<q_t>::value) {
+        return float_grid ? select_quantized_grid_launcher<q_t, q_t, float, Modes>(gridKind)
+                          : select_quantized_grid_launcher<q_t, q_t, half, Modes>(gridKind);
+    }
+    if(outputDataType == GridSample3DDataType::GHALF) {
+        return float_grid ? select_quantized_grid_launcher<q_t, half, float, Modes>(gridKind)
+                          : select_quantized_grid_launcher<q_t, half, half, Modes>(gridKind);
+    }
+    return nullptr;
+}
+
+// Ragged batch, one thread per packed output voxel: the voxel's item is found by a binary search
+// of the item table on grid_offset, then its taps are resolved once and reused for every channel.
+// The table comes from a device tensor, so every block first checks all of it
+// (grid_sample_3d_ragged_item_valid); a malformed table zero-fills the whole output instead of
+// reading or writing out of bounds.
+template <typename scalar_t, typename grid_t, typename Modes>
+__global__ void grid_sample_3d_ragged_kernel(
+    const scalar_t* input,
+    const grid_t* grid,
+    const GridSample3DRaggedItem* items,
+    size_t numItems, size_t C, size_t V_in, size_t G,
+    scalar_t* output
+) {
+    constexpr bool bilinear = Modes::interpolation == GridSample3DInterpolationMode::Bilinear;
+    int invalid = 0;
+    for(size_t i = threadIdx.x; i < numItems; i += blockDim.x) {
+        invalid |= !grid_sample_3d_ragged_item_valid(items, i, numItems, V_in, G);
+    }
+    if(__syncthreads_or(invalid)) {
+        for(size_t g = static_cast<size_t>(blockIdx.x) * blockDim.x + threadIdx.x; g < G; g += static_cast<size_t>(gridDim.x) * blockDim.x) {
+            for(size_t c = 0; c < C; c++) {
+                output[c * G + g] = from_float<scalar_t>(0.f);
+            }
+        }
+        return;
+    }
+    for(size_t g = static_cast<size_t>(blockIdx.x) * blockDim.x + threadIdx.x; g < G; g += static_cast<size_t>(gridDim.x) * blockDim.x) {
+        // last item starting at or before g
+        size_t lo = 0, hi = numItems;
+        while(hi - lo > 1) {
+            const size_t mid = (lo + hi) / 2;
+            if(static_cast<size_t>(items[mid].grid_offset) <= g) {
+                lo = mid;
+            } else {
+                hi = mid;
+            }
+        }
+        const GridSample3DRaggedItem item = items[lo];
+        const size_t s = g - item.grid_offset;
+        if(g < static_cast<size_t>(item.grid_offset) || s >= static_cast<size_t>(item.D_grid) * item.H_grid * item.W_grid) {
+            continue;
+        }
+        const int D_in = item.D_in, H_in = item.H_in, W_in = item.W_in;
+        const float ix = compute_index<Modes::padding, Modes::align_corners>(to_float(grid[3 * g]), W_in);
+        const float iy = compute_index<Modes::padding, Modes::align_corners>(to_float(grid[3 * g + 1]), H_in);
+        const float iz = compute_index<Modes::padding, Modes::align_corners>(to_float(grid[3 * g + 2]), D_in);
+        const scalar_t* input_item = input + item.input_offset;
+        if constexpr (bilinear) {
+            const int x0 = static_cast<int>(::floorf(ix));
+            const int y0 = static_cast<int>(::floorf(iy));
+            const int z0 = static_cast<int>(::floorf(iz));
+            int32_t offset[8];
+            float weight[8];
+            // corner order and weight products of grid_sample_3d_bilinear_kernel, high corner first
+            int k = 0;
+            for(int dz = 1; dz >= 0; dz--) {
+                for(int dy = 1; dy >= 0; dy--) {
+                    for(int dx = 1; dx >= 0; dx--, k++) {
+                        const int x = x0 + dx, y = y0 + dy, z = z0 + dz;
+                        const bool inside = x >= 0 && x < W_in && y >= 0 && y < H_in && z >= 0 && z < D_in;
+                        offset[k] = inside ? (z * H_in + y) * W_in + x : -1;
+                        weight[k] = (dx ? ix - x0 : static_cast<float>(x0 + 1) - ix) *
+                                    (dy ? iy - y0 : static_cast<float>(y0 + 1) - iy) *
+                                    (dz ? iz - z0 : static_cast<float>(z0 + 1) - iz);
+                    }
+                }
+            }
+            for(size_t c = 0; c < C; c++) {
+                const scalar_t* input_C = input_item + c * V_in;
+                float value = 0.f;
+                for(k = 0; k < 8; k++) {
+                    if(offset[k] >= 0) {
+                        value += weight[k] * to_float(input_C[offset[k]]);
+                    }
+                }
+                output[c * G + g] = from_float<scalar_t>(value);
+            }
+        } else {
+            const int x = static_cast<int>(::roundf(ix));
+            const int y = static_cast<int>(::roundf(iy));
+            const int z = static_cast<int>(::roundf(iz));
+            const bool inside = x >= 0 && x < W_in && y >= 0 && y < H_in && z >= 0 && z < D_in;
+            const int32_t offset = inside ? (z * H_in + y) * W_in + x : -1;
+            for(size_t c = 0; c < C; c++) {
+                output[c * G + g] = offset >= 0 ? input_item[c * V_in + offset] : from_float<scalar_t>(0.f);
+            }
+        }
+    }
+}
+
+template <typename scalar_t, typename grid_t, typename Modes>
+static int grid_sample_3d_ragged_launch(
+    const void* input,
+    const void* grid,
+    const GridSample3DRaggedItem* items,
+    size_t numItems, size_t C, size_t V_in, size_t G,
+    void* output,
+    cudaStream_t stream,
+    const GridSample3DTactic& tactic
+) {
+    if(G == 0) {
+        return 0;
+    }
+    // the item offsets are int32
+    if(numItems == 0 || V_in > static_cast<size_t>(INT32_MAX) || G > static_cast<size_t>(INT32_MAX)) {
+        grid_sample_3d_log(GridSample3DLogSeverity::Error,
+                           "Error in grid_sample_3d_ragged_cuda: %zu items, %zu input and %zu grid voxels", numItems, V_in, G);
+        return 1;
+    }
+    const unsigned int block = tactic.blockSize > 0 ? static_cast<unsigned int>(tactic.blockSize) : 256;
+    // enough threads to fill any device; every block reads the whole table once to validate it
+    const unsigned int blocks = static_cast<unsigned int>(std::min<size_t>(std::max<size_t>((G + block - 1) / block, 1), 2048));
+    grid_sample_3d_ragged_kernel<scalar_t, grid_t, Modes><<<blocks, block, 0, stream>>>(
+        static_cast<const scalar_t*>(input), static_cast<const grid_t*>(grid), items, numItems, C, V_in, G,
+        static_cast<scalar_t*>(output));
+    cudaError_t err = cudaGetLastError();
+    if(err != cudaSuccess) {
+        grid_sample_3d_log(GridSample3DLogSeverity::Error, "Error in grid_sample_3d_ragged_cuda: %s", cudaGetErrorString(err));
+    }
+    return err != cudaSuccess;
+}
+
+template <typename scalar_t, typename Modes>
+static GridSample3DRaggedCudaLauncher select_ragged_grid_type(GridSample3DDataType gridDataType) {
+    if(gridDataType == GridSample3DDataType::GFLOAT) {
+        return grid_sample_3d_ragged_launch<scalar_t, float, Modes>;
+    }
+    if(gridDataType == GridSample3DDataTypeOf<scalar_t>::value) {
+        return grid_sample_3d_ragged_launch<scalar_t, scalar_t, Modes>;
+    }
+    return nullptr;
+}
+
+GridSample3DRaggedCudaLauncher grid_sample_3d_ragged_cuda_select(
+    GridSample3DDataType dataType,
+    GridSample3DDataType gridDataType,
+    GridSample3DInterpolationMode interpolationMode,
+    GridSample3DPaddingMode paddingMode,
+    bool align_corners
+) {
+    if(interpolationMode != GridSample3DInterpolationMode::Bilinear &&
+       interpolationMode != GridSample3DInterpolationMode::Nearest) {
+        return nullptr;
+    }
+    return grid_sample_3d_dispatch_modes(interpolationMode, paddingMode, align_corners,
+                                         [&](auto modes) -> GridSample3DRaggedCudaLauncher {
+        using Modes = decltype(modes);
+        switch(dataType) {
+        case GridSample3DDataType::GFLOAT:
+            return select_ragged_grid_type<float, Modes>(gridDataType);
+        case GridSample3DDataType::GHALF:
+            return select_ragged_grid_type<half, Modes>(gridDataType);
+        case GridSample3DDataType::GBF16:
+            return select_ragged_grid_type<bfloat16, Modes>(gridDataType);
+        default:
+            return nullptr;
+        }
+    });
+}
+
+// Level l of the mip pyramid from level l - 1 (`src`, the input itself for l == 1), one thread per
+// voxel of level l over all N x C slices.
+template <typename T>
+__global__ void grid_sample_3d_mip_downsample_kernel(
+    const T* src,
+    GridSample3DMipPyramid pyramid,
+    int l,
+    size_t slices,
+    float* levels
+) {
+    const size_t voxels = pyramid.sliceVoxels(l);
+    const size_t src_voxels = pyramid.sliceVoxels(l - 1);
+    const int W = pyramid.W[l], H = pyramid.H[l];
+    float* dst = levels + pyramid.offset[l];
+    for(size_t i = static_cast<size_t>(blockIdx.x) * blockDim.x + threadIdx.x; i < slices * voxels; i += static_cast<size_t>(gridDim.x) * blockDim.x) {
+        const size_t s = i / voxels;
+        const int v = static_cast<int>(i - s * voxels);
+        dst[i] = grid_sample_3d_mip_average(src + s * src_voxels, pyramid.D[l - 1], pyramid.H[l - 1], pyramid.W[l - 1],
+                                            v / (W * H), v / W % H, v % W);
+    }
+}
+
+// Mipmap sampling, one thread per output voxel: the taps of both levels are resolved once and
+// reused for every channel. `lod` (N x D_grid x H_grid x W_grid) overrides the Jacobian LOD when set.
+template <typename scalar_t, typename grid_t, typename Modes>
+__global__ void grid_sample_3d_mipmap_kernel(
+    const scalar_t* input,
+    const grid_t* grid,
+    const float* lod,
+    GridSample3DMipPyramid pyramid,
+    const float* levels,
+    size_t N, size_t C,
+    size_t D_grid, size_t H_grid, size_t W_grid,
+    const uint8_t* mask,
+    scalar_t* output
+) {
+    const int D_in = pyramid.D[0], H_in = pyramid.H[0], W_in = pyramid.W[0];
+    const size_t spatial = D_grid * H_grid * W_grid;
+    const size_t stride_C = pyramid.sliceVoxels(0);
+    for(size_t i = static_cast<size_t>(blockIdx.x) * blockDim.x + threadIdx.x; i < N * spatial; i += static_cast<size_t>(gridDim.x) * blockDim.x) {
+        const size_t n = i / spatial;
+        const size_t s = i - n * spatial;
+        GridSample3DMipTaps taps;
+        taps.numLevels = 0;
+        if(mask == nullptr || mask[i] != 0) {
+            const grid_t* grid_N = grid + n * spatial * 3;
+            const float voxel_lod = lod != nullptr
+                ? lod[i]
+                : grid_sample_3d_mip_lod<Modes::align_corners>(grid_N, s / (W_grid * H_grid), s / W_grid % H_grid, s % W_grid,
+                                                               D_grid, H_grid, W_grid, D_in, H_in, W_in);
+            grid_sample_3d_mip_taps<Modes::padding>(
+                pyramid,
+                compute_index<Modes::padding, Modes::align_corners>(to_float(grid_N[s * 3]), W_in),
+                compute_index<Modes::padding, Modes::align_corners>(to_float(grid_N[s * 3 + 1]), H_in),
+                compute_index<Modes::padding, Modes::align_corners>(to_float(grid_N[s * 3 + 2]), D_in),
+                voxel_lod, taps);
+        }
+        for(size_t c = 0; c < C; c++) {
+            const size_t slice = n * C + c;
+            output[slice * spatial + s] = from_float<scalar_t>(
+                grid_sample_3d_mip_gather(taps, pyramid, input + slice * stride_C, levels, slice));
+        }
+    }
+}
+
+// Builds the pyramid into `workspace` (or a stream-ordered allocation without one), then samples.
+template <typename scalar_t, typename grid_t, typename Modes>
+static int grid_sample_3d_mipmap_run(
+    const scalar_t* input,
+    const grid_t* grid,
+    const float* lod,
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    size_t D_grid, size_t H_grid, size_t W_grid,
+    scalar_t* output,
+    cudaStream_t stream,
+    const GridSample3DTactic& tactic,
+    void* workspace,
+    const uint8_t* mask
+) {
+    if(D_in * H_in * W_in > static_cast<size_t>(INT32_MAX)) {
+        grid_sample_3d_log(GridSample3DLogSeverity::Error, "Error in grid_sample_3d_mipmap_cuda: a %zu x %zu x %zu slice does not fit 32-bit offsets", D_in, H_in, W_in);
+        return 1;
+    }
+    const size_t slices = N * C;
+    const GridSample3DMipPyramid pyramid(slices, static_cast<int>(D_in), static_cast<int>(H_in), static_cast<int>(W_in));
+    const size_t bytes = pyramid.offset[pyramid.levels] * sizeof(float);
+    float* levels = static_cast<float*>(workspace);
+    cudaError_t err = cudaSuccess;
+    if(levels == nullptr && bytes > 0) {
+        err = cudaMallocAsync(reinterpret_cast<void**>(&levels), bytes, stream);
+        if(err != cudaSuccess) {
+            grid_sample_3d_log(GridSample3DLogSeverity::Error, "Error in grid_sample_3d_mipmap_cuda: %s", cudaGetErrorString(err));
+            return 1;
+        }
+    }
+
+    const unsigned int block = tactic.blockSize > 0 ? static_cast<unsigned int>(tactic.blockSize) : 256;
+    auto blocks_for = [block](size_t threads) {
+        return static_cast<unsigned int>(std::min<size_t>(std::max<size_t>((threads + block - 1) / block, 1), 65535));
+    };
+    for(int l = 1; l < pyramid.levels; l++) {
+        const size_t voxels = slices * pyramid.sliceVoxels(l);
+        if(l == 1) {
+            grid_sample_3d_mip_downsample_kernel<scalar_t><<<blocks_for(voxels), block, 0, stream>>>(input, pyramid, l, slices, levels);
+        } else {
+            grid_sample_3d_mip_downsample_kernel<float><<<blocks_for(voxels), block, 0, stream>>>(levels + pyramid.offset[l - 1], pyramid, l, slices, levels);
+        }
+    }
+    grid_sample_3d_mipmap_kernel<scalar_t, grid_t, Modes><<<blocks_for(N * D_grid * H_grid * W_grid), block, 0, stream>>>(
+        input, grid, lod, pyramid, levels, N, C, D_grid, H_grid, W_grid, mask, output);
+    err = cudaGetLastError();
+    if(levels != workspace) {
+        cudaFreeAsync(levels, stream);
+    }
+    if(err != cudaSuccess) {
+        grid_sample_3d_log(GridSample3DLogSeverity::Error, "Error in grid_sample_3d_mipmap_cuda: %s", cudaGetErrorString(err));
+    }
+    return err != cudaSuccess;
+}
+
+// One entry of the launcher table for GridSample3DInterpolationMode::Mipmap (NCDHW, absolute grid).
+template <typename scalar_t, typename grid_t, typename Modes>
+static int grid_sample_3d_mipmap_launch(
+    const void* input,
+    const void* grid_,
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    size_t D_grid, size_t H_grid, size_t W_grid,
+    void* output,
+    cudaStream_t stream,
+    GridSample3DLayout layout,
+    const GridSample3DTactic& tactic,
+    void* workspace,
+    const uint8_t* mask
+) {
+    if(layout != GridSample3DLayout::NCDHW) {
+        grid_sample_3d_log(GridSample3DLogSeverity::Error, "Error in grid_sample_3d_mipmap_cuda: the input must be NCDHW");
+        return 1;
+    }
+    return grid_sample_3d_mipmap_run<scalar_t, grid_t, Modes>(static_cast<const scalar_t*>(input), static_cast<const grid_t*>(grid_),
+                                                              nullptr, N, C, D_in, H_in, W_in, D_grid, H_grid, W_grid,
+                                                              static_cast<scalar_t*>(output), stream, tactic, workspace, mask);
+}
+
+template <typename scalar_t, typename Modes>
+static GridSample3DCudaLauncher select_mipmap_grid_type(GridSample3DDataType gridDataType) {
+    if(gridDataType == GridSample3DDataType::GFLOAT) {
+        return grid_sample_3d_mipmap_launch<scalar_t, float, Modes>;
+    }
+    if(gridDataType == GridSample3DDataTypeOf<scalar_t>::value) {
+        return grid_sample_3d_mipmap_launch<scalar_t, scalar_t, Modes>;
+    }
+    return nullptr;
+}
+
+static GridSample3DCudaLauncher select_launcher(
+    GridSample3DDataType dataType,
+    GridSample3DDataType gridDataType,
+    GridSample3DInterpolationMode interpolationMode,
+    GridSample3DPaddingMode paddingMode,
+    bool align_corners,
+    GridSample3DGridKind gridKind,
+    bool affine
+) {
+    if(interpolationMode == GridSample3DInterpolationMode::Mipmap) {
+        if(affine || gridKind != GridSample3DGridKind::Absolute) {
+            return nullptr;
+        }
+        return grid_sample_3d_dispatch_padding<GridSample3DInterpolationMode::Mipmap>(paddingMode, align_corners,
+                                                                                    [&](auto modes) -> GridSample3DCudaLauncher {
+            using Modes = decltype(modes);
+            switch(dataType) {
+            case GridSample3DDataType::GFLOAT:
+                return select_mipmap_grid_type<float, Modes>(gridDataType);
+            case GridSample3DDataType::GHALF:
+                return select_mipmap_grid_type<half, Modes>(gridDataType);
+            case GridSample3DDataType::GBF16:
+                return select_mipmap_grid_type<bfloat16, Modes>(gridDataType);
+            default:
+                return nullptr;
+            }
+        });
+    }
+    if(interpolationMode != GridSample3DInterpolationMode::Bilinear &&
+       interpolationMode != GridSample3DInterpolationMode::Nearest) {
+        return nullptr;
+    }
+    return grid_sample_3d_dispatch_modes(interpolationMode, paddingMode, align_corners,
+                                         [&](auto modes) -> GridSample3DCudaLauncher {
+        using Modes = decltype(modes);
+        switch(dataType) {
+        case GridSample3DDataType::GFLOAT:
+            return select_grid_type<float, Modes>(gridDataType, gridKind, affine);
+        case GridSample3DDataType::GHALF:
+            return select_grid_type<half, Modes>(gridDataType, gridKind, affine);
+        case GridSample3DDataType::GBF16:
+            return select_grid_type<bfloat16, Modes>(gridDataType, gridKind, affine);
+        default:
+            // int8/uint8 volumes go through grid_sample_3d_quantized_cuda_select
+            return nullptr;
+        }
+    });
+}
+
+GridSample3DCudaLauncher grid_sample_3d_cuda_select(
+    GridSample3DDataType dataType,
+    GridSample3DDataType gridDataType,
+    GridSample3DInterpolationMode interpolationMode,
+    GridSample3DPaddingMode paddingMode,
+    bool align_corners,
+    GridSample3DGridKind gridKind
+) {
+    return select_launcher(dataType, gridDataType, interpolationMode, paddingMode, align_corners, gridKind, false);
+}
+
+GridSample3DCudaLauncher grid_sample_3d_affine_cuda_select(
+    GridSample3DDataType dataType,
+    GridSample3DDataType thetaDataType,
+    GridSample3DInterpolationMode interpolationMode,
+    GridSample3DPaddingMode paddingMode,
+    bool align_corners
+) {
+    return select_launcher(dataType, thetaDataType, interpolationMode, paddingMode, align_corners,
+                           GridSample3DGridKind::Absolute, true);
+}
+
+template <typename label_t, typename grid_t, typename Modes>
+static GridSample3DCudaLauncher select_labels_grid_launcher(GridSample3DGridKind gridKind) {
+    switch(gridKind) {
+    case GridSample3DGridKind::Absolute:
+        return grid_sample_3d_labels_launch<label_t, grid_t, Modes, GridSample3DGridKind::Absolute>;
+    case GridSample3DGridKind::DisplacementVoxels:
+        return grid_sample_3d_labels_launch<label_t, grid_t, Modes, GridSample3DGridKind::DisplacementVoxels>;
+    case GridSample3DGridKind::DisplacementNormalized:
+        return grid_sample_3d_labels_launch<label_t, grid_t, Modes, GridSample3DGridKind::DisplacementNormalized>;
+    }
+    return nullptr;
+}
+
+template <typename label_t, typename Modes>
+static GridSample3DCudaLauncher select_labels_grid_type(GridSample3DDataType gridDataType, GridSample3DGridKind gridKind) {
+    switch(gridDataType) {
+    case GridSample3DDataType::GFLOAT:
+        return select_labels_grid_launcher<label_t, float, Modes>(gridKind);
+    case GridSample3DDataType::GHALF:
+        return select_labels_grid_launcher<label_t, half, Modes>(gridKind);
+    default:
+        return nullptr;
+    }
+}
+
+GridSample3DCudaLauncher grid_sample_3d_labels_cuda_select(
+    GridSample3DDataType dataType,
+    GridSample3DDataType gridDataType,
+    GridSample3DPaddingMode paddingMode,
+    bool align_corners,
+    GridSample3DGridKind gridKind
+) {
+    return grid_sample_3d_dispatch_padding<GridSample3DInterpolationMode::Nearest>(paddingMode, align_corners,
+                                                                                   [&](auto modes) -> GridSample3DCudaLauncher {
+        using Modes = decltype(modes);
+        switch(dataType) {
+        case GridSample3DDataType::GINT32:
+            return select_labels_grid_type<int32_t, Modes>(gridDataType, gridKind);
+        case GridSample3DDataType::GINT8:
+            return select_labels_grid_type<int8_t, Modes>(gridDataType, gridKind);
+        case GridSample3DDataType::GUINT8:
+            return select_labels_grid_type<uint8_t, Modes>(gridDataType, gridKind);
+        default:
+            return nullptr;
+        }
+    });
+}
+
+GridSample3DQuantizedCudaLauncher grid_sample_3d_quantized_cuda_select(
+    GridSample3DDataType dataType,
+    GridSample3DDataType outputDataType,
+    GridSample3DDataType gridDataType,
+    GridSample3DInterpolationMode interpolationMode,
+    GridSample3DPaddingMode paddingMode,
+    bool align_corners,
+    GridSample3DGridKind gridKind
+) {
+    if(interpolationMode != GridSample3DInterpolationMode::Bilinear &&
+       interpolationMode != GridSample3DInterpolationMode::Nearest) {
+        return nullptr;
+    }
+    return grid_sample_3d_dispatch_modes(interpolationMode, paddingMode, align_corners,
+                                         [&](auto modes) -> GridSample3DQuantizedCudaLauncher {
+        using Modes = decltype(modes);
+        switch(dataType) {
+        case GridSample3DDataType::GINT8:
+            return select_quantized_types<int8_t, Modes>(outputDataType, gridDataType, gridKind);
+        case GridSample3DDataType::GUINT8:
+            return select_quantized_types<uint8_t, Modes>(outputDataType, gridDataType, gridKind);
+        default:
+            return nullptr;
+        }
+    });
+}
+
+// points per block of grid_sample_3d_points_kernel
+#define POINT_TILE 32
+
+// Point-list gather with an N x P x C output: each block first resolves the taps (offsets within
+// one channel, -1 when out of bounds, and weights) of POINT_TILE points into shared memory, then its
+// threads walk the (point, channel) pairs channel-fastest so that consecutive threads write
+// consecutive output elements.
+template <typename Values, typename grid_t, typename Modes>
+__global__ void grid_sample_3d_points_kernel(
+    const typename Values::input_t* input,
+    Values values,
+    const grid_t* points,
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    size_t P,
+    const uint8_t* mask,
+    typename Values::output_t* output
+) {
+    constexpr bool bilinear = Modes::interpolation == GridSample3DInterpolationMode::Bilinear;
+    constexpr int TAPS = bilinear ? 8 : 1;
+    __shared__ int64_t tap_offset[POINT_TILE][TAPS];
+    __shared__ float tap_weight[POINT_TILE][TAPS];
+
+    const size_t total = N * P;
+    const size_t stride_C = D_in * H_in * W_in;
+    for(size_t first = static_cast<size_t>(blockIdx.x) * POINT_TILE; first < total; first += static_cast<size_t>(gridDim.x) * POINT_TILE) {
+        const size_t count = min(static_cast<size_t>(POINT_TILE), total - first);
+        if(threadIdx.x < count) {
+            const size_t i = threadIdx.x;
+            const size_t point = first + i;
+            const grid_t* xyz = points + 3 * point;
+            const float ix = compute_index<Modes::padding, Modes::align_corners>(to_float(xyz[0]), static_cast<int>(W_in));
+            const float iy = compute_index<Modes::padding, Modes::align_corners>(to_float(xyz[1]), static_cast<int>(H_in));
+            const float iz = compute_index<Modes::padding, Modes::align_corners>(to_float(xyz[2]), static_cast<int>(D_in));
+            const bool off = mask != nullptr && mask[point] == 0;
+            if constexpr (bilinear) {
+                const int x0 = static_cast<int>(::floorf(ix));
+                const int y0 = static_cast<int>(::floorf(iy));
+                const int z0 = static_cast<int>(::floorf(iz));
+                // corner order and weight products of grid_sample_3d_bilinear_kernel, high corner first
+                int k = 0;
+                for(int dz = 1; dz >= 0; dz--) {
+                    for(int dy = 1; dy >= 0; dy--) {
+                        for(int dx = 1; dx >= 0; dx--, k++) {
+                            const int x = x0 + dx, y = y0 + dy, z = z0 + dz;
+                            const bool inside = x >= 0 && x < W_in && y >= 0 && y < H_in && z >= 0 && z < D_in;
+                            tap_offset[i][k] = inside && !off ? (static_cast<int64_t>(z) * H_in + y) * W_in + x : -1;
+                            tap_weight[i][k] = (dx ? ix - x0 : static_cast<float>(x0 + 1) - ix) *
+                                               (dy ? iy - y0 : static_cast<float>(y0 + 1) - iy) *
+                                               (dz ? iz - z0 : static_cast<float>(z0 + 1) - iz);
+                        }
+                    }
+                }
+            } else {
+                const int x = static_cast<int>(::roundf(ix));
+                const int y = static_cast<int>(::roundf(iy));
+                const int z = static_cast<int>(::roundf(iz));
+                const bool inside = x >= 0 && x < W_in && y >= 0 && y < H_in && z >= 0 && z < D_in;
+                tap_offset[i][0] = inside && !off ? (static_cast<int64_t>(z) * H_in + y) * W_in + x : -1;
+                tap_weight[i][0] = 1.f;
+            }
+        }
+        __syncthreads();
+
+        for(size_t t = threadIdx.x; t < count * C; t += blockDim.x) {
+            const size_t i = t / C;
+            const size_t c = t - i * C;
+            const size_t point = first + i;
+            const typename Values::input_t* input_NC = input + ((point / P) * C + c) * stride_C;
+            if constexpr (bilinear) {
+                float value = 0.f;
+                for(int k = 0; k < TAPS; k++) {
+                    if(tap_offset[i][k] >= 0) {
+                        value += tap_weight[i][k] * values.load(input_NC[tap_offset[i][k]], c);
+                    }
+                }
+                output[point * C + c] = values.store(value, c);
+            } else {
+                output[point * C + c] = tap_offset[i][0] >= 0 ? values.copy(input_NC[tap_offset[i][0]], c) : values.store(0.f, c);
+            }
+        }
+        __syncthreads();
+    }
+}
+
+// One entry of the point launcher table: `grid_` is N x P x 3 with P = D_grid * H_grid * W_grid,
+// the output N x P x C.
+template <typename scalar_t, typename grid_t, typename Modes>
+static int grid_sample_3d_points_launch(
+    const void* input,
+    const void* grid_,
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    size_t D_grid, size_t H_grid, size_t W_grid,
+    void* output,
+    cudaStream_t stream,
+    GridSample3DLayout layout,
+    const GridSample3DTactic& tactic,
+    void*,
+    const uint8_t* mask
+) {
+    if(layout != GridSample3DLayout::NCDHW) {
+        grid_sample_3d_log(GridSample3DLogSeverity::Error, "Error in grid_sample_3d_points_cuda: the input must be NCDHW");
+        return 1;
+    }
+    const size_t P = D_grid * H_grid * W_grid;
+    const size_t tiles = (N * P + POINT_TILE - 1) / POINT_TILE;
+    const unsigned int block = tactic.blockSize > 0 ? static_cast<unsigned int>(tactic.blockSize) : 128;
+    const unsigned int blocks = static_cast<unsigned int>(std::min<size_t>(std::max<size_t>(tiles, 1), 65535));
+    grid_sample_3d_points_kernel<ConvertValues<scalar_t>, grid_t, Modes><<<blocks, block, 0, stream>>>(
+        static_cast<const scalar_t*>(input), ConvertValues<scalar_t>{}, static_cast<const grid_t*>(grid_),
+        N, C, D_in, H_in, W_in, P, mask, static_cast<scalar_t*>(output));
+    cudaError_t err = cudaGetLastError();
+    if(err != cudaSuccess) {
+        grid_sample_3d_log(GridSample3DLogSeverity::Error, "Error in grid_sample_3d_points_cuda: %s", cudaGetErrorString(err));
+    }
+    return err != cudaSuccess;
+}
+
+template <typename scalar_t, typename Modes>
+static GridSample3DCudaLauncher select_points_grid_type(GridSample3DDataType gridDataType) {
+    if(gridDataType == GridSample3DDataType::GFLOAT) {
+        return grid_sample_3d_points_launch<scalar_t, float, Modes>;
+    }
+    if(gridDataType == GridSample3DDataTypeOf<scalar_t>::value) {
+        return grid_sample_3d_points_launch<scalar_t, scalar_t, Modes>;
+    }
+    return nullptr;
+}
+
+GridSample3DCudaLauncher grid_sample_3d_points_cuda_select(
+    GridSample3DDataType dataType,
+    GridSample3DDataType gridDataType,
+    GridSample3DInterpolationMode interpolationMode,
+    GridSample3DPaddingMode paddingMode,
+    bool align_corners,
+    GridSample3DPointLayout pointLayout
+) {
+    // N x C x P is the NCDHW output of a 1 x 1 x P grid
+    if(pointLayout == GridSample3DPointLayout::NCP) {
+        return grid_sample_3d_cuda_select(dataType, gridDataType, interpolationMode, paddingMode, align_corners,
+                                          GridSample3DGridKind::Absolute);
+    }
+    if(interpolationMode != GridSample3DInterpolationMode::Bilinear &&
+       interpolationMode != GridSample3DInterpolationMode::Nearest) {
+        return nullptr;
+    }
+    return grid_sample_3d_dispatch_modes(interpolationMode, paddingMode, align_corners,
+                                         [&](auto modes) -> GridSample3DCudaLauncher {
+        using Modes = decltype(modes);
+        switch(dataType) {
+        case GridSample3DDataType::GFLOAT:
+            return select_points_grid_type<float, Modes>(gridDataType);
+        case GridSample3DDataType::GHALF:
+            return select_points_grid_type<half, Modes>(gridDataType);
+        case GridSample3DDataType::GBF16:
+            return select_points_grid_type<bfloat16, Modes>(gridDataType);
+        default:
+            return nullptr;
+        }
+    });
+}
+
+template <typename scalar_t, typename grid_t>
+int grid_sample_3d_points_cuda(
+    const scalar_t* input,
+    const grid_t* points,
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    size_t P,
+    bool align_corners,
+    GridSample3DInterpolationMode interpolationMode,
+    GridSample3DPaddingMode paddingMode,
+    scalar_t* output,
+    cudaStream_t stream,
+    GridSample3DPointLayout pointLayout,
+    const GridSample3DTactic& tactic,
+    void* workspace,
+    const uint8_t* mask
+) {
+    GridSample3DCudaLauncher launcher = grid_sample_3d_points_cuda_select(GridSample3DDataTypeOf<scalar_t>::value,
+                                                                          GridSample3DDataTypeOf<grid_t>::value,
+                                                                          interpolationMode, paddingMode, align_corners,
+                                                                          pointLayout);
+    if(!launcher) {
+        return 1;
+    }
+    return launcher(input, points, N, C, D_in, H_in, W_in, 1, 1, P, output, stream, GridSample3DLayout::NCDHW,
+                    tactic, workspace, mask);
+}
+
+template <typename scalar_t, typename grid_t>
+int grid_sample_3d_ragged_cuda(
+    const scalar_t* input,
+    const grid_t* grid,
+    const GridSample3DRaggedItem* items,
+    size_t numItems, size_t C, size_t V_in, size_t G,
+    bool align_corners,
+    GridSample3DInterpolationMode interpolationMode,
+    GridSample3DPaddingMode paddingMode,
+    scalar_t* output,
+    cudaStream_t stream,
+    const GridSample3DTactic& tactic
+) {
+    GridSample3DRaggedCudaLauncher launcher = grid_sample_3d_ragged_cuda_select(GridSample3DDataTypeOf<scalar_t>::value,
+                                                                                GridSample3DDataTypeOf<grid_t>::value,
+                                                                                interpolationMode, paddingMode, align_corners);
+    if(!launcher) {
+        return 1;
+    }
+    return launcher(input, grid, items, numItems, C, V_in, G, output, stream, tactic);
+}
+
+template <typename scalar_t, typename grid_t>
+int grid_sample_3d_mipmap_cuda(
+    const scalar_t* input,
+    const grid_t* grid,
+    const float* lod,
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    size_t D_grid, size_t H_grid, size_t W_grid,
+    bool align_corners,
+    GridSample3DPaddingMode paddingMode,
+    scalar_t* output,
+    cudaStream_t stream,
+    void* workspace,
+    const uint8_t* mask
+) {
+    return grid_sample_3d_dispatch_padding<GridSample3DInterpolationMode::Mipmap>(paddingMode, align_corners, [&](auto modes) {
+        return grid_sample_3d_mipmap_run<scalar_t, grid_t, decltype(modes)>(input, grid, lod, N, C, D_in, H_in, W_in,
+                                                                            D_grid, H_grid, W_grid, output, stream,
+                                                                            GridSample3DTactic(), workspace, mask);
+    });
+}
+
+template <typename scalar_t, typename grid_t>
+int grid_sample_3d_cuda(
+    const scalar_t* input,
+    const grid_t* grid,
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    size_t D_grid, size_t H_grid, size_t W_grid,
+    bool align_corners,
+    GridSample3DInterpolationMode interpolationMode,
+    GridSample3DPaddingMode paddingMode,
+    scalar_t* output,
+    cudaStream_t stream,
+    GridSample3DLayout layout,
+    GridSample3DGridKind gridKind,
+    const GridSample3DTactic& tactic,
+    void* workspace,
+    const uint8_t* mask
+) {
+    GridSample3DCudaLauncher launcher = grid_sample_3d_cuda_select(GridSample3DDataTypeOf<scalar_t>::value,
+                                                                   GridSample3DDataTypeOf<grid_t>::value,
+                                                                   interpolationMode, paddingMode, align_corners,
+                                                                   gridKind);
+    if(!launcher) {
+        return 1;
+    }
+    return launcher(input, grid, N, C, D_in, H_in, W_in, D_grid, H_grid, W_grid, output, stream, layout, tactic, workspace, mask);
+}
+
+template <typename scalar_t, typename grid_t>
+int grid_sample_3d_strided_cuda(
+    const scalar_t* input,
+    const GridSample3DStrides& inputStrides,
+    const grid_t* grid,
+    const GridSample3DGridStrides& gridStrides,
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    size_t D_grid, size_t H_grid, size_t W_grid,
+    bool align_corners,
+    GridSample3DInterpolationMode interpolationMode,
+    GridSample3DPaddingMode paddingMode,
+    scalar_t* output,
+    const GridSample3DStrides& outputStrides,
+    cudaStream_t stream,
+    const GridSample3DTactic& tactic,
+    void* workspace,
+    const uint8_t* mask
+) {
+    if(interpolationMode != GridSample3DInterpolationMode::Bilinear &&
+       interpolationMode != GridSample3DInterpolationMode::Nearest) {
+        return 1;
+    }
+    if(N * C * D_grid * H_grid * W_grid == 0) {
+        return 0;
+    }
+    return grid_sample_3d_dispatch_modes(interpolationMode, paddingMode, align_corners, [&](auto modes) {
+        return grid_sample_3d_strided_launch<scalar_t, grid_t, decltype(modes)>(input, inputStrides, grid, gridStrides,
+                                                                               N, C, D_in, H_in, W_in, D_grid, H_grid, W_grid,
+                                                                               output, outputStrides, stream, tactic,
+                                                                               workspace, mask);
+    });
+}
+
+template <typename scalar_t, typename grid_t>
+int grid_sample_3d_affine_cuda(
+    const scalar_t* input,
+    const grid_t* theta,
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    size_t D_out, size_t H_out, size_t W_out,
+    bool align_corners,
+    GridSample3DInterpolationMode interpolationMode,
+    GridSample3DPaddingMode paddingMode,
+    scalar_t* output,
+    cudaStream_t stream,
+    GridSample3DLayout layout,
+    const GridSample3DTactic& tactic,
+    void* workspace,
+    const uint8_t* mask
+) {
+    GridSample3DCudaLauncher launcher = grid_sample_3d_affine_cuda_select(GridSample3DDataTypeOf<scalar_t>::value,
+                                                                          GridSample3DDataTypeOf<grid_t>::value,
+                                                                          interpolationMode, paddingMode, align_corners);
+    if(!launcher) {
+        return 1;
+    }
+    return launcher(input, theta, N, C, D_in, H_in, W_in, D_out, H_out, W_out, output, stream, layout, tactic, workspace, mask);
+}
+
+template <typename q_t, typename out_t, typename grid_t>
+int grid_sample_3d_quantized_cuda(
+    const q_t* input,
+    const GridSample3DQuantization& inputQuantization,
+    const grid_t* grid,
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    size_t D_grid, size_t H_grid, size_t W_grid,
+    bool align_corners,
+    GridSample3DInterpolationMode interpolationMode,
+    GridSample3DPaddingMode paddingMode,
+    out_t* output,
+    const GridSample3DQuantization& outputQuantization,
+    cudaStream_t stream,
+    GridSample3DLayout layout,
+    GridSample3DGridKind gridKind,
+    const GridSample3DTactic& tactic,
+    void* workspace,
+    const uint8_t* mask
+) {
+    GridSample3DQuantizedCudaLauncher launcher = grid_sample_3d_quantized_cuda_select(
+        GridSample3DDataTypeOf<q_t>::value, GridSample3DDataTypeOf<out_t>::value, GridSample3DDataTypeOf<grid_t>::value,
+        interpolationMode, paddingMode, align_corners, gridKind);
+    if(!launcher) {
+        return 1;
+    }
+    return launcher(input, inputQuantization, grid, N, C, D_in, H_in, W_in, D_grid, H_grid, W_grid,
+                    output, outputQuantization, stream, layout, tactic, workspace, mask);
+}
+
+template <typename label_t, typename grid_t>
+int grid_sample_3d_labels_cuda(
+    const label_t* input,
+    const grid_t* grid,
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    size_t D_grid, size_t H_grid, size_t W_grid,
+    bool align_corners,
+    GridSample3DPaddingMode paddingMode,
+    label_t* output,
+    cudaStream_t stream,
+    GridSample3DLayout layout,
+    GridSample3DGridKind gridKind,
+    const GridSample3DTactic& tactic,
+    void* workspace,
+    const uint8_t* mask
+) {
+    GridSample3DCudaLauncher launcher = grid_sample_3d_labels_cuda_select(GridSample3DDataTypeOf<label_t>::value,
+                                                                          GridSample3DDataTypeOf<grid_t>::value,
+                                                                          paddingMode, align_corners, gridKind);
+    if(!launcher) {
+        return 1;
+    }
+    return launcher(input, grid, N, C, D_in, H_in, W_in, D_grid, H_grid, W_grid, output, stream, layout, tactic, workspace, mask);
+}
+
+GridSample3DTactic grid_sample_3d_cuda_autotune(
+    GridSample3DCudaLauncher launcher,
+    const void* input,
+    const void* grid,
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    size_t D_grid, size_t H_grid, size_t W_grid,
+    void* output,
+    cudaStream_t stream,
+    GridSample3DLayout layout
+) {
+    std::vector<GridSample3DTactic> candidates = grid_sample_3d_tactic_candidates(
+        GridSample3DBackend::CUDA, N * D_grid * H_grid * W_grid, C);
+    if(!launcher) {
+        return candidates.front();
+    }
+    cudaEvent_t start, stop;
+    if(cudaEventCreate(&start) != cudaSuccess || cudaEventCreate(&stop) != cudaSuccess) {
+        return candidates.front();
+    }
+    GridSample3DTactic best = grid_sample_3d_pick_tactic(candidates, [&](const GridSample3DTactic& tactic) {
+        cudaEventRecord(start, stream);
+        if(launcher(input, grid, N, C, D_in, H_in, W_in, D_grid, H_grid, W_grid, output, stream, layout, tactic, nullptr, nullptr) != 0) {
+            return -1.f;
+        }
+        cudaEventRecord(stop, stream);
+        float ms = -1.f;
+        if(cudaEventSynchronize(stop) != cudaSuccess || cudaEventElapsedTime(&ms, start, stop) != cudaSuccess) {
+            return -1.f;
+        }
+        return ms;
+    });
+    cudaEventDestroy(start);
+    cudaEventDestroy(stop);
+    return best;
+}
+
+// template specialization
+template int grid_sample_3d_cuda<float, float>(
+    const float* input,
+    const float* grid,
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    size_t D_grid, size_t H_grid, size_t W_grid,
+    bool align_corners,
+    GridSample3DInterpolationMode interpolationMode,
+    GridSample3DPaddingMode paddingMode,
+    float* output,
+    cudaStream_t stream,
+    GridSample3DLayout layout,
+    GridSample3DGridKind gridKind,
+    const GridSample3DTactic& tactic,
+    void* workspace,
+    const uint8_t* mask
+);
+
+template int grid_sample_3d_cuda<half, half>(
+    const half* input,
+    const half* grid,
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    size_t D_grid, size_t H_grid, size_t W_grid,
+    bool align_corners,
+    GridSample3DInterpolationMode interpolationMode,
+    GridSample3DPaddingMode paddingMode,
+    half* output,
+    cudaStream_t stream,
+    GridSample3DLayout layout,
+    GridSample3DGridKind gridKind,
+    const GridSample3DTactic& tactic,
+    void* workspace,
+    const uint8_t* mask
+);
+
+template int grid_sample_3d_cuda<bfloat16, bfloat16>(
+    const bfloat16* input,
+    const bfloat16* grid,
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    size_t D_grid, size_t H_grid, size_t W_grid,
+    bool align_corners,
+    GridSample3DInterpolationMode interpolationMode,
+    GridSample3DPaddingMode paddingMode,
+    bfloat16* output,
+    cudaStream_t stream,
+    GridSample3DLayout layout,
+    GridSample3DGridKind gridKind,
+    const GridSample3DTactic& tactic,
+    void* workspace,
+    const uint8_t* mask
+);
+
+template int grid_sample_3d_cuda<half, float>(
+    const half* input,
+    const float* grid,
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    size_t D_grid, size_t H_grid, size_t W_grid,
+    bool align_corners,
+    GridSample3DInterpolationMode interpolationMode,
+    GridSample3DPaddingMode paddingMode,
+    half* output,
+    cudaStream_t stream,
+    GridSample3DLayout layout,
+    GridSample3DGridKind gridKind,
+    const GridSample3DTactic& tactic,
+    void* workspace,
+    const uint8_t* mask
+);
+
+template int grid_sample_3d_cuda<bfloat16, float>(
+    const bfloat16* input,
+    const float* grid,
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    size_t D_grid, size_t H_grid, size_t W_grid,
+    bool align_corners,
+    GridSample3DInterpolationMode interpolationMode,
+    GridSample3DPaddingMode paddingMode,
+    bfloat16* output,
+    cudaStream_t stream,
+    GridSample3DLayout layout,
+    GridSample3DGridKind gridKind,
+    const GridSample3DTactic& tactic,
+    void* workspace,
+    const uint8_t* mask
+);
+
+template int grid_sample_3d_affine_cuda<float, float>(
+    const float* input,
+    const float* theta,
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    size_t D_out, size_t H_out, size_t W_out,
+    bool align_corners,
+    GridSample3DInterpolationMode interpolationMode,
+    GridSample3DPaddingMode paddingMode,
+    float* output,
+    cudaStream_t stream,
+    GridSample3DLayout layout,
+    const GridSample3DTactic& tactic,
+    void* workspace,
+    const uint8_t* mask
+);
+
+template int grid_sample_3d_affine_cuda<half, half>(
+    const half* input,
+    const half* theta,
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    size_t D_out, size_t H_out, size_t W_out,
+    bool align_corners,
+    GridSample3DInterpolationMode interpolationMode,
+    GridSample3DPaddingMode paddingMode,
+    half* output,
+    cudaStream_t stream,
+    GridSample3DLayout layout,
+    const GridSample3DTactic& tactic,
+    void* workspace,
+    const uint8_t* mask
+);
+
+template int grid_sample_3d_affine_cuda<bfloat16, bfloat16>(
+    const bfloat16* input,
+    const bfloat16* theta,
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    size_t D_out, size_t H_out, size_t W_out,
+    bool align_corners,
+    GridSample3DInterpolationMode interpolationMode,
+    GridSample3DPaddingMode paddingMode,
+    bfloat16* output,
+    cudaStream_t stream,
+    GridSample3DLayout layout,
+    const GridSample3DTactic& tactic,
+    void* workspace,
+    const uint8_t* mask
+);
+
+template int grid_sample_3d_affine_cuda<half, float>(
+    const half* input,
+    const float* theta,
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    size_t D_out, size_t H_out, size_t W_out,
+    bool align_corners,
+    GridSample3DInterpolationMode interpolationMode,
+    GridSample3DPaddingMode paddingMode,
+    half* output,
+    cudaStream_t stream,
+    GridSample3DLayout layout,
+    const GridSample3DTactic& tactic,
+    void* workspace,
+    const uint8_t* mask
+);
+
+template int grid_sample_3d_affine_cuda<bfloat16, float>(
+    const bfloat16* input,
+    const float* theta,
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    size_t D_out, size_t H_out, size_t W_out,
+    bool align_corners,
+    GridSample3DInterpolationMode interpolationMode,
+    GridSample3DPaddingMode paddingMode,
+    bfloat16* output,
+    cudaStream_t stream,
+    GridSample3DLayout layout,
+    const GridSample3DTactic& tactic,
+    void* workspace,
+    const uint8_t* mask
+);
+
+template int grid_sample_3d_quantized_cuda<int8_t, int8_t, float>(
+    const int8_t* input,
+    const GridSample3DQuantization& inputQuantization,
+    const float* grid,
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    size_t D_grid, size_t H_grid, size_t W_grid,
+    bool align_corners,
+    GridSample3DInterpolationMode interpolationMode,
+    GridSample3DPaddingMode paddingMode,
+    int8_t* output,
+    const GridSample3DQuantization& outputQuantization,
+    cudaStream_t stream,
+    GridSample3DLayout layout,
+    GridSample3DGridKind gridKind,
+    const GridSample3DTactic& tactic,
+    void* workspace,
+    const uint8_t* mask
+);
+
+template int grid_sample_3d_quantized_cuda<int8_t, int8_t, half>(
+    const int8_t* input,
+    const GridSample3DQuantization& inputQuantization,
+    const half* grid,
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    size_t D_grid, size_t H_grid, size_t W_grid,
+    bool align_corners,
+    GridSample3DInterpolationMode interpolationMode,
+    GridSample3DPaddingMode paddingMode,
+    int8_t* output,
+    const GridSample3DQuantization& outputQuantization,
+    cudaStream_t stream,
+    GridSample3DLayout layout,
+    GridSample3DGridKind gridKind,
+    const GridSample3DTactic& tactic,
+    void* workspace,
+    const uint8_t* mask
+);
+
+template int grid_sample_3d_quantized_cuda<int8_t, half, float>(
+    const int8_t* input,
+    const GridSample3DQuantization& inputQuantization,
+    const float* grid,
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    size_t D_grid, size_t H_grid, size_t W_grid,
+    bool align_corners,
+    GridSample3DInterpolationMode interpolationMode,
+    GridSample3DPaddingMode paddingMode,
+    half* output,
+    const GridSample3DQuantization& outputQuantization,
+    cudaStream_t stream,
+    GridSample3DLayout layout,
+    GridSample3DGridKind gridKind,
+    const GridSample3DTactic& tactic,
+    void* workspace,
+    const uint8_t* mask
+);
+
+template int grid_sample_3d_quantized_cuda<int8_t, half, half>(
+    const int8_t* input,
+    const GridSample3DQuantization& inputQuantization,
+    const half* grid,
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    size_t D_grid, size_t H_grid, size_t W_grid,
+    bool align_corners,
+    GridSample3DInterpolationMode interpolationMode,
+    GridSample3DPaddingMode paddingMode,
+    half* output,
+    const GridSample3DQuantization& outputQuantization,
+    cudaStream_t stream,
+    GridSample3DLayout layout,
+    GridSample3DGridKind gridKind,
+    const GridSample3DTactic& tactic,
+    void* workspace,
+    const uint8_t* mask
+);
+
+template int grid_sample_3d_quantized_cuda<uint8_t, uint8_t, float>(
+    const uint8_t* input,
+    const GridSample3DQuantization& inputQuantization,
+    const float* grid,
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    size_t D_grid, size_t H_grid, size_t W_grid,
+    bool align_corners,
+    GridSample3DInterpolationMode interpolationMode,
+    GridSample3DPaddingMode paddingMode,
+    uint8_t* output,
+    const GridSample3DQuantization& outputQuantization,
+    cudaStream_t stream,
+    GridSample3DLayout layout,
+    GridSample3DGridKind gridKind,
+    const GridSample3DTactic& tactic,
+    void* workspace,
+    const uint8_t* mask
+);
+
+template int grid_sample_3d_quantized_cuda<uint8_t, uint8_t, half>(
+    const uint8_t* input,
+    const GridSample3DQuantization& inputQuantization,
+    const half* grid,
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    size_t D_grid, size_t H_grid, size_t W_grid,
+    bool align_corners,
+    GridSample3DInterpolationMode interpolationMode,
+    GridSample3DPaddingMode paddingMode,
+    uint8_t* output,
+    const GridSample3DQuantization& outputQuantization,
+    cudaStream_t stream,
+    GridSample3DLayout layout,
+    GridSample3DGridKind gridKind,
+    const GridSample3DTactic& tactic,
+    void* workspace,
+    const uint8_t* mask
+);
+
+template int grid_sample_3d_quantized_cuda<uint8_t, half, float>(
+    const uint8_t* input,
+    const GridSample3DQuantization& inputQuantization,
+    const float* grid,
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    size_t D_grid, size_t H_grid, size_t W_grid,
+    bool align_corners,
+    GridSample3DInterpolationMode interpolationMode,
+    GridSample3DPaddingMode paddingMode,
+    half* output,
+    const GridSample3DQuantization& outputQuantization,
+    cudaStream_t stream,
+    GridSample3DLayout layout,
+    GridSample3DGridKind gridKind,
+    const GridSample3DTactic& tactic,
+    void* workspace,
+    const uint8_t* mask
+);
+
+template int grid_sample_3d_quantized_cuda<uint8_t, half, half>(
+    const uint8_t* input,
+    const GridSample3DQuantization& inputQuantization,
+    const half* grid,
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    size_t D_grid, size_t H_grid, size_t W_grid,
+    bool align_corners,
+    GridSample3DInterpolationMode interpolationMode,
+    GridSample3DPaddingMode paddingMode,
+    half* output,
+    const GridSample3DQuantization& outputQuantization,
+    cudaStream_t stream,
+    GridSample3DLayout layout,
+    GridSample3DGridKind gridKind,
+    const GridSample3DTactic& tactic,
+    void* workspace,
+    const uint8_t* mask
+);
+
+template int grid_sample_3d_labels_cuda<int32_t, float>(
+    const int32_t* input,
+    const float* grid,
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    size_t D_grid, size_t H_grid, size_t W_grid,
+    bool align_corners,
+    GridSample3DPaddingMode paddingMode,
+    int32_t* output,
+    cudaStream_t stream,
+    GridSample3DLayout layout,
+    GridSample3DGridKind gridKind,
+    const GridSample3DTactic& tactic,
+    void* workspace,
+    const uint8_t* mask
+);
+
+template int grid_sample_3d_labels_cuda<int32_t, half>(
+    const int32_t* input,
+    const half* grid,
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    size_t D_grid, size_t H_grid, size_t W_grid,
+    bool align_corners,
+    GridSample3DPaddingMode paddingMode,
+    int32_t* output,
+    cudaStream_t stream,
+    GridSample3DLayout layout,
+    GridSample3DGridKind gridKind,
+    const GridSample3DTactic& tactic,
+    void* workspace,
+    const uint8_t* mask
+);
+
+template int grid_sample_3d_labels_cuda<int8_t, float>(
+    const int8_t* input,
+    const float* grid,
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    size_t D_grid, size_t H_grid, size_t W_grid,
+    bool align_corners,
+    GridSample3DPaddingMode paddingMode,
+    int8_t* output,
+    cudaStream_t stream,
+    GridSample3DLayout layout,
+    GridSample3DGridKind gridKind,
+    const GridSample3DTactic& tactic,
+    void* workspace,
+    const uint8_t* mask
+);
+
+template int grid_sample_3d_labels_cuda<int8_t, half>(
+    const int8_t* input,
+    const half* grid,
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    size_t D_grid, size_t H_grid, size_t W_grid,
+    bool align_corners,
+    GridSample3DPaddingMode paddingMode,
+    int8_t* output,
+    cudaStream_t stream,
+    GridSample3DLayout layout,
+    GridSample3DGridKind gridKind,
+    const GridSample3DTactic& tactic,
+    void* workspace,
+    const uint8_t* mask
+);
+
+template int grid_sample_3d_labels_cuda<uint8_t, float>(
+    const uint8_t* input,
+    const float* grid,
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    size_t D_grid, size_t H_grid, size_t W_grid,
+    bool align_corners,
+    GridSample3DPaddingMode paddingMode,
+    uint8_t* output,
+    cudaStream_t stream,
+    GridSample3DLayout layout,
+    GridSample3DGridKind gridKind,
+    const GridSample3DTactic& tactic,
+    void* workspace,
+    const uint8_t* mask
+);
+
+template int grid_sample_3d_labels_cuda<uint8_t, half>(
+    const uint8_t* input,
+    const half* grid,
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    size_t D_grid, size_t H_grid, size_t W_grid,
+    bool align_corners,
+    GridSample3DPaddingMode paddingMode,
+    uint8_t* output,
+    cudaStream_t stream,
+    GridSample3DLayout layout,
+    GridSample3DGridKind gridKind,
+    const GridSample3DTactic& tactic,
+    void* workspace,
+    const uint8_t* mask
+);
+
+template int grid_sample_3d_points_cuda<float, float>(
+    const float* input,
+    const float* points,
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    size_t P,
+    bool align_corners,
+    GridSample3DInterpolationMode interpolationMode,
+    GridSample3DPaddingMode paddingMode,
+    float* output,
+    cudaStream_t stream,
+    GridSample3DPointLayout pointLayout,
+    const GridSample3DTactic& tactic,
+    void* workspace,
+    const uint8_t* mask
+);
+
+template int grid_sample_3d_points_cuda<half, half>(
+    const half* input,
+    const half* points,
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    size_t P,
+    bool align_corners,
+    GridSample3DInterpolationMode interpolationMode,
+    GridSample3DPaddingMode paddingMode,
+    half* output,
+    cudaStream_t stream,
+    GridSample3DPointLayout pointLayout,
+    const GridSample3DTactic& tactic,
+    void* workspace,
+    const uint8_t* mask
+);
+
+template int grid_sample_3d_points_cuda<bfloat16, bfloat16>(
+    const bfloat16* input,
+    const bfloat16* points,
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    size_t P,
+    bool align_corners,
+    GridSample3DInterpolationMode interpolationMode,
+    GridSample3DPaddingMode paddingMode,
+    bfloat16* output,
+    cudaStream_t stream,
+    GridSample3DPointLayout pointLayout,
+    const GridSample3DTactic& tactic,
+    void* workspace,
+    const uint8_t* mask
+);
+
+template int grid_sample_3d_points_cuda<half, float>(
+    const half* input,
+    const float* points,
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    size_t P,
+    bool align_corners,
+    GridSample3DInterpolationMode interpolationMode,
+    GridSample3DPaddingMode paddingMode,
+    half* output,
+    cudaStream_t stream,
+    GridSample3DPointLayout pointLayout,
+    const GridSample3DTactic& tactic,
+    void* workspace,
+    const uint8_t* mask
+);
+
+template int grid_sample_3d_points_cuda<bfloat16, float>(
+    const bfloat16* input,
+    const float* points,
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    size_t P,
+    bool align_corners,
+    GridSample3DInterpolationMode interpolationMode,
+    GridSample3DPaddingMode paddingMode,
+    bfloat16* output,
+    cudaStream_t stream,
+    GridSample3DPointLayout pointLayout,
+    const GridSample3DTactic& tactic,
+    void* workspace,
+    const uint8_t* mask
+);
+
+template int grid_sample_3d_mipmap_cuda<float, float>(
+    const float* input,
+    const float* grid,
+    const float* lod,
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    size_t D_grid, size_t H_grid, size_t W_grid,
+    bool align_corners,
+    GridSample3DPaddingMode paddingMode,
+    float* output,
+    cudaStream_t stream,
+    void* workspace,
+    const uint8_t* mask
+);
+
+template int grid_sample_3d_mipmap_cuda<half, half>(
+    const half* input,
+    const half* grid,
+    const float* lod,
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    size_t D_grid, size_t H_grid, size_t W_grid,
+    bool align_corners,
+    GridSample3DPaddingMode paddingMode,
+    half* output,
+    cudaStream_t stream,
+    void* workspace,
+    const uint8_t* mask
+);
+
+template int grid_sample_3d_mipmap_cuda<bfloat16, bfloat16>(
+    const bfloat16* input,
+    const bfloat16* grid,
+    const float* lod,
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    size_t D_grid, size_t H_grid, size_t W_grid,
+    bool align_corners,
+    GridSample3DPaddingMode paddingMode,
+    bfloat16* output,
+    cudaStream_t stream,
+    void* workspace,
+    const uint8_t* mask
+);
+
+template int grid_sample_3d_mipmap_cuda<half, float>(
+    const half* input,
+    const float* grid,
+    const float* lod,
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    size_t D_grid, size_t H_grid, size_t W_grid,
+    bool align_corners,
+    GridSample3DPaddingMode paddingMode,
+    half* output,
+    cudaStream_t stream,
+    void* workspace,
+    const uint8_t* mask
+);
+
+template int grid_sample_3d_mipmap_cuda<bfloat16, float>(
+    const bfloat16* input,
+    const float* grid,
+    const float* lod,
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    size_t D_grid, size_t H_grid, size_t W_grid,
+    bool align_corners,
+    GridSample3DPaddingMode paddingMode,
+    bfloat16* output,
+    cudaStream_t stream,
+    void* workspace,
+    const uint8_t* mask
+);
+
+template int grid_sample_3d_ragged_cuda<float, float>(
+    const float* input,
+    const float* grid,
+    const GridSample3DRaggedItem* items,
+    size_t numItems, size_t C, size_t V_in, size_t G,
+    bool align_corners,
+    GridSample3DInterpolationMode interpolationMode,
+    GridSample3DPaddingMode paddingMode,
+    float* output,
+    cudaStream_t stream,
+    const GridSample3DTactic& tactic
+);
+
+template int grid_sample_3d_ragged_cuda<half, half>(
+    const half* input,
+    const half* grid,
+    const GridSample3DRaggedItem* items,
+    size_t numItems, size_t C, size_t V_in, size_t G,
+    bool align_corners,
+    GridSample3DInterpolationMode interpolationMode,
+    GridSample3DPaddingMode paddingMode,
+    half* output,
+    cudaStream_t stream,
+    const GridSample3DTactic& tactic
+);
+
+template int grid_sample_3d_ragged_cuda<bfloat16, bfloat16>(
+    const bfloat16* input,
+    const bfloat16* grid,
+    const GridSample3DRaggedItem* items,
+    size_t numItems, size_t C, size_t V_in, size_t G,
+    bool align_corners,
+    GridSample3DInterpolationMode interpolationMode,
+    GridSample3DPaddingMode paddingMode,
+    bfloat16* output,
+    cudaStream_t stream,
+    const GridSample3DTactic& tactic
+);
+
+template int grid_sample_3d_ragged_cuda<half, float>(
+    const half* input,
+    const float* grid,
+    const GridSample3DRaggedItem* items,
+    size_t numItems, size_t C, size_t V_in, size_t G,
+    bool align_corners,
+    GridSample3DInterpolationMode interpolationMode,
+    GridSample3DPaddingMode paddingMode,
+    half* output,
+    cudaStream_t stream,
+    const GridSample3DTactic& tactic
+);
+
+template int grid_sample_3d_ragged_cuda<bfloat16, float>(
+    const bfloat16* input,
+    const float* grid,
+    const GridSample3DRaggedItem* items,
+    size_t numItems, size_t C, size_t V_in, size_t G,
+    bool align_corners,
+    GridSample3DInterpolationMode interpolationMode,
+    GridSample3DPaddingMode paddingMode,
+    bfloat16* output,
+    cudaStream_t stream,
+    const GridSample3DTactic& tactic
+);
+
+template int grid_sample_3d_strided_cuda<float, float>(
+    const float* input,
+    const GridSample3DStrides& inputStrides,
+    const float* grid,
+    const GridSample3DGridStrides& gridStrides,
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    size_t D_grid, size_t H_grid, size_t W_grid,
+    bool align_corners,
+    GridSample3DInterpolationMode interpolationMode,
+    GridSample3DPaddingMode paddingMode,
+    float* output,
+    const GridSample3DStrides& outputStrides,
+    cudaStream_t stream,
+    const GridSample3DTactic& tactic,
+    void* workspace,
+    const uint8_t* mask
+);
+
+template int grid_sample_3d_strided_cuda<half, half>(
+    const half* input,
+    const GridSample3DStrides& inputStrides,
+    const half* grid,
+    const GridSample3DGridStrides& gridStrides,
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    size_t D_grid, size_t H_grid, size_t W_grid,
+    bool align_corners,
+    GridSample3DInterpolationMode interpolationMode,
+    GridSample3DPaddingMode paddingMode,
+    half* output,
+    const GridSample3DStrides& outputStrides,
+    cudaStream_t stream,
+    const GridSample3DTactic& tactic,
+    void* workspace,
+    const uint8_t* mask
+);
+
+template int grid_sample_3d_strided_cuda<bfloat16, bfloat16>(
+    const bfloat16* input,
+    const GridSample3DStrides& inputStrides,
+    const bfloat16* grid,
+    const GridSample3DGridStrides& gridStrides,
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    size_t D_grid, size_t H_grid, size_t W_grid,
+    bool align_corners,
+    GridSample3DInterpolationMode interpolationMode,
+    GridSample3DPaddingMode paddingMode,
+    bfloat16* output,
+    const GridSample3DStrides& outputStrides,
+    cudaStream_t stream,
+    const GridSample3DTactic& tactic,
+    void* workspace,
+    const uint8_t* mask
+);
+
+template int grid_sample_3d_strided_cuda<half, float>(
+    const half* input,
+    const GridSample3DStrides& inputStrides,
+    const float* grid,
+    const GridSample3DGridStrides& gridStrides,
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    size_t D_grid, size_t H_grid, size_t W_grid,
+    bool align_corners,
+    GridSample3DInterpolationMode interpolationMode,
+    GridSample3DPaddingMode paddingMode,
+    half* output,
+    const GridSample3DStrides& outputStrides,
+    cudaStream_t stream,
+    const GridSample3DTactic& tactic,
+    void* workspace,
+    const uint8_t* mask
+);
+
+template int grid_sample_3d_strided_cuda<bfloat16, float>(
+    const bfloat16* input,
+    const GridSample3DStrides& inputStrides,
+    const float* grid,
+    const GridSample3DGridStrides& gridStrides,
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    size_t D_grid, size_t H_grid, size_t W_grid,
+    bool align_corners,
+    GridSample3DInterpolationMode interpolationMode,
+    GridSample3DPaddingMode paddingMode,
+    bfloat16* output,
+    const GridSample3DStrides& outputStrides,
+    cudaStream_t stream,
+    const GridSample3DTactic& tactic,
+    void* workspace,
+    const uint8_t* mask
+);
@@ -2,101 +2,148 @@
 
 #pragma once
 
+#include <algorithm>
+#include <float.h>
 #include <iostream>
+#include <math.h>
+#include <stdint.h>
+#include <type_traits>
 
 #include <cuda_runtime.h>
 #include <cuda_fp16.h>
+#include <cuda_bf16.h>
 
 #include "grid_sample_3d.h"
 
-static __forceinline__ __device__
-__half operator*(const __half& a, const int& b)
-{
-    return a * __int2half_rn(b);
+// Element conversions shared by the CUDA kernels and the CPU backend. Storage may be fp16 or bf16,
+// but coordinates, weights and accumulation are always fp32.
+static __forceinline__ __host__ __device__
+float to_float(float v) {
+    return v;
 }
 
-static __forceinline__ __device__
-__half operator*(const float& a, const half& b)
-{
-    return __float2half(a) * b;
+static __forceinline__ __host__ __device__
+float to_float(__half v) {
+    return __half2float(v);
 }
 
-static __forceinline__ __device__
-__half operator+=(const float& a, const half& b)
-{
-    return __float2half(a) += b;
+static __forceinline__ __host__ __device__
+float to_float(__nv_bfloat16 v) {
+    return __bfloat162float(v);
 }
 
-static __forceinline__ __device__
-__half operator/(const __half& a, const int& b)
-{
-    return a / __int2half_rn(b);
-}
+template<typename scalar_t>
+__forceinline__ __host__ __device__
+scalar_t from_float(float v);
 
-static __forceinline__ __device__
-__half operator+(const __half& a, const float& b)
-{
-    return a + __float2half(b);
+template<>
+__forceinline__ __host__ __device__
+float from_float<float>(float v) {
+    return v;
 }
 
-static __forceinline__ __device__
-__half operator-(const __half& a, const int& b)
-{
-    return a - __int2half_rn(b);
+template<>
+__forceinline__ __host__ __device__
+__half from_float<__half>(float v) {
+    return __float2half(v);
 }
 
-static __forceinline__ __device__
-__half operator-(const int& a, const __half& b)
-{
-    return __int2half_rn(a) - b;
+template<>
+__forceinline__ __host__ __device__
+__nv_bfloat16 from_float<__nv_bfloat16>(float v) {
+    return __float2bfloat16(v);
 }
 
-static __forceinline__ __device__
-__half operator+=(const __half& a, const __half& b)
-{
-    return a + b;
-}
+// GridSample3DDataType of a storage type
+template <typename scalar_t>
+struct GridSample3DDataTypeOf;
 
-static __forceinline__ __device__
-__half min(const __half& a, const half& b)
-{
-    return __float2half(min(__half2float(a), __half2float(b)));
-}
+template <>
+struct GridSample3DDataTypeOf<float> {
+    static constexpr GridSample3DDataType value = GridSample3DDataType::GFLOAT;
+};
 
-static __forceinline__ __device__
-__half max(const __half& a, const half& b)
-{
-    return __float2half(max(__half2float(a), __half2float(b)));
-}
+template <>
+struct GridSample3DDataTypeOf<__half> {
+    static constexpr GridSample3DDataType value = GridSample3DDataType::GHALF;
+};
 
-static __forceinline__ __device__
-__half fabs(const __half& a)
-{
-    //TODO return __habs(a); what happened.
-    return __float2half(fabs(__half2float(a)));
-}
+template <>
+struct GridSample3DDataTypeOf<__nv_bfloat16> {
+    static constexpr GridSample3DDataType value = GridSample3DDataType::GBF16;
+};
+
+template <>
+struct GridSample3DDataTypeOf<int32_t> {
+    static constexpr GridSample3DDataType value = GridSample3DDataType::GINT32;
+};
+
+template <>
+struct GridSample3DDataTypeOf<int8_t> {
+    static constexpr GridSample3DDataType value = GridSample3DDataType::GINT8;
+};
+
+template <>
+struct GridSample3DDataTypeOf<uint8_t> {
+    static constexpr GridSample3DDataType value = GridSample3DDataType::GUINT8;
+};
+
+template <typename q_t>
+struct QuantizedRange;
 
-static __forceinline__ __device__
-__half floor(const __half& a)
-{
-    return hfloor(a);
+template <>
+struct QuantizedRange<int8_t> {
+    static constexpr int lowest = -128;
+    static constexpr int highest = 127;
+};
+
+template <>
+struct QuantizedRange<uint8_t> {
+    static constexpr int lowest = 0;
+    static constexpr int highest = 255;
+};
+
+// real value of q in channel c, see GridSample3DQuantization
+static __forceinline__ __host__ __device__
+float dequantize_value(int32_t q, const GridSample3DQuantization& quantization, size_t c) {
+    const float scale = quantization.channelScale ? quantization.channelScale[c] : quantization.scale;
+    const int32_t zero_point = quantization.channelZeroPoint ? quantization.channelZeroPoint[c] : quantization.zeroPoint;
+    return scale * static_cast<float>(q - zero_point);
 }
 
-static __forceinline__ __device__
-__half roundf(const __half& a)
-{
-    return hrint(a);
+// Stores the fp32 result of channel c: quantized (rounding half to even and saturating, as
+// TensorRT and PyTorch do) for integer out_t, converted otherwise.
+template <typename out_t>
+static __forceinline__ __host__ __device__
+out_t quantize_value(float v, const GridSample3DQuantization& quantization, size_t c) {
+    if constexpr (std::is_integral<out_t>::value) {
+        const float scale = quantization.channelScale ? quantization.channelScale[c] : quantization.scale;
+        const int32_t zero_point = quantization.channelZeroPoint ? quantization.channelZeroPoint[c] : quantization.zeroPoint;
+        const float q = rintf(v / scale) + static_cast<float>(zero_point);
+        constexpr float lowest = static_cast<float>(QuantizedRange<out_t>::lowest);
+        constexpr float highest = static_cast<float>(QuantizedRange<out_t>::highest);
+        // NaN saturates to the lowest value
+        return static_cast<out_t>(q > lowest ? (q < highest ? q : highest) : lowest);
+    } else {
+        return from_float<out_t>(v);
+    }
 }
 
-static __forceinline__ __device__
-__half fmod(const __half& a, const __half& b)
-{
-  return __float2half(fmodf(__half2float(a), __half2float(b)));
+template<typename scalar_t>
+static __forceinline__ __host__ __device__
+scalar_t clip_coordinates(scalar_t in, int clip_limit) {
+#if defined(__CUDA_ARCH__)
+    return ::min(static_cast<scalar_t>(clip_limit - 1), ::max(in, static_cast<scalar_t>(0)));
+#else
+    // written so that NaN clips to 0 like fmaxf does on the device; callers rely on the result being in range
+    const scalar_t upper = static_cast<scalar_t>(clip_limit - 1);
+    return in > static_cast<scalar_t>(0) ? (in < upper ? in : upper) : static_cast<scalar_t>(0);
+#endif
 }
 
 // borrow from pytorch aten/src/Aten/native/GridSampler.h
 template<typename scalar_t>
-static __forceinline__ __device__
+static __forceinline__ __host__ __device__
 scalar_t reflect_coordinates(scalar_t in, int twice_low,
                                            int twice_high) {
   if (twice_low == twice_high) {
@@ -115,35 +162,695 @@ scalar_t reflect_coordinates(scalar_t in, int twice_low,
   }
 }
 
+// unnormalize coord from [-1, 1] to [0, size - 1] if align_corners = False
+// else unnormalize coord from [-1, 1] to [-0.5, size - 0.5]
+template <bool align_corners, typename scalar_t>
+static __forceinline__ __host__ __device__
+scalar_t grid_sampler_unnormalize(const scalar_t coord, const int size) {
+    if(align_corners) {
+        return ((coord + 1.f) / 2) * (size - 1);
+    }
+    return ((coord + 1.f) * size - 1) / 2;
+}
+
+// check if the (unnormalized) coord_ is out of input boundary,
+// if so, make it back to the boundary based on padding_mode
+template <GridSample3DPaddingMode padding_mode, bool align_corners, typename scalar_t>
+static __forceinline__ __host__ __device__
+scalar_t compute_coordinates(scalar_t coord_, const int size) {
+    if (padding_mode == GridSample3DPaddingMode::Border) { // border mode, clip to [0, size-1]
+        coord_ = clip_coordinates(coord_, size);
+    } else if (padding_mode == GridSample3DPaddingMode::Reflection) { // reflection mode
+        if(align_corners) {
+            coord_ = reflect_coordinates(coord_, 0, 2 * (size - 1));
+        } else {
+            coord_ = reflect_coordinates(coord_, -1, 2 * size - 1);
+        }
+        coord_ = clip_coordinates(coord_, size);
+    }
+    return coord_;
+}
+
+// Compile-time specialization: with the padding mode and align_corners fixed every branch
+// below folds away, e.g. Zeros + !align_corners is only the unnormalization arithmetic.
+template <GridSample3DPaddingMode padding_mode, bool align_corners, typename scalar_t>
+static __forceinline__ __host__ __device__
+scalar_t compute_index(
+    const scalar_t coord,
+    const int size
+) {
+    return compute_coordinates<padding_mode, align_corners>(grid_sampler_unnormalize<align_corners>(coord, size), size);
+}
+
 template <typename scalar_t>
-static __forceinline__ __device__
+static __forceinline__ __host__ __device__
 scalar_t compute_index(
     const scalar_t coord,
     const int size,
     const GridSample3DPaddingMode padding_mode, 
     const bool align_corners
 ) {
-    // unnormalize coord from [-1, 1] to [0, size - 1] if align_corners = False
-    // else unnormalize coord from [-1, 1] to [-0.5, size - 0.5]
-    scalar_t coord_;
-    if(align_corners) {
-        coord_ = ((coord + 1.f) / 2) * (size - 1);
-    }else {
-        coord_ = ((coord + 1.f) * size - 1) / 2;
+    switch (padding_mode) {
+    case GridSample3DPaddingMode::Border:
+        return align_corners ? compute_index<GridSample3DPaddingMode::Border, true>(coord, size)
+                             : compute_index<GridSample3DPaddingMode::Border, false>(coord, size);
+    case GridSample3DPaddingMode::Reflection:
+        return align_corners ? compute_index<GridSample3DPaddingMode::Reflection, true>(coord, size)
+                             : compute_index<GridSample3DPaddingMode::Reflection, false>(coord, size);
+    default:
+        return align_corners ? compute_index<GridSample3DPaddingMode::Zeros, true>(coord, size)
+                             : compute_index<GridSample3DPaddingMode::Zeros, false>(coord, size);
     }
+}
 
-    // check if the coord_ is out of input boundary,
-    // if so, make it back to the boundary based on padding_mode
-    if (padding_mode == GridSample3DPaddingMode::Border) { // border mode, clip to [0, size-1]
-        coord_ = ::min(static_cast<scalar_t>(size-1), ::max(coord_, static_cast<scalar_t>(0)));
-    } else if (padding_mode == GridSample3DPaddingMode::Reflection) { // reflection mode
-        if(align_corners) {
-            coord_ = reflect_coordinates(coord_, 0, 2 * (size - 1));
+// Normalized base coordinate of voxel i along an axis of `size` voxels, as in F.affine_grid
+// (linspace(-1, 1) scaled by (size - 1) / size unless align_corners; 0 for a single voxel).
+template <bool align_corners>
+static __forceinline__ __host__ __device__
+float affine_grid_base(int i, int size) {
+    if (size <= 1) {
+        return 0.f;
+    }
+    if (align_corners) {
+        return static_cast<float>(2 * i) / (size - 1) - 1.f;
+    }
+    return static_cast<float>(2 * i + 1) / size - 1.f;
+}
+
+// Grid coordinate of F.affine_grid: theta (3 x 4, row-major) times the base coordinate (bx, by, bz, 1).
+static __forceinline__ __host__ __device__
+void affine_grid_coords(const float* theta, float bx, float by, float bz, float& x, float& y, float& z) {
+    x = theta[0] * bx + theta[1] * by + theta[2]  * bz + theta[3];
+    y = theta[4] * bx + theta[5] * by + theta[6]  * bz + theta[7];
+    z = theta[8] * bx + theta[9] * by + theta[10] * bz + theta[11];
+}
+
+// Identity coordinate of output voxel i (of out_size along the axis) in input voxels, i.e. the
+// unnormalized affine_grid_base; exactly i when the sizes match.
+template <bool align_corners>
+static __forceinline__ __host__ __device__
+float identity_voxel(int i, int out_size, int in_size) {
+    if (out_size <= 1) {
+        return grid_sampler_unnormalize<align_corners>(0.f, in_size);
+    }
+    if (align_corners) {
+        return static_cast<float>(i) * (in_size - 1) / (out_size - 1);
+    }
+    return (static_cast<float>(i) + 0.5f) * in_size / out_size - 0.5f;
+}
+
+// Source index of grid value `coord` of the given kind at output voxel i (of out_size along the
+// axis). Displacements are added to the identity coordinate in fp32, so the grid may stay fp16.
+template <GridSample3DGridKind grid_kind, GridSample3DPaddingMode padding_mode, bool align_corners, typename coord_t>
+static __forceinline__ __host__ __device__
+coord_t compute_index(
+    const coord_t coord,
+    const int i,
+    const int out_size,
+    const int size
+) {
+    if constexpr (grid_kind == GridSample3DGridKind::DisplacementNormalized) {
+        return compute_index<padding_mode, align_corners>(affine_grid_base<align_corners>(i, out_size) + coord, size);
+    } else if constexpr (grid_kind == GridSample3DGridKind::DisplacementVoxels) {
+        return compute_coordinates<padding_mode, align_corners>(identity_voxel<align_corners>(i, out_size, size) + coord, size);
+    } else {
+        return compute_index<padding_mode, align_corners>(coord, size);
+    }
+}
+
+// Iteration space of a GridSample3DTraversal over an N x D x H x W output. The output is cut into
+// bricks of bd x bh x bw voxels (clipped at the far edges), numbered per batch item row-major
+// (Tiled) or along a Z-order curve over the brick grid padded to powers of two (Morton), and
+// index i maps to voxel i % brickVoxels() of brick i / brickVoxels(). Indices of Morton padding
+// map to no voxel. Linear is the plain row-major order.
+struct GridSample3DBricks {
+    GridSample3DTraversal traversal;
+    size_t D, H, W;
+    size_t bd, bh, bw;               // brick size
+    size_t nd, nh, nw;               // bricks per axis
+    int bits_d, bits_h, bits_w;      // Morton bits per axis
+    size_t per_batch;                // brick indices per batch item
+    // bucketed order (GridSample3DBucketing): while *use_order is set, index i < ordered is the
+    // flat output voxel order[i] instead
+    const uint32_t* order = nullptr;
+    const int32_t* use_order = nullptr;
+    size_t ordered = 0;
+
+    __host__ __device__ size_t brickVoxels() const { return bd * bh * bw; }
+
+    // size of the iteration space of N batch items
+    __host__ __device__ size_t count(size_t N) const {
+        return traversal == GridSample3DTraversal::Linear ? N * D * H * W : N * per_batch * brickVoxels();
+    }
+
+    // First voxel of brick b; false for Morton padding. The index math runs in index_t, which the
+    // CUDA kernels narrow to 32 bits when the launch allows it (grid_sample_3d_index_fits_32bit).
+    template <typename index_t = size_t>
+    __host__ __device__ bool origin(index_t b, index_t& n, index_t& d0, index_t& h0, index_t& w0) const {
+        const index_t per_batch_ = static_cast<index_t>(per_batch);
+        n = b / per_batch_;
+        b %= per_batch_;
+        index_t zd = 0, zh = 0, zw = 0;
+        if (traversal == GridSample3DTraversal::Morton) {
+            // de-interleave w, h, d bits; an axis drops out once its bits are used up
+            int bit = 0;
+            for (int k = 0; k < bits_d || k < bits_h || k < bits_w; k++) {
+                if (k < bits_w) {
+                    zw |= ((b >> bit++) & 1) << k;
+                }
+                if (k < bits_h) {
+                    zh |= ((b >> bit++) & 1) << k;
+                }
+                if (k < bits_d) {
+                    zd |= ((b >> bit++) & 1) << k;
+                }
+            }
         } else {
-            coord_ = reflect_coordinates(coord_, -1, 2 * size - 1);
+            const index_t nw_ = static_cast<index_t>(nw), nh_ = static_cast<index_t>(nh);
+            zw = b % nw_;
+            zh = (b / nw_) % nh_;
+            zd = b / (nw_ * nh_);
         }
-        coord_ = ::min(static_cast<scalar_t>(size-1), ::max(coord_, static_cast<scalar_t>(0)));
+        d0 = zd * static_cast<index_t>(bd);
+        h0 = zh * static_cast<index_t>(bh);
+        w0 = zw * static_cast<index_t>(bw);
+        return zd < nd && zh < nh && zw < nw;
     }
 
-    return coord_;
-}
\ No newline at end of file
+    // voxel (n, d, h, w) of index i; false when i maps to no voxel
+    template <typename index_t = size_t>
+    __host__ __device__ bool voxel(index_t i, index_t& n, index_t& d, index_t& h, index_t& w) const {
+        if (order != nullptr && *use_order) {
+            if (i >= ordered) {
+                return false;
+            }
+            i = order[i];
+        } else if (traversal != GridSample3DTraversal::Linear) {
+            return brickVoxel<index_t>(i, n, d, h, w);
+        }
+        const index_t D_ = static_cast<index_t>(D), H_ = static_cast<index_t>(H), W_ = static_cast<index_t>(W);
+        n = i / (D_ * H_ * W_);
+        d = (i / (H_ * W_)) % D_;
+        h = (i / W_) % H_;
+        w = i % W_;
+        return true;
+    }
+
+    // voxel of index i of a Tiled or Morton traversal
+    template <typename index_t = size_t>
+    __host__ __device__ bool brickVoxel(index_t i, index_t& n, index_t& d, index_t& h, index_t& w) const {
+        const index_t bh_ = static_cast<index_t>(bh), bw_ = static_cast<index_t>(bw);
+        const index_t brick_voxels = static_cast<index_t>(brickVoxels());
+        const index_t v = i % brick_voxels;
+        if (!origin<index_t>(i / brick_voxels, n, d, h, w)) {
+            return false;
+        }
+        d += v / (bh_ * bw_);
+        h += (v / bw_) % bh_;
+        w += v % bw_;
+        return d < D && h < H && w < W;
+    }
+};
+
+// Whether a launch of the NCDHW kernels can use 32-bit index math: every element index of the
+// input, the output and the grid, and the traversal index plus one grid stride, stay below 2^31.
+inline bool grid_sample_3d_index_fits_32bit(
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    size_t D_grid, size_t H_grid, size_t W_grid,
+    size_t iterations
+) {
+    const size_t limit = static_cast<size_t>(INT32_MAX);
+    return N * C * D_in * H_in * W_in <= limit && N * C * D_grid * H_grid * W_grid <= limit &&
+           N * D_grid * H_grid * W_grid * 3 <= limit && iterations <= limit;
+}
+
+// Voxels of a D x H x W ragged item, or limit + 1 when there are more than `limit` (at most
+// INT32_MAX, so every partial product stays in 64 bits); negative extents are caught by the caller.
+__forceinline__ __host__ __device__
+size_t grid_sample_3d_ragged_voxels(int32_t D, int32_t H, int32_t W, size_t limit) {
+    const size_t DH = static_cast<size_t>(static_cast<uint32_t>(D)) * static_cast<uint32_t>(H);
+    if (DH > limit) {
+        return limit + 1;
+    }
+    const size_t DHW = DH * static_cast<uint32_t>(W);
+    return DHW > limit ? limit + 1 : DHW;
+}
+
+// Whether item i of a ragged table of numItems items is usable with a packed input of V_in and a
+// grid of G voxels (both at most INT32_MAX): a non-empty volume inside the input, and a grid range
+// starting where item i - 1 ends (at 0 for the first item) and, for the last item, ending at G.
+// With every item valid the table is in range, sorted by grid_offset and covers the grid without
+// a gap, so every output voxel is written exactly once.
+__forceinline__ __host__ __device__
+bool grid_sample_3d_ragged_item_valid(const GridSample3DRaggedItem* items, size_t i, size_t numItems,
+                                      size_t V_in, size_t G) {
+    const GridSample3DRaggedItem item = items[i];
+    if (item.D_in <= 0 || item.H_in <= 0 || item.W_in <= 0 || item.D_grid < 0 || item.H_grid < 0 ||
+        item.W_grid < 0 || item.input_offset < 0 || item.grid_offset < 0) {
+        return false;
+    }
+    const size_t input_end = item.input_offset + grid_sample_3d_ragged_voxels(item.D_in, item.H_in, item.W_in, V_in);
+    const size_t grid_end = item.grid_offset + grid_sample_3d_ragged_voxels(item.D_grid, item.H_grid, item.W_grid, G);
+    size_t grid_begin = 0;
+    if (i > 0) {
+        const GridSample3DRaggedItem previous = items[i - 1];
+        grid_begin = static_cast<size_t>(static_cast<uint32_t>(previous.grid_offset)) +
+                     grid_sample_3d_ragged_voxels(previous.D_grid, previous.H_grid, previous.W_grid, G);
+    }
+    return input_end <= V_in && static_cast<size_t>(item.grid_offset) == grid_begin && grid_end <= G &&
+           (i + 1 < numItems || grid_end == G);
+}
+
+// Elements spanned by a strided N x C x D x H x W view: one past its largest element index.
+inline size_t grid_sample_3d_strided_span(size_t N, size_t C, size_t D, size_t H, size_t W,
+                                          const GridSample3DStrides& strides) {
+    if (N * C * D * H * W == 0) {
+        return 0;
+    }
+    return 1 + (N - 1) * strides.N + (C - 1) * strides.C + (D - 1) * strides.D + (H - 1) * strides.H +
+           (W - 1) * strides.W;
+}
+
+// Same predicate for strided views: the spans replace the element counts.
+inline bool grid_sample_3d_strided_index_fits_32bit(
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    const GridSample3DStrides& inputStrides,
+    size_t D_grid, size_t H_grid, size_t W_grid,
+    const GridSample3DGridStrides& gridStrides,
+    const GridSample3DStrides& outputStrides,
+    size_t iterations
+) {
+    const size_t limit = static_cast<size_t>(INT32_MAX);
+    const GridSample3DStrides grid{gridStrides.N, gridStrides.XYZ, gridStrides.D, gridStrides.H, gridStrides.W};
+    return grid_sample_3d_strided_span(N, C, D_in, H_in, W_in, inputStrides) <= limit &&
+           grid_sample_3d_strided_span(N, C, D_grid, H_grid, W_grid, outputStrides) <= limit &&
+           grid_sample_3d_strided_span(N, 3, D_grid, H_grid, W_grid, grid) <= limit && iterations <= limit;
+}
+
+inline int grid_sample_3d_ceil_log2(size_t n) {
+    int bits = 0;
+    while ((size_t(1) << bits) < n) {
+        bits++;
+    }
+    return bits;
+}
+
+// Bricks of (at most) bd x bh x bw voxels over a D x H x W output.
+inline GridSample3DBricks grid_sample_3d_bricks(
+    GridSample3DTraversal traversal,
+    size_t D, size_t H, size_t W,
+    size_t bd, size_t bh, size_t bw
+) {
+    GridSample3DBricks b;
+    b.traversal = traversal;
+    b.D = D;
+    b.H = H;
+    b.W = W;
+    b.bd = std::max<size_t>(std::min(bd, D), 1);
+    b.bh = std::max<size_t>(std::min(bh, H), 1);
+    b.bw = std::max<size_t>(std::min(bw, W), 1);
+    b.nd = (D + b.bd - 1) / b.bd;
+    b.nh = (H + b.bh - 1) / b.bh;
+    b.nw = (W + b.bw - 1) / b.bw;
+    const bool morton = traversal == GridSample3DTraversal::Morton;
+    b.bits_d = morton ? grid_sample_3d_ceil_log2(b.nd) : 0;
+    b.bits_h = morton ? grid_sample_3d_ceil_log2(b.nh) : 0;
+    b.bits_w = morton ? grid_sample_3d_ceil_log2(b.nw) : 0;
+    b.per_batch = morton ? size_t(1) << (b.bits_d + b.bits_h + b.bits_w) : b.nd * b.nh * b.nw;
+    return b;
+}
+
+// Bucketed sampling (GridSample3DBucketing): the input is cut into blocks of
+// GRID_SAMPLE_3D_BUCKET_EDGE^3 voxels, one bucket each per batch item, and an output voxel goes to
+// the bucket of its (unnormalized, padded) source index.
+#define GRID_SAMPLE_3D_BUCKET_EDGE 16
+// The Auto heuristic looks at GRID_SAMPLE_3D_BUCKET_SAMPLES pairs of horizontal neighbours spread
+// over the output and buckets when more than a quarter of them have sources further apart than
+// half a block along some axis; plain resampling, even a 4x downsample, stays in output order.
+#define GRID_SAMPLE_3D_BUCKET_SAMPLES 4096
+#define GRID_SAMPLE_3D_BUCKET_JUMP (GRID_SAMPLE_3D_BUCKET_EDGE / 2.f)
+
+struct GridSample3DBuckets {
+    int D, H, W;        // input size
+    int nd, nh, nw;     // blocks per axis
+
+    __host__ __device__ size_t count() const { return static_cast<size_t>(nd) * nh * nw; }
+
+    __host__ __device__ static int axis(float i, int blocks) {
+        int b = static_cast<int>(floorf(i)) / GRID_SAMPLE_3D_BUCKET_EDGE;
+        return b < 0 ? 0 : (b >= blocks ? blocks - 1 : b);
+    }
+
+    // bucket of source index (ix, iy, iz); sources outside the input go to the nearest block
+    __host__ __device__ size_t bucket(float ix, float iy, float iz) const {
+        // NaN sources are read as zeros and land in bucket 0
+        if (!(ix == ix && iy == iy && iz == iz)) {
+            return 0;
+        }
+        ix = fminf(fmaxf(ix, -1.f), static_cast<float>(W));
+        iy = fminf(fmaxf(iy, -1.f), static_cast<float>(H));
+        iz = fminf(fmaxf(iz, -1.f), static_cast<float>(D));
+        return (static_cast<size_t>(axis(iz, nd)) * nh + axis(iy, nh)) * nw + axis(ix, nw);
+    }
+};
+
+inline GridSample3DBuckets grid_sample_3d_buckets(size_t D_in, size_t H_in, size_t W_in) {
+    GridSample3DBuckets b;
+    b.D = static_cast<int>(D_in);
+    b.H = static_cast<int>(H_in);
+    b.W = static_cast<int>(W_in);
+    b.nd = static_cast<int>(std::max<size_t>((D_in + GRID_SAMPLE_3D_BUCKET_EDGE - 1) / GRID_SAMPLE_3D_BUCKET_EDGE, 1));
+    b.nh = static_cast<int>(std::max<size_t>((H_in + GRID_SAMPLE_3D_BUCKET_EDGE - 1) / GRID_SAMPLE_3D_BUCKET_EDGE, 1));
+    b.nw = static_cast<int>(std::max<size_t>((W_in + GRID_SAMPLE_3D_BUCKET_EDGE - 1) / GRID_SAMPLE_3D_BUCKET_EDGE, 1));
+    return b;
+}
+
+// Left voxel (n, d, h, w) of heuristic sample s over an N x D x H x W output (W > 1): the samples
+// step evenly through the rows and scatter along them.
+__host__ __device__ inline void grid_sample_3d_bucket_sample(
+    size_t s, size_t N, size_t D, size_t H, size_t W,
+    size_t& n, size_t& d, size_t& h, size_t& w
+) {
+    const size_t row = s * (N * D * H) / GRID_SAMPLE_3D_BUCKET_SAMPLES;
+    n = row / (D * H);
+    d = (row / H) % D;
+    h = row % H;
+    w = (s * 7919) % (W - 1);
+}
+
+__host__ __device__ inline bool grid_sample_3d_bucket_jump(float ix0, float iy0, float iz0,
+                                                           float ix1, float iy1, float iz1) {
+    return fabsf(ix1 - ix0) > GRID_SAMPLE_3D_BUCKET_JUMP || fabsf(iy1 - iy0) > GRID_SAMPLE_3D_BUCKET_JUMP ||
+           fabsf(iz1 - iz0) > GRID_SAMPLE_3D_BUCKET_JUMP;
+}
+
+// Layout of the bucketing workspace: the use-order flag, one offset per bucket and batch item, and
+// the sorted order of the `voxels` output voxels, each 256-byte aligned.
+struct GridSample3DBucketWorkspace {
+    size_t offsets_at;
+    size_t order_at;
+    size_t bytes;
+
+    GridSample3DBucketWorkspace(size_t buckets, size_t voxels) {
+        auto aligned = [](size_t bytes) { return (bytes + 255) / 256 * 256; };
+        offsets_at = 256;
+        order_at = offsets_at + aligned(buckets * sizeof(uint32_t));
+        bytes = order_at + aligned(voxels * sizeof(uint32_t));
+    }
+};
+
+// Brick of the CUDA tiled traversals: 256 voxels, so a warp covers a 1 x 4 x 8 patch and a
+// 256-thread block one brick
+#define GRID_SAMPLE_3D_CUDA_BRICK_D 4
+#define GRID_SAMPLE_3D_CUDA_BRICK_H 8
+#define GRID_SAMPLE_3D_CUDA_BRICK_W 8
+
+inline GridSample3DBricks grid_sample_3d_cuda_bricks(const GridSample3DTactic& tactic, size_t D_grid, size_t H_grid, size_t W_grid) {
+    return grid_sample_3d_bricks(tactic.traversal, D_grid, H_grid, W_grid, GRID_SAMPLE_3D_CUDA_BRICK_D,
+                                 GRID_SAMPLE_3D_CUDA_BRICK_H, GRID_SAMPLE_3D_CUDA_BRICK_W);
+}
+
+// Bounds prepass (GridSample3DTactic::tileBounds): the output is cut into tiles of
+// GRID_SAMPLE_3D_BOUNDS_TILE consecutive voxels of the traversal, and each tile is classified from
+// the box around the source indices of its voxels. Outside tiles have no tap in the input and are
+// zero-filled; Inside tiles have every tap in it and skip the bounds checks.
+#define GRID_SAMPLE_3D_BOUNDS_TILE 256
+
+enum class GridSample3DTileClass : uint8_t { Mixed, Inside, Outside };
+
+struct GridSample3DIndexBox {
+    float lo[3] = {FLT_MAX, FLT_MAX, FLT_MAX};
+    float hi[3] = {-FLT_MAX, -FLT_MAX, -FLT_MAX};
+    bool nan = false;
+
+    __host__ __device__ void add(float ix, float iy, float iz) {
+        const float i[3] = {ix, iy, iz};
+        for (int a = 0; a < 3; a++) {
+            nan |= !(i[a] == i[a]);
+            lo[a] = fminf(lo[a], i[a]);
+            hi[a] = fmaxf(hi[a], i[a]);
+        }
+    }
+
+    __host__ __device__ void merge(const GridSample3DIndexBox& other) {
+        for (int a = 0; a < 3; a++) {
+            lo[a] = fminf(lo[a], other.lo[a]);
+            hi[a] = fmaxf(hi[a], other.hi[a]);
+        }
+        nan |= other.nan;
+    }
+
+    // Tap footprint of the box against a W x H x D input: floor(i) and floor(i) + 1 for bilinear,
+    // round(i) for nearest. Compared as floats, so far-away indices cannot overflow.
+    __host__ __device__ GridSample3DTileClass classify(GridSample3DInterpolationMode interpolation, int W, int H, int D) const {
+        if (nan) {
+            return GridSample3DTileClass::Mixed;
+        }
+        const float size[3] = {static_cast<float>(W), static_cast<float>(H), static_cast<float>(D)};
+        const bool bilinear = interpolation == GridSample3DInterpolationMode::Bilinear;
+        bool inside = true;
+        for (int a = 0; a < 3; a++) {
+            if (lo[a] > hi[a]) {
+                return GridSample3DTileClass::Outside;
+            }
+            const float first = bilinear ? floorf(lo[a]) : roundf(lo[a]);
+            const float last = bilinear ? floorf(hi[a]) + 1.f : roundf(hi[a]);
+            if (last < 0.f || first >= size[a]) {
+                return GridSample3DTileClass::Outside;
+            }
+            inside &= first >= 0.f && last < size[a];
+        }
+        return inside ? GridSample3DTileClass::Inside : GridSample3DTileClass::Mixed;
+    }
+};
+
+// Layout of the CUDA workspace of a tactic: the bucketing workspace (GridSample3DBucketWorkspace)
+// when bucketing is on, then one GridSample3DTileClass per bounds tile when tileBounds is set.
+struct GridSample3DWorkspace {
+    size_t tiles_at = 0;
+    size_t tiles = 0;
+    size_t bytes = 0;
+
+    GridSample3DWorkspace(const GridSample3DTactic& tactic,
+                          size_t N, size_t D_in, size_t H_in, size_t W_in,
+                          size_t D_grid, size_t H_grid, size_t W_grid) {
+        if (tactic.bucketing != GridSample3DBucketing::Off) {
+            const GridSample3DBuckets buckets = grid_sample_3d_buckets(D_in, H_in, W_in);
+            bytes = GridSample3DBucketWorkspace(N * buckets.count(), N * D_grid * H_grid * W_grid).bytes;
+        }
+        if (tactic.tileBounds) {
+            const size_t voxels = grid_sample_3d_cuda_bricks(tactic, D_grid, H_grid, W_grid).count(N);
+            tiles_at = bytes;
+            tiles = (voxels + GRID_SAMPLE_3D_BOUNDS_TILE - 1) / GRID_SAMPLE_3D_BOUNDS_TILE;
+            bytes = tiles_at + (tiles * sizeof(GridSample3DTileClass) + 255) / 256 * 256;
+        }
+    }
+};
+
+// levels of a mip pyramid at most, level 0 being the input itself
+#define GRID_SAMPLE_3D_MIP_LEVELS 16
+
+// Mip pyramid of a D x H x W input (GridSample3DInterpolationMode::Mipmap): level l + 1 averages
+// the 2 x 2 x 2 voxels of level l (fewer at an odd far edge), down to 1 x 1 x 1. Levels 1 and up
+// are fp32 and stored one after the other, `slices` (N x C) slices each; level 0 is the input.
+struct GridSample3DMipPyramid {
+    int levels;
+    int D[GRID_SAMPLE_3D_MIP_LEVELS], H[GRID_SAMPLE_3D_MIP_LEVELS], W[GRID_SAMPLE_3D_MIP_LEVELS];
+    size_t offset[GRID_SAMPLE_3D_MIP_LEVELS + 1];   // first element of level l >= 1; offset[levels] = total
+
+    __host__ __device__ GridSample3DMipPyramid(size_t slices, int D_in, int H_in, int W_in) {
+        levels = 1;
+        D[0] = D_in;
+        H[0] = H_in;
+        W[0] = W_in;
+        offset[0] = offset[1] = 0;
+        while (levels < GRID_SAMPLE_3D_MIP_LEVELS && (D[levels - 1] > 1 || H[levels - 1] > 1 || W[levels - 1] > 1)) {
+            const int l = levels++;
+            D[l] = (D[l - 1] + 1) / 2;
+            H[l] = (H[l - 1] + 1) / 2;
+            W[l] = (W[l - 1] + 1) / 2;
+            offset[l + 1] = offset[l] + slices * sliceVoxels(l);
+        }
+    }
+
+    __host__ __device__ size_t sliceVoxels(int l) const {
+        return static_cast<size_t>(D[l]) * H[l] * W[l];
+    }
+};
+
+// Box average of the (up to) 2 x 2 x 2 voxels of a D x H x W slice under voxel (z, y, x) of the next level.
+template <typename T>
+__host__ __device__ inline float grid_sample_3d_mip_average(const T* src, int D, int H, int W, int z, int y, int x) {
+    const int z_end = 2 * z + 2 < D ? 2 * z + 2 : D;
+    const int y_end = 2 * y + 2 < H ? 2 * y + 2 : H;
+    const int x_end = 2 * x + 2 < W ? 2 * x + 2 : W;
+    float sum = 0.f;
+    int count = 0;
+    for (int sz = 2 * z; sz < z_end; sz++) {
+        for (int sy = 2 * y; sy < y_end; sy++) {
+            for (int sx = 2 * x; sx < x_end; sx++) {
+                sum += to_float(src[(static_cast<size_t>(sz) * H + sy) * W + sx]);
+                count++;
+            }
+        }
+    }
+    return sum / count;
+}
+
+// Level of detail of output voxel (d, h, w) from the grid Jacobian: log2 of the longest step, in
+// input voxels, to the next output voxel along any axis (the previous one at the far edge).
+// `grid` is the D_grid x H_grid x W_grid x 3 grid of the voxel's batch item.
+template <bool align_corners, typename grid_t>
+__host__ __device__ inline float grid_sample_3d_mip_lod(
+    const grid_t* grid,
+    size_t d, size_t h, size_t w,
+    size_t D_grid, size_t H_grid, size_t W_grid,
+    int D_in, int H_in, int W_in
+) {
+    const grid_t* g = grid + ((d * H_grid + h) * W_grid + w) * 3;
+    const float ix = grid_sampler_unnormalize<align_corners>(to_float(g[0]), W_in);
+    const float iy = grid_sampler_unnormalize<align_corners>(to_float(g[1]), H_in);
+    const float iz = grid_sampler_unnormalize<align_corners>(to_float(g[2]), D_in);
+    const size_t at[3] = {w, h, d};
+    const size_t size[3] = {W_grid, H_grid, D_grid};
+    const size_t step[3] = {3, W_grid * 3, H_grid * W_grid * 3};
+    float rho2 = 0.f;
+    for (int a = 0; a < 3; a++) {
+        if (size[a] < 2) {
+            continue;
+        }
+        const grid_t* q = at[a] + 1 < size[a] ? g + step[a] : g - step[a];
+        const float dx = grid_sampler_unnormalize<align_corners>(to_float(q[0]), W_in) - ix;
+        const float dy = grid_sampler_unnormalize<align_corners>(to_float(q[1]), H_in) - iy;
+        const float dz = grid_sampler_unnormalize<align_corners>(to_float(q[2]), D_in) - iz;
+        rho2 = fmaxf(rho2, dx * dx + dy * dy + dz * dz);
+    }
+    return rho2 > 1.f ? 0.5f * log2f(rho2) : 0.f;
+}
+
+// Taps of one Mipmap sample: the trilinear corners of one level, or of two neighbouring levels
+// blended by the fractional LOD. Offsets are within an (n, c) slice of the level, -1 when out of
+// bounds; the blend is folded into the weights.
+struct GridSample3DMipTaps {
+    int numLevels;
+    int level[2];
+    int32_t offset[2][8];
+    float weight[2][8];
+};
+
+// Taps of source index (ix, iy, iz) of level 0 (as returned by compute_index) at LOD `lod`.
+// Level l voxel i covers level 0 voxels [i * 2^l, (i + 1) * 2^l); Border/Reflection indices are
+// clipped to each level, Zeros drops the corners outside it.
+template <GridSample3DPaddingMode padding_mode>
+__host__ __device__ inline void grid_sample_3d_mip_taps(
+    const GridSample3DMipPyramid& pyramid,
+    float ix, float iy, float iz,
+    float lod,
+    GridSample3DMipTaps& taps
+) {
+    constexpr bool clipped = padding_mode != GridSample3DPaddingMode::Zeros;
+    lod = fminf(fmaxf(lod, 0.f), static_cast<float>(pyramid.levels - 1));
+    const int l0 = static_cast<int>(floorf(lod));
+    const float t = lod - l0;
+    taps.numLevels = t > 0.f ? 2 : 1;
+    for (int j = 0; j < taps.numLevels; j++) {
+        const int l = l0 + j;
+        const float blend = j == 0 ? 1.f - t : t;
+        const int D = pyramid.D[l], H = pyramid.H[l], W = pyramid.W[l];
+        const float scale = 1.f / static_cast<float>(1 << l);
+        float x = l == 0 ? ix : (ix + 0.5f) * scale - 0.5f;
+        float y = l == 0 ? iy : (iy + 0.5f) * scale - 0.5f;
+        float z = l == 0 ? iz : (iz + 0.5f) * scale - 0.5f;
+        if (clipped) {
+            x = fminf(fmaxf(x, 0.f), static_cast<float>(W - 1));
+            y = fminf(fmaxf(y, 0.f), static_cast<float>(H - 1));
+            z = fminf(fmaxf(z, 0.f), static_cast<float>(D - 1));
+        }
+        const int x0 = static_cast<int>(floorf(x));
+        const int y0 = static_cast<int>(floorf(y));
+        const int z0 = static_cast<int>(floorf(z));
+        // same corner order and weight products as the bilinear taps
+        const float wx[2] = {static_cast<float>(x0 + 1) - x, x - x0};
+        const float wy[2] = {static_cast<float>(y0 + 1) - y, y - y0};
+        const float wz[2] = {static_cast<float>(z0 + 1) - z, z - z0};
+        taps.level[j] = l;
+        int k = 0;
+        for (int dz = 1; dz >= 0; dz--) {
+            for (int dy = 1; dy >= 0; dy--) {
+                for (int dx = 1; dx >= 0; dx--, k++) {
+                    const int cx = x0 + dx, cy = y0 + dy, cz = z0 + dz;
+                    const bool inside = cx >= 0 && cx < W && cy >= 0 && cy < H && cz >= 0 && cz < D;
+                    taps.offset[j][k] = inside ? (cz * H + cy) * W + cx : -1;
+                    taps.weight[j][k] = inside ? wx[dx] * wy[dy] * wz[dz] * blend : 0.f;
+                }
+            }
+        }
+    }
+}
+
+// Sample of the (n, c) slice `slice` = n * C + c: level 0 is read from `input_NC`, the other
+// levels from `levels`, the pyramid of GridSample3DMipPyramid.
+template <typename input_t>
+__host__ __device__ inline float grid_sample_3d_mip_gather(
+    const GridSample3DMipTaps& taps,
+    const GridSample3DMipPyramid& pyramid,
+    const input_t* input_NC,
+    const float* levels,
+    size_t slice
+) {
+    float value = 0.f;
+    for (int j = 0; j < taps.numLevels; j++) {
+        const int l = taps.level[j];
+        const float* level_NC = l == 0 ? nullptr : levels + pyramid.offset[l] + slice * pyramid.sliceVoxels(l);
+        for (int k = 0; k < 8; k++) {
+            const int32_t offset = taps.offset[j][k];
+            if (offset >= 0) {
+                const float v = l == 0 ? to_float(input_NC[offset]) : level_NC[offset];
+                value = fmaf(v, taps.weight[j][k], value);
+            }
+        }
+    }
+    return value;
+}
+
+// Compile-time set of sampling modes, see grid_sample_3d_dispatch_modes.
+template <GridSample3DInterpolationMode interpolation_mode, GridSample3DPaddingMode padding_mode, bool align>
+struct GridSample3DModes {
+    static constexpr GridSample3DInterpolationMode interpolation = interpolation_mode;
+    static constexpr GridSample3DPaddingMode padding = padding_mode;
+    static constexpr bool align_corners = align;
+};
+
+template <GridSample3DInterpolationMode interpolation, GridSample3DPaddingMode padding, typename Fn>
+inline auto grid_sample_3d_dispatch_align(bool align_corners, Fn&& fn) {
+    return align_corners ? fn(GridSample3DModes<interpolation, padding, true>{})
+                         : fn(GridSample3DModes<interpolation, padding, false>{});
+}
+
+template <GridSample3DInterpolationMode interpolation, typename Fn>
+inline auto grid_sample_3d_dispatch_padding(GridSample3DPaddingMode padding, bool align_corners, Fn&& fn) {
+    switch (padding) {
+    case GridSample3DPaddingMode::Border:
+        return grid_sample_3d_dispatch_align<interpolation, GridSample3DPaddingMode::Border>(align_corners, fn);
+    case GridSample3DPaddingMode::Reflection:
+        return grid_sample_3d_dispatch_align<interpolation, GridSample3DPaddingMode::Reflection>(align_corners, fn);
+    default:
+        return grid_sample_3d_dispatch_align<interpolation, GridSample3DPaddingMode::Zeros>(align_corners, fn);
+    }
+}
+
+// Calls fn(GridSample3DModes<...>{}) with the runtime modes turned into compile-time constants,
+// so the caller picks one specialization up front instead of branching per voxel.
+// The interpolation mode must be valid (Bilinear or Nearest).
+template <typename Fn>
+inline auto grid_sample_3d_dispatch_modes(
+    GridSample3DInterpolationMode interpolation,
+    GridSample3DPaddingMode padding,
+    bool align_corners,
+    Fn&& fn
+) {
+    if (interpolation == GridSample3DInterpolationMode::Nearest) {
+        return grid_sample_3d_dispatch_padding<GridSample3DInterpolationMode::Nearest>(padding, align_corners, fn);
+    }
+    return grid_sample_3d_dispatch_padding<GridSample3DInterpolationMode::Bilinear>(padding, align_corners, fn);
+}
@@ -1,25 +1,674 @@
+#include <limits.h>
+#include <stdint.h>
+#include <functional>
 #include <string>
+#include <vector>
 
 #include <cuda_runtime.h>
 
 #ifndef GRID_SAMPLE_3D_H
 #define GRID_SAMPLE_3D_H
 
-enum class GridSample3DInterpolationMode{ Bilinear, Nearest};
+// Mipmap samples a mip pyramid of the input (2x box filter per level) trilinearly, in the level
+// or between the two levels matching the local footprint of the grid: anti-aliased downsampling.
+enum class GridSample3DInterpolationMode{ Bilinear, Nearest, Mipmap};
 enum class GridSample3DPaddingMode{ Zeros, Border, Reflection};
-enum class GridSample3DDataType {GFLOAT, GHALF};
+enum class GridSample3DDataType {GFLOAT, GHALF, GBF16, GINT8, GUINT8, GINT32};
+// Memory layout of input and output; the grid is always N x D x H x W x 3.
+// NDHWC8 is TensorRT's kDHWC8: channels-last with C padded to a multiple of 8.
+enum class GridSample3DLayout { NCDHW, NDHWC, NDHWC8 };
 
-template <typename scalar_t>
+// What the grid holds: absolute normalized coordinates (F.grid_sample), or a displacement added to
+// the identity coordinate of each output voxel, in input voxels or in normalized [-1, 1] units.
+enum class GridSample3DGridKind { Absolute, DisplacementVoxels, DisplacementNormalized };
+
+// Affine quantization of an int8/uint8 tensor: real = scale * (q - zeroPoint). The per-channel
+// arrays (C values each) replace the per-tensor values when set; they live in device memory for
+// the CUDA entry points and in host memory for the CPU ones.
+struct GridSample3DQuantization {
+    float scale = 1.f;
+    int32_t zeroPoint = 0;
+    const float* channelScale = nullptr;
+    const int32_t* channelZeroPoint = nullptr;
+};
+
+// Order in which the output voxels are visited. Tiled walks the output in small 3D bricks so the
+// corner gathers of neighbouring rows and slices hit the same cache lines; Morton also visits the
+// bricks along a Z-order curve, so bricks processed together are close in all three axes.
+enum class GridSample3DTraversal { Linear, Tiled, Morton };
+
+// Bucketed sampling for incoherent grids (random access, jittered point sets): the output voxels
+// are counting-sorted by the input block their source falls in, sampled bucket by bucket so each
+// block stays in cache, and the results scattered back to output order. Auto buckets on the GPU
+// only when a sample of neighbouring output voxels jumps across the input, and keeps output order
+// on the CPU. Results match output order exactly.
+enum class GridSample3DBucketing { Off, On, Auto };
+
+// Launch configuration of one sampling call. The CUDA kernels use blockSize, voxelsPerThread and
+// channelsPerThread; the CPU backend uses tileVoxels and numThreads. The defaults are the
+// untuned configuration; grid_sample_3d_cuda_autotune / grid_sample_3d_cpu_autotune pick the
+// fastest of grid_sample_3d_tactic_candidates, and the plugin serializes the winner with the engine.
+struct GridSample3DTactic {
+    int32_t blockSize = 128;        // CUDA threads per block
+    int32_t voxelsPerThread = 1;    // output voxels per CUDA thread (grid-stride loop)
+    int32_t channelsPerThread = 0;  // NCDHW channels per CUDA thread, one slice per gridDim.y; 0 = all
+    int32_t tileVoxels = 256;       // CPU voxels per run whose taps are computed together
+    int32_t numThreads = 0;         // CPU pool threads used, 0 = all
+    GridSample3DTraversal traversal = GridSample3DTraversal::Linear;  // both backends
+    GridSample3DBucketing bucketing = GridSample3DBucketing::Off;     // both backends, CUDA needs a workspace
+    bool tileBounds = false;        // bounds prepass per output tile, both backends, CUDA needs a workspace
+
+    bool operator==(const GridSample3DTactic& other) const {
+        return blockSize == other.blockSize && voxelsPerThread == other.voxelsPerThread &&
+               channelsPerThread == other.channelsPerThread && tileVoxels == other.tileVoxels &&
+               numThreads == other.numThreads && traversal == other.traversal && bucketing == other.bucketing &&
+               tileBounds == other.tileBounds;
+    }
+};
+
+enum class GridSample3DBackend { CUDA, CPU };
+
+// distance between two voxels in a channels-last tensor
+inline size_t grid_sample_3d_channel_pitch(GridSample3DLayout layout, size_t C) {
+    return layout == GridSample3DLayout::NDHWC8 ? (C + 7) / 8 * 8 : C;
+}
+
+// scalar_t (input and output) is float, __half or __nv_bfloat16; grid_t is float or scalar_t.
+// Coordinates and weights are computed in fp32 whatever the storage types, so a float grid keeps
+// sub-voxel precision on large volumes while the volume itself stays 16-bit.
+// tactic.bucketing and tactic.tileBounds need `workspace`, grid_sample_3d_workspace_size bytes of
+// device memory; without one every entry point samples in output order with per-voxel bounds checks.
+// The optional `mask` (N x D_grid x H_grid x W_grid bytes, device memory) switches output voxels
+// off: where it is 0 every channel is written as zero without reading the grid or the input.
+template <typename scalar_t, typename grid_t>
 int grid_sample_3d_cuda(
     const scalar_t* input,
-    const scalar_t* grid,
+    const grid_t* grid,
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    size_t D_grid, size_t H_grid, size_t W_grid,
+    bool align_corners,
+    GridSample3DInterpolationMode interpolationMode,
+    GridSample3DPaddingMode paddingMode,
+    scalar_t* output,
+    cudaStream_t stream,
+    GridSample3DLayout layout = GridSample3DLayout::NCDHW,
+    GridSample3DGridKind gridKind = GridSample3DGridKind::Absolute,
+    const GridSample3DTactic& tactic = GridSample3DTactic(),
+    void* workspace = nullptr,
+    const uint8_t* mask = nullptr
+);
+
+// Launcher of the CUDA kernels specialized on one data type and one set of sampling modes,
+// buffers typed as selected. Pick it once with grid_sample_3d_cuda_select and reuse it per launch.
+typedef int (*GridSample3DCudaLauncher)(
+    const void* input,
+    const void* grid,
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    size_t D_grid, size_t H_grid, size_t W_grid,
+    void* output,
+    cudaStream_t stream,
+    GridSample3DLayout layout,
+    const GridSample3DTactic& tactic,
+    void* workspace,
+    const uint8_t* mask
+);
+
+// Returns nullptr for an unsupported combination, e.g. a grid that is neither fp32 nor of the input type.
+GridSample3DCudaLauncher grid_sample_3d_cuda_select(
+    GridSample3DDataType dataType,
+    GridSample3DDataType gridDataType,
+    GridSample3DInterpolationMode interpolationMode,
+    GridSample3DPaddingMode paddingMode,
+    bool align_corners,
+    GridSample3DGridKind gridKind = GridSample3DGridKind::Absolute
+);
+
+// Element strides of a view of an N x C x D x H x W tensor, as torch.Tensor.stride() reports
+// them: sliced, permuted and padded views are described without a copy. Strides are
+// non-negative; overlapping output strides are undefined behaviour.
+struct GridSample3DStrides {
+    size_t N, C, D, H, W;
+};
+
+// Element strides of an N x D x H x W x 3 grid view; XYZ steps from x to y to z, so a
+// permuted (N, 3, D, H, W) grid has XYZ = D * H * W and W = 1.
+struct GridSample3DGridStrides {
+    size_t N, D, H, W, XYZ;
+};
+
+inline GridSample3DStrides grid_sample_3d_contiguous_strides(size_t C, size_t D, size_t H, size_t W) {
+    return GridSample3DStrides{C * D * H * W, D * H * W, H * W, W, 1};
+}
+
+inline GridSample3DGridStrides grid_sample_3d_contiguous_grid_strides(size_t D, size_t H, size_t W) {
+    return GridSample3DGridStrides{D * H * W * 3, H * W * 3, W * 3, 3, 1};
+}
+
+// grid_sample_3d_cuda on strided views: channel slices and channels-last inputs are read, permuted
+// grids decoded and sub-regions of a larger output written in place. Absolute grids, Bilinear or
+// Nearest; the mask stays a contiguous N x D_grid x H_grid x W_grid tensor. Index math is 32-bit
+// when the span of every view fits, as for the contiguous entry point.
+template <typename scalar_t, typename grid_t>
+int grid_sample_3d_strided_cuda(
+    const scalar_t* input,
+    const GridSample3DStrides& inputStrides,
+    const grid_t* grid,
+    const GridSample3DGridStrides& gridStrides,
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    size_t D_grid, size_t H_grid, size_t W_grid,
+    bool align_corners,
+    GridSample3DInterpolationMode interpolationMode,
+    GridSample3DPaddingMode paddingMode,
+    scalar_t* output,
+    const GridSample3DStrides& outputStrides,
+    cudaStream_t stream,
+    const GridSample3DTactic& tactic = GridSample3DTactic(),
+    void* workspace = nullptr,
+    const uint8_t* mask = nullptr
+);
+
+// Fused F.affine_grid + grid_sample: the coordinates of the D_out x H_out x W_out output are
+// computed from theta (N x 3 x 4, row-major) per voxel instead of being read from a grid tensor.
+// align_corners applies to both the affine grid and the sampling, as when both calls share it.
+template <typename scalar_t, typename grid_t>
+int grid_sample_3d_affine_cuda(
+    const scalar_t* input,
+    const grid_t* theta,
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    size_t D_out, size_t H_out, size_t W_out,
+    bool align_corners,
+    GridSample3DInterpolationMode interpolationMode,
+    GridSample3DPaddingMode paddingMode,
+    scalar_t* output,
+    cudaStream_t stream,
+    GridSample3DLayout layout = GridSample3DLayout::NCDHW,
+    const GridSample3DTactic& tactic = GridSample3DTactic(),
+    void* workspace = nullptr,
+    const uint8_t* mask = nullptr
+);
+
+// Launchers of grid_sample_3d_affine_cuda; their `grid` argument is theta and D/H/W_grid the output size.
+GridSample3DCudaLauncher grid_sample_3d_affine_cuda_select(
+    GridSample3DDataType dataType,
+    GridSample3DDataType thetaDataType,
+    GridSample3DInterpolationMode interpolationMode,
+    GridSample3DPaddingMode paddingMode,
+    bool align_corners
+);
+
+// Quantized volume: the int8/uint8 input (q_t) is dequantized with inputQuantization and
+// interpolated in fp32; out_t is q_t (requantized with outputQuantization, rounding half to even
+// and saturating) or __half (outputQuantization unused). grid_t is float or __half.
+// NCDHW and NDHWC layouts only.
+template <typename q_t, typename out_t, typename grid_t>
+int grid_sample_3d_quantized_cuda(
+    const q_t* input,
+    const GridSample3DQuantization& inputQuantization,
+    const grid_t* grid,
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    size_t D_grid, size_t H_grid, size_t W_grid,
+    bool align_corners,
+    GridSample3DInterpolationMode interpolationMode,
+    GridSample3DPaddingMode paddingMode,
+    out_t* output,
+    const GridSample3DQuantization& outputQuantization,
+    cudaStream_t stream,
+    GridSample3DLayout layout = GridSample3DLayout::NCDHW,
+    GridSample3DGridKind gridKind = GridSample3DGridKind::Absolute,
+    const GridSample3DTactic& tactic = GridSample3DTactic(),
+    void* workspace = nullptr,
+    const uint8_t* mask = nullptr
+);
+
+typedef int (*GridSample3DQuantizedCudaLauncher)(
+    const void* input,
+    const GridSample3DQuantization& inputQuantization,
+    const void* grid,
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    size_t D_grid, size_t H_grid, size_t W_grid,
+    void* output,
+    const GridSample3DQuantization& outputQuantization,
+    cudaStream_t stream,
+    GridSample3DLayout layout,
+    const GridSample3DTactic& tactic,
+    void* workspace,
+    const uint8_t* mask
+);
+
+// dataType is GINT8 or GUINT8, outputDataType the same or GHALF, gridDataType GFLOAT or GHALF;
+// returns nullptr for any other combination.
+GridSample3DQuantizedCudaLauncher grid_sample_3d_quantized_cuda_select(
+    GridSample3DDataType dataType,
+    GridSample3DDataType outputDataType,
+    GridSample3DDataType gridDataType,
+    GridSample3DInterpolationMode interpolationMode,
+    GridSample3DPaddingMode paddingMode,
+    bool align_corners,
+    GridSample3DGridKind gridKind = GridSample3DGridKind::Absolute
+);
+
+// Label maps: nearest sampling of integer class IDs (label_t is int32_t, int8_t or uint8_t),
+// copied as is without any arithmetic; with Zeros padding out-of-bounds voxels get label 0.
+// grid_t is float or __half.
+template <typename label_t, typename grid_t>
+int grid_sample_3d_labels_cuda(
+    const label_t* input,
+    const grid_t* grid,
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    size_t D_grid, size_t H_grid, size_t W_grid,
+    bool align_corners,
+    GridSample3DPaddingMode paddingMode,
+    label_t* output,
+    cudaStream_t stream,
+    GridSample3DLayout layout = GridSample3DLayout::NCDHW,
+    GridSample3DGridKind gridKind = GridSample3DGridKind::Absolute,
+    const GridSample3DTactic& tactic = GridSample3DTactic(),
+    void* workspace = nullptr,
+    const uint8_t* mask = nullptr
+);
+
+// Launchers of grid_sample_3d_labels_cuda; dataType is GINT32, GINT8 or GUINT8.
+GridSample3DCudaLauncher grid_sample_3d_labels_cuda_select(
+    GridSample3DDataType dataType,
+    GridSample3DDataType gridDataType,
+    GridSample3DPaddingMode paddingMode,
+    bool align_corners,
+    GridSample3DGridKind gridKind = GridSample3DGridKind::Absolute
+);
+
+// Point-list queries (NeRF-style feature lookups, keypoint heads): `points` is N x P x 3 normalized
+// (x, y, z) and the input is NCDHW. NCP writes N x C x P, the NCDHW output of a 1 x 1 x P grid;
+// NPC writes N x P x C, the C channels of a point contiguous, from a kernel that computes the taps
+// of a tile of points once and then gathers (point, channel) pairs channel-fastest. NPC uses
+// tactic.blockSize only. The optional mask is N x P. grid_t is float or scalar_t.
+enum class GridSample3DPointLayout { NPC, NCP };
+
+template <typename scalar_t, typename grid_t>
+int grid_sample_3d_points_cuda(
+    const scalar_t* input,
+    const grid_t* points,
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    size_t P,
+    bool align_corners,
+    GridSample3DInterpolationMode interpolationMode,
+    GridSample3DPaddingMode paddingMode,
+    scalar_t* output,
+    cudaStream_t stream,
+    GridSample3DPointLayout pointLayout = GridSample3DPointLayout::NPC,
+    const GridSample3DTactic& tactic = GridSample3DTactic(),
+    void* workspace = nullptr,
+    const uint8_t* mask = nullptr
+);
+
+// Launchers of grid_sample_3d_points_cuda, called with the points as a 1 x 1 x P grid
+// (D_grid = H_grid = 1, W_grid = P) and the NCDHW layout.
+GridSample3DCudaLauncher grid_sample_3d_points_cuda_select(
+    GridSample3DDataType dataType,
+    GridSample3DDataType gridDataType,
+    GridSample3DInterpolationMode interpolationMode,
+    GridSample3DPaddingMode paddingMode,
+    bool align_corners,
+    GridSample3DPointLayout pointLayout
+);
+
+// Mipmap sampling (GridSample3DInterpolationMode::Mipmap, also reached through grid_sample_3d_cuda)
+// with an optional level of detail per output voxel: `lod` (N x D_grid x H_grid x W_grid fp32,
+// device memory) replaces the LOD derived from the grid Jacobian, 0 being the input and l its 2^l
+// times downsampled level. NCDHW layout and absolute grids only. The fp32 pyramid lives in
+// `workspace` (grid_sample_3d_mipmap_workspace_size bytes), or in stream-ordered memory allocated
+// per call without one.
+template <typename scalar_t, typename grid_t>
+int grid_sample_3d_mipmap_cuda(
+    const scalar_t* input,
+    const grid_t* grid,
+    const float* lod,
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    size_t D_grid, size_t H_grid, size_t W_grid,
+    bool align_corners,
+    GridSample3DPaddingMode paddingMode,
+    scalar_t* output,
+    cudaStream_t stream,
+    void* workspace = nullptr,
+    const uint8_t* mask = nullptr
+);
+
+// One item of a ragged batch: volumes of different sizes sampled by grids of different sizes in
+// one call. The items are packed channel-major: the input is C x V_in and the output C x G, with
+// each channel holding the items back to back, and the grid is G x 3. Offsets count voxels, so an
+// item's channel c starts at c * V_in + input_offset in the input and at c * G + grid_offset in
+// the output, and its grid at 3 * grid_offset. Eight int32 fields, so that a (B, 8) int32 tensor
+// is a table of B items; items are sorted by grid_offset and cover the grid without gaps or
+// overlaps, as grid_sample_3d_ragged_pack lays them out.
+struct GridSample3DRaggedItem {
+    int32_t D_in, H_in, W_in;
+    int32_t D_grid, H_grid, W_grid;
+    int32_t input_offset;
+    int32_t grid_offset;
+};
+
+// Sets the offsets of items packed back to back in order and returns V_in and G; false when a
+// packed tensor exceeds the int32 offsets.
+inline bool grid_sample_3d_ragged_pack(GridSample3DRaggedItem* items, size_t count, size_t& V_in, size_t& G) {
+    V_in = 0;
+    G = 0;
+    for (size_t i = 0; i < count; i++) {
+        items[i].input_offset = static_cast<int32_t>(V_in);
+        items[i].grid_offset = static_cast<int32_t>(G);
+        V_in += static_cast<size_t>(items[i].D_in) * items[i].H_in * items[i].W_in;
+        G += static_cast<size_t>(items[i].D_grid) * items[i].H_grid * items[i].W_grid;
+        if (V_in > static_cast<size_t>(INT32_MAX) || G > static_cast<size_t>(INT32_MAX)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Ragged batch in one launch: every output voxel finds its item in `items` (device memory,
+// numItems entries) and samples that item's volume with absolute coordinates. The kernel validates
+// the table first: items must lie inside the packed input and cover the grid in grid_offset order
+// without gaps or overlaps, else the whole output is zero-filled. V_in and G are at most
+// INT32_MAX. Uses tactic.blockSize only. grid_t is float or scalar_t.
+template <typename scalar_t, typename grid_t>
+int grid_sample_3d_ragged_cuda(
+    const scalar_t* input,
+    const grid_t* grid,
+    const GridSample3DRaggedItem* items,
+    size_t numItems, size_t C, size_t V_in, size_t G,
+    bool align_corners,
+    GridSample3DInterpolationMode interpolationMode,
+    GridSample3DPaddingMode paddingMode,
+    scalar_t* output,
+    cudaStream_t stream,
+    const GridSample3DTactic& tactic = GridSample3DTactic()
+);
+
+typedef int (*GridSample3DRaggedCudaLauncher)(
+    const void* input,
+    const void* grid,
+    const GridSample3DRaggedItem* items,
+    size_t numItems, size_t C, size_t V_in, size_t G,
+    void* output,
+    cudaStream_t stream,
+    const GridSample3DTactic& tactic
+);
+
+// Launchers of grid_sample_3d_ragged_cuda: float/half/bf16 volumes, Bilinear or Nearest; nullptr otherwise.
+GridSample3DRaggedCudaLauncher grid_sample_3d_ragged_cuda_select(
+    GridSample3DDataType dataType,
+    GridSample3DDataType gridDataType,
+    GridSample3DInterpolationMode interpolationMode,
+    GridSample3DPaddingMode paddingMode,
+    bool align_corners
+);
+
+// Host implementation with the same layout and semantics as grid_sample_3d_cuda; the mask is in host memory.
+// Runs on the process-wide CPU thread pool (GRID_SAMPLE_3D_NUM_THREADS, default: all cores).
+template <typename scalar_t, typename grid_t>
+int grid_sample_3d_cpu(
+    const scalar_t* input,
+    const grid_t* grid,
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    size_t D_grid, size_t H_grid, size_t W_grid,
+    bool align_corners,
+    GridSample3DInterpolationMode interpolationMode,
+    GridSample3DPaddingMode paddingMode,
+    scalar_t* output,
+    GridSample3DLayout layout = GridSample3DLayout::NCDHW,
+    GridSample3DGridKind gridKind = GridSample3DGridKind::Absolute,
+    const GridSample3DTactic& tactic = GridSample3DTactic(),
+    const uint8_t* mask = nullptr
+);
+
+// Host implementation of grid_sample_3d_strided_cuda. Runs of tileVoxels output voxels in linear
+// order; tactic.traversal and tactic.bucketing are not used. Taps are 32-bit offsets within an
+// (n, c) slice, so the spatial span of the input view must fit in INT32_MAX elements.
+template <typename scalar_t, typename grid_t>
+int grid_sample_3d_strided_cpu(
+    const scalar_t* input,
+    const GridSample3DStrides& inputStrides,
+    const grid_t* grid,
+    const GridSample3DGridStrides& gridStrides,
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    size_t D_grid, size_t H_grid, size_t W_grid,
+    bool align_corners,
+    GridSample3DInterpolationMode interpolationMode,
+    GridSample3DPaddingMode paddingMode,
+    scalar_t* output,
+    const GridSample3DStrides& outputStrides,
+    const GridSample3DTactic& tactic = GridSample3DTactic(),
+    const uint8_t* mask = nullptr
+);
+
+// Host implementation of grid_sample_3d_mipmap_cuda; `lod` is in host memory.
+template <typename scalar_t, typename grid_t>
+int grid_sample_3d_mipmap_cpu(
+    const scalar_t* input,
+    const grid_t* grid,
+    const float* lod,
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    size_t D_grid, size_t H_grid, size_t W_grid,
+    bool align_corners,
+    GridSample3DPaddingMode paddingMode,
+    scalar_t* output,
+    const GridSample3DTactic& tactic = GridSample3DTactic(),
+    const uint8_t* mask = nullptr
+);
+
+// Host implementation of grid_sample_3d_points_cuda.
+template <typename scalar_t, typename grid_t>
+int grid_sample_3d_points_cpu(
+    const scalar_t* input,
+    const grid_t* points,
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    size_t P,
+    bool align_corners,
+    GridSample3DInterpolationMode interpolationMode,
+    GridSample3DPaddingMode paddingMode,
+    scalar_t* output,
+    GridSample3DPointLayout pointLayout = GridSample3DPointLayout::NPC,
+    const GridSample3DTactic& tactic = GridSample3DTactic(),
+    const uint8_t* mask = nullptr
+);
+
+// Host implementation of grid_sample_3d_ragged_cuda, `items` in host memory: one parallel region
+// over runs of every item's output voxels. Returns 1 for a malformed table (see
+// grid_sample_3d_ragged_item_valid) or V_in or G beyond INT32_MAX.
+template <typename scalar_t, typename grid_t>
+int grid_sample_3d_ragged_cpu(
+    const scalar_t* input,
+    const grid_t* grid,
+    const GridSample3DRaggedItem* items,
+    size_t numItems, size_t C, size_t V_in, size_t G,
+    bool align_corners,
+    GridSample3DInterpolationMode interpolationMode,
+    GridSample3DPaddingMode paddingMode,
+    scalar_t* output,
+    const GridSample3DTactic& tactic = GridSample3DTactic()
+);
+
+// Host implementation of grid_sample_3d_affine_cuda.
+template <typename scalar_t, typename grid_t>
+int grid_sample_3d_affine_cpu(
+    const scalar_t* input,
+    const grid_t* theta,
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    size_t D_out, size_t H_out, size_t W_out,
+    bool align_corners,
+    GridSample3DInterpolationMode interpolationMode,
+    GridSample3DPaddingMode paddingMode,
+    scalar_t* output,
+    GridSample3DLayout layout = GridSample3DLayout::NCDHW,
+    const GridSample3DTactic& tactic = GridSample3DTactic(),
+    const uint8_t* mask = nullptr
+);
+
+// Host implementation of grid_sample_3d_quantized_cuda.
+template <typename q_t, typename out_t, typename grid_t>
+int grid_sample_3d_quantized_cpu(
+    const q_t* input,
+    const GridSample3DQuantization& inputQuantization,
+    const grid_t* grid,
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    size_t D_grid, size_t H_grid, size_t W_grid,
+    bool align_corners,
+    GridSample3DInterpolationMode interpolationMode,
+    GridSample3DPaddingMode paddingMode,
+    out_t* output,
+    const GridSample3DQuantization& outputQuantization,
+    GridSample3DLayout layout = GridSample3DLayout::NCDHW,
+    GridSample3DGridKind gridKind = GridSample3DGridKind::Absolute,
+    const GridSample3DTactic& tactic = GridSample3DTactic(),
+    const uint8_t* mask = nullptr
+);
+
+// Host implementation of grid_sample_3d_labels_cuda.
+template <typename label_t, typename grid_t>
+int grid_sample_3d_labels_cpu(
+    const label_t* input,
+    const grid_t* grid,
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    size_t D_grid, size_t H_grid, size_t W_grid,
+    bool align_corners,
+    GridSample3DPaddingMode paddingMode,
+    label_t* output,
+    GridSample3DLayout layout = GridSample3DLayout::NCDHW,
+    GridSample3DGridKind gridKind = GridSample3DGridKind::Absolute,
+    const GridSample3DTactic& tactic = GridSample3DTactic(),
+    const uint8_t* mask = nullptr
+);
+
+// Device workspace of a tactic for an N x D_grid x H_grid x W_grid output from a D_in x H_in x W_in
+// input: the bucket flag, offsets and sorted voxel order of bucketed sampling (GridSample3DBucketing),
+// and the tile classes of the bounds prepass. 0 when the tactic needs none.
+size_t grid_sample_3d_workspace_size(
+    const GridSample3DTactic& tactic,
+    size_t N, size_t D_in, size_t H_in, size_t W_in,
+    size_t D_grid, size_t H_grid, size_t W_grid
+);
+
+// Device workspace of Mipmap sampling: pyramid levels 1 and up of an N x C x D_in x H_in x W_in input, in fp32.
+size_t grid_sample_3d_mipmap_workspace_size(size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in);
+
+// Output tiles of the bounds prepass (tactic.tileBounds) by class, for a linear traversal.
+struct GridSample3DTileStats {
+    size_t outside = 0;     // zero-filled without reading the input
+    size_t inside = 0;      // sampled without bounds checks
+    size_t mixed = 0;
+};
+
+// Classifies the tiles of an absolute grid on the host, as the CUDA prepass does.
+template <typename grid_t>
+GridSample3DTileStats grid_sample_3d_tile_stats(
+    const grid_t* grid,
+    size_t N, size_t D_in, size_t H_in, size_t W_in,
+    size_t D_grid, size_t H_grid, size_t W_grid,
+    bool align_corners,
+    GridSample3DInterpolationMode interpolationMode,
+    GridSample3DPaddingMode paddingMode
+);
+
+// Tactics worth timing for an output of `voxels` voxels (N x D x H x W) and C channels; the
+// default tactic always comes first.
+std::vector<GridSample3DTactic> grid_sample_3d_tactic_candidates(GridSample3DBackend backend, size_t voxels, size_t C);
+
+// Applies TensorRT's 1-based tactic `id`, an index into the CUDA candidates for `voxels` and C, to
+// `tactic`, keeping its bucketing mode and bounds prepass. Id 0 (TensorRT's default) keeps `tactic`,
+// and so does any id when `sized` is false: a plugin restored from an engine never saw the shapes
+// the ids were listed for, so they would index a different list, and `tactic` already holds the
+// one timed while building. false for an id past the list.
+bool grid_sample_3d_apply_tactic_id(int32_t id, bool sized, size_t voxels, size_t C, GridSample3DTactic& tactic);
+
+// Runs measure(tactic) `repeats` times per candidate (milliseconds, negative on failure) and returns
+// the candidate with the lowest median; the first candidate when every measurement fails.
+GridSample3DTactic grid_sample_3d_pick_tactic(
+    const std::vector<GridSample3DTactic>& candidates,
+    const std::function<float(const GridSample3DTactic&)>& measure,
+    int repeats = 5
+);
+
+// Times every CUDA candidate with `launcher` on the given buffers (overwriting output) and
+// returns the fastest; the launch arguments are those of GridSample3DCudaLauncher.
+GridSample3DTactic grid_sample_3d_cuda_autotune(
+    GridSample3DCudaLauncher launcher,
+    const void* input,
+    const void* grid,
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    size_t D_grid, size_t H_grid, size_t W_grid,
+    void* output,
+    cudaStream_t stream,
+    GridSample3DLayout layout = GridSample3DLayout::NCDHW
+);
+
+// Same for grid_sample_3d_cpu.
+template <typename scalar_t, typename grid_t>
+GridSample3DTactic grid_sample_3d_cpu_autotune(
+    const scalar_t* input,
+    const grid_t* grid,
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    size_t D_grid, size_t H_grid, size_t W_grid,
+    bool align_corners,
+    GridSample3DInterpolationMode interpolationMode,
+    GridSample3DPaddingMode paddingMode,
+    scalar_t* output,
+    GridSample3DLayout layout = GridSample3DLayout::NCDHW,
+    GridSample3DGridKind gridKind = GridSample3DGridKind::Absolute
+);
+
+// Sampling plan of a static grid: the gather offsets and weights of every output voxel are
+// computed once by grid_sample_3d_plan_create, then grid_sample_3d_plan_apply only streams
+// the input. Host-side; apply gives bit-identical results to grid_sample_3d_cpu.
+struct GridSample3DPlan;
+
+// Returns nullptr for an unsupported configuration.
+template <typename grid_t>
+GridSample3DPlan* grid_sample_3d_plan_create(
+    const grid_t* grid,
+    size_t N, size_t D_in, size_t H_in, size_t W_in,
+    size_t D_grid, size_t H_grid, size_t W_grid,
+    bool align_corners,
+    GridSample3DInterpolationMode interpolationMode,
+    GridSample3DPaddingMode paddingMode
+);
+
+// N must match the plan's batch, or the plan must hold a single grid which is then applied to every item.
+template <typename scalar_t>
+int grid_sample_3d_plan_apply(
+    const GridSample3DPlan* plan,
+    const scalar_t* input,
+    size_t N, size_t C,
+    scalar_t* output
+);
+
+void grid_sample_3d_plan_destroy(GridSample3DPlan* plan);
+
+// Out-of-core variant of grid_sample_3d_cpu (NCDHW, absolute grid) for inputs larger than
+// memory. The input is read from the memory-mapped file `inputPath`: raw little-endian scalar_t
+// from byte `inputOffset` on (e.g. past an .npy header). The output is sampled in tiles of
+// consecutive depth slices of one batch item. Each tile is read from a slab holding only the input
+// depths its grid reaches, and the next slab is loaded while the current tile is sampled.
+// Tiles are grown while their slab (all C channels) fits in slabBytes, so at most two slabs are
+// resident. Returns 1 when a single output slice needs more, or on an I/O error.
+#define GRID_SAMPLE_3D_STREAM_SLAB_BYTES (size_t(256) << 20)
+
+struct GridSample3DStreamStats {
+    size_t tiles = 0;
+    size_t bytesRead = 0;     // slab bytes copied from the file, overlapping slabs counted again
+    size_t maxSlabBytes = 0;
+};
+
+template <typename scalar_t, typename grid_t>
+int grid_sample_3d_stream_cpu(
+    const char* inputPath,
+    size_t inputOffset,
+    const grid_t* grid,
     size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
     size_t D_grid, size_t H_grid, size_t W_grid,
     bool align_corners,
     GridSample3DInterpolationMode interpolationMode,
     GridSample3DPaddingMode paddingMode,
     scalar_t* output,
-    cudaStream_t stream
+    size_t slabBytes = GRID_SAMPLE_3D_STREAM_SLAB_BYTES,
+    GridSample3DStreamStats* stats = nullptr
 );
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,263 @@
+#include "grid_sample_3d_c_api.h"
+#include "grid_sample_3d.h"
+#include "grid_sample_3d.cuh"
+#include "grid_sample_3d_profile.h"
+
+#include <climits>
+#include <cstdarg>
+#include <cstdio>
+
+#include <cuda_bf16.h>
+#include <cuda_fp16.h>
+#include <cuda_runtime.h>
+
+using half = __half;
+using bfloat16 = __nv_bfloat16;
+
+namespace
+{
+    thread_local char last_error[512] = "";
+
+    // records and logs the reason of a failed call, returns `status`
+    int32_t fail(GridSample3DStatus status, const char* format, ...)
+#if defined(__GNUC__)
+        __attribute__((format(printf, 2, 3)))
+#endif
+        ;
+
+    int32_t fail(GridSample3DStatus status, const char* format, ...) {
+        va_list args;
+        va_start(args, format);
+        std::vsnprintf(last_error, sizeof(last_error), format, args);
+        va_end(args);
+        grid_sample_3d_log(GridSample3DLogSeverity::Error, "Error in grid_sample_3d_dlpack: %s", last_error);
+        return status;
+    }
+
+    // A 5-D DLPack tensor: its first element, extents and element strides.
+    struct View {
+        void* data;
+        size_t shape[5];
+        size_t strides[5];
+    };
+
+    bool make_view(const DLTensor& t, View& view) {
+        if (t.ndim != 5 || t.shape == nullptr) {
+            return false;
+        }
+        view.data = static_cast<char*>(t.data) + t.byte_offset;
+        size_t compact = 1;
+        for (int i = 4; i >= 0; i--) {
+            if (t.shape[i] < 0 || (t.strides != nullptr && t.strides[i] < 0)) {
+                return false;
+            }
+            view.shape[i] = static_cast<size_t>(t.shape[i]);
+            view.strides[i] = t.strides != nullptr ? static_cast<size_t>(t.strides[i]) : compact;
+            compact *= view.shape[i];
+        }
+        return true;
+    }
+
+    bool data_type(DLDataType dtype, GridSample3DDataType& type) {
+        if (dtype.lanes != 1) {
+            return false;
+        }
+        if (dtype.code == kDLFloat && dtype.bits == 32) {
+            type = GridSample3DDataType::GFLOAT;
+        } else if (dtype.code == kDLFloat && dtype.bits == 16) {
+            type = GridSample3DDataType::GHALF;
+        } else if (dtype.code == kDLBfloat && dtype.bits == 16) {
+            type = GridSample3DDataType::GBF16;
+        } else {
+            return false;
+        }
+        return true;
+    }
+
+    bool same_device(const DLDevice& a, const DLDevice& b) {
+        return a.device_type == b.device_type && a.device_id == b.device_id;
+    }
+
+    // One validated call.
+    struct Call {
+        View input, grid, output;
+        GridSample3DStrides inputStrides, outputStrides;
+        GridSample3DGridStrides gridStrides;
+        bool align_corners;
+        GridSample3DInterpolationMode interpolationMode;
+        GridSample3DPaddingMode paddingMode;
+        bool cuda;
+        cudaStream_t stream;
+    };
+
+    template <typename scalar_t, typename grid_t>
+    int sample(const Call& call) {
+        const size_t* in = call.input.shape;
+        const size_t* out = call.output.shape;
+        const scalar_t* input = static_cast<const scalar_t*>(call.input.data);
+        const grid_t* grid = static_cast<const grid_t*>(call.grid.data);
+        scalar_t* output = static_cast<scalar_t*>(call.output.data);
+        if (call.cuda) {
+            return grid_sample_3d_strided_cuda<scalar_t, grid_t>(input, call.inputStrides, grid, call.gridStrides,
+                                                                 in[0], in[1], in[2], in[3], in[4], out[2], out[3], out[4],
+                                                                 call.align_corners, call.interpolationMode,
+                                                                 call.paddingMode, output, call.outputStrides,
+                                                                 call.stream);
+        }
+        return grid_sample_3d_strided_cpu<scalar_t, grid_t>(input, call.inputStrides, grid, call.gridStrides,
+                                                            in[0], in[1], in[2], in[3], in[4], out[2], out[3], out[4],
+                                                            call.align_corners, call.interpolationMode,
+                                                            call.paddingMode, output, call.outputStrides);
+    }
+
+    // the type pairs of the strided entry points; -1 for any other
+    int dispatch(GridSample3DDataType dataType, GridSample3DDataType gridDataType, const Call& call) {
+        const bool float_grid = gridDataType == GridSample3DDataType::GFLOAT;
+        const bool same_grid = gridDataType == dataType;
+        switch (dataType) {
+            case GridSample3DDataType::GFLOAT:
+                return sample<float, float>(call);
+            case GridSample3DDataType::GHALF:
+                return float_grid ? sample<half, float>(call) : same_grid ? sample<half, half>(call) : -1;
+            case GridSample3DDataType::GBF16:
+                return float_grid ? sample<bfloat16, float>(call) : same_grid ? sample<bfloat16, bfloat16>(call) : -1;
+            default:
+                return -1;
+        }
+    }
+
+    // makes `device` current for the lifetime of the guard
+    struct DeviceGuard {
+        int previous = -1;
+
+        bool enter(int device) {
+            if (cudaGetDevice(&previous) != cudaSuccess) {
+                return false;
+            }
+            return previous == device || cudaSetDevice(device) == cudaSuccess;
+        }
+
+        ~DeviceGuard() {
+            int current = -1;
+            if (previous >= 0 && cudaGetDevice(&current) == cudaSuccess && current != previous) {
+                cudaSetDevice(previous);
+            }
+        }
+    };
+} // namespace
+
+int32_t grid_sample_3d_c_api_version(void) {
+    return GRID_SAMPLE_3D_C_API_VERSION;
+}
+
+const char* grid_sample_3d_last_error(void) {
+    return last_error;
+}
+
+int32_t grid_sample_3d_dlpack(
+    const DLManagedTensor* input,
+    const DLManagedTensor* grid,
+    DLManagedTensor* output,
+    int32_t interpolationMode,
+    int32_t paddingMode,
+    int32_t alignCorners,
+    void* stream
+) {
+    last_error[0] = '\0';
+    if (input == nullptr || grid == nullptr || output == nullptr) {
+        return fail(GRID_SAMPLE_3D_STATUS_INVALID_ARGUMENT, "input, grid and output must not be NULL");
+    }
+    const DLTensor& in = input->dl_tensor;
+    const DLTensor& g = grid->dl_tensor;
+    const DLTensor& out = output->dl_tensor;
+
+    Call call;
+    if (!make_view(in, call.input) || !make_view(g, call.grid) || !make_view(out, call.output)) {
+        return fail(GRID_SAMPLE_3D_STATUS_INVALID_ARGUMENT, "tensors must be 5-D with non-negative strides");
+    }
+    const size_t* is = call.input.shape;
+    const size_t* gs = call.grid.shape;
+    const size_t* os = call.output.shape;
+    if (gs[4] != 3 || gs[0] != is[0] || os[0] != is[0] || os[1] != is[1] || os[2] != gs[1] || os[3] != gs[2] ||
+        os[4] != gs[3]) {
+        return fail(GRID_SAMPLE_3D_STATUS_INVALID_ARGUMENT,
+                    "shapes must be input (N, C, D, H, W), grid (N, D', H', W', 3) and output (N, C, D', H', W')");
+    }
+
+    GridSample3DDataType dataType, gridDataType, outputDataType;
+    if (!data_type(in.dtype, dataType) || !data_type(g.dtype, gridDataType) || !data_type(out.dtype, outputDataType)) {
+        return fail(GRID_SAMPLE_3D_STATUS_UNSUPPORTED, "dtypes must be float32, float16 or bfloat16");
+    }
+    if (outputDataType != dataType) {
+        return fail(GRID_SAMPLE_3D_STATUS_INVALID_ARGUMENT, "output dtype must match the input dtype");
+    }
+
+    if (interpolationMode != GRID_SAMPLE_3D_INTERPOLATION_BILINEAR &&
+        interpolationMode != GRID_SAMPLE_3D_INTERPOLATION_NEAREST) {
+        return fail(GRID_SAMPLE_3D_STATUS_UNSUPPORTED, "interpolation mode %d", interpolationMode);
+    }
+    if (paddingMode < GRID_SAMPLE_3D_PADDING_ZEROS || paddingMode > GRID_SAMPLE_3D_PADDING_REFLECTION) {
+        return fail(GRID_SAMPLE_3D_STATUS_INVALID_ARGUMENT, "padding mode %d", paddingMode);
+    }
+    call.interpolationMode = static_cast<GridSample3DInterpolationMode>(interpolationMode);
+    call.paddingMode = static_cast<GridSample3DPaddingMode>(paddingMode);
+    call.align_corners = alignCorners != 0;
+
+    const size_t* ist = call.input.strides;
+    const size_t* gst = call.grid.strides;
+    const size_t* ost = call.output.strides;
+    call.inputStrides = GridSample3DStrides{ist[0], ist[1], ist[2], ist[3], ist[4]};
+    call.gridStrides = GridSample3DGridStrides{gst[0], gst[1], gst[2], gst[3], gst[4]};
+    call.outputStrides = GridSample3DStrides{ost[0], ost[1], ost[2], ost[3], ost[4]};
+    call.stream = static_cast<cudaStream_t>(stream);
+
+    if (!same_device(in.device, g.device) || !same_device(in.device, out.device)) {
+        return fail(GRID_SAMPLE_3D_STATUS_INVALID_ARGUMENT, "input, grid and output must be on one device");
+    }
+    switch (in.device.device_type) {
+        case kDLCPU:
+        case kDLCUDAHost:
+            call.cuda = false;
+            // tap offsets of the CPU backend are 32-bit within one (n, c) slice
+            if (grid_sample_3d_strided_span(1, 1, is[2], is[3], is[4], call.inputStrides) >
+                static_cast<size_t>(INT32_MAX)) {
+                return fail(GRID_SAMPLE_3D_STATUS_UNSUPPORTED, "an input channel spans more than 2^31 elements");
+            }
+            break;
+        case kDLCUDA:
+        case kDLCUDAManaged:
+            call.cuda = true;
+            break;
+        default:
+            return fail(GRID_SAMPLE_3D_STATUS_UNSUPPORTED, "device type %d", static_cast<int>(in.device.device_type));
+    }
+
+    if (!call.cuda) {
+        const int status = dispatch(dataType, gridDataType, call);
+        if (status < 0) {
+            return fail(GRID_SAMPLE_3D_STATUS_UNSUPPORTED, "the grid dtype must be float32 or the input dtype");
+        }
+        return status == 0 ? GRID_SAMPLE_3D_STATUS_OK : fail(GRID_SAMPLE_3D_STATUS_FAILURE, "CPU sampling failed");
+    }
+
+    DeviceGuard guard;
+    if (!guard.enter(in.device.device_id)) {
+        return fail(GRID_SAMPLE_3D_STATUS_FAILURE, "cannot make CUDA device %d current", in.device.device_id);
+    }
+    const size_t grid_element = gridDataType == GridSample3DDataType::GFLOAT ? 4 : 2;
+    const size_t element = dataType == GridSample3DDataType::GFLOAT ? 4 : 2;
+    GridSample3DProfileScope profile("grid_sample_3d_dlpack",
+                                     GridSample3DProfileShape{is[0], is[1], is[2], is[3], is[4], os[2], os[3], os[4]},
+                                     (is[0] * is[1] * is[2] * is[3] * is[4]) * element +
+                                         (gs[0] * gs[1] * gs[2] * gs[3] * 3) * grid_element,
+                                     (os[0] * os[1] * os[2] * os[3] * os[4]) * element, call.stream);
+    const int status = dispatch(dataType, gridDataType, call);
+    if (status < 0) {
+        profile.finish(1);
+        return fail(GRID_SAMPLE_3D_STATUS_UNSUPPORTED, "the grid dtype must be float32 or the input dtype");
+    }
+    if (profile.finish(status) != 0) {
+        return fail(GRID_SAMPLE_3D_STATUS_FAILURE, "CUDA sampling failed");
+    }
+    return GRID_SAMPLE_3D_STATUS_OK;
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <stdint.h>
+
+#include <dlpack/dlpack.h>
+
+// C ABI of the sampling kernels on DLPack tensors, for eager callers (Python through ctypes or a
+// framework's DLPack export, C/C++ services) without a TensorRT engine. The tensors are borrowed
+// for the duration of the call: their deleters are never called and nothing is copied. Strides
+// (in elements, NULL for a compact row-major tensor) and byte_offset are honored, so slices,
+// permuted grids and sub-regions of a larger output are sampled in place.
+//
+//   input   N x C x D_in x H_in x W_in     float32, float16 or bfloat16
+//   grid    N x D_out x H_out x W_out x 3  float32 or the input dtype; absolute (x, y, z) in [-1, 1]
+//   output  N x C x D_out x H_out x W_out  the input dtype
+//
+// All three tensors live on one device. kDLCPU and kDLCUDAHost tensors are sampled by the CPU
+// backend, kDLCUDA and kDLCUDAManaged tensors by the CUDA kernels, queued on `stream` (a
+// cudaStream_t, NULL for the default stream) of the tensors' device without synchronizing.
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// bumped when a declaration of this header changes incompatibly
+#define GRID_SAMPLE_3D_C_API_VERSION 1
+
+typedef enum {
+    GRID_SAMPLE_3D_STATUS_OK = 0,
+    GRID_SAMPLE_3D_STATUS_INVALID_ARGUMENT = 1,   // NULL tensor, mismatched shapes or devices
+    GRID_SAMPLE_3D_STATUS_UNSUPPORTED = 2,        // dtype, device, mode or stride combination
+    GRID_SAMPLE_3D_STATUS_FAILURE = 3             // the backend failed, e.g. a CUDA launch error
+} GridSample3DStatus;
+
+// Values of GridSample3DInterpolationMode and GridSample3DPaddingMode (grid_sample_3d.h).
+typedef enum {
+    GRID_SAMPLE_3D_INTERPOLATION_BILINEAR = 0,
+    GRID_SAMPLE_3D_INTERPOLATION_NEAREST = 1
+} GridSample3DCInterpolationMode;
+
+typedef enum {
+    GRID_SAMPLE_3D_PADDING_ZEROS = 0,
+    GRID_SAMPLE_3D_PADDING_BORDER = 1,
+    GRID_SAMPLE_3D_PADDING_REFLECTION = 2
+} GridSample3DCPaddingMode;
+
+int32_t grid_sample_3d_c_api_version(void);
+
+// F.grid_sample(input, grid, mode, padding_mode, align_corners) written into `output`.
+// Returns a GridSample3DStatus; the reason of a failure is logged through grid_sample_3d_log and
+// kept for grid_sample_3d_last_error.
+int32_t grid_sample_3d_dlpack(
+    const DLManagedTensor* input,
+    const DLManagedTensor* grid,
+    DLManagedTensor* output,
+    int32_t interpolationMode,
+    int32_t paddingMode,
+    int32_t alignCorners,
+    void* stream
+);
+
+// Message of the last failed call on this thread, "" when it succeeded.
+const char* grid_sample_3d_last_error(void);
+
+#ifdef __cplusplus
+}
+#endif
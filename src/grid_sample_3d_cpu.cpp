@@ -0,0 +1,1813 @@
+#include "grid_sample_3d.h"
+#include "grid_sample_3d.cuh"
+#include "grid_sample_3d_cpu.h"
+#include "grid_sample_3d_cpu_simd.h"
+#include "grid_sample_3d_profile.h"
+#include "grid_sample_3d_thread_pool.h"
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+
+using half = __half;
+using bfloat16 = __nv_bfloat16;
+
+namespace
+{
+    inline float fmadd(float a, float b, float c) {
+#if defined(__FMA__)
+        return std::fma(a, b, c);
+#else
+        return a * b + c;
+#endif
+    }
+} // namespace
+
+void grid_sample_3d_cpu_compute_taps(
+    const GridSample3DTapGeometry& g,
+    float x, float y, float z,
+    size_t i,
+    GridSample3DTaps& taps
+) {
+    grid_sample_3d_dispatch_modes(g.interpolationMode, g.paddingMode, g.align_corners, [&](auto modes) {
+        grid_sample_3d_cpu_compute_taps<decltype(modes)>(g, x, y, z, i, taps);
+    });
+}
+
+template <typename grid_t>
+void grid_sample_3d_cpu_compute_run_taps(
+    const GridSample3DTapGeometry& geometry,
+    const grid_t* grid,
+    size_t count,
+    GridSample3DTaps& taps
+) {
+    taps.resize(grid_sample_3d_num_taps(geometry.interpolationMode), count);
+    // one mode dispatch per run, the voxel loop runs the specialized tap math
+    grid_sample_3d_dispatch_modes(geometry.interpolationMode, geometry.paddingMode, geometry.align_corners,
+                                  [&](auto modes) {
+        for (size_t i = 0; i < count; i++) {
+            grid_sample_3d_cpu_compute_taps<decltype(modes)>(geometry,
+                                                             to_float(grid[3 * i]),
+                                                             to_float(grid[3 * i + 1]),
+                                                             to_float(grid[3 * i + 2]),
+                                                             i, taps);
+        }
+    });
+}
+
+namespace
+{
+    template <GridSample3DGridKind grid_kind, typename Modes, typename grid_t>
+    void compute_displacement_run_taps(
+        const GridSample3DTapGeometry& g,
+        const grid_t* grid,
+        size_t D_out, size_t H_out, size_t W_out,
+        size_t begin, size_t count,
+        GridSample3DTaps& taps
+    ) {
+        int w = static_cast<int>(begin % W_out);
+        int h = static_cast<int>((begin / W_out) % H_out);
+        int d = static_cast<int>(begin / (W_out * H_out));
+        for (size_t i = 0; i < count; i++) {
+            float ix = compute_index<grid_kind, Modes::padding, Modes::align_corners>(
+                to_float(grid[3 * i]), w, static_cast<int>(W_out), g.W_in);
+            float iy = compute_index<grid_kind, Modes::padding, Modes::align_corners>(
+                to_float(grid[3 * i + 1]), h, static_cast<int>(H_out), g.H_in);
+            float iz = compute_index<grid_kind, Modes::padding, Modes::align_corners>(
+                to_float(grid[3 * i + 2]), d, static_cast<int>(D_out), g.D_in);
+            grid_sample_3d_cpu_compute_taps_at<Modes>(g, ix, iy, iz, i, taps);
+            if (++w == static_cast<int>(W_out)) {
+                w = 0;
+                if (++h == static_cast<int>(H_out)) {
+                    h = 0;
+                    d++;
+                }
+            }
+        }
+    }
+} // namespace
+
+template <typename grid_t>
+void grid_sample_3d_cpu_compute_displacement_run_taps(
+    const GridSample3DTapGeometry& geometry,
+    GridSample3DGridKind gridKind,
+    const grid_t* grid,
+    size_t D_out, size_t H_out, size_t W_out,
+    size_t begin, size_t count,
+    GridSample3DTaps& taps
+) {
+    if (gridKind == GridSample3DGridKind::Absolute) {
+        grid_sample_3d_cpu_compute_run_taps(geometry, grid, count, taps);
+        return;
+    }
+    taps.resize(grid_sample_3d_num_taps(geometry.interpolationMode), count);
+    grid_sample_3d_dispatch_modes(geometry.interpolationMode, geometry.paddingMode, geometry.align_corners,
+                                  [&](auto modes) {
+        using Modes = decltype(modes);
+        if (gridKind == GridSample3DGridKind::DisplacementVoxels) {
+            compute_displacement_run_taps<GridSample3DGridKind::DisplacementVoxels, Modes>(
+                geometry, grid, D_out, H_out, W_out, begin, count, taps);
+        } else {
+            compute_displacement_run_taps<GridSample3DGridKind::DisplacementNormalized, Modes>(
+                geometry, grid, D_out, H_out, W_out, begin, count, taps);
+        }
+    });
+}
+
+void grid_sample_3d_cpu_compute_affine_run_taps(
+    const GridSample3DTapGeometry& geometry,
+    const float* theta,
+    size_t D_out, size_t H_out, size_t W_out,
+    size_t begin, size_t count,
+    GridSample3DTaps& taps
+) {
+    taps.resize(grid_sample_3d_num_taps(geometry.interpolationMode), count);
+    grid_sample_3d_dispatch_modes(geometry.interpolationMode, geometry.paddingMode, geometry.align_corners,
+                                  [&](auto modes) {
+        using Modes = decltype(modes);
+        size_t w = begin % W_out;
+        size_t h = (begin / W_out) % H_out;
+        size_t d = begin / (W_out * H_out);
+        for (size_t i = 0; i < count; i++) {
+            float x, y, z;
+            affine_grid_coords(theta,
+                               affine_grid_base<Modes::align_corners>(static_cast<int>(w), static_cast<int>(W_out)),
+                               affine_grid_base<Modes::align_corners>(static_cast<int>(h), static_cast<int>(H_out)),
+                               affine_grid_base<Modes::align_corners>(static_cast<int>(d), static_cast<int>(D_out)),
+                               x, y, z);
+            grid_sample_3d_cpu_compute_taps<Modes>(geometry, x, y, z, i, taps);
+            if (++w == W_out) {
+                w = 0;
+                if (++h == H_out) {
+                    h = 0;
+                    d++;
+                }
+            }
+        }
+    });
+}
+
+template <typename scalar_t>
+void grid_sample_3d_cpu_gather(
+    const GridSample3DTaps& taps,
+    const scalar_t* input,
+    scalar_t* output
+) {
+    const size_t count = taps.count;
+    for (size_t i = 0; i < count; i++) {
+        float value = 0.f;
+        for (int k = 0; k < taps.numTaps; k++) {
+            int32_t offset = taps.offsets[k * count + i];
+            if (offset >= 0) {
+                value = fmadd(to_float(input[offset]), taps.weights[k * count + i], value);
+            }
+        }
+        output[i] = from_float<scalar_t>(value);
+    }
+}
+
+namespace
+{
+    // resolved once: the vector gathers only run on a CPU with the ISA they were built for
+    bool simd_gathers() {
+        static const bool available = grid_sample_3d_cpu_simd_available();
+        return available;
+    }
+
+    // scalar fp32 gathers; `checked` = false drops the out-of-bounds tests when every tap is in bounds
+    template <bool checked>
+    void gather_float(const GridSample3DTaps& taps, const float* input, float* output) {
+        const size_t count = taps.count;
+        const int32_t* offsets = taps.offsets.data();
+        const float* weights = taps.weights.data();
+        for (size_t i = 0; i < count; i++) {
+            float value = 0.f;
+            for (int k = 0; k < taps.numTaps; k++) {
+                int32_t offset = offsets[k * count + i];
+                if (!checked || offset >= 0) {
+                    value = fmadd(input[offset], weights[k * count + i], value);
+                }
+            }
+            output[i] = value;
+        }
+    }
+
+    template <bool checked>
+    void gather_float_channels_last(const GridSample3DTaps& taps, const float* input, size_t C, size_t pitch,
+                                    float* output) {
+        const size_t count = taps.count;
+        const int32_t* offsets = taps.offsets.data();
+        const float* weights = taps.weights.data();
+        for (size_t i = 0; i < count; i++) {
+            float* output_i = output + i * pitch;
+            for (size_t c = 0; c < C; c++) {
+                float value = 0.f;
+                for (int k = 0; k < taps.numTaps; k++) {
+                    int32_t offset = offsets[k * count + i];
+                    if (!checked || offset >= 0) {
+                        value = fmadd(input[offset + c], weights[k * count + i], value);
+                    }
+                }
+                output_i[c] = value;
+            }
+            std::fill(output_i + C, output_i + pitch, 0.f);
+        }
+    }
+} // namespace
+
+template <>
+void grid_sample_3d_cpu_gather<float>(
+    const GridSample3DTaps& taps,
+    const float* input,
+    float* output
+) {
+    if (simd_gathers()) {
+        grid_sample_3d_cpu_simd_gather(taps.offsets.data(), taps.weights.data(), taps.numTaps, taps.count,
+                                       !taps.inside, input, output);
+    } else if (taps.inside) {
+        gather_float<false>(taps, input, output);
+    } else {
+        gather_float<true>(taps, input, output);
+    }
+}
+
+template <typename scalar_t>
+void grid_sample_3d_cpu_gather_channels_last(
+    const GridSample3DTaps& taps,
+    const scalar_t* input,
+    size_t C, size_t pitch,
+    scalar_t* output
+) {
+    const size_t count = taps.count;
+    for (size_t i = 0; i < count; i++) {
+        scalar_t* output_i = output + i * pitch;
+        for (size_t c = 0; c < C; c++) {
+            float value = 0.f;
+            for (int k = 0; k < taps.numTaps; k++) {
+                int32_t offset = taps.offsets[k * count + i];
+                if (offset >= 0) {
+                    value = fmadd(to_float(input[offset + c]), taps.weights[k * count + i], value);
+                }
+            }
+            output_i[c] = from_float<scalar_t>(value);
+        }
+        std::fill(output_i + C, output_i + pitch, from_float<scalar_t>(0.f));
+    }
+}
+
+template <>
+void grid_sample_3d_cpu_gather_channels_last<float>(
+    const GridSample3DTaps& taps,
+    const float* input,
+    size_t C, size_t pitch,
+    float* output
+) {
+    if (simd_gathers()) {
+        grid_sample_3d_cpu_simd_gather_channels_last(taps.offsets.data(), taps.weights.data(), taps.numTaps,
+                                                     taps.count, !taps.inside, input, C, pitch, output);
+    } else if (taps.inside) {
+        gather_float_channels_last<false>(taps, input, C, pitch, output);
+    } else {
+        gather_float_channels_last<true>(taps, input, C, pitch, output);
+    }
+}
+
+template <typename q_t, typename out_t>
+void grid_sample_3d_cpu_gather_quantized(
+    const GridSample3DTaps& taps,
+    const q_t* input,
+    const GridSample3DQuantization& inputQuantization,
+    const GridSample3DQuantization& outputQuantization,
+    size_t c,
+    out_t* output
+) {
+    const size_t count = taps.count;
+    for (size_t i = 0; i < count; i++) {
+        float value = 0.f;
+        for (int k = 0; k < taps.numTaps; k++) {
+            int32_t offset = taps.offsets[k * count + i];
+            if (offset >= 0) {
+                value = fmadd(dequantize_value(input[offset], inputQuantization, c), taps.weights[k * count + i], value);
+            }
+        }
+        output[i] = quantize_value<out_t>(value, outputQuantization, c);
+    }
+}
+
+template <typename q_t, typename out_t>
+void grid_sample_3d_cpu_gather_quantized_channels_last(
+    const GridSample3DTaps& taps,
+    const q_t* input,
+    const GridSample3DQuantization& inputQuantization,
+    const GridSample3DQuantization& outputQuantization,
+    size_t C, size_t pitch,
+    out_t* output
+) {
+    const size_t count = taps.count;
+    for (size_t i = 0; i < count; i++) {
+        out_t* output_i = output + i * pitch;
+        for (size_t c = 0; c < C; c++) {
+            float value = 0.f;
+            for (int k = 0; k < taps.numTaps; k++) {
+                int32_t offset = taps.offsets[k * count + i];
+                if (offset >= 0) {
+                    value = fmadd(dequantize_value(input[offset + c], inputQuantization, c),
+                                  taps.weights[k * count + i], value);
+                }
+            }
+            output_i[c] = quantize_value<out_t>(value, outputQuantization, c);
+        }
+    }
+}
+
+namespace
+{
+    // Gathers of sample_runs: one (n, c) slice of a run, or every channel of a channels-last run.
+    template <typename scalar_t>
+    struct ConvertGather {
+        void operator()(const GridSample3DTaps& taps, const scalar_t* input, size_t, scalar_t* output) const {
+            grid_sample_3d_cpu_gather<scalar_t>(taps, input, output);
+        }
+
+        void channelsLast(const GridSample3DTaps& taps, const scalar_t* input, size_t C, size_t pitch,
+                          scalar_t* output) const {
+            grid_sample_3d_cpu_gather_channels_last<scalar_t>(taps, input, C, pitch, output);
+        }
+    };
+
+    template <typename q_t, typename out_t>
+    struct DequantizeGather {
+        GridSample3DQuantization inputQuantization;
+        GridSample3DQuantization outputQuantization;
+
+        void operator()(const GridSample3DTaps& taps, const q_t* input, size_t c, out_t* output) const {
+            grid_sample_3d_cpu_gather_quantized(taps, input, inputQuantization, outputQuantization, c, output);
+        }
+
+        void channelsLast(const GridSample3DTaps& taps, const q_t* input, size_t C, size_t pitch, out_t* output) const {
+            grid_sample_3d_cpu_gather_quantized_channels_last(taps, input, inputQuantization, outputQuantization,
+                                                              C, pitch, output);
+        }
+    };
+
+    // Label maps: the single nearest tap is copied as is, 0 when out of bounds.
+    template <typename label_t>
+    struct LabelGather {
+        void operator()(const GridSample3DTaps& taps, const label_t* input, size_t, label_t* output) const {
+            const int32_t* offsets = taps.offsets.data();
+            for (size_t i = 0; i < taps.count; i++) {
+                output[i] = taps.numTaps > 0 && offsets[i] >= 0 ? input[offsets[i]] : label_t(0);
+            }
+        }
+
+        void channelsLast(const GridSample3DTaps& taps, const label_t* input, size_t C, size_t pitch,
+                          label_t* output) const {
+            const int32_t* offsets = taps.offsets.data();
+            for (size_t i = 0; i < taps.count; i++) {
+                label_t* output_i = output + i * pitch;
+                if (taps.numTaps > 0 && offsets[i] >= 0) {
+                    std::copy(input + offsets[i], input + offsets[i] + C, output_i);
+                } else {
+                    std::fill(output_i, output_i + C, label_t(0));
+                }
+                std::fill(output_i + C, output_i + pitch, label_t(0));
+            }
+        }
+    };
+
+    // Input voxel (x, y, z) of the first in-bounds tap of voxel i; false when every tap is out of bounds.
+    inline bool tap_voxel(const GridSample3DTapGeometry& g, const GridSample3DTaps& taps, size_t i,
+                          float& x, float& y, float& z) {
+        for (int k = 0; k < taps.numTaps; k++) {
+            const int32_t offset = taps.offsets[k * taps.count + i];
+            if (offset >= 0) {
+                // 32-bit divisions, the offsets of a slice fit
+                const int32_t stride_D = static_cast<int32_t>(g.stride_D);
+                const int32_t stride_H = static_cast<int32_t>(g.stride_H);
+                z = static_cast<float>(offset / stride_D);
+                y = static_cast<float>(offset % stride_D / stride_H);
+                x = static_cast<float>(offset % stride_H / static_cast<int32_t>(g.stride_W));
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Output mask of a run (one byte per voxel): voxels whose byte is 0 lose every tap, so the
+    // gathers write zeros for them without reading the input.
+    inline void mask_taps(GridSample3DTaps& taps, const uint8_t* mask) {
+        for (size_t i = 0; i < taps.count; i++) {
+            if (mask[i] != 0) {
+                continue;
+            }
+            for (int k = 0; k < taps.numTaps; k++) {
+                taps.offsets[k * taps.count + i] = -1;
+                taps.weights[k * taps.count + i] = 0.f;
+            }
+        }
+    }
+
+    // Shared driver of the host entry points: splits the output into runs and gathers every run
+    // with the taps from run_taps(geometry, n, begin, count, taps). Runs whose voxels are all
+    // masked out skip run_taps and only write zeros.
+    template <typename input_t, typename output_t, typename RunTaps, typename Gather>
+    int sample_runs(
+        const input_t* input,
+        size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+        size_t D_grid, size_t H_grid, size_t W_grid,
+        bool align_corners,
+        GridSample3DInterpolationMode interpolationMode,
+        GridSample3DPaddingMode paddingMode,
+        output_t* output,
+        GridSample3DLayout layout,
+        const GridSample3DTactic& tactic,
+        const uint8_t* mask,
+        RunTaps run_taps,
+        Gather gather
+    ) {
+        if (interpolationMode != GridSample3DInterpolationMode::Bilinear &&
+            interpolationMode != GridSample3DInterpolationMode::Nearest) {
+            return 1;
+        }
+        const bool channels_last = layout != GridSample3DLayout::NCDHW;
+        // channels-last voxels are `pitch` elements apart and the channels are contiguous
+        const size_t pitch = channels_last ? grid_sample_3d_channel_pitch(layout, C) : 1;
+
+        // tap offsets are 32-bit within one (n, c) slice, or one batch item when channels-last
+        if (D_in * H_in * W_in * pitch > static_cast<size_t>(INT32_MAX)) {
+            return 1;
+        }
+
+        const size_t input_stride_N = D_in * H_in * W_in * (channels_last ? pitch : C);
+        const size_t input_stride_C = channels_last ? 1 : D_in * H_in * W_in;
+        const size_t output_stride_N = D_grid * H_grid * W_grid * (channels_last ? pitch : C);
+        const size_t output_stride_C = channels_last ? 1 : D_grid * H_grid * W_grid;
+
+        const GridSample3DTapGeometry geometry{
+            static_cast<int>(D_in), static_cast<int>(H_in), static_cast<int>(W_in),
+            static_cast<int64_t>(H_in * W_in * pitch), static_cast<int64_t>(W_in * pitch), static_cast<int64_t>(pitch),
+            align_corners, interpolationMode, paddingMode};
+
+        // the contiguous grid/output let a run cross rows, so work is split over
+        // runs of the flattened N x D_grid x H_grid x W_grid voxels
+        const size_t spatial = D_grid * H_grid * W_grid;
+        const size_t run_length = tactic.tileVoxels > 0 ? tactic.tileVoxels : GRID_SAMPLE_3D_CPU_RUN;
+        const size_t runs_per_batch = (spatial + run_length - 1) / run_length;
+        const size_t runs = N * runs_per_batch;
+        // at most numThreads chunks, so at most numThreads pool threads take part
+        const size_t grain = tactic.numThreads > 0 ? (runs + tactic.numThreads - 1) / tactic.numThreads : 1;
+
+        // out-of-bounds taps are counted before any mask drops them
+        const bool profile = grid_sample_3d_profile_enabled();
+        auto compute_taps = [&](size_t n, size_t s_begin, size_t s_count, GridSample3DTaps& taps) {
+            run_taps(geometry, n, s_begin, s_count, taps);
+            if (profile) {
+                const size_t total = static_cast<size_t>(taps.numTaps) * taps.count;
+                grid_sample_3d_profile_add_taps(total, std::count(taps.offsets.begin(), taps.offsets.begin() + total, -1));
+            }
+        };
+
+        // taps and gathers of the s_count voxels from flattened voxel s_begin of batch item n
+        auto sample_run = [&](size_t n, size_t s_begin, size_t s_count, GridSample3DTaps& taps) {
+            const uint8_t* run_mask = mask != nullptr ? mask + n * spatial + s_begin : nullptr;
+            if (run_mask != nullptr && std::all_of(run_mask, run_mask + s_count, [](uint8_t m) { return m == 0; })) {
+                taps.resize(0, s_count);
+            } else {
+                compute_taps(n, s_begin, s_count, taps);
+                if (run_mask != nullptr) {
+                    mask_taps(taps, run_mask);
+                }
+                if (tactic.tileBounds) {
+                    grid_sample_3d_cpu_classify_taps(taps);
+                }
+            }
+
+            if (channels_last) {
+                gather.channelsLast(taps, input + n * input_stride_N, C, pitch,
+                                    output + n * output_stride_N + s_begin * pitch);
+                return;
+            }
+
+            const input_t* input_NC = input + n * input_stride_N;
+            output_t* output_NC = output + n * output_stride_N + s_begin;
+            for (size_t c = 0; c < C; c++) {
+                gather(taps, input_NC, c, output_NC);
+                input_NC += input_stride_C;
+                output_NC += output_stride_C;
+            }
+        };
+
+        // Auto keeps output order here: the host caches and out-of-order gathers already hide the
+        // incoherent reads that bucketing saves on the GPU (see bench_grid_sample --bucketed)
+        if (tactic.bucketing == GridSample3DBucketing::On && spatial > 1) {
+            // chunks of the output: compute the taps of every voxel and bucket it by the input block
+            // of its first in-bounds tap, counting-sort the voxels by bucket, then gather runs of the
+            // sorted voxels into a buffer and scatter the results back to their output positions
+            const GridSample3DBuckets buckets = grid_sample_3d_buckets(D_in, H_in, W_in);
+            const int num_taps = grid_sample_3d_num_taps(interpolationMode);
+            const size_t chunk = GRID_SAMPLE_3D_CPU_BUCKET_CHUNK;
+            const size_t chunks_per_batch = (spatial + chunk - 1) / chunk;
+            const size_t chunks = N * chunks_per_batch;
+            const size_t chunk_grain = tactic.numThreads > 0 ? (chunks + tactic.numThreads - 1) / tactic.numThreads : 1;
+            GridSample3DThreadPool::instance().parallelFor(chunks, chunk_grain, [&](size_t begin, size_t end) {
+                thread_local GridSample3DTaps tls_taps;
+                thread_local std::vector<int32_t> tls_chunk_offsets;
+                thread_local std::vector<float> tls_chunk_weights;
+                thread_local std::vector<uint32_t> tls_bucket, tls_order, tls_offsets;
+                thread_local std::vector<output_t> tls_values;
+                // bound once, thread_local accesses are not free inside the voxel loops
+                GridSample3DTaps& taps = tls_taps;
+                std::vector<int32_t>& chunk_offsets = tls_chunk_offsets;
+                std::vector<float>& chunk_weights = tls_chunk_weights;
+                std::vector<uint32_t>& bucket = tls_bucket;
+                std::vector<uint32_t>& order = tls_order;
+                std::vector<uint32_t>& offsets = tls_offsets;
+                std::vector<output_t>& values = tls_values;
+                for (size_t ch = begin; ch < end; ch++) {
+                    const size_t n = ch / chunks_per_batch;
+                    const size_t c_begin = (ch % chunks_per_batch) * chunk;
+                    const size_t c_count = std::min(chunk, spatial - c_begin);
+
+                    // taps of the chunk, voxel-major so a sorted voxel reads one contiguous record
+                    bucket.resize(c_count);
+                    chunk_offsets.resize(c_count * num_taps);
+                    chunk_weights.resize(c_count * num_taps);
+                    for (size_t r = 0; r < c_count; r += run_length) {
+                        const size_t r_count = std::min(run_length, c_count - r);
+                        compute_taps(n, c_begin + r, r_count, taps);
+                        if (mask != nullptr) {
+                            mask_taps(taps, mask + n * spatial + c_begin + r);
+                        }
+                        for (size_t i = 0; i < r_count; i++) {
+                            float x, y, z;
+                            bucket[r + i] = tap_voxel(geometry, taps, i, x, y, z)
+                                ? static_cast<uint32_t>(buckets.bucket(x, y, z)) : 0;
+                            for (int k = 0; k < num_taps; k++) {
+                                chunk_offsets[(r + i) * num_taps + k] = taps.offsets[k * r_count + i];
+                                chunk_weights[(r + i) * num_taps + k] = taps.weights[k * r_count + i];
+                            }
+                        }
+                    }
+                    offsets.assign(buckets.count() + 1, 0);
+                    for (size_t v = 0; v < c_count; v++) {
+                        offsets[bucket[v] + 1]++;
+                    }
+                    for (size_t b = 1; b < offsets.size(); b++) {
+                        offsets[b] += offsets[b - 1];
+                    }
+                    order.resize(c_count);
+                    for (size_t v = 0; v < c_count; v++) {
+                        order[offsets[bucket[v]]++] = static_cast<uint32_t>(v);
+                    }
+
+                    for (size_t r = 0; r < c_count; r += run_length) {
+                        const size_t r_count = std::min(run_length, c_count - r);
+                        const uint32_t* run_order = order.data() + r;
+                        taps.resize(num_taps, r_count);
+                        for (size_t i = 0; i < r_count; i++) {
+                            for (int k = 0; k < num_taps; k++) {
+                                taps.offsets[k * r_count + i] = chunk_offsets[run_order[i] * num_taps + k];
+                                taps.weights[k * r_count + i] = chunk_weights[run_order[i] * num_taps + k];
+                            }
+                        }
+
+                        if (channels_last) {
+                            values.resize(r_count * pitch);
+                            gather.channelsLast(taps, input + n * input_stride_N, C, pitch, values.data());
+                            output_t* output_N = output + (n * spatial + c_begin) * pitch;
+                            for (size_t i = 0; i < r_count; i++) {
+                                std::copy_n(values.data() + i * pitch, pitch, output_N + run_order[i] * pitch);
+                            }
+                            continue;
+                        }
+
+                        values.resize(r_count);
+                        const input_t* input_NC = input + n * input_stride_N;
+                        output_t* output_NC = output + n * output_stride_N + c_begin;
+                        for (size_t c = 0; c < C; c++) {
+                            gather(taps, input_NC, c, values.data());
+                            for (size_t i = 0; i < r_count; i++) {
+                                output_NC[run_order[i]] = values[i];
+                            }
+                            input_NC += input_stride_C;
+                            output_NC += output_stride_C;
+                        }
+                    }
+                }
+            });
+            return 0;
+        }
+
+        if (tactic.traversal != GridSample3DTraversal::Linear) {
+            // bricks of BRICK x BRICK rows of run_length voxels; a row is still a contiguous run
+            const GridSample3DBricks bricks = grid_sample_3d_bricks(tactic.traversal, D_grid, H_grid, W_grid,
+                                                                    GRID_SAMPLE_3D_CPU_BRICK, GRID_SAMPLE_3D_CPU_BRICK,
+                                                                    run_length);
+            const size_t num_bricks = N * bricks.per_batch;
+            const size_t brick_grain = tactic.numThreads > 0 ? (num_bricks + tactic.numThreads - 1) / tactic.numThreads : 1;
+            GridSample3DThreadPool::instance().parallelFor(num_bricks, brick_grain, [&](size_t begin, size_t end) {
+                thread_local GridSample3DTaps taps;
+                for (size_t b = begin; b < end; b++) {
+                    size_t n, d0, h0, w0;
+                    if (!bricks.origin(b, n, d0, h0, w0)) {
+                        continue;
+                    }
+                    const size_t d_end = std::min(d0 + bricks.bd, D_grid);
+                    const size_t h_end = std::min(h0 + bricks.bh, H_grid);
+                    const size_t w_count = std::min(bricks.bw, W_grid - w0);
+                    for (size_t d = d0; d < d_end; d++) {
+                        for (size_t h = h0; h < h_end; h++) {
+                            sample_run(n, (d * H_grid + h) * W_grid + w0, w_count, taps);
+                        }
+                    }
+                }
+            });
+            return 0;
+        }
+
+        GridSample3DThreadPool::instance().parallelFor(runs, grain, [&](size_t begin, size_t end) {
+            thread_local GridSample3DTaps taps;
+            for (size_t run = begin; run < end; run++) {
+                const size_t n = run / runs_per_batch;
+                const size_t s_begin = (run % runs_per_batch) * run_length;
+                sample_run(n, s_begin, std::min<size_t>(run_length, spatial - s_begin), taps);
+            }
+        });
+
+        return 0;
+    }
+
+    // Profile scope of one host call: the input and `gridBytes` of grid are read, the output written.
+    template <typename input_t, typename output_t>
+    GridSample3DProfileScope profile_call(
+        const char* name,
+        size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+        size_t D_grid, size_t H_grid, size_t W_grid,
+        size_t gridBytes
+    ) {
+        return GridSample3DProfileScope(name, GridSample3DProfileShape{N, C, D_in, H_in, W_in, D_grid, H_grid, W_grid},
+                                        N * C * D_in * H_in * W_in * sizeof(input_t) + gridBytes,
+                                        N * C * D_grid * H_grid * W_grid * sizeof(output_t));
+    }
+} // namespace
+
+template <typename scalar_t, typename grid_t>
+int grid_sample_3d_cpu(
+    const scalar_t* input,
+    const grid_t* grid,
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    size_t D_grid, size_t H_grid, size_t W_grid,
+    bool align_corners,
+    GridSample3DInterpolationMode interpolationMode,
+    GridSample3DPaddingMode paddingMode,
+    scalar_t* output,
+    GridSample3DLayout layout,
+    GridSample3DGridKind gridKind,
+    const GridSample3DTactic& tactic,
+    const uint8_t* mask
+) {
+    const size_t grid_stride_N = D_grid * H_grid * W_grid * 3;
+    GridSample3DProfileScope profile = profile_call<scalar_t, scalar_t>(
+        "grid_sample_3d_cpu", N, C, D_in, H_in, W_in, D_grid, H_grid, W_grid, N * grid_stride_N * sizeof(grid_t));
+    if (interpolationMode == GridSample3DInterpolationMode::Mipmap) {
+        if (layout != GridSample3DLayout::NCDHW || gridKind != GridSample3DGridKind::Absolute) {
+            return profile.finish(1);
+        }
+        return profile.finish(grid_sample_3d_mipmap_cpu(input, grid, nullptr, N, C, D_in, H_in, W_in, D_grid, H_grid,
+                                                        W_grid, align_corners, paddingMode, output, tactic, mask));
+    }
+    return profile.finish(sample_runs(input, N, C, D_in, H_in, W_in, D_grid, H_grid, W_grid,
+                                      align_corners, interpolationMode, paddingMode, output, layout, tactic, mask,
+                                      [&](const GridSample3DTapGeometry& geometry, size_t n, size_t begin, size_t count,
+                                          GridSample3DTaps& taps) {
+        grid_sample_3d_cpu_compute_displacement_run_taps(geometry, gridKind, grid + n * grid_stride_N + begin * 3,
+                                                         D_grid, H_grid, W_grid, begin, count, taps);
+    }, ConvertGather<scalar_t>{}));
+}
+
+template <typename scalar_t, typename grid_t>
+int grid_sample_3d_strided_cpu(
+    const scalar_t* input,
+    const GridSample3DStrides& inputStrides,
+    const grid_t* grid,
+    const GridSample3DGridStrides& gridStrides,
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    size_t D_grid, size_t H_grid, size_t W_grid,
+    bool align_corners,
+    GridSample3DInterpolationMode interpolationMode,
+    GridSample3DPaddingMode paddingMode,
+    scalar_t* output,
+    const GridSample3DStrides& outputStrides,
+    const GridSample3DTactic& tactic,
+    const uint8_t* mask
+) {
+    if (interpolationMode != GridSample3DInterpolationMode::Bilinear &&
+        interpolationMode != GridSample3DInterpolationMode::Nearest) {
+        return 1;
+    }
+    // tap offsets are 32-bit within one (n, c) slice of the input view
+    if (grid_sample_3d_strided_span(1, 1, D_in, H_in, W_in, inputStrides) > static_cast<size_t>(INT32_MAX)) {
+        return 1;
+    }
+    GridSample3DProfileScope profile = profile_call<scalar_t, scalar_t>(
+        "grid_sample_3d_strided_cpu", N, C, D_in, H_in, W_in, D_grid, H_grid, W_grid,
+        N * D_grid * H_grid * W_grid * 3 * sizeof(grid_t));
+
+    const GridSample3DTapGeometry geometry{
+        static_cast<int>(D_in), static_cast<int>(H_in), static_cast<int>(W_in),
+        static_cast<int64_t>(inputStrides.D), static_cast<int64_t>(inputStrides.H), static_cast<int64_t>(inputStrides.W),
+        align_corners, interpolationMode, paddingMode};
+    // a contiguous output slice is gathered in place, any other one through a per-run buffer
+    const bool output_dense = outputStrides.W == 1 && outputStrides.H == W_grid && outputStrides.D == H_grid * W_grid;
+
+    const size_t spatial = D_grid * H_grid * W_grid;
+    const size_t run_length = tactic.tileVoxels > 0 ? tactic.tileVoxels : GRID_SAMPLE_3D_CPU_RUN;
+    const size_t runs_per_batch = (spatial + run_length - 1) / run_length;
+    const size_t runs = C > 0 ? N * runs_per_batch : 0;
+    const size_t grain = tactic.numThreads > 0 ? (runs + tactic.numThreads - 1) / tactic.numThreads : 1;
+    const bool profile_taps = grid_sample_3d_profile_enabled();
+
+    GridSample3DThreadPool::instance().parallelFor(runs, grain, [&](size_t begin, size_t end) {
+        thread_local GridSample3DTaps taps;
+        thread_local std::vector<float> tls_coords;
+        thread_local std::vector<size_t> tls_offsets;
+        thread_local std::vector<scalar_t> tls_values;
+        for (size_t run = begin; run < end; run++) {
+            const size_t n = run / runs_per_batch;
+            const size_t s_begin = (run % runs_per_batch) * run_length;
+            const size_t count = std::min(run_length, spatial - s_begin);
+
+            // the run's coordinates are decoded from the grid view into a contiguous (x, y, z) run,
+            // and its voxels' offsets in the output view are kept for the writes
+            tls_coords.resize(count * 3);
+            tls_offsets.resize(count);
+            for (size_t i = 0; i < count; i++) {
+                const size_t s = s_begin + i;
+                const size_t d = s / (H_grid * W_grid), h = s / W_grid % H_grid, w = s % W_grid;
+                const grid_t* g = grid + n * gridStrides.N + d * gridStrides.D + h * gridStrides.H + w * gridStrides.W;
+                tls_coords[3 * i] = to_float(g[0]);
+                tls_coords[3 * i + 1] = to_float(g[gridStrides.XYZ]);
+                tls_coords[3 * i + 2] = to_float(g[2 * gridStrides.XYZ]);
+                tls_offsets[i] = d * outputStrides.D + h * outputStrides.H + w * outputStrides.W;
+            }
+            grid_sample_3d_cpu_compute_run_taps(geometry, tls_coords.data(), count, taps);
+            if (profile_taps) {
+                const size_t total = static_cast<size_t>(taps.numTaps) * taps.count;
+                grid_sample_3d_profile_add_taps(total, std::count(taps.offsets.begin(), taps.offsets.begin() + total, -1));
+            }
+            if (mask != nullptr) {
+                mask_taps(taps, mask + n * spatial + s_begin);
+            }
+            if (tactic.tileBounds) {
+                grid_sample_3d_cpu_classify_taps(taps);
+            }
+
+            tls_values.resize(count);
+            for (size_t c = 0; c < C; c++) {
+                const scalar_t* input_NC = input + n * inputStrides.N + c * inputStrides.C;
+                scalar_t* output_NC = output + n * outputStrides.N + c * outputStrides.C;
+                if (output_dense) {
+                    grid_sample_3d_cpu_gather<scalar_t>(taps, input_NC, output_NC + s_begin);
+                    continue;
+                }
+                grid_sample_3d_cpu_gather<scalar_t>(taps, input_NC, tls_values.data());
+                for (size_t i = 0; i < count; i++) {
+                    output_NC[tls_offsets[i]] = tls_values[i];
+                }
+            }
+        }
+    });
+    return profile.finish(0);
+}
+
+template <typename scalar_t, typename grid_t>
+int grid_sample_3d_affine_cpu(
+    const scalar_t* input,
+    const grid_t* theta,
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    size_t D_out, size_t H_out, size_t W_out,
+    bool align_corners,
+    GridSample3DInterpolationMode interpolationMode,
+    GridSample3DPaddingMode paddingMode,
+    scalar_t* output,
+    GridSample3DLayout layout,
+    const GridSample3DTactic& tactic,
+    const uint8_t* mask
+) {
+    GridSample3DProfileScope profile = profile_call<scalar_t, scalar_t>(
+        "grid_sample_3d_affine_cpu", N, C, D_in, H_in, W_in, D_out, H_out, W_out, N * 12 * sizeof(grid_t));
+    return profile.finish(sample_runs(input, N, C, D_in, H_in, W_in, D_out, H_out, W_out,
+                                      align_corners, interpolationMode, paddingMode, output, layout, tactic, mask,
+                                      [&](const GridSample3DTapGeometry& geometry, size_t n, size_t begin, size_t count,
+                                          GridSample3DTaps& taps) {
+        float theta_N[12];
+        for (int i = 0; i < 12; i++) {
+            theta_N[i] = to_float(theta[n * 12 + i]);
+        }
+        grid_sample_3d_cpu_compute_affine_run_taps(geometry, theta_N, D_out, H_out, W_out, begin, count, taps);
+    }, ConvertGather<scalar_t>{}));
+}
+
+template <typename label_t, typename grid_t>
+int grid_sample_3d_labels_cpu(
+    const label_t* input,
+    const grid_t* grid,
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    size_t D_grid, size_t H_grid, size_t W_grid,
+    bool align_corners,
+    GridSample3DPaddingMode paddingMode,
+    label_t* output,
+    GridSample3DLayout layout,
+    GridSample3DGridKind gridKind,
+    const GridSample3DTactic& tactic,
+    const uint8_t* mask
+) {
+    const size_t grid_stride_N = D_grid * H_grid * W_grid * 3;
+    GridSample3DProfileScope profile = profile_call<label_t, label_t>(
+        "grid_sample_3d_labels_cpu", N, C, D_in, H_in, W_in, D_grid, H_grid, W_grid, N * grid_stride_N * sizeof(grid_t));
+    return profile.finish(sample_runs(input, N, C, D_in, H_in, W_in, D_grid, H_grid, W_grid,
+                                      align_corners, GridSample3DInterpolationMode::Nearest, paddingMode, output, layout,
+                                      tactic, mask,
+                                      [&](const GridSample3DTapGeometry& geometry, size_t n, size_t begin, size_t count,
+                                          GridSample3DTaps& taps) {
+        grid_sample_3d_cpu_compute_displacement_run_taps(geometry, gridKind, grid + n * grid_stride_N + begin * 3,
+                                                         D_grid, H_grid, W_grid, begin, count, taps);
+    }, LabelGather<label_t>{}));
+}
+
+template <typename scalar_t, typename grid_t>
+int grid_sample_3d_points_cpu(
+    const scalar_t* input,
+    const grid_t* points,
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    size_t P,
+    bool align_corners,
+    GridSample3DInterpolationMode interpolationMode,
+    GridSample3DPaddingMode paddingMode,
+    scalar_t* output,
+    GridSample3DPointLayout pointLayout,
+    const GridSample3DTactic& tactic,
+    const uint8_t* mask
+) {
+    // N x C x P is the NCDHW output of a 1 x 1 x P grid
+    if (pointLayout == GridSample3DPointLayout::NCP) {
+        return grid_sample_3d_cpu(input, points, N, C, D_in, H_in, W_in, 1, 1, P, align_corners,
+                                  interpolationMode, paddingMode, output, GridSample3DLayout::NCDHW,
+                                  GridSample3DGridKind::Absolute, tactic, mask);
+    }
+    if (interpolationMode != GridSample3DInterpolationMode::Bilinear &&
+        interpolationMode != GridSample3DInterpolationMode::Nearest) {
+        return 1;
+    }
+    if (D_in * H_in * W_in > static_cast<size_t>(INT32_MAX)) {
+        return 1;
+    }
+    GridSample3DProfileScope profile = profile_call<scalar_t, scalar_t>(
+        "grid_sample_3d_points_cpu", N, C, D_in, H_in, W_in, 1, 1, P, N * P * 3 * sizeof(grid_t));
+
+    const size_t input_stride_C = D_in * H_in * W_in;
+    const GridSample3DTapGeometry geometry{
+        static_cast<int>(D_in), static_cast<int>(H_in), static_cast<int>(W_in),
+        static_cast<int64_t>(H_in * W_in), static_cast<int64_t>(W_in), 1,
+        align_corners, interpolationMode, paddingMode};
+
+    const size_t run_length = tactic.tileVoxels > 0 ? tactic.tileVoxels : GRID_SAMPLE_3D_CPU_RUN;
+    const size_t runs_per_batch = (P + run_length - 1) / run_length;
+    const size_t runs = N * runs_per_batch;
+    const size_t grain = tactic.numThreads > 0 ? (runs + tactic.numThreads - 1) / tactic.numThreads : 1;
+
+    // every channel of a run is gathered into a C x count block with the NCDHW gathers, then
+    // transposed into the count rows of C contiguous channels of the output
+    GridSample3DThreadPool::instance().parallelFor(runs, grain, [&](size_t begin, size_t end) {
+        thread_local GridSample3DTaps taps;
+        thread_local std::vector<scalar_t> tls_values;
+        for (size_t run = begin; run < end; run++) {
+            const size_t n = run / runs_per_batch;
+            const size_t p_begin = (run % runs_per_batch) * run_length;
+            const size_t count = std::min<size_t>(run_length, P - p_begin);
+            grid_sample_3d_cpu_compute_run_taps(geometry, points + (n * P + p_begin) * 3, count, taps);
+            if (mask != nullptr) {
+                mask_taps(taps, mask + n * P + p_begin);
+            }
+
+            tls_values.resize(C * count);
+            scalar_t* values = tls_values.data();
+            const scalar_t* input_NC = input + n * C * input_stride_C;
+            for (size_t c = 0; c < C; c++) {
+                grid_sample_3d_cpu_gather<scalar_t>(taps, input_NC, values + c * count);
+                input_NC += input_stride_C;
+            }
+            scalar_t* output_run = output + (n * P + p_begin) * C;
+            for (size_t i = 0; i < count; i++) {
+                for (size_t c = 0; c < C; c++) {
+                    output_run[i * C + c] = values[c * count + i];
+                }
+            }
+        }
+    });
+    return 0;
+}
+
+template <typename scalar_t, typename grid_t>
+int grid_sample_3d_ragged_cpu(
+    const scalar_t* input,
+    const grid_t* grid,
+    const GridSample3DRaggedItem* items,
+    size_t numItems, size_t C, size_t V_in, size_t G,
+    bool align_corners,
+    GridSample3DInterpolationMode interpolationMode,
+    GridSample3DPaddingMode paddingMode,
+    scalar_t* output,
+    const GridSample3DTactic& tactic
+) {
+    if (interpolationMode != GridSample3DInterpolationMode::Bilinear &&
+        interpolationMode != GridSample3DInterpolationMode::Nearest) {
+        return 1;
+    }
+    // the item offsets and the tap offsets within a channel are int32
+    if (V_in > static_cast<size_t>(INT32_MAX) || G > static_cast<size_t>(INT32_MAX)) {
+        return 1;
+    }
+    // runs never cross items, the first run of item i is runs_before[i]
+    const size_t run_length = tactic.tileVoxels > 0 ? tactic.tileVoxels : GRID_SAMPLE_3D_CPU_RUN;
+    std::vector<size_t> runs_before(numItems + 1, 0);
+    for (size_t i = 0; i < numItems; i++) {
+        if (!grid_sample_3d_ragged_item_valid(items, i, numItems, V_in, G)) {
+            return 1;
+        }
+        const GridSample3DRaggedItem& item = items[i];
+        const size_t voxels = static_cast<size_t>(item.D_grid) * item.H_grid * item.W_grid;
+        runs_before[i + 1] = runs_before[i] + (voxels + run_length - 1) / run_length;
+    }
+    const size_t runs = runs_before[numItems];
+    const size_t grain = tactic.numThreads > 0 ? (runs + tactic.numThreads - 1) / tactic.numThreads : 1;
+
+    GridSample3DThreadPool::instance().parallelFor(runs, grain, [&](size_t begin, size_t end) {
+        thread_local GridSample3DTaps taps;
+        size_t i = std::upper_bound(runs_before.begin(), runs_before.end(), begin) - runs_before.begin() - 1;
+        for (size_t run = begin; run < end; run++) {
+            while (run >= runs_before[i + 1]) {
+                i++;
+            }
+            const GridSample3DRaggedItem& item = items[i];
+            const size_t voxels = static_cast<size_t>(item.D_grid) * item.H_grid * item.W_grid;
+            const size_t s_begin = (run - runs_before[i]) * run_length;
+            const size_t count = std::min(run_length, voxels - s_begin);
+            const GridSample3DTapGeometry geometry{
+                item.D_in, item.H_in, item.W_in,
+                static_cast<int64_t>(item.H_in) * item.W_in, item.W_in, 1,
+                align_corners, interpolationMode, paddingMode};
+            const size_t first = item.grid_offset + s_begin;
+            grid_sample_3d_cpu_compute_run_taps(geometry, grid + first * 3, count, taps);
+            for (size_t c = 0; c < C; c++) {
+                grid_sample_3d_cpu_gather<scalar_t>(taps, input + c * V_in + item.input_offset, output + c * G + first);
+            }
+        }
+    });
+    return 0;
+}
+
+template <typename scalar_t, typename grid_t>
+int grid_sample_3d_mipmap_cpu(
+    const scalar_t* input,
+    const grid_t* grid,
+    const float* lod,
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    size_t D_grid, size_t H_grid, size_t W_grid,
+    bool align_corners,
+    GridSample3DPaddingMode paddingMode,
+    scalar_t* output,
+    const GridSample3DTactic& tactic,
+    const uint8_t* mask
+) {
+    if (D_in * H_in * W_in > static_cast<size_t>(INT32_MAX)) {
+        return 1;
+    }
+    const size_t slices = N * C;
+    const GridSample3DMipPyramid pyramid(slices, static_cast<int>(D_in), static_cast<int>(H_in), static_cast<int>(W_in));
+    std::vector<float> levels(pyramid.offset[pyramid.levels]);
+
+    // each level averages the previous one, slice by slice
+    for (int l = 1; l < pyramid.levels; l++) {
+        const size_t voxels = pyramid.sliceVoxels(l);
+        const size_t src_voxels = pyramid.sliceVoxels(l - 1);
+        const int D = pyramid.D[l - 1], H = pyramid.H[l - 1], W = pyramid.W[l - 1];
+        GridSample3DThreadPool::instance().parallelFor(slices, 1, [&](size_t begin, size_t end) {
+            for (size_t s = begin; s < end; s++) {
+                float* dst = levels.data() + pyramid.offset[l] + s * voxels;
+                size_t i = 0;
+                for (int z = 0; z < pyramid.D[l]; z++) {
+                    for (int y = 0; y < pyramid.H[l]; y++) {
+                        for (int x = 0; x < pyramid.W[l]; x++, i++) {
+                            dst[i] = l == 1
+                                ? grid_sample_3d_mip_average(input + s * src_voxels, D, H, W, z, y, x)
+                                : grid_sample_3d_mip_average(levels.data() + pyramid.offset[l - 1] + s * src_voxels,
+                                                             D, H, W, z, y, x);
+                        }
+                    }
+                }
+            }
+        });
+    }
+
+    const size_t spatial = D_grid * H_grid * W_grid;
+    const size_t run_length = tactic.tileVoxels > 0 ? tactic.tileVoxels : GRID_SAMPLE_3D_CPU_RUN;
+    const size_t runs_per_batch = (spatial + run_length - 1) / run_length;
+    const size_t runs = N * runs_per_batch;
+    const size_t grain = tactic.numThreads > 0 ? (runs + tactic.numThreads - 1) / tactic.numThreads : 1;
+    const size_t input_stride_C = D_in * H_in * W_in;
+
+    grid_sample_3d_dispatch_padding<GridSample3DInterpolationMode::Mipmap>(paddingMode, align_corners, [&](auto modes) {
+        constexpr GridSample3DPaddingMode padding = decltype(modes)::padding;
+        constexpr bool align = decltype(modes)::align_corners;
+        GridSample3DThreadPool::instance().parallelFor(runs, grain, [&](size_t begin, size_t end) {
+            thread_local std::vector<GridSample3DMipTaps> tls_taps;
+            for (size_t run = begin; run < end; run++) {
+                const size_t n = run / runs_per_batch;
+                const size_t s_begin = (run % runs_per_batch) * run_length;
+                const size_t count = std::min<size_t>(run_length, spatial - s_begin);
+                tls_taps.resize(count);
+                const grid_t* grid_N = grid + n * spatial * 3;
+                for (size_t i = 0; i < count; i++) {
+                    const size_t s = s_begin + i;
+                    GridSample3DMipTaps& taps = tls_taps[i];
+                    if (mask != nullptr && mask[n * spatial + s] == 0) {
+                        taps.numLevels = 0;
+                        continue;
+                    }
+                    const size_t w = s % W_grid, h = s / W_grid % H_grid, d = s / (W_grid * H_grid);
+                    const float voxel_lod = lod != nullptr
+                        ? lod[n * spatial + s]
+                        : grid_sample_3d_mip_lod<align>(grid_N, d, h, w, D_grid, H_grid, W_grid,
+                                                        static_cast<int>(D_in), static_cast<int>(H_in),
+                                                        static_cast<int>(W_in));
+                    grid_sample_3d_mip_taps<padding>(
+                        pyramid,
+                        compute_index<padding, align>(to_float(grid_N[s * 3]), static_cast<int>(W_in)),
+                        compute_index<padding, align>(to_float(grid_N[s * 3 + 1]), static_cast<int>(H_in)),
+                        compute_index<padding, align>(to_float(grid_N[s * 3 + 2]), static_cast<int>(D_in)),
+                        voxel_lod, taps);
+                }
+                for (size_t c = 0; c < C; c++) {
+                    const size_t slice = n * C + c;
+                    const scalar_t* input_NC = input + slice * input_stride_C;
+                    scalar_t* output_NC = output + slice * spatial + s_begin;
+                    for (size_t i = 0; i < count; i++) {
+                        output_NC[i] = from_float<scalar_t>(
+                            grid_sample_3d_mip_gather(tls_taps[i], pyramid, input_NC, levels.data(), slice));
+                    }
+                }
+            }
+        });
+        return 0;
+    });
+    return 0;
+}
+
+template <typename q_t, typename out_t, typename grid_t>
+int grid_sample_3d_quantized_cpu(
+    const q_t* input,
+    const GridSample3DQuantization& inputQuantization,
+    const grid_t* grid,
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    size_t D_grid, size_t H_grid, size_t W_grid,
+    bool align_corners,
+    GridSample3DInterpolationMode interpolationMode,
+    GridSample3DPaddingMode paddingMode,
+    out_t* output,
+    const GridSample3DQuantization& outputQuantization,
+    GridSample3DLayout layout,
+    GridSample3DGridKind gridKind,
+    const GridSample3DTactic& tactic,
+    const uint8_t* mask
+) {
+    const size_t grid_stride_N = D_grid * H_grid * W_grid * 3;
+    GridSample3DProfileScope profile = profile_call<q_t, out_t>(
+        "grid_sample_3d_quantized_cpu", N, C, D_in, H_in, W_in, D_grid, H_grid, W_grid, N * grid_stride_N * sizeof(grid_t));
+    // the per-channel parameters cover C channels, not the NDHWC8 padding
+    if (layout == GridSample3DLayout::NDHWC8) {
+        return profile.finish(1);
+    }
+    return profile.finish(sample_runs(input, N, C, D_in, H_in, W_in, D_grid, H_grid, W_grid,
+                                      align_corners, interpolationMode, paddingMode, output, layout, tactic, mask,
+                                      [&](const GridSample3DTapGeometry& geometry, size_t n, size_t begin, size_t count,
+                                          GridSample3DTaps& taps) {
+        grid_sample_3d_cpu_compute_displacement_run_taps(geometry, gridKind, grid + n * grid_stride_N + begin * 3,
+                                                         D_grid, H_grid, W_grid, begin, count, taps);
+    }, DequantizeGather<q_t, out_t>{inputQuantization, outputQuantization}));
+}
+
+// template specialization
+template void grid_sample_3d_cpu_compute_run_taps<float>(
+    const GridSample3DTapGeometry& geometry,
+    const float* grid,
+    size_t count,
+    GridSample3DTaps& taps
+);
+
+template void grid_sample_3d_cpu_compute_run_taps<half>(
+    const GridSample3DTapGeometry& geometry,
+    const half* grid,
+    size_t count,
+    GridSample3DTaps& taps
+);
+
+template void grid_sample_3d_cpu_compute_run_taps<bfloat16>(
+    const GridSample3DTapGeometry& geometry,
+    const bfloat16* grid,
+    size_t count,
+    GridSample3DTaps& taps
+);
+
+template void grid_sample_3d_cpu_compute_displacement_run_taps<float>(
+    const GridSample3DTapGeometry& geometry,
+    GridSample3DGridKind gridKind,
+    const float* grid,
+    size_t D_out, size_t H_out, size_t W_out,
+    size_t begin, size_t count,
+    GridSample3DTaps& taps
+);
+
+template void grid_sample_3d_cpu_compute_displacement_run_taps<half>(
+    const GridSample3DTapGeometry& geometry,
+    GridSample3DGridKind gridKind,
+    const half* grid,
+    size_t D_out, size_t H_out, size_t W_out,
+    size_t begin, size_t count,
+    GridSample3DTaps& taps
+);
+
+template void grid_sample_3d_cpu_compute_displacement_run_taps<bfloat16>(
+    const GridSample3DTapGeometry& geometry,
+    GridSample3DGridKind gridKind,
+    const bfloat16* grid,
+    size_t D_out, size_t H_out, size_t W_out,
+    size_t begin, size_t count,
+    GridSample3DTaps& taps
+);
+
+template void grid_sample_3d_cpu_gather<half>(
+    const GridSample3DTaps& taps,
+    const half* input,
+    half* output
+);
+
+template void grid_sample_3d_cpu_gather<bfloat16>(
+    const GridSample3DTaps& taps,
+    const bfloat16* input,
+    bfloat16* output
+);
+
+template void grid_sample_3d_cpu_gather_channels_last<half>(
+    const GridSample3DTaps& taps,
+    const half* input,
+    size_t C, size_t pitch,
+    half* output
+);
+
+template void grid_sample_3d_cpu_gather_channels_last<bfloat16>(
+    const GridSample3DTaps& taps,
+    const bfloat16* input,
+    size_t C, size_t pitch,
+    bfloat16* output
+);
+
+template int grid_sample_3d_cpu<float, float>(
+    const float* input,
+    const float* grid,
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    size_t D_grid, size_t H_grid, size_t W_grid,
+    bool align_corners,
+    GridSample3DInterpolationMode interpolationMode,
+    GridSample3DPaddingMode paddingMode,
+    float* output,
+    GridSample3DLayout layout,
+    GridSample3DGridKind gridKind,
+    const GridSample3DTactic& tactic,
+    const uint8_t* mask
+);
+
+template int grid_sample_3d_cpu<half, half>(
+    const half* input,
+    const half* grid,
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    size_t D_grid, size_t H_grid, size_t W_grid,
+    bool align_corners,
+    GridSample3DInterpolationMode interpolationMode,
+    GridSample3DPaddingMode paddingMode,
+    half* output,
+    GridSample3DLayout layout,
+    GridSample3DGridKind gridKind,
+    const GridSample3DTactic& tactic,
+    const uint8_t* mask
+);
+
+template int grid_sample_3d_cpu<bfloat16, bfloat16>(
+    const bfloat16* input,
+    const bfloat16* grid,
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    size_t D_grid, size_t H_grid, size_t W_grid,
+    bool align_corners,
+    GridSample3DInterpolationMode interpolationMode,
+    GridSample3DPaddingMode paddingMode,
+    bfloat16* output,
+    GridSample3DLayout layout,
+    GridSample3DGridKind gridKind,
+    const GridSample3DTactic& tactic,
+    const uint8_t* mask
+);
+
+template int grid_sample_3d_cpu<half, float>(
+    const half* input,
+    const float* grid,
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    size_t D_grid, size_t H_grid, size_t W_grid,
+    bool align_corners,
+    GridSample3DInterpolationMode interpolationMode,
+    GridSample3DPaddingMode paddingMode,
+    half* output,
+    GridSample3DLayout layout,
+    GridSample3DGridKind gridKind,
+    const GridSample3DTactic& tactic,
+    const uint8_t* mask
+);
+
+template int grid_sample_3d_cpu<bfloat16, float>(
+    const bfloat16* input,
+    const float* grid,
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    size_t D_grid, size_t H_grid, size_t W_grid,
+    bool align_corners,
+    GridSample3DInterpolationMode interpolationMode,
+    GridSample3DPaddingMode paddingMode,
+    bfloat16* output,
+    GridSample3DLayout layout,
+    GridSample3DGridKind gridKind,
+    const GridSample3DTactic& tactic,
+    const uint8_t* mask
+);
+
+template int grid_sample_3d_strided_cpu<float, float>(
+    const float* input,
+    const GridSample3DStrides& inputStrides,
+    const float* grid,
+    const GridSample3DGridStrides& gridStrides,
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    size_t D_grid, size_t H_grid, size_t W_grid,
+    bool align_corners,
+    GridSample3DInterpolationMode interpolationMode,
+    GridSample3DPaddingMode paddingMode,
+    float* output,
+    const GridSample3DStrides& outputStrides,
+    const GridSample3DTactic& tactic,
+    const uint8_t* mask
+);
+
+template int grid_sample_3d_strided_cpu<half, half>(
+    const half* input,
+    const GridSample3DStrides& inputStrides,
+    const half* grid,
+    const GridSample3DGridStrides& gridStrides,
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    size_t D_grid, size_t H_grid, size_t W_grid,
+    bool align_corners,
+    GridSample3DInterpolationMode interpolationMode,
+    GridSample3DPaddingMode paddingMode,
+    half* output,
+    const GridSample3DStrides& outputStrides,
+    const GridSample3DTactic& tactic,
+    const uint8_t* mask
+);
+
+template int grid_sample_3d_strided_cpu<bfloat16, bfloat16>(
+    const bfloat16* input,
+    const GridSample3DStrides& inputStrides,
+    const bfloat16* grid,
+    const GridSample3DGridStrides& gridStrides,
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    size_t D_grid, size_t H_grid, size_t W_grid,
+    bool align_corners,
+    GridSample3DInterpolationMode interpolationMode,
+    GridSample3DPaddingMode paddingMode,
+    bfloat16* output,
+    const GridSample3DStrides& outputStrides,
+    const GridSample3DTactic& tactic,
+    const uint8_t* mask
+);
+
+template int grid_sample_3d_strided_cpu<half, float>(
+    const half* input,
+    const GridSample3DStrides& inputStrides,
+    const float* grid,
+    const GridSample3DGridStrides& gridStrides,
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    size_t D_grid, size_t H_grid, size_t W_grid,
+    bool align_corners,
+    GridSample3DInterpolationMode interpolationMode,
+    GridSample3DPaddingMode paddingMode,
+    half* output,
+    const GridSample3DStrides& outputStrides,
+    const GridSample3DTactic& tactic,
+    const uint8_t* mask
+);
+
+template int grid_sample_3d_strided_cpu<bfloat16, float>(
+    const bfloat16* input,
+    const GridSample3DStrides& inputStrides,
+    const float* grid,
+    const GridSample3DGridStrides& gridStrides,
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    size_t D_grid, size_t H_grid, size_t W_grid,
+    bool align_corners,
+    GridSample3DInterpolationMode interpolationMode,
+    GridSample3DPaddingMode paddingMode,
+    bfloat16* output,
+    const GridSample3DStrides& outputStrides,
+    const GridSample3DTactic& tactic,
+    const uint8_t* mask
+);
+
+template int grid_sample_3d_affine_cpu<float, float>(
+    const float* input,
+    const float* theta,
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    size_t D_out, size_t H_out, size_t W_out,
+    bool align_corners,
+    GridSample3DInterpolationMode interpolationMode,
+    GridSample3DPaddingMode paddingMode,
+    float* output,
+    GridSample3DLayout layout,
+    const GridSample3DTactic& tactic,
+    const uint8_t* mask
+);
+
+template int grid_sample_3d_affine_cpu<half, half>(
+    const half* input,
+    const half* theta,
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    size_t D_out, size_t H_out, size_t W_out,
+    bool align_corners,
+    GridSample3DInterpolationMode interpolationMode,
+    GridSample3DPaddingMode paddingMode,
+    half* output,
+    GridSample3DLayout layout,
+    const GridSample3DTactic& tactic,
+    const uint8_t* mask
+);
+
+template int grid_sample_3d_affine_cpu<bfloat16, bfloat16>(
+    const bfloat16* input,
+    const bfloat16* theta,
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    size_t D_out, size_t H_out, size_t W_out,
+    bool align_corners,
+    GridSample3DInterpolationMode interpolationMode,
+    GridSample3DPaddingMode paddingMode,
+    bfloat16* output,
+    GridSample3DLayout layout,
+    const GridSample3DTactic& tactic,
+    const uint8_t* mask
+);
+
+template int grid_sample_3d_affine_cpu<half, float>(
+    const half* input,
+    const float* theta,
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    size_t D_out, size_t H_out, size_t W_out,
+    bool align_corners,
+    GridSample3DInterpolationMode interpolationMode,
+    GridSample3DPaddingMode paddingMode,
+    half* output,
+    GridSample3DLayout layout,
+    const GridSample3DTactic& tactic,
+    const uint8_t* mask
+);
+
+template int grid_sample_3d_affine_cpu<bfloat16, float>(
+    const bfloat16* input,
+    const float* theta,
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    size_t D_out, size_t H_out, size_t W_out,
+    bool align_corners,
+    GridSample3DInterpolationMode interpolationMode,
+    GridSample3DPaddingMode paddingMode,
+    bfloat16* output,
+    GridSample3DLayout layout,
+    const GridSample3DTactic& tactic,
+    const uint8_t* mask
+);
+
+template int grid_sample_3d_points_cpu<float, float>(
+    const float* input,
+    const float* points,
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    size_t P,
+    bool align_corners,
+    GridSample3DInterpolationMode interpolationMode,
+    GridSample3DPaddingMode paddingMode,
+    float* output,
+    GridSample3DPointLayout pointLayout,
+    const GridSample3DTactic& tactic,
+    const uint8_t* mask
+);
+
+template int grid_sample_3d_points_cpu<half, half>(
+    const half* input,
+    const half* points,
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    size_t P,
+    bool align_corners,
+    GridSample3DInterpolationMode interpolationMode,
+    GridSample3DPaddingMode paddingMode,
+    half* output,
+    GridSample3DPointLayout pointLayout,
+    const GridSample3DTactic& tactic,
+    const uint8_t* mask
+);
+
+template int grid_sample_3d_points_cpu<bfloat16, bfloat16>(
+    const bfloat16* input,
+    const bfloat16* points,
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    size_t P,
+    bool align_corners,
+    GridSample3DInterpolationMode interpolationMode,
+    GridSample3DPaddingMode paddingMode,
+    bfloat16* output,
+    GridSample3DPointLayout pointLayout,
+    const GridSample3DTactic& tactic,
+    const uint8_t* mask
+);
+
+template int grid_sample_3d_points_cpu<half, float>(
+    const half* input,
+    const float* points,
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    size_t P,
+    bool align_corners,
+    GridSample3DInterpolationMode interpolationMode,
+    GridSample3DPaddingMode paddingMode,
+    half* output,
+    GridSample3DPointLayout pointLayout,
+    const GridSample3DTactic& tactic,
+    const uint8_t* mask
+);
+
+template int grid_sample_3d_points_cpu<bfloat16, float>(
+    const bfloat16* input,
+    const float* points,
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    size_t P,
+    bool align_corners,
+    GridSample3DInterpolationMode interpolationMode,
+    GridSample3DPaddingMode paddingMode,
+    bfloat16* output,
+    GridSample3DPointLayout pointLayout,
+    const GridSample3DTactic& tactic,
+    const uint8_t* mask
+);
+
+template int grid_sample_3d_ragged_cpu<float, float>(
+    const float* input,
+    const float* grid,
+    const GridSample3DRaggedItem* items,
+    size_t numItems, size_t C, size_t V_in, size_t G,
+    bool align_corners,
+    GridSample3DInterpolationMode interpolationMode,
+    GridSample3DPaddingMode paddingMode,
+    float* output,
+    const GridSample3DTactic& tactic
+);
+
+template int grid_sample_3d_ragged_cpu<half, half>(
+    const half* input,
+    const half* grid,
+    const GridSample3DRaggedItem* items,
+    size_t numItems, size_t C, size_t V_in, size_t G,
+    bool align_corners,
+    GridSample3DInterpolationMode interpolationMode,
+    GridSample3DPaddingMode paddingMode,
+    half* output,
+    const GridSample3DTactic& tactic
+);
+
+template int grid_sample_3d_ragged_cpu<bfloat16, bfloat16>(
+    const bfloat16* input,
+    const bfloat16* grid,
+    const GridSample3DRaggedItem* items,
+    size_t numItems, size_t C, size_t V_in, size_t G,
+    bool align_corners,
+    GridSample3DInterpolationMode interpolationMode,
+    GridSample3DPaddingMode paddingMode,
+    bfloat16* output,
+    const GridSample3DTactic& tactic
+);
+
+template int grid_sample_3d_ragged_cpu<half, float>(
+    const half* input,
+    const float* grid,
+    const GridSample3DRaggedItem* items,
+    size_t numItems, size_t C, size_t V_in, size_t G,
+    bool align_corners,
+    GridSample3DInterpolationMode interpolationMode,
+    GridSample3DPaddingMode paddingMode,
+    half* output,
+    const GridSample3DTactic& tactic
+);
+
+template int grid_sample_3d_ragged_cpu<bfloat16, float>(
+    const bfloat16* input,
+    const float* grid,
+    const GridSample3DRaggedItem* items,
+    size_t numItems, size_t C, size_t V_in, size_t G,
+    bool align_corners,
+    GridSample3DInterpolationMode interpolationMode,
+    GridSample3DPaddingMode paddingMode,
+    bfloat16* output,
+    const GridSample3DTactic& tactic
+);
+
+template int grid_sample_3d_mipmap_cpu<float, float>(
+    const float* input,
+    const float* grid,
+    const float* lod,
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    size_t D_grid, size_t H_grid, size_t W_grid,
+    bool align_corners,
+    GridSample3DPaddingMode paddingMode,
+    float* output,
+    const GridSample3DTactic& tactic,
+    const uint8_t* mask
+);
+
+template int grid_sample_3d_mipmap_cpu<half, half>(
+    const half* input,
+    const half* grid,
+    const float* lod,
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    size_t D_grid, size_t H_grid, size_t W_grid,
+    bool align_corners,
+    GridSample3DPaddingMode paddingMode,
+    half* output,
+    const GridSample3DTactic& tactic,
+    const uint8_t* mask
+);
+
+template int grid_sample_3d_mipmap_cpu<bfloat16, bfloat16>(
+    const bfloat16* input,
+    const bfloat16* grid,
+    const float* lod,
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    size_t D_grid, size_t H_grid, size_t W_grid,
+    bool align_corners,
+    GridSample3DPaddingMode paddingMode,
+    bfloat16* output,
+    const GridSample3DTactic& tactic,
+    const uint8_t* mask
+);
+
+template int grid_sample_3d_mipmap_cpu<half, float>(
+    const half* input,
+    const float* grid,
+    const float* lod,
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    size_t D_grid, size_t H_grid, size_t W_grid,
+    bool align_corners,
+    GridSample3DPaddingMode paddingMode,
+    half* output,
+    const GridSample3DTactic& tactic,
+    const uint8_t* mask
+);
+
+template int grid_sample_3d_mipmap_cpu<bfloat16, float>(
+    const bfloat16* input,
+    const float* grid,
+    const float* lod,
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    size_t D_grid, size_t H_grid, size_t W_grid,
+    bool align_corners,
+    GridSample3DPaddingMode paddingMode,
+    bfloat16* output,
+    const GridSample3DTactic& tactic,
+    const uint8_t* mask
+);
+
+template int grid_sample_3d_quantized_cpu<int8_t, int8_t, float>(
+    const int8_t* input,
+    const GridSample3DQuantization& inputQuantization,
+    const float* grid,
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    size_t D_grid, size_t H_grid, size_t W_grid,
+    bool align_corners,
+    GridSample3DInterpolationMode interpolationMode,
+    GridSample3DPaddingMode paddingMode,
+    int8_t* output,
+    const GridSample3DQuantization& outputQuantization,
+    GridSample3DLayout layout,
+    GridSample3DGridKind gridKind,
+    const GridSample3DTactic& tactic,
+    const uint8_t* mask
+);
+
+template int grid_sample_3d_quantized_cpu<int8_t, int8_t, half>(
+    const int8_t* input,
+    const GridSample3DQuantization& inputQuantization,
+    const half* grid,
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    size_t D_grid, size_t H_grid, size_t W_grid,
+    bool align_corners,
+    GridSample3DInterpolationMode interpolationMode,
+    GridSample3DPaddingMode paddingMode,
+    int8_t* output,
+    const GridSample3DQuantization& outputQuantization,
+    GridSample3DLayout layout,
+    GridSample3DGridKind gridKind,
+    const GridSample3DTactic& tactic,
+    const uint8_t* mask
+);
+
+template int grid_sample_3d_quantized_cpu<int8_t, half, float>(
+    const int8_t* input,
+    const GridSample3DQuantization& inputQuantization,
+    const float* grid,
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    size_t D_grid, size_t H_grid, size_t W_grid,
+    bool align_corners,
+    GridSample3DInterpolationMode interpolationMode,
+    GridSample3DPaddingMode paddingMode,
+    half* output,
+    const GridSample3DQuantization& outputQuantization,
+    GridSample3DLayout layout,
+    GridSample3DGridKind gridKind,
+    const GridSample3DTactic& tactic,
+    const uint8_t* mask
+);
+
+template int grid_sample_3d_quantized_cpu<int8_t, half, half>(
+    const int8_t* input,
+    const GridSample3DQuantization& inputQuantization,
+    const half* grid,
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    size_t D_grid, size_t H_grid, size_t W_grid,
+    bool align_corners,
+    GridSample3DInterpolationMode interpolationMode,
+    GridSample3DPaddingMode paddingMode,
+    half* output,
+    const GridSample3DQuantization& outputQuantization,
+    GridSample3DLayout layout,
+    GridSample3DGridKind gridKind,
+    const GridSample3DTactic& tactic,
+    const uint8_t* mask
+);
+
+template int grid_sample_3d_quantized_cpu<uint8_t, uint8_t, float>(
+    const uint8_t* input,
+    const GridSample3DQuantization& inputQuantization,
+    const float* grid,
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    size_t D_grid, size_t H_grid, size_t W_grid,
+    bool align_corners,
+    GridSample3DInterpolationMode interpolationMode,
+    GridSample3DPaddingMode paddingMode,
+    uint8_t* output,
+    const GridSample3DQuantization& outputQuantization,
+    GridSample3DLayout layout,
+    GridSample3DGridKind gridKind,
+    const GridSample3DTactic& tactic,
+    const uint8_t* mask
+);
+
+template int grid_sample_3d_quantized_cpu<uint8_t, uint8_t, half>(
+    const uint8_t* input,
+    const GridSample3DQuantization& inputQuantization,
+    const half* grid,
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    size_t D_grid, size_t H_grid, size_t W_grid,
+    bool align_corners,
+    GridSample3DInterpolationMode interpolationMode,
+    GridSample3DPaddingMode paddingMode,
+    uint8_t* output,
+    const GridSample3DQuantization& outputQuantization,
+    GridSample3DLayout layout,
+    GridSample3DGridKind gridKind,
+    const GridSample3DTactic& tactic,
+    const uint8_t* mask
+);
+
+template int grid_sample_3d_quantized_cpu<uint8_t, half, float>(
+    const uint8_t* input,
+    const GridSample3DQuantization& inputQuantization,
+    const float* grid,
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    size_t D_grid, size_t H_grid, size_t W_grid,
+    bool align_corners,
+    GridSample3DInterpolationMode interpolationMode,
+    GridSample3DPaddingMode paddingMode,
+    half* output,
+    const GridSample3DQuantization& outputQuantization,
+    GridSample3DLayout layout,
+    GridSample3DGridKind gridKind,
+    const GridSample3DTactic& tactic,
+    const uint8_t* mask
+);
+
+template int grid_sample_3d_quantized_cpu<uint8_t, half, half>(
+    const uint8_t* input,
+    const GridSample3DQuantization& inputQuantization,
+    const half* grid,
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    size_t D_grid, size_t H_grid, size_t W_grid,
+    bool align_corners,
+    GridSample3DInterpolationMode interpolationMode,
+    GridSample3DPaddingMode paddingMode,
+    half* output,
+    const GridSample3DQuantization& outputQuantization,
+    GridSample3DLayout layout,
+    GridSample3DGridKind gridKind,
+    const GridSample3DTactic& tactic,
+    const uint8_t* mask
+);
+
+template int grid_sample_3d_labels_cpu<int32_t, float>(
+    const int32_t* input,
+    const float* grid,
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    size_t D_grid, size_t H_grid, size_t W_grid,
+    bool align_corners,
+    GridSample3DPaddingMode paddingMode,
+    int32_t* output,
+    GridSample3DLayout layout,
+    GridSample3DGridKind gridKind,
+    const GridSample3DTactic& tactic,
+    const uint8_t* mask
+);
+
+template int grid_sample_3d_labels_cpu<int32_t, half>(
+    const int32_t* input,
+    const half* grid,
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    size_t D_grid, size_t H_grid, size_t W_grid,
+    bool align_corners,
+    GridSample3DPaddingMode paddingMode,
+    int32_t* output,
+    GridSample3DLayout layout,
+    GridSample3DGridKind gridKind,
+    const GridSample3DTactic& tactic,
+    const uint8_t* mask
+);
+
+template int grid_sample_3d_labels_cpu<int8_t, float>(
+    const int8_t* input,
+    const float* grid,
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    size_t D_grid, size_t H_grid, size_t W_grid,
+    bool align_corners,
+    GridSample3DPaddingMode paddingMode,
+    int8_t* output,
+    GridSample3DLayout layout,
+    GridSample3DGridKind gridKind,
+    const GridSample3DTactic& tactic,
+    const uint8_t* mask
+);
+
+template int grid_sample_3d_labels_cpu<int8_t, half>(
+    const int8_t* input,
+    const half* grid,
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    size_t D_grid, size_t H_grid, size_t W_grid,
+    bool align_corners,
+    GridSample3DPaddingMode paddingMode,
+    int8_t* output,
+    GridSample3DLayout layout,
+    GridSample3DGridKind gridKind,
+    const GridSample3DTactic& tactic,
+    const uint8_t* mask
+);
+
+template int grid_sample_3d_labels_cpu<uint8_t, float>(
+    const uint8_t* input,
+    const float* grid,
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    size_t D_grid, size_t H_grid, size_t W_grid,
+    bool align_corners,
+    GridSample3DPaddingMode paddingMode,
+    uint8_t* output,
+    GridSample3DLayout layout,
+    GridSample3DGridKind gridKind,
+    const GridSample3DTactic& tactic,
+    const uint8_t* mask
+);
+
+template int grid_sample_3d_labels_cpu<uint8_t, half>(
+    const uint8_t* input,
+    const half* grid,
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    size_t D_grid, size_t H_grid, size_t W_grid,
+    bool align_corners,
+    GridSample3DPaddingMode paddingMode,
+    uint8_t* output,
+    GridSample3DLayout layout,
+    GridSample3DGridKind gridKind,
+    const GridSample3DTactic& tactic,
+    const uint8_t* mask
+);
@@ -0,0 +1,236 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "grid_sample_3d.h"
+#include "grid_sample_3d.cuh"
+
+// Internal building blocks of the CPU backend (grid_sample_3d_cpu.cpp), shared with the
+// other host-side entry points. Not part of the public API.
+
+// default number of consecutive output voxels whose taps are computed before streaming the
+// channels (GridSample3DTactic::tileVoxels)
+#define GRID_SAMPLE_3D_CPU_RUN 256
+
+// depth and height of the bricks of a tiled traversal, whose rows are runs of tileVoxels voxels
+#define GRID_SAMPLE_3D_CPU_BRICK 4
+
+// output voxels sorted together by bucketed sampling (GridSample3DBucketing); their taps are kept
+// while the chunk is visited in bucket order, about 2 MiB per thread for bilinear
+#define GRID_SAMPLE_3D_CPU_BUCKET_CHUNK (1 << 15)
+
+// Input geometry the taps are computed against.
+struct GridSample3DTapGeometry {
+    int D_in, H_in, W_in;
+    int64_t stride_D, stride_H, stride_W;
+    bool align_corners;
+    GridSample3DInterpolationMode interpolationMode;
+    GridSample3DPaddingMode paddingMode;
+    // first input depth held in memory (a slab of grid_sample_3d_stream_cpu); offsets start there
+    int z_begin = 0;
+};
+
+// Gather taps of a run of output voxels, stored tap-major (tap k of voxel i lives at
+// [k * count + i]) so the channel loop streams one tap across the whole run.
+// Offsets are relative to depth z_begin of the (n, c) input slice; -1 marks an out-of-bounds corner.
+struct GridSample3DTaps {
+    int numTaps = 0;
+    size_t count = 0;
+    std::vector<int32_t> offsets;
+    std::vector<float> weights;
+    bool inside = false;    // no offset is -1, so gathers may skip the checks
+
+    void resize(int taps, size_t n) {
+        numTaps = taps;
+        count = n;
+        inside = false;
+        offsets.resize(static_cast<size_t>(taps) * n);
+        weights.resize(static_cast<size_t>(taps) * n);
+    }
+};
+
+// Bounds of a run (GridSample3DTactic::tileBounds): drops every tap when none is in bounds, so the
+// gathers only write zeros, and marks the run inside when all are.
+inline void grid_sample_3d_cpu_classify_taps(GridSample3DTaps& taps) {
+    const size_t n = static_cast<size_t>(taps.numTaps) * taps.count;
+    size_t valid = 0;
+    for (size_t i = 0; i < n; i++) {
+        valid += taps.offsets[i] >= 0;
+    }
+    if (valid == 0) {
+        taps.numTaps = 0;
+    }
+    taps.inside = valid == n;
+}
+
+inline int grid_sample_3d_num_taps(GridSample3DInterpolationMode mode) {
+    return mode == GridSample3DInterpolationMode::Nearest ? 1 : 8;
+}
+
+// Fills the taps of voxel i from its source index (ix, iy, iz) as returned by compute_index,
+// specialized on GridSample3DModes (see grid_sample_3d_dispatch_modes).
+template <typename Modes>
+inline void grid_sample_3d_cpu_compute_taps_at(
+    const GridSample3DTapGeometry& g,
+    float ix, float iy, float iz,
+    size_t i,
+    GridSample3DTaps& taps
+) {
+    constexpr bool zeros = Modes::padding == GridSample3DPaddingMode::Zeros;
+
+    const size_t count = taps.count;
+    int32_t* offsets = taps.offsets.data() + i;
+    float* weights = taps.weights.data() + i;
+
+    if (Modes::interpolation == GridSample3DInterpolationMode::Nearest) {
+        int xn = static_cast<int>(::roundf(ix));
+        int yn = static_cast<int>(::roundf(iy));
+        int zn = static_cast<int>(::roundf(iz));
+        // Border/Reflection coordinates are clipped to the volume, so only Zeros needs the check
+        bool inside = !zeros || (xn >= 0 && xn < g.W_in && yn >= 0 && yn < g.H_in && zn >= 0 && zn < g.D_in);
+        offsets[0] = inside ? static_cast<int32_t>((zn - g.z_begin) * g.stride_D + yn * g.stride_H + xn * g.stride_W) : -1;
+        weights[0] = inside ? 1.f : 0.f;
+        return;
+    }
+
+    int x0 = static_cast<int>(::floor(ix));
+    int y0 = static_cast<int>(::floor(iy));
+    int z0 = static_cast<int>(::floor(iz));
+    int x1 = x0 + 1;
+    int y1 = y0 + 1;
+    int z1 = z0 + 1;
+
+    // same corner order and weight products as grid_sample_3d_bilinear_kernel
+    const float wx[2] = {static_cast<float>(x1) - ix, ix - x0};
+    const float wy[2] = {static_cast<float>(y1) - iy, iy - y0};
+    const float wz[2] = {static_cast<float>(z1) - iz, iz - z0};
+    const int64_t ox[2] = {x0 * g.stride_W, x1 * g.stride_W};
+    const int64_t oy[2] = {y0 * g.stride_H, y1 * g.stride_H};
+    const int64_t oz[2] = {(z0 - g.z_begin) * g.stride_D, (z1 - g.z_begin) * g.stride_D};
+    // per-axis validity; clipped coordinates keep the low corner inside, only the high corner can fall off
+    const bool vx[2] = {!zeros || (x0 >= 0 && x0 < g.W_in), x1 < g.W_in && (!zeros || x1 >= 0)};
+    const bool vy[2] = {!zeros || (y0 >= 0 && y0 < g.H_in), y1 < g.H_in && (!zeros || y1 >= 0)};
+    const bool vz[2] = {!zeros || (z0 >= 0 && z0 < g.D_in), z1 < g.D_in && (!zeros || z1 >= 0)};
+
+    int k = 0;
+    for (int dz = 1; dz >= 0; dz--) {
+        for (int dy = 1; dy >= 0; dy--) {
+            for (int dx = 1; dx >= 0; dx--, k++) {
+                bool inside = vx[dx] && vy[dy] && vz[dz];
+                offsets[k * count] = inside ? static_cast<int32_t>(oz[dz] + oy[dy] + ox[dx]) : -1;
+                weights[k * count] = inside ? wx[dx] * wy[dy] * wz[dz] : 0.f;
+            }
+        }
+    }
+}
+
+// Same from the normalized grid coordinate (x, y, z).
+template <typename Modes>
+inline void grid_sample_3d_cpu_compute_taps(
+    const GridSample3DTapGeometry& g,
+    float x, float y, float z,
+    size_t i,
+    GridSample3DTaps& taps
+) {
+    grid_sample_3d_cpu_compute_taps_at<Modes>(g,
+                                              compute_index<Modes::padding, Modes::align_corners>(x, g.W_in),
+                                              compute_index<Modes::padding, Modes::align_corners>(y, g.H_in),
+                                              compute_index<Modes::padding, Modes::align_corners>(z, g.D_in),
+                                              i, taps);
+}
+
+// Same with the modes taken from the geometry at runtime (one dispatch per voxel).
+void grid_sample_3d_cpu_compute_taps(
+    const GridSample3DTapGeometry& geometry,
+    float x, float y, float z,
+    size_t i,
+    GridSample3DTaps& taps
+);
+
+// Fills taps for `count` consecutive voxels of a contiguous (x, y, z) grid.
+template <typename grid_t>
+void grid_sample_3d_cpu_compute_run_taps(
+    const GridSample3DTapGeometry& geometry,
+    const grid_t* grid,
+    size_t count,
+    GridSample3DTaps& taps
+);
+
+// Same for a displacement grid (GridSample3DGridKind) over a D_out x H_out x W_out output, the
+// run starting at flat voxel index `begin`; `grid` points at the run's first voxel.
+template <typename grid_t>
+void grid_sample_3d_cpu_compute_displacement_run_taps(
+    const GridSample3DTapGeometry& geometry,
+    GridSample3DGridKind gridKind,
+    const grid_t* grid,
+    size_t D_out, size_t H_out, size_t W_out,
+    size_t begin, size_t count,
+    GridSample3DTaps& taps
+);
+
+// Same for `count` consecutive voxels of a D_out x H_out x W_out output starting at flat index
+// `begin`, with the F.affine_grid coordinates of theta (3 x 4, row-major) instead of a grid.
+void grid_sample_3d_cpu_compute_affine_run_taps(
+    const GridSample3DTapGeometry& geometry,
+    const float* theta,
+    size_t D_out, size_t H_out, size_t W_out,
+    size_t begin, size_t count,
+    GridSample3DTaps& taps
+);
+
+// output[i] = sum_k weight[k][i] * input[offset[k][i]] for every voxel of the run of one channel.
+template <typename scalar_t>
+void grid_sample_3d_cpu_gather(
+    const GridSample3DTaps& taps,
+    const scalar_t* input,
+    scalar_t* output
+);
+
+template <>
+void grid_sample_3d_cpu_gather<float>(
+    const GridSample3DTaps& taps,
+    const float* input,
+    float* output
+);
+
+// Channels-last variant: each tap of voxel i is one contiguous read of C channels starting at
+// input[offset[k][i]]; the C results are written to output[i * pitch].
+template <typename scalar_t>
+void grid_sample_3d_cpu_gather_channels_last(
+    const GridSample3DTaps& taps,
+    const scalar_t* input,
+    size_t C, size_t pitch,
+    scalar_t* output
+);
+
+template <>
+void grid_sample_3d_cpu_gather_channels_last<float>(
+    const GridSample3DTaps& taps,
+    const float* input,
+    size_t C, size_t pitch,
+    float* output
+);
+
+// Quantized variants: the int8/uint8 input of channel c is dequantized, and the fp32 result is
+// requantized (out_t == q_t) or converted to fp16 with quantize_value.
+template <typename q_t, typename out_t>
+void grid_sample_3d_cpu_gather_quantized(
+    const GridSample3DTaps& taps,
+    const q_t* input,
+    const GridSample3DQuantization& inputQuantization,
+    const GridSample3DQuantization& outputQuantization,
+    size_t c,
+    out_t* output
+);
+
+template <typename q_t, typename out_t>
+void grid_sample_3d_cpu_gather_quantized_channels_last(
+    const GridSample3DTaps& taps,
+    const q_t* input,
+    const GridSample3DQuantization& inputQuantization,
+    const GridSample3DQuantization& outputQuantization,
+    size_t C, size_t pitch,
+    out_t* output
+);
@@ -0,0 +1,170 @@
+#include "grid_sample_3d_cpu_simd.h"
+
+#include <math.h>
+
+#if defined(__AVX2__) || defined(__AVX512F__)
+#include <immintrin.h>
+#endif
+
+// Only C functions and intrinsics here: a std:: template or inline function instantiated in this
+// file could be the copy the linker keeps for every other file, and carry the vector ISA with it.
+namespace
+{
+    inline float fmadd(float a, float b, float c) {
+#if defined(__FMA__)
+        return fmaf(a, b, c);
+#else
+        return a * b + c;
+#endif
+    }
+
+    // fp32 gathers; `checked` = false drops the out-of-bounds tests when every tap is in bounds
+    template <bool checked>
+    void gather_float(const int32_t* offsets, const float* weights, int numTaps, size_t count, const float* input,
+                      float* output) {
+        size_t i = 0;
+
+#if defined(__AVX512F__)
+        for (; i + 16 <= count; i += 16) {
+            __m512 value = _mm512_setzero_ps();
+            for (int k = 0; k < numTaps; k++) {
+                __m512i index = _mm512_loadu_si512(offsets + k * count + i);
+                __m512 v;
+                if constexpr (checked) {
+                    __mmask16 valid = _mm512_cmpge_epi32_mask(index, _mm512_setzero_si512());
+                    v = _mm512_mask_i32gather_ps(_mm512_setzero_ps(), valid, index, input, 4);
+                } else {
+                    v = _mm512_i32gather_ps(index, input, 4);
+                }
+                value = _mm512_fmadd_ps(v, _mm512_loadu_ps(weights + k * count + i), value);
+            }
+            _mm512_storeu_ps(output + i, value);
+        }
+#endif
+
+#if defined(__AVX2__) && defined(__FMA__)
+        const __m256i minus_one = _mm256_set1_epi32(-1);
+        for (; i + 8 <= count; i += 8) {
+            __m256 value = _mm256_setzero_ps();
+            for (int k = 0; k < numTaps; k++) {
+                __m256i index = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(offsets + k * count + i));
+                __m256 v;
+                if constexpr (checked) {
+                    __m256 valid = _mm256_castsi256_ps(_mm256_cmpgt_epi32(index, minus_one));
+                    v = _mm256_mask_i32gather_ps(_mm256_setzero_ps(), input, index, valid, 4);
+                } else {
+                    v = _mm256_i32gather_ps(input, index, 4);
+                }
+                value = _mm256_fmadd_ps(v, _mm256_loadu_ps(weights + k * count + i), value);
+            }
+            _mm256_storeu_ps(output + i, value);
+        }
+#endif
+
+        for (; i < count; i++) {
+            float value = 0.f;
+            for (int k = 0; k < numTaps; k++) {
+                int32_t offset = offsets[k * count + i];
+                if (!checked || offset >= 0) {
+                    value = fmadd(input[offset], weights[k * count + i], value);
+                }
+            }
+            output[i] = value;
+        }
+    }
+
+    template <bool checked>
+    void gather_float_channels_last(const int32_t* offsets, const float* weights, int numTaps, size_t count,
+                                    const float* input, size_t C, size_t pitch, float* output) {
+        for (size_t i = 0; i < count; i++) {
+            float* output_i = output + i * pitch;
+            size_t c = 0;
+
+            // the corner reads are contiguous across channels, so they vectorize without gathers
+#if defined(__AVX512F__)
+            for (; c + 16 <= C; c += 16) {
+                __m512 value = _mm512_setzero_ps();
+                for (int k = 0; k < numTaps; k++) {
+                    int32_t offset = offsets[k * count + i];
+                    if (!checked || offset >= 0) {
+                        value = _mm512_fmadd_ps(_mm512_loadu_ps(input + offset + c),
+                                                _mm512_set1_ps(weights[k * count + i]), value);
+                    }
+                }
+                _mm512_storeu_ps(output_i + c, value);
+            }
+#endif
+
+#if defined(__AVX2__) && defined(__FMA__)
+            for (; c + 8 <= C; c += 8) {
+                __m256 value = _mm256_setzero_ps();
+                for (int k = 0; k < numTaps; k++) {
+                    int32_t offset = offsets[k * count + i];
+                    if (!checked || offset >= 0) {
+                        value = _mm256_fmadd_ps(_mm256_loadu_ps(input + offset + c),
+                                                _mm256_set1_ps(weights[k * count + i]), value);
+                    }
+                }
+                _mm256_storeu_ps(output_i + c, value);
+            }
+#endif
+
+            for (; c < C; c++) {
+                float value = 0.f;
+                for (int k = 0; k < numTaps; k++) {
+                    int32_t offset = offsets[k * count + i];
+                    if (!checked || offset >= 0) {
+                        value = fmadd(input[offset + c], weights[k * count + i], value);
+                    }
+                }
+                output_i[c] = value;
+            }
+            for (c = C; c < pitch; c++) {
+                output_i[c] = 0.f;
+            }
+        }
+    }
+} // namespace
+
+bool grid_sample_3d_cpu_simd_available() {
+#if defined(__AVX512F__)
+    return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#elif defined(__AVX2__) && defined(__FMA__)
+    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#else
+    return false;
+#endif
+}
+
+void grid_sample_3d_cpu_simd_gather(
+    const int32_t* offsets,
+    const float* weights,
+    int numTaps,
+    size_t count,
+    bool checked,
+    const float* input,
+    float* output
+) {
+    if (checked) {
+        gather_float<true>(offsets, weights, numTaps, count, input, output);
+    } else {
+        gather_float<false>(offsets, weights, numTaps, count, input, output);
+    }
+}
+
+void grid_sample_3d_cpu_simd_gather_channels_last(
+    const int32_t* offsets,
+    const float* weights,
+    int numTaps,
+    size_t count,
+    bool checked,
+    const float* input,
+    size_t C, size_t pitch,
+    float* output
+) {
+    if (checked) {
+        gather_float_channels_last<true>(offsets, weights, numTaps, count, input, C, pitch, output);
+    } else {
+        gather_float_channels_last<false>(offsets, weights, numTaps, count, input, C, pitch, output);
+    }
+}
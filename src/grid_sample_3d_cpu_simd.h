@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Vector fp32 gathers of the CPU backend. grid_sample_3d_cpu_simd.cpp is the only file built with
+// the ISA of GRID_SAMPLE_3D_CPU_AVX2 / GRID_SAMPLE_3D_CPU_AVX512, so the library loads on any x86-64
+// host; the gathers below may only run once grid_sample_3d_cpu_simd_available() returned true.
+
+// true when the file was built with a vector ISA and the running CPU supports it
+bool grid_sample_3d_cpu_simd_available();
+
+// grid_sample_3d_cpu_gather<float> on taps stored tap-major ([k * count + i]); `checked` skips
+// offsets of -1.
+void grid_sample_3d_cpu_simd_gather(
+    const int32_t* offsets,
+    const float* weights,
+    int numTaps,
+    size_t count,
+    bool checked,
+    const float* input,
+    float* output
+);
+
+// grid_sample_3d_cpu_gather_channels_last<float> on the same taps.
+void grid_sample_3d_cpu_simd_gather_channels_last(
+    const int32_t* offsets,
+    const float* weights,
+    int numTaps,
+    size_t count,
+    bool checked,
+    const float* input,
+    size_t C, size_t pitch,
+    float* output
+);
@@ -0,0 +1,191 @@
+#include "grid_sample_3d.h"
+#include "grid_sample_3d_cpu.h"
+#include "grid_sample_3d_thread_pool.h"
+
+#include <algorithm>
+#include <climits>
+#include <cstring>
+
+#include <cuda_fp16.h>
+
+using half = __half;
+using bfloat16 = __nv_bfloat16;
+
+struct GridSample3DPlan {
+    size_t N;
+    size_t D_in, H_in, W_in;
+    size_t D_grid, H_grid, W_grid;
+    size_t runs_per_batch;
+    // N * runs_per_batch runs; a run with no taps lies entirely outside the input
+    std::vector<GridSample3DTaps> runs;
+};
+
+namespace
+{
+    // Drops the taps that are out of bounds for every voxel of the run (e.g. a corner plane
+    // beyond the volume border). Those taps only ever add 0, so the result is unchanged bit for bit.
+    void fold_out_of_bounds_taps(GridSample3DTaps& taps) {
+        const size_t count = taps.count;
+        int kept = 0;
+        for (int k = 0; k < taps.numTaps; k++) {
+            const int32_t* offsets = taps.offsets.data() + k * count;
+            bool used = std::any_of(offsets, offsets + count, [](int32_t offset) { return offset >= 0; });
+            if (!used) {
+                continue;
+            }
+            if (kept != k) {
+                std::copy(offsets, offsets + count, taps.offsets.data() + kept * count);
+                std::copy(taps.weights.data() + k * count, taps.weights.data() + (k + 1) * count,
+                          taps.weights.data() + kept * count);
+            }
+            kept++;
+        }
+        taps.resize(kept, count);
+        taps.offsets.shrink_to_fit();
+        taps.weights.shrink_to_fit();
+    }
+} // namespace
+
+template <typename grid_t>
+GridSample3DPlan* grid_sample_3d_plan_create(
+    const grid_t* grid,
+    size_t N, size_t D_in, size_t H_in, size_t W_in,
+    size_t D_grid, size_t H_grid, size_t W_grid,
+    bool align_corners,
+    GridSample3DInterpolationMode interpolationMode,
+    GridSample3DPaddingMode paddingMode
+) {
+    if (interpolationMode != GridSample3DInterpolationMode::Bilinear &&
+        interpolationMode != GridSample3DInterpolationMode::Nearest) {
+        return nullptr;
+    }
+    if (D_in * H_in * W_in > static_cast<size_t>(INT32_MAX)) {
+        return nullptr;
+    }
+
+    const GridSample3DTapGeometry geometry{
+        static_cast<int>(D_in), static_cast<int>(H_in), static_cast<int>(W_in),
+        static_cast<int64_t>(H_in * W_in), static_cast<int64_t>(W_in), 1,
+        align_corners, interpolationMode, paddingMode};
+
+    auto plan = new GridSample3DPlan();
+    plan->N = N;
+    plan->D_in = D_in;
+    plan->H_in = H_in;
+    plan->W_in = W_in;
+    plan->D_grid = D_grid;
+    plan->H_grid = H_grid;
+    plan->W_grid = W_grid;
+
+    const size_t spatial = D_grid * H_grid * W_grid;
+    const size_t grid_stride_N = spatial * 3;
+    plan->runs_per_batch = (spatial + GRID_SAMPLE_3D_CPU_RUN - 1) / GRID_SAMPLE_3D_CPU_RUN;
+    plan->runs.resize(N * plan->runs_per_batch);
+
+    GridSample3DThreadPool::instance().parallelFor(plan->runs.size(), 1, [&](size_t begin, size_t end) {
+        for (size_t run = begin; run < end; run++) {
+            const size_t n = run / plan->runs_per_batch;
+            const size_t s_begin = (run % plan->runs_per_batch) * GRID_SAMPLE_3D_CPU_RUN;
+            const size_t s_count = std::min<size_t>(GRID_SAMPLE_3D_CPU_RUN, spatial - s_begin);
+            GridSample3DTaps& taps = plan->runs[run];
+            grid_sample_3d_cpu_compute_run_taps(geometry, grid + n * grid_stride_N + s_begin * 3, s_count, taps);
+            fold_out_of_bounds_taps(taps);
+        }
+    });
+
+    return plan;
+}
+
+template <typename scalar_t>
+int grid_sample_3d_plan_apply(
+    const GridSample3DPlan* plan,
+    const scalar_t* input,
+    size_t N, size_t C,
+    scalar_t* output
+) {
+    // a single-grid plan is broadcast over the batch
+    if (!plan || (N != plan->N && plan->N != 1)) {
+        return 1;
+    }
+
+    const size_t input_stride_C = plan->D_in * plan->H_in * plan->W_in;
+    const size_t input_stride_N = C * input_stride_C;
+    const size_t output_stride_C = plan->D_grid * plan->H_grid * plan->W_grid;
+    const size_t output_stride_N = C * output_stride_C;
+    const size_t runs_per_batch = plan->runs_per_batch;
+
+    GridSample3DThreadPool::instance().parallelFor(N * runs_per_batch, 1, [&](size_t begin, size_t end) {
+        for (size_t run = begin; run < end; run++) {
+            const size_t n = run / runs_per_batch;
+            const size_t s_begin = (run % runs_per_batch) * GRID_SAMPLE_3D_CPU_RUN;
+            const GridSample3DTaps& taps = plan->runs[plan->N == 1 ? run % runs_per_batch : run];
+
+            const scalar_t* input_NC = input + n * input_stride_N;
+            scalar_t* output_NC = output + n * output_stride_N + s_begin;
+            for (size_t c = 0; c < C; c++) {
+                if (taps.numTaps == 0) {
+                    std::memset(static_cast<void*>(output_NC), 0, taps.count * sizeof(scalar_t));
+                } else {
+                    grid_sample_3d_cpu_gather<scalar_t>(taps, input_NC, output_NC);
+                }
+                input_NC += input_stride_C;
+                output_NC += output_stride_C;
+            }
+        }
+    });
+
+    return 0;
+}
+
+void grid_sample_3d_plan_destroy(GridSample3DPlan* plan) {
+    delete plan;
+}
+
+// template specialization
+template GridSample3DPlan* grid_sample_3d_plan_create<float>(
+    const float* grid,
+    size_t N, size_t D_in, size_t H_in, size_t W_in,
+    size_t D_grid, size_t H_grid, size_t W_grid,
+    bool align_corners,
+    GridSample3DInterpolationMode interpolationMode,
+    GridSample3DPaddingMode paddingMode
+);
+
+template GridSample3DPlan* grid_sample_3d_plan_create<half>(
+    const half* grid,
+    size_t N, size_t D_in, size_t H_in, size_t W_in,
+    size_t D_grid, size_t H_grid, size_t W_grid,
+    bool align_corners,
+    GridSample3DInterpolationMode interpolationMode,
+    GridSample3DPaddingMode paddingMode
+);
+
+template GridSample3DPlan* grid_sample_3d_plan_create<bfloat16>(
+    const bfloat16* grid,
+    size_t N, size_t D_in, size_t H_in, size_t W_in,
+    size_t D_grid, size_t H_grid, size_t W_grid,
+    bool align_corners,
+    GridSample3DInterpolationMode interpolationMode,
+    GridSample3DPaddingMode paddingMode
+);
+
+template int grid_sample_3d_plan_apply<float>(
+    const GridSample3DPlan* plan,
+    const float* input,
+    size_t N, size_t C,
+    float* output
+);
+
+template int grid_sample_3d_plan_apply<half>(
+    const GridSample3DPlan* plan,
+    const half* input,
+    size_t N, size_t C,
+    half* output
+);
+
+template int grid_sample_3d_plan_apply<bfloat16>(
+    const GridSample3DPlan* plan,
+    const bfloat16* input,
+    size_t N, size_t C,
+    bfloat16* output
+);
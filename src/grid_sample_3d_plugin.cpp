@@ -1,18 +1,23 @@
 #include "grid_sample_3d_plugin.h"
 
+#include <algorithm>
 #include <cstring>
 #include <cassert>
-#include <iostream>
 
 #include <cuda_fp16.h>
 #include <NvInfer.h>
 #include <NvInferPlugin.h>
 
 #include "grid_sample_3d.h"
+#include "grid_sample_3d_profile.h"
 
 using namespace nvinfer1;
+using nvinfer1::plugin::AffineGridSample3DPlugin;
+using nvinfer1::plugin::AffineGridSample3DPluginCreator;
 using nvinfer1::plugin::GridSample3DPlugin;
 using nvinfer1::plugin::GridSample3DPluginCreator;
+using nvinfer1::plugin::RaggedGridSample3DPlugin;
+using nvinfer1::plugin::RaggedGridSample3DPluginCreator;
 
 using half = __half;
 
@@ -21,11 +26,17 @@ namespace
 {
     static const AsciiChar *GRID_SAMPLER_PLUGIN_VERSION = "1";
     static const AsciiChar *GRID_SAMPLER_PLUGIN_NAME = "GridSample3D";
+    static const AsciiChar *AFFINE_GRID_SAMPLER_PLUGIN_NAME = "AffineGridSample3D";
+    static const AsciiChar *RAGGED_GRID_SAMPLER_PLUGIN_NAME = "RaggedGridSample3D";
     static const AsciiChar *GRID_SAMPLER_PLUGIN_NAMESPACE = "";
 } // namespace
 
 PluginFieldCollection GridSample3DPluginCreator::mFC{};
 std::vector<PluginField> GridSample3DPluginCreator::mPluginAttributes;
+PluginFieldCollection AffineGridSample3DPluginCreator::mFC{};
+std::vector<PluginField> AffineGridSample3DPluginCreator::mPluginAttributes;
+PluginFieldCollection RaggedGridSample3DPluginCreator::mFC{};
+std::vector<PluginField> RaggedGridSample3DPluginCreator::mPluginAttributes;
 
 // utility helpers, keep same layout as original serialization
 template <typename scalar_t>
@@ -43,6 +54,183 @@ scalar_t readFromBuffer(const char *&buffer)
     return val;
 }
 
+// the layout follows the format TensorRT picked for input/output, so it is never serialized
+static GridSample3DLayout toLayout(TensorFormat format)
+{
+    return format == TensorFormat::kDHWC8 ? GridSample3DLayout::NDHWC8 : GridSample3DLayout::NCDHW;
+}
+
+static bool isSupportedType(DataType dataType)
+{
+    return dataType == DataType::kFLOAT || dataType == DataType::kHALF || dataType == DataType::kBF16;
+}
+
+static bool isQuantizedType(DataType dataType)
+{
+    return dataType == DataType::kINT8 || dataType == DataType::kUINT8;
+}
+
+static size_t elementSize(DataType dataType)
+{
+    switch (dataType)
+    {
+    case DataType::kHALF:
+    case DataType::kBF16:
+        return 2;
+    case DataType::kINT8:
+    case DataType::kUINT8:
+        return 1;
+    default:
+        return 4;
+    }
+}
+
+static GridSample3DDataType toDataType(DataType dataType)
+{
+    switch (dataType)
+    {
+    case DataType::kHALF:
+        return GridSample3DDataType::GHALF;
+    case DataType::kBF16:
+        return GridSample3DDataType::GBF16;
+    case DataType::kINT8:
+        return GridSample3DDataType::GINT8;
+    case DataType::kUINT8:
+        return GridSample3DDataType::GUINT8;
+    case DataType::kINT32:
+        return GridSample3DDataType::GINT32;
+    default:
+        return GridSample3DDataType::GFLOAT;
+    }
+}
+
+// the "tactic" field: blockSize, voxelsPerThread, channelsPerThread, tileVoxels, numThreads, traversal
+static const int32_t TACTIC_FIELD_LENGTH = 6;
+
+static void writeTactic(const GridSample3DTactic &tactic, int32_t *values)
+{
+    values[0] = tactic.blockSize;
+    values[1] = tactic.voxelsPerThread;
+    values[2] = tactic.channelsPerThread;
+    values[3] = tactic.tileVoxels;
+    values[4] = tactic.numThreads;
+    values[5] = static_cast<int32_t>(tactic.traversal);
+}
+
+static GridSample3DTactic readTactic(const int32_t *values)
+{
+    GridSample3DTactic tactic;
+    tactic.blockSize = values[0];
+    tactic.voxelsPerThread = values[1];
+    tactic.channelsPerThread = values[2];
+    tactic.tileVoxels = values[3];
+    tactic.numThreads = values[4];
+    if (values[5] >= 0 && values[5] <= static_cast<int32_t>(GridSample3DTraversal::Morton))
+    {
+        tactic.traversal = static_cast<GridSample3DTraversal>(values[5]);
+    }
+    return tactic;
+}
+
+// grid_kind is either a string ("absolute", "displacement_voxels", "displacement_normalized")
+// or the GridSample3DGridKind value as an int
+static bool parseGridKind(const PluginField &field, GridSample3DGridKind &gridKind)
+{
+    if (field.type == PluginFieldType::kCHAR)
+    {
+        std::string value(static_cast<const char *>(field.data), field.length);
+        value = value.c_str(); // drop a trailing NUL counted in length
+        if (value == "absolute")
+        {
+            gridKind = GridSample3DGridKind::Absolute;
+        }
+        else if (value == "displacement_voxels")
+        {
+            gridKind = GridSample3DGridKind::DisplacementVoxels;
+        }
+        else if (value == "displacement_normalized")
+        {
+            gridKind = GridSample3DGridKind::DisplacementNormalized;
+        }
+        else
+        {
+            return false;
+        }
+        return true;
+    }
+    int value = *reinterpret_cast<const int *>(field.data);
+    if (value < 0 || value > static_cast<int>(GridSample3DGridKind::DisplacementNormalized))
+    {
+        return false;
+    }
+    gridKind = static_cast<GridSample3DGridKind>(value);
+    return true;
+}
+
+// bucketing is either a string ("off", "on", "auto") or the GridSample3DBucketing value as an int
+static bool parseBucketing(const PluginField &field, GridSample3DBucketing &bucketing)
+{
+    if (field.type == PluginFieldType::kCHAR)
+    {
+        std::string value(static_cast<const char *>(field.data), field.length);
+        value = value.c_str(); // drop a trailing NUL counted in length
+        if (value == "off")
+        {
+            bucketing = GridSample3DBucketing::Off;
+        }
+        else if (value == "on")
+        {
+            bucketing = GridSample3DBucketing::On;
+        }
+        else if (value == "auto")
+        {
+            bucketing = GridSample3DBucketing::Auto;
+        }
+        else
+        {
+            return false;
+        }
+        return true;
+    }
+    int value = *reinterpret_cast<const int *>(field.data);
+    if (value < 0 || value > static_cast<int>(GridSample3DBucketing::Auto))
+    {
+        return false;
+    }
+    bucketing = static_cast<GridSample3DBucketing>(value);
+    return true;
+}
+
+// point_layout is either a string ("npc", "ncp") or the GridSample3DPointLayout value as an int
+static bool parsePointLayout(const PluginField &field, GridSample3DPointLayout &pointLayout)
+{
+    if (field.type == PluginFieldType::kCHAR)
+    {
+        std::string value(static_cast<const char *>(field.data), field.length);
+        value = value.c_str(); // drop a trailing NUL counted in length
+        if (value == "npc")
+        {
+            pointLayout = GridSample3DPointLayout::NPC;
+        }
+        else if (value == "ncp")
+        {
+            pointLayout = GridSample3DPointLayout::NCP;
+        }
+        else
+        {
+            return false;
+        }
+        return true;
+    }
+    int value = *reinterpret_cast<const int *>(field.data);
+    if (value < 0 || value > static_cast<int>(GridSample3DPointLayout::NCP))
+    {
+        return false;
+    }
+    pointLayout = static_cast<GridSample3DPointLayout>(value);
+    return true;
+}
+
 // Constructors
 GridSample3DPlugin::GridSample3DPlugin(const std::string name,
                                        size_t inputChannel,
@@ -55,7 +243,8 @@ GridSample3DPlugin::GridSample3DPlugin(const std::string name,
                                        bool alignCorners,
                                        GridSample3DInterpolationMode interpolationMode,
                                        GridSample3DPaddingMode paddingMode,
-                                       DataType dataType)
+                                       DataType dataType,
+                                       GridSample3DGridKind gridKind)
     : mLayerName(name),
       mInputChannel(inputChannel),
       mInputDepth(inputDepth),
@@ -67,7 +256,11 @@ GridSample3DPlugin::GridSample3DPlugin(const std::string name,
       mAlignCorners(alignCorners),
       mInterpolationMode(interpolationMode),
       mPaddingMode(paddingMode),
+      mGridKind(gridKind),
       mDataType(dataType),
+      mGridDataType(dataType),
+      mLayout(GridSample3DLayout::NCDHW),
+      mLauncher(nullptr),
       mBatch(0)
 {
 }
@@ -75,11 +268,13 @@ GridSample3DPlugin::GridSample3DPlugin(const std::string name,
 GridSample3DPlugin::GridSample3DPlugin(const std::string name,
                                        bool alignCorners,
                                        GridSample3DInterpolationMode interpolationMode,
-                                       GridSample3DPaddingMode paddingMode)
+                                       GridSample3DPaddingMode paddingMode,
+                                       GridSample3DGridKind gridKind)
     : mLayerName(name),
       mAlignCorners(alignCorners),
       mInterpolationMode(interpolationMode),
       mPaddingMode(paddingMode),
+      mGridKind(gridKind),
       mBatch(0),
       mInputChannel(0),
       mInputDepth(0),
@@ -88,12 +283,18 @@ GridSample3DPlugin::GridSample3DPlugin(const std::string name,
       mGridDepth(0),
       mGridHeight(0),
       mGridWidth(0),
-      mDataType(DataType::kFLOAT)
+      mDataType(DataType::kFLOAT),
+      mGridDataType(DataType::kFLOAT),
+      mLayout(GridSample3DLayout::NCDHW),
+      mLauncher(nullptr)
 {
 }
 
 GridSample3DPlugin::GridSample3DPlugin(const std::string name, const void *buffer, size_t buffer_size)
-    : mLayerName(name)
+    : mLayerName(name),
+      mGridKind(GridSample3DGridKind::Absolute),
+      mLayout(GridSample3DLayout::NCDHW),
+      mLauncher(nullptr)
 {
     const char *data = reinterpret_cast<const char *>(buffer);
     const char *start = data;
@@ -108,13 +309,50 @@ GridSample3DPlugin::GridSample3DPlugin(const std::string name, const void *buffe
     mInterpolationMode = readFromBuffer<GridSample3DInterpolationMode>(data);
     mPaddingMode = readFromBuffer<GridSample3DPaddingMode>(data);
     mDataType = readFromBuffer<DataType>(data);
+    mGridDataType = mDataType;
+    // buffers written before the tactic (or the bucketing mode, the bounds prepass or the point
+    // layout) was serialized keep the default one
+    if (buffer_size >= getSerializationSize() - 3 * sizeof(int32_t))
+    {
+        int32_t tactic[TACTIC_FIELD_LENGTH];
+        for (int32_t i = 0; i < TACTIC_FIELD_LENGTH; i++)
+        {
+            tactic[i] = readFromBuffer<int32_t>(data);
+        }
+        mTactic = readTactic(tactic);
+    }
+    if (buffer_size >= getSerializationSize() - 2 * sizeof(int32_t))
+    {
+        const int32_t bucketing = readFromBuffer<int32_t>(data);
+        if (bucketing >= 0 && bucketing <= static_cast<int32_t>(GridSample3DBucketing::Auto))
+        {
+            mTactic.bucketing = static_cast<GridSample3DBucketing>(bucketing);
+        }
+    }
+    if (buffer_size >= getSerializationSize() - sizeof(int32_t))
+    {
+        mTactic.tileBounds = readFromBuffer<int32_t>(data) != 0;
+    }
+    if (buffer_size >= getSerializationSize())
+    {
+        const int32_t pointLayout = readFromBuffer<int32_t>(data);
+        if (pointLayout >= 0 && pointLayout <= static_cast<int32_t>(GridSample3DPointLayout::NCP))
+        {
+            mPointLayout = static_cast<GridSample3DPointLayout>(pointLayout);
+        }
+    }
 
     // verify expected size
-    assert(static_cast<size_t>(data - start) == (sizeof(size_t) * 7 + sizeof(bool) +
-                                                 sizeof(GridSample3DInterpolationMode) + sizeof(GridSample3DPaddingMode) + sizeof(DataType)));
+    assert(static_cast<size_t>(data - start) <= getSerializationSize());
 }
 
-GridSample3DPlugin::~GridSample3DPlugin() noexcept {}
+GridSample3DPlugin::~GridSample3DPlugin() noexcept
+{
+    if (mDeviceChannelQuantization != nullptr)
+    {
+        cudaFree(mDeviceChannelQuantization);
+    }
+}
 
 // IPluginV3
 IPluginCapability *GridSample3DPlugin::getCapabilityInterface(PluginCapabilityType type) noexcept
@@ -151,7 +389,20 @@ IPluginV3 *GridSample3DPlugin::clone() noexcept
                                          mAlignCorners,
                                          mInterpolationMode,
                                          mPaddingMode,
-                                         mDataType);
+                                         mDataType,
+                                         mGridKind);
+    plugin->mGridDataType = mGridDataType;
+    plugin->mLayout = mLayout;
+    plugin->mLauncher = mLauncher;
+    plugin->mTactic = mTactic;
+    plugin->mMasked = mMasked;
+    plugin->mPoints = mPoints;
+    plugin->mPointLayout = mPointLayout;
+    plugin->mTacticVoxels = mTacticVoxels;
+    plugin->mTacticSized = mTacticSized;
+    plugin->mTacticChannels = mTacticChannels;
+    // setQuantization uploads the clone's own copy of the per-channel parameters
+    plugin->setQuantization(mInputScale, mInputZeroPoint, mOutputScale, mOutputZeroPoint, mQuantizedOutput);
     plugin->setPluginNamespace(mNameSpace.c_str());
     return plugin;
 }
@@ -169,7 +420,7 @@ int32_t GridSample3DPlugin::getOutputDataTypes(
     // keep same behavior as previous getOutputDataType
     assert(nbOutputs == 1);
     assert(nbInputs >= 1);
-    outputTypes[0] = inputTypes[0];
+    outputTypes[0] = outputDataType(inputTypes[0]);
     return 0;
 }
 
@@ -179,9 +430,23 @@ int32_t GridSample3DPlugin::getOutputShapes(DimsExprs const *inputs, int32_t nbI
     assert(nbInputs >= 2);
     assert(outputs != nullptr);
     assert(inputs[0].nbDims == 5);
-    assert(inputs[1].nbDims == 5);
+    assert(inputs[1].nbDims == 5 || inputs[1].nbDims == 3);
+    // the optional mask (N, D_grid, H_grid, W_grid) or (N, P) does not change the output
+    assert(nbInputs == 2 || inputs[2].nbDims == inputs[1].nbDims - 1);
 
     DimsExprs gridDim = inputs[1];
+    if (gridDim.nbDims == 3)
+    {
+        // point list (N, P, 3): output (N, P, C) or (N, C, P)
+        const bool npc = mPointLayout == GridSample3DPointLayout::NPC;
+        DimsExprs output;
+        output.nbDims = 3;
+        output.d[0] = inputs[0].d[0];
+        output.d[1] = npc ? gridDim.d[1] : inputs[0].d[1];
+        output.d[2] = npc ? inputs[0].d[1] : gridDim.d[1];
+        outputs[0] = output;
+        return 0;
+    }
     DimsExprs output(inputs[0]);
     // layout: input dims: N, C, D, H, W (nbDims=5)
     // grid dims: N, D_grid, H_grid, W_grid, 3  (nbDims=5)
@@ -198,13 +463,66 @@ bool GridSample3DPlugin::supportsFormatCombination(
     int32_t nbInputs,
     int32_t nbOutputs) noexcept
 {
-    // same logic as before, adapted to DynamicPluginTensorDesc
-    assert(nbInputs == 2 && nbOutputs == 1 && pos < (nbInputs + nbOutputs));
+    // same logic as before, adapted to DynamicPluginTensorDesc; a third input is the output mask
+    assert((nbInputs == 2 || nbInputs == 3) && nbOutputs == 1 && pos < (nbInputs + nbOutputs));
 
-    bool condition = inOut[pos].desc.format == nvinfer1::TensorFormat::kLINEAR;
-    condition &= (inOut[pos].desc.type == nvinfer1::DataType::kFLOAT ||
-                  inOut[pos].desc.type == nvinfer1::DataType::kHALF);
-    condition &= (inOut[pos].desc.type == inOut[0].desc.type);
+    const PluginTensorDesc &desc = inOut[pos].desc;
+    const DataType inputType = inOut[0].desc.type;
+    const bool labels = inputType == DataType::kINT32;
+    const bool quantized = isQuantizedType(inputType);
+    if ((quantized || labels) && !acceptsIntegerInput())
+    {
+        return false;
+    }
+    // int32 inputs are label maps, only meaningful with nearest sampling
+    if (labels && mInterpolationMode != GridSample3DInterpolationMode::Nearest)
+    {
+        return false;
+    }
+    // mipmap sampling builds an fp32 pyramid of a linear float/half/bf16 volume and reads absolute grids
+    if (mInterpolationMode == GridSample3DInterpolationMode::Mipmap &&
+        (quantized || labels || isPointList(inOut[1].desc.dims) || mGridKind != GridSample3DGridKind::Absolute ||
+         desc.format != nvinfer1::TensorFormat::kLINEAR))
+    {
+        return false;
+    }
+    // point lists are linear; the (N, P, C) kernel samples float/half/bf16 with absolute coordinates
+    const bool points = isPointList(inOut[1].desc.dims);
+    if (points && (mGridKind != GridSample3DGridKind::Absolute ||
+                   (mPointLayout == GridSample3DPointLayout::NPC && (quantized || labels)) ||
+                   desc.format != nvinfer1::TensorFormat::kLINEAR))
+    {
+        return false;
+    }
+    if (pos == 2 && nbInputs == 3)
+    {
+        // one byte per output voxel, nonzero where the voxel is sampled
+        return (desc.type == nvinfer1::DataType::kBOOL || desc.type == nvinfer1::DataType::kUINT8) &&
+               desc.format == nvinfer1::TensorFormat::kLINEAR;
+    }
+    bool condition = isSupportedType(desc.type) || (pos == 0 && (quantized || labels));
+    if (pos == 1)
+    {
+        // the grid is N x D x H x W x 3 (or N x P x 3), fp32 or of the input type (fp16 for an integer
+        // input); coordinates are computed in fp32 either way, so an fp32 grid keeps its precision
+        // with a 16-bit volume
+        const DataType narrowGridType = quantized || labels ? nvinfer1::DataType::kHALF : inputType;
+        condition &= (desc.type == nvinfer1::DataType::kFLOAT || desc.type == narrowGridType);
+        return condition && desc.format == nvinfer1::TensorFormat::kLINEAR;
+    }
+    if (pos == nbInputs)
+    {
+        condition = desc.type == outputDataType(inputType);
+    }
+    // input and output are either both linear (NCDHW) or both channels-last (kDHWC8, fp16/bf16 only)
+    bool linear = desc.format == nvinfer1::TensorFormat::kLINEAR;
+    bool channelsLast = desc.format == nvinfer1::TensorFormat::kDHWC8 &&
+                        (desc.type == nvinfer1::DataType::kHALF || desc.type == nvinfer1::DataType::kBF16);
+    condition &= (linear || channelsLast);
+    if (pos == nbInputs)
+    {
+        condition &= (desc.format == inOut[0].desc.format);
+    }
     return condition;
 }
 
@@ -214,31 +532,314 @@ int32_t GridSample3DPlugin::configurePlugin(DynamicPluginTensorDesc const *in,
                                             int32_t nbOutputs) noexcept
 {
     // Previously configurePlugin returned void and set dims; now return int32_t
-    assert(nbInputs == 2 && nbOutputs == 1);
+    assert((nbInputs == 2 || nbInputs == 3) && nbOutputs == 1);
     // for 3d grid sample, the input should be 5 dims
     assert(in[0].desc.dims.nbDims == 5);
-    assert(in[1].desc.dims.nbDims == 5);
-
-    mBatch = in[0].desc.dims.d[0];
-    mInputChannel = in[0].desc.dims.d[1];
-    mInputDepth = in[0].desc.dims.d[2];
-    mInputHeight = in[0].desc.dims.d[3];
-    mInputWidth = in[0].desc.dims.d[4];
-    mGridDepth = in[1].desc.dims.d[1];
-    mGridHeight = in[1].desc.dims.d[2];
-    mGridWidth = in[1].desc.dims.d[3];
-    mDataType = in[0].desc.type;
 
-    assert(mBatch == in[1].desc.dims.d[0]);
-    assert(in[1].desc.dims.d[4] == 3);
+    configureInput(in[0].desc.dims, in[0].desc.type, in[0].desc.format);
+    configureGrid(in[1].desc.dims, in[1].desc.type);
+    configureTacticSizes(in[0], out[0]);
+    mLauncher = selectLauncher();
+    // desc.dims holds -1 for a dynamic extent; per-channel parameters need C fixed by the profile
+    const int64_t channels = in[0].min.d[1] == in[0].max.d[1] ? in[0].max.d[1] : -1;
+    if (!configureQuantization(channels))
+    {
+        return -1;
+    }
+    configureMask(nbInputs == 3 ? &in[2].desc.dims : nullptr);
     return 0;
 }
 
-int32_t GridSample3DPlugin::getWorkspaceSize(PluginTensorDesc const * /*inputs*/,
-                                             int32_t /*nbInputs*/,
-                                             PluginTensorDesc const * /*outputs*/,
-                                             int32_t /*nbOutputs*/) const noexcept
+void GridSample3DPlugin::configureInput(Dims const &dims, DataType type, TensorFormat format)
 {
+    mBatch = dims.d[0];
+    mInputChannel = dims.d[1];
+    mInputDepth = dims.d[2];
+    mInputHeight = dims.d[3];
+    mInputWidth = dims.d[4];
+    mDataType = type;
+    mLayout = toLayout(format);
+}
+
+void GridSample3DPlugin::configureGrid(Dims const &dims, DataType type)
+{
+    assert(dims.nbDims == 5 || dims.nbDims == 3);
+    assert(dims.d[0] == static_cast<int64_t>(mBatch) && dims.d[dims.nbDims - 1] == 3);
+    mGridDataType = type;
+    mPoints = isPointList(dims);
+    mGridDepth = mPoints ? 1 : dims.d[1];
+    mGridHeight = mPoints ? 1 : dims.d[2];
+    mGridWidth = mPoints ? dims.d[1] : dims.d[3];
+}
+
+// the mask, when present, covers the output voxels (N, D_grid, H_grid, W_grid) of the configured
+// shapes, or the points (N, P)
+void GridSample3DPlugin::configureMask(Dims const *dims)
+{
+    mMasked = dims != nullptr;
+    assert(!mMasked || (mPoints && dims->nbDims == 2 && dims->d[0] == static_cast<int64_t>(mBatch) &&
+                        dims->d[1] == static_cast<int64_t>(mGridWidth)) ||
+           (!mPoints && dims->nbDims == 4 && dims->d[0] == static_cast<int64_t>(mBatch) &&
+            dims->d[1] == static_cast<int64_t>(mGridDepth) &&
+            dims->d[2] == static_cast<int64_t>(mGridHeight) &&
+            dims->d[3] == static_cast<int64_t>(mGridWidth)));
+}
+
+// desc.dims holds -1 for a dynamic extent at build time, so the tactic list is sized from the opt
+// shapes of the profile; an unknown extent keeps the full list
+void GridSample3DPlugin::configureTacticSizes(DynamicPluginTensorDesc const &input, DynamicPluginTensorDesc const &output)
+{
+    mTacticSized = true;
+    mTacticVoxels = SIZE_MAX;
+    mTacticChannels = SIZE_MAX;
+    Dims const &out = output.opt;
+    const int64_t channels = input.opt.d[1];
+    size_t elements = 1;
+    for (int32_t i = 0; i < out.nbDims; i++)
+    {
+        if (out.d[i] < 0)
+        {
+            return;
+        }
+        elements *= static_cast<size_t>(out.d[i]);
+    }
+    if (channels <= 0)
+    {
+        return;
+    }
+    // the output holds C values per sampled voxel in every layout
+    mTacticVoxels = elements / static_cast<size_t>(channels);
+    mTacticChannels = static_cast<size_t>(channels);
+}
+
+// resolved once per shape change so enqueue launches the specialized kernels without dispatching
+GridSample3DCudaLauncher GridSample3DPlugin::selectLauncher() const
+{
+    if (isLabelMap())
+    {
+        return grid_sample_3d_labels_cuda_select(toDataType(mDataType), toDataType(mGridDataType), mPaddingMode,
+                                                 mAlignCorners, mGridKind);
+    }
+    if (!isSupportedType(mDataType) || !isSupportedType(mGridDataType))
+    {
+        return nullptr;
+    }
+    if (mPoints)
+    {
+        return grid_sample_3d_points_cuda_select(toDataType(mDataType), toDataType(mGridDataType), mInterpolationMode,
+                                                 mPaddingMode, mAlignCorners, mPointLayout);
+    }
+    return grid_sample_3d_cuda_select(toDataType(mDataType), toDataType(mGridDataType), mInterpolationMode, mPaddingMode,
+                                      mAlignCorners, mGridKind);
+}
+
+bool GridSample3DPlugin::acceptsIntegerInput() const
+{
+    return true;
+}
+
+bool GridSample3DPlugin::isPointList(Dims const &dims) const
+{
+    return dims.nbDims == 3;
+}
+
+size_t GridSample3DPlugin::gridBytes() const
+{
+    return mBatch * mGridDepth * mGridHeight * mGridWidth * 3 * elementSize(mGridDataType);
+}
+
+// Nearest sampling of an int32 input, or of an int8/uint8 input requantized with its own per-tensor
+// parameters, only copies values: it takes the label path, which skips the dequantize/requantize
+// round trip. With Zeros padding the label path writes 0, so a quantized input also needs a zero
+// point of 0 (or another padding mode) to keep the quantized result.
+bool GridSample3DPlugin::isLabelMap() const
+{
+    if (mInterpolationMode != GridSample3DInterpolationMode::Nearest)
+    {
+        return false;
+    }
+    if (mDataType == DataType::kINT32)
+    {
+        return true;
+    }
+    return isQuantizedType(mDataType) && mQuantizedOutput && mInputScale.size() == 1 && mInputZeroPoint.size() == 1 &&
+           mInputScale[0] == mOutputScale && mInputZeroPoint[0] == mOutputZeroPoint &&
+           (mPaddingMode != GridSample3DPaddingMode::Zeros || mOutputZeroPoint == 0);
+}
+
+DataType GridSample3DPlugin::outputDataType(DataType inputType) const
+{
+    return isQuantizedType(inputType) && !mQuantizedOutput ? DataType::kHALF : inputType;
+}
+
+void GridSample3DPlugin::setQuantization(std::vector<float> const &inputScale,
+                                         std::vector<int32_t> const &inputZeroPoint,
+                                         float outputScale,
+                                         int32_t outputZeroPoint,
+                                         bool quantizedOutput)
+{
+    mInputScale = inputScale;
+    mInputZeroPoint = inputZeroPoint;
+    mOutputScale = outputScale;
+    mOutputZeroPoint = outputZeroPoint;
+    mQuantizedOutput = quantizedOutput;
+    uploadChannelQuantization();
+}
+
+void GridSample3DPlugin::setLaunchTactic(GridSample3DTactic const &tactic)
+{
+    mTactic = tactic;
+}
+
+void GridSample3DPlugin::setPointLayout(GridSample3DPointLayout pointLayout)
+{
+    mPointLayout = pointLayout;
+}
+
+void GridSample3DPlugin::uploadChannelQuantization()
+{
+    if (mDeviceChannelQuantization != nullptr)
+    {
+        cudaFree(mDeviceChannelQuantization);
+        mDeviceChannelQuantization = nullptr;
+    }
+    mChannelQuantizationCount = 0;
+    const size_t channels = std::max(mInputScale.size(), mInputZeroPoint.size());
+    if (channels <= 1)
+    {
+        return;
+    }
+    if ((mInputScale.size() != 1 && mInputScale.size() != channels) ||
+        (mInputZeroPoint.size() != 1 && mInputZeroPoint.size() != channels))
+    {
+        grid_sample_3d_log(GridSample3DLogSeverity::Error, "GridSample3D: input_scale and input_zero_point need 1 or C values");
+        return;
+    }
+    // both arrays are expanded to C values so one upload covers either
+    std::vector<float> scales(channels, mInputScale[0]);
+    std::vector<int32_t> zeroPoints(channels, mInputZeroPoint[0]);
+    if (mInputScale.size() == channels)
+    {
+        scales = mInputScale;
+    }
+    if (mInputZeroPoint.size() == channels)
+    {
+        zeroPoints = mInputZeroPoint;
+    }
+    const size_t bytes = channels * (sizeof(float) + sizeof(int32_t));
+    if (cudaMalloc(&mDeviceChannelQuantization, bytes) != cudaSuccess)
+    {
+        mDeviceChannelQuantization = nullptr;
+        grid_sample_3d_log(GridSample3DLogSeverity::Error, "GridSample3D: cannot allocate the per-channel parameters");
+        return;
+    }
+    float *deviceScales = static_cast<float *>(mDeviceChannelQuantization);
+    int32_t *deviceZeroPoints = reinterpret_cast<int32_t *>(deviceScales + channels);
+    if (cudaMemcpy(deviceScales, scales.data(), channels * sizeof(float), cudaMemcpyHostToDevice) != cudaSuccess ||
+        cudaMemcpy(deviceZeroPoints, zeroPoints.data(), channels * sizeof(int32_t), cudaMemcpyHostToDevice) != cudaSuccess)
+    {
+        cudaFree(mDeviceChannelQuantization);
+        mDeviceChannelQuantization = nullptr;
+        grid_sample_3d_log(GridSample3DLogSeverity::Error, "GridSample3D: cannot upload the per-channel parameters");
+        return;
+    }
+    mChannelQuantizationCount = channels;
+}
+
+bool GridSample3DPlugin::configureQuantization(int64_t channels)
+{
+    mQuantizedLauncher = nullptr;
+    if (!isQuantizedType(mDataType) || isLabelMap())
+    {
+        return true;
+    }
+
+    mInputQuantization = GridSample3DQuantization();
+    mInputQuantization.scale = mInputScale[0];
+    mInputQuantization.zeroPoint = mInputZeroPoint[0];
+    mOutputQuantization = GridSample3DQuantization();
+    mOutputQuantization.scale = mOutputScale;
+    mOutputQuantization.zeroPoint = mOutputZeroPoint;
+
+    if (mInputScale.size() > 1 || mInputZeroPoint.size() > 1)
+    {
+        if (mDeviceChannelQuantization == nullptr)
+        {
+            // setQuantization logged why
+            return false;
+        }
+        if (channels < 0 || static_cast<size_t>(channels) != mChannelQuantizationCount)
+        {
+            grid_sample_3d_log(GridSample3DLogSeverity::Error,
+                               "GridSample3D: %zu per-channel input parameters need a static C of %zu, got %lld",
+                               mChannelQuantizationCount, mChannelQuantizationCount, static_cast<long long>(channels));
+            return false;
+        }
+        float *deviceScales = static_cast<float *>(mDeviceChannelQuantization);
+        mInputQuantization.channelScale = deviceScales;
+        mInputQuantization.channelZeroPoint = reinterpret_cast<int32_t *>(deviceScales + mChannelQuantizationCount);
+    }
+
+    if (!isSupportedType(mGridDataType))
+    {
+        return true;
+    }
+    mQuantizedLauncher = grid_sample_3d_quantized_cuda_select(toDataType(mDataType), toDataType(outputDataType(mDataType)),
+                                                              toDataType(mGridDataType), mInterpolationMode, mPaddingMode,
+                                                              mAlignCorners, mGridKind);
+    return true;
+}
+
+size_t GridSample3DPlugin::getWorkspaceSize(DynamicPluginTensorDesc const *inputs,
+                                            int32_t /*nbInputs*/,
+                                            DynamicPluginTensorDesc const *outputs,
+                                            int32_t /*nbOutputs*/) const noexcept
+{
+    if (mInterpolationMode == GridSample3DInterpolationMode::Mipmap)
+    {
+        // the pyramid of the largest input; mipmap sampling neither buckets nor runs the bounds prepass
+        Dims const &in = inputs[0].max;
+        return grid_sample_3d_mipmap_workspace_size(in.d[0], in.d[1], in.d[2], in.d[3], in.d[4]);
+    }
+    if (mTactic.bucketing == GridSample3DBucketing::Off && !mTactic.tileBounds)
+    {
+        return 0;
+    }
+    // N, C, D, H, W of the input and the output at the top of the optimization profile
+    Dims const &in = inputs[0].max;
+    Dims const &out = outputs[0].max;
+    if (out.nbDims == 3)
+    {
+        // a point list (N, P, 3) is sampled as a 1 x 1 x P grid
+        Dims const &points = inputs[1].max;
+        return grid_sample_3d_workspace_size(mTactic, points.d[0], in.d[2], in.d[3], in.d[4], 1, 1, points.d[1]);
+    }
+    return grid_sample_3d_workspace_size(mTactic, out.d[0], in.d[2], in.d[3], in.d[4], out.d[2], out.d[3], out.d[4]);
+}
+
+std::vector<GridSample3DTactic> GridSample3DPlugin::tacticCandidates() const
+{
+    return grid_sample_3d_tactic_candidates(GridSample3DBackend::CUDA, mTacticVoxels, tacticChannels());
+}
+
+// NCDHW has one gridDim.y slice per channel group, the channels-last kernels cover all channels
+size_t GridSample3DPlugin::tacticChannels() const
+{
+    return mLayout == GridSample3DLayout::NCDHW ? mTacticChannels : 0;
+}
+
+int32_t GridSample3DPlugin::getNbTactics() noexcept
+{
+    return static_cast<int32_t>(tacticCandidates().size());
+}
+
+int32_t GridSample3DPlugin::getValidTactics(int32_t *tactics, int32_t nbTactics) noexcept
+{
+    const int32_t count = std::min(nbTactics, getNbTactics());
+    for (int32_t i = 0; i < count; i++)
+    {
+        tactics[i] = i + 1;
+    }
     return 0;
 }
 
@@ -250,22 +851,17 @@ int32_t GridSample3DPlugin::onShapeChange(PluginTensorDesc const *in,
                                           int32_t nbOutputs) noexcept
 {
     // Called before enqueue at runtime (mirror configurePlugin semantics for runtime)
-    assert(nbInputs == 2 && nbOutputs == 1);
+    assert((nbInputs == 2 || nbInputs == 3) && nbOutputs == 1);
     assert(in[0].dims.nbDims == 5);
-    assert(in[1].dims.nbDims == 5);
-
-    mBatch = in[0].dims.d[0];
-    mInputChannel = in[0].dims.d[1];
-    mInputDepth = in[0].dims.d[2];
-    mInputHeight = in[0].dims.d[3];
-    mInputWidth = in[0].dims.d[4];
-    mGridDepth = in[1].dims.d[1];
-    mGridHeight = in[1].dims.d[2];
-    mGridWidth = in[1].dims.d[3];
-    mDataType = in[0].type;
 
-    assert(mBatch == in[1].dims.d[0]);
-    assert(in[1].dims.d[4] == 3);
+    configureInput(in[0].dims, in[0].type, in[0].format);
+    configureGrid(in[1].dims, in[1].type);
+    mLauncher = selectLauncher();
+    if (!configureQuantization(in[0].dims.d[1]))
+    {
+        return -1;
+    }
+    configureMask(nbInputs == 3 ? &in[2].dims : nullptr);
     return 0;
 }
 
@@ -273,38 +869,43 @@ int32_t GridSample3DPlugin::enqueue(PluginTensorDesc const * /*inputDesc*/,
                                     PluginTensorDesc const * /*outputDesc*/,
                                     void const *const *inputs,
                                     void *const *outputs,
-                                    void * /*workspace*/,
+                                    void *workspace,
                                     cudaStream_t stream) noexcept
 {
-    int status = -1;
-    if (mDataType == DataType::kFLOAT)
+    const uint8_t *mask = mMasked ? static_cast<const uint8_t *>(inputs[2]) : nullptr;
+    const size_t inputVoxels = mBatch * mInputChannel * mInputDepth * mInputHeight * mInputWidth;
+    const size_t outputVoxels = mBatch * mInputChannel * mGridDepth * mGridHeight * mGridWidth;
+    GridSample3DProfileScope profile(getPluginName(),
+                                     GridSample3DProfileShape{mBatch, mInputChannel, mInputDepth, mInputHeight, mInputWidth,
+                                                              mGridDepth, mGridHeight, mGridWidth},
+                                     inputVoxels * elementSize(mDataType) + gridBytes(),
+                                     outputVoxels * elementSize(outputDataType(mDataType)),
+                                     stream);
+    if (mQuantizedLauncher != nullptr)
     {
-        status = grid_sample_3d_cuda<float>(
-            static_cast<const float *>(inputs[0]),
-            static_cast<const float *>(inputs[1]),
-            mBatch, mInputChannel, mInputDepth, mInputHeight, mInputWidth,
-            mGridDepth, mGridHeight, mGridWidth,
-            mAlignCorners,
-            mInterpolationMode,
-            mPaddingMode,
-            static_cast<float *>(outputs[0]),
-            stream);
+        return profile.finish(mQuantizedLauncher(inputs[0], mInputQuantization, inputs[1],
+                                                 mBatch, mInputChannel, mInputDepth, mInputHeight, mInputWidth,
+                                                 mGridDepth, mGridHeight, mGridWidth,
+                                                 outputs[0], mOutputQuantization,
+                                                 stream,
+                                                 mLayout,
+                                                 mTactic,
+                                                 workspace,
+                                                 mask));
     }
-    else if (mDataType == DataType::kHALF)
+    if (mLauncher == nullptr)
     {
-        status = grid_sample_3d_cuda<half>(
-            static_cast<const half *>(inputs[0]),
-            static_cast<const half *>(inputs[1]),
-            mBatch, mInputChannel, mInputDepth, mInputHeight, mInputWidth,
-            mGridDepth, mGridHeight, mGridWidth,
-            mAlignCorners,
-            mInterpolationMode,
-            mPaddingMode,
-            static_cast<half *>(outputs[0]),
-            stream);
+        return profile.finish(-1);
     }
-
-    return status;
+    return profile.finish(mLauncher(inputs[0], inputs[1],
+                                    mBatch, mInputChannel, mInputDepth, mInputHeight, mInputWidth,
+                                    mGridDepth, mGridHeight, mGridWidth,
+                                    outputs[0],
+                                    stream,
+                                    mLayout,
+                                    mTactic,
+                                    workspace,
+                                    mask));
 }
 
 IPluginV3 *GridSample3DPlugin::attachToContext(IPluginResourceContext * /*context*/) noexcept
@@ -314,6 +915,13 @@ IPluginV3 *GridSample3DPlugin::attachToContext(IPluginResourceContext * /*contex
     return clone();
 }
 
+int32_t GridSample3DPlugin::setTactic(int32_t tactic) noexcept
+{
+    // the ids index the candidates of configurePlugin's shapes; a plugin restored from the "tactic"
+    // field keeps it whatever id TensorRT passes
+    return grid_sample_3d_apply_tactic_id(tactic, mTacticSized, mTacticVoxels, tacticChannels(), mTactic) ? 0 : -1;
+}
+
 // IPluginV3OneCore methods
 
 const AsciiChar *GridSample3DPlugin::getPluginName() const noexcept
@@ -338,7 +946,8 @@ void GridSample3DPlugin::setPluginNamespace(AsciiChar const *pluginNamespace) no
 
 size_t GridSample3DPlugin::getSerializationSize() const noexcept
 {
-    return sizeof(size_t) * 7 + sizeof(bool) + sizeof(GridSample3DInterpolationMode) + sizeof(GridSample3DPaddingMode) + sizeof(DataType);
+    return sizeof(size_t) * 7 + sizeof(bool) + sizeof(GridSample3DInterpolationMode) + sizeof(GridSample3DPaddingMode) + sizeof(DataType) +
+           sizeof(int32_t) * TACTIC_FIELD_LENGTH + sizeof(int32_t) * 3;
 }
 
 void GridSample3DPlugin::serialize(void *buffer) const noexcept
@@ -356,6 +965,15 @@ void GridSample3DPlugin::serialize(void *buffer) const noexcept
     writeToBuffer<GridSample3DInterpolationMode>(data, mInterpolationMode);
     writeToBuffer<GridSample3DPaddingMode>(data, mPaddingMode);
     writeToBuffer<DataType>(data, mDataType);
+    int32_t tactic[TACTIC_FIELD_LENGTH];
+    writeTactic(mTactic, tactic);
+    for (int32_t i = 0; i < TACTIC_FIELD_LENGTH; i++)
+    {
+        writeToBuffer<int32_t>(data, tactic[i]);
+    }
+    writeToBuffer<int32_t>(data, static_cast<int32_t>(mTactic.bucketing));
+    writeToBuffer<int32_t>(data, static_cast<int32_t>(mTactic.tileBounds));
+    writeToBuffer<int32_t>(data, static_cast<int32_t>(mPointLayout));
     assert(static_cast<size_t>(data - start) == getSerializationSize());
 }
 
@@ -366,11 +984,353 @@ void GridSample3DPlugin::destroy() noexcept
 
 nvinfer1::PluginFieldCollection const *GridSample3DPlugin::getFieldsToSerialize() noexcept
 {
-    // static to ensure it persists after function returns
-    static nvinfer1::PluginFieldCollection emptyCollection{};
-    emptyCollection.nbFields = 0;
-    emptyCollection.fields = nullptr;
-    return &emptyCollection;
+    // the runtime plugin is rebuilt by the creator from these fields
+    mSerializedAttributes[0] = static_cast<int32_t>(mInterpolationMode);
+    mSerializedAttributes[1] = static_cast<int32_t>(mPaddingMode);
+    mSerializedAttributes[2] = static_cast<int32_t>(mAlignCorners);
+    mSerializedAttributes[3] = static_cast<int32_t>(mGridKind);
+    mSerializedAttributes[4] = mOutputZeroPoint;
+    mSerializedAttributes[5] = static_cast<int32_t>(mQuantizedOutput);
+    mSerializedAttributes[6] = static_cast<int32_t>(mTactic.bucketing);
+    mSerializedAttributes[7] = static_cast<int32_t>(mTactic.tileBounds);
+    mSerializedAttributes[8] = static_cast<int32_t>(mPointLayout);
+    mSerializedOutputScale = mOutputScale;
+    mDataToSerialize.clear();
+    mDataToSerialize.emplace_back("interpolation_mode", &mSerializedAttributes[0], PluginFieldType::kINT32, 1);
+    mDataToSerialize.emplace_back("padding_mode", &mSerializedAttributes[1], PluginFieldType::kINT32, 1);
+    mDataToSerialize.emplace_back("align_corners", &mSerializedAttributes[2], PluginFieldType::kINT32, 1);
+    mDataToSerialize.emplace_back("grid_kind", &mSerializedAttributes[3], PluginFieldType::kINT32, 1);
+    mDataToSerialize.emplace_back("input_scale", mInputScale.data(), PluginFieldType::kFLOAT32,
+                                  static_cast<int32_t>(mInputScale.size()));
+    mDataToSerialize.emplace_back("input_zero_point", mInputZeroPoint.data(), PluginFieldType::kINT32,
+                                  static_cast<int32_t>(mInputZeroPoint.size()));
+    mDataToSerialize.emplace_back("output_scale", &mSerializedOutputScale, PluginFieldType::kFLOAT32, 1);
+    mDataToSerialize.emplace_back("output_zero_point", &mSerializedAttributes[4], PluginFieldType::kINT32, 1);
+    mDataToSerialize.emplace_back("quantized_output", &mSerializedAttributes[5], PluginFieldType::kINT32, 1);
+    writeTactic(mTactic, mSerializedTactic);
+    mDataToSerialize.emplace_back("tactic", mSerializedTactic, PluginFieldType::kINT32, TACTIC_FIELD_LENGTH);
+    mDataToSerialize.emplace_back("bucketing", &mSerializedAttributes[6], PluginFieldType::kINT32, 1);
+    mDataToSerialize.emplace_back("tile_bounds", &mSerializedAttributes[7], PluginFieldType::kINT32, 1);
+    mDataToSerialize.emplace_back("point_layout", &mSerializedAttributes[8], PluginFieldType::kINT32, 1);
+    mFCToSerialize.nbFields = static_cast<int32_t>(mDataToSerialize.size());
+    mFCToSerialize.fields = mDataToSerialize.data();
+    return &mFCToSerialize;
+}
+
+// ---------------- Affine Plugin ----------------
+
+AffineGridSample3DPlugin::AffineGridSample3DPlugin(const std::string name,
+                                                   size_t inputChannel,
+                                                   size_t inputDepth,
+                                                   size_t inputHeight,
+                                                   size_t inputWidth,
+                                                   size_t outputDepth,
+                                                   size_t outputHeight,
+                                                   size_t outputWidth,
+                                                   bool alignCorners,
+                                                   GridSample3DInterpolationMode interpolationMode,
+                                                   GridSample3DPaddingMode paddingMode,
+                                                   DataType dataType)
+    : GridSample3DPlugin(name, inputChannel, inputDepth, inputHeight, inputWidth,
+                         outputDepth, outputHeight, outputWidth,
+                         alignCorners, interpolationMode, paddingMode, dataType)
+{
+}
+
+AffineGridSample3DPlugin::AffineGridSample3DPlugin(const std::string name,
+                                                   bool alignCorners,
+                                                   GridSample3DInterpolationMode interpolationMode,
+                                                   GridSample3DPaddingMode paddingMode,
+                                                   size_t outputDepth,
+                                                   size_t outputHeight,
+                                                   size_t outputWidth)
+    : GridSample3DPlugin(name, alignCorners, interpolationMode, paddingMode)
+{
+    // the "grid" dimensions are the output size, theta only carries the transform
+    mGridDepth = outputDepth;
+    mGridHeight = outputHeight;
+    mGridWidth = outputWidth;
+}
+
+IPluginV3 *AffineGridSample3DPlugin::clone() noexcept
+{
+    auto plugin = new AffineGridSample3DPlugin(mLayerName,
+                                               mInputChannel,
+                                               mInputDepth,
+                                               mInputHeight,
+                                               mInputWidth,
+                                               mGridDepth,
+                                               mGridHeight,
+                                               mGridWidth,
+                                               mAlignCorners,
+                                               mInterpolationMode,
+                                               mPaddingMode,
+                                               mDataType);
+    plugin->mGridDataType = mGridDataType;
+    plugin->mLayout = mLayout;
+    plugin->mLauncher = mLauncher;
+    plugin->mTactic = mTactic;
+    plugin->mMasked = mMasked;
+    plugin->mTacticVoxels = mTacticVoxels;
+    plugin->mTacticSized = mTacticSized;
+    plugin->mTacticChannels = mTacticChannels;
+    plugin->setPluginNamespace(mNameSpace.c_str());
+    return plugin;
+}
+
+int32_t AffineGridSample3DPlugin::getOutputShapes(DimsExprs const *inputs, int32_t nbInputs, DimsExprs const * /*shapeInputs*/, int32_t /*nbShapeInputs*/, DimsExprs *outputs, int32_t nbOutputs, IExprBuilder &exprBuilder) noexcept
+{
+    assert(nbInputs >= 2);
+    assert(outputs != nullptr);
+    assert(inputs[0].nbDims == 5);
+    assert(inputs[1].nbDims == 3);
+
+    // input dims: N, C, D, H, W; theta dims: N, 3, 4
+    DimsExprs output(inputs[0]);
+    output.d[2] = exprBuilder.constant(static_cast<int64_t>(mGridDepth));
+    output.d[3] = exprBuilder.constant(static_cast<int64_t>(mGridHeight));
+    output.d[4] = exprBuilder.constant(static_cast<int64_t>(mGridWidth));
+    outputs[0] = output;
+    return 0;
+}
+
+int32_t AffineGridSample3DPlugin::configurePlugin(DynamicPluginTensorDesc const *in,
+                                                  int32_t nbInputs,
+                                                  DynamicPluginTensorDesc const *out,
+                                                  int32_t nbOutputs) noexcept
+{
+    assert((nbInputs == 2 || nbInputs == 3) && nbOutputs == 1);
+    assert(in[0].desc.dims.nbDims == 5);
+    assert(in[1].desc.dims.nbDims == 3);
+
+    configureInput(in[0].desc.dims, in[0].desc.type, in[0].desc.format);
+    mGridDataType = in[1].desc.type;
+    configureTacticSizes(in[0], out[0]);
+    mLauncher = selectLauncher();
+    configureMask(nbInputs == 3 ? &in[2].desc.dims : nullptr);
+
+    assert(mBatch == in[1].desc.dims.d[0]);
+    assert(in[1].desc.dims.d[1] == 3 && in[1].desc.dims.d[2] == 4);
+    return 0;
+}
+
+int32_t AffineGridSample3DPlugin::onShapeChange(PluginTensorDesc const *in,
+                                                int32_t nbInputs,
+                                                PluginTensorDesc const *out,
+                                                int32_t nbOutputs) noexcept
+{
+    assert((nbInputs == 2 || nbInputs == 3) && nbOutputs == 1);
+    assert(in[0].dims.nbDims == 5);
+    assert(in[1].dims.nbDims == 3);
+
+    configureInput(in[0].dims, in[0].type, in[0].format);
+    mGridDataType = in[1].type;
+    // the output carries the size from the build attributes
+    mGridDepth = out[0].dims.d[2];
+    mGridHeight = out[0].dims.d[3];
+    mGridWidth = out[0].dims.d[4];
+    mLauncher = selectLauncher();
+    configureMask(nbInputs == 3 ? &in[2].dims : nullptr);
+
+    assert(mBatch == in[1].dims.d[0]);
+    assert(in[1].dims.d[1] == 3 && in[1].dims.d[2] == 4);
+    return 0;
+}
+
+const AsciiChar *AffineGridSample3DPlugin::getPluginName() const noexcept
+{
+    return AFFINE_GRID_SAMPLER_PLUGIN_NAME;
+}
+
+nvinfer1::PluginFieldCollection const *AffineGridSample3DPlugin::getFieldsToSerialize() noexcept
+{
+    GridSample3DPlugin::getFieldsToSerialize();
+    mSerializedOutputSize[0] = static_cast<int32_t>(mGridDepth);
+    mSerializedOutputSize[1] = static_cast<int32_t>(mGridHeight);
+    mSerializedOutputSize[2] = static_cast<int32_t>(mGridWidth);
+    mDataToSerialize.emplace_back("output_size", mSerializedOutputSize, PluginFieldType::kINT32, 3);
+    mFCToSerialize.nbFields = static_cast<int32_t>(mDataToSerialize.size());
+    mFCToSerialize.fields = mDataToSerialize.data();
+    return &mFCToSerialize;
+}
+
+// the fused affine path samples float/half/bf16 volumes only
+bool AffineGridSample3DPlugin::acceptsIntegerInput() const
+{
+    return false;
+}
+
+bool AffineGridSample3DPlugin::isPointList(Dims const & /*dims*/) const
+{
+    return false;
+}
+
+size_t AffineGridSample3DPlugin::gridBytes() const
+{
+    return mBatch * 12 * elementSize(mGridDataType);
+}
+
+GridSample3DCudaLauncher AffineGridSample3DPlugin::selectLauncher() const
+{
+    if (!isSupportedType(mDataType) || !isSupportedType(mGridDataType))
+    {
+        return nullptr;
+    }
+    return grid_sample_3d_affine_cuda_select(toDataType(mDataType), toDataType(mGridDataType), mInterpolationMode,
+                                             mPaddingMode, mAlignCorners);
+}
+
+// ---------------- Ragged Plugin ----------------
+
+RaggedGridSample3DPlugin::RaggedGridSample3DPlugin(const std::string name,
+                                                   bool alignCorners,
+                                                   GridSample3DInterpolationMode interpolationMode,
+                                                   GridSample3DPaddingMode paddingMode)
+    : GridSample3DPlugin(name, alignCorners, interpolationMode, paddingMode)
+{
+}
+
+IPluginV3 *RaggedGridSample3DPlugin::clone() noexcept
+{
+    auto plugin = new RaggedGridSample3DPlugin(mLayerName, mAlignCorners, mInterpolationMode, mPaddingMode);
+    plugin->mBatch = mBatch;
+    plugin->mInputChannel = mInputChannel;
+    plugin->mInputDepth = mInputDepth;
+    plugin->mInputHeight = mInputHeight;
+    plugin->mInputWidth = mInputWidth;
+    plugin->mGridDepth = mGridDepth;
+    plugin->mGridHeight = mGridHeight;
+    plugin->mGridWidth = mGridWidth;
+    plugin->mDataType = mDataType;
+    plugin->mGridDataType = mGridDataType;
+    plugin->mTactic = mTactic;
+    plugin->mItems = mItems;
+    plugin->mRaggedLauncher = mRaggedLauncher;
+    plugin->setPluginNamespace(mNameSpace.c_str());
+    return plugin;
+}
+
+int32_t RaggedGridSample3DPlugin::getOutputShapes(DimsExprs const *inputs, int32_t nbInputs, DimsExprs const * /*shapeInputs*/, int32_t /*nbShapeInputs*/, DimsExprs *outputs, int32_t nbOutputs, IExprBuilder & /*exprBuilder*/) noexcept
+{
+    assert(nbInputs == 3 && nbOutputs == 1);
+    assert(inputs[0].nbDims == 2 && inputs[1].nbDims == 2 && inputs[2].nbDims == 2);
+
+    // input (C, V_in), grid (G, 3), items (B, 8) -> output (C, G)
+    DimsExprs output;
+    output.nbDims = 2;
+    output.d[0] = inputs[0].d[0];
+    output.d[1] = inputs[1].d[0];
+    outputs[0] = output;
+    return 0;
+}
+
+bool RaggedGridSample3DPlugin::supportsFormatCombination(int32_t pos,
+                                                         DynamicPluginTensorDesc const *inOut,
+                                                         int32_t nbInputs,
+                                                         int32_t nbOutputs) noexcept
+{
+    assert(nbInputs == 3 && nbOutputs == 1 && pos < (nbInputs + nbOutputs));
+
+    const PluginTensorDesc &desc = inOut[pos].desc;
+    if (desc.format != nvinfer1::TensorFormat::kLINEAR)
+    {
+        return false;
+    }
+    switch (pos)
+    {
+    case 0:
+        return isSupportedType(desc.type);
+    case 1:
+        return desc.type == DataType::kFLOAT || desc.type == inOut[0].desc.type;
+    case 2:
+        return desc.type == DataType::kINT32;
+    default:
+        return desc.type == inOut[0].desc.type;
+    }
+}
+
+void RaggedGridSample3DPlugin::configureRagged(Dims const &input, DataType type, Dims const &grid, DataType gridType,
+                                               Dims const &items)
+{
+    mBatch = 1;
+    mInputChannel = input.d[0];
+    mInputDepth = 1;
+    mInputHeight = 1;
+    mInputWidth = input.d[1];
+    mGridDepth = 1;
+    mGridHeight = 1;
+    mGridWidth = grid.d[0];
+    mItems = items.d[0];
+    mDataType = type;
+    mGridDataType = gridType;
+    mRaggedLauncher = grid_sample_3d_ragged_cuda_select(toDataType(type), toDataType(gridType), mInterpolationMode,
+                                                        mPaddingMode, mAlignCorners);
+    assert(grid.d[1] == 3 && items.d[1] == 8);
+}
+
+int32_t RaggedGridSample3DPlugin::configurePlugin(DynamicPluginTensorDesc const *in,
+                                                  int32_t nbInputs,
+                                                  DynamicPluginTensorDesc const * /*out*/,
+                                                  int32_t nbOutputs) noexcept
+{
+    assert(nbInputs == 3 && nbOutputs == 1);
+    configureRagged(in[0].desc.dims, in[0].desc.type, in[1].desc.dims, in[1].desc.type, in[2].desc.dims);
+    return 0;
+}
+
+size_t RaggedGridSample3DPlugin::getWorkspaceSize(DynamicPluginTensorDesc const * /*inputs*/,
+                                                  int32_t /*nbInputs*/,
+                                                  DynamicPluginTensorDesc const * /*outputs*/,
+                                                  int32_t /*nbOutputs*/) const noexcept
+{
+    return 0;
+}
+
+int32_t RaggedGridSample3DPlugin::onShapeChange(PluginTensorDesc const *in,
+                                                int32_t nbInputs,
+                                                PluginTensorDesc const * /*out*/,
+                                                int32_t nbOutputs) noexcept
+{
+    assert(nbInputs == 3 && nbOutputs == 1);
+    configureRagged(in[0].dims, in[0].type, in[1].dims, in[1].type, in[2].dims);
+    return 0;
+}
+
+int32_t RaggedGridSample3DPlugin::enqueue(PluginTensorDesc const * /*inputDesc*/,
+                                          PluginTensorDesc const * /*outputDesc*/,
+                                          void const *const *inputs,
+                                          void *const *outputs,
+                                          void * /*workspace*/,
+                                          cudaStream_t stream) noexcept
+{
+    // the packed (C, V_in) input and (C, G) output are profiled as a 1 x 1 x V_in volume and a 1 x 1 x G grid
+    GridSample3DProfileScope profile(getPluginName(),
+                                     GridSample3DProfileShape{mItems, mInputChannel, 1, 1, mInputWidth, 1, 1, mGridWidth},
+                                     mInputChannel * mInputWidth * elementSize(mDataType) +
+                                         mGridWidth * 3 * elementSize(mGridDataType) + mItems * sizeof(GridSample3DRaggedItem),
+                                     mInputChannel * mGridWidth * elementSize(mDataType),
+                                     stream);
+    if (mRaggedLauncher == nullptr)
+    {
+        return profile.finish(-1);
+    }
+    return profile.finish(mRaggedLauncher(inputs[0], inputs[1], static_cast<const GridSample3DRaggedItem *>(inputs[2]),
+                                          mItems, mInputChannel, mInputWidth, mGridWidth, outputs[0], stream, mTactic));
+}
+
+const AsciiChar *RaggedGridSample3DPlugin::getPluginName() const noexcept
+{
+    return RAGGED_GRID_SAMPLER_PLUGIN_NAME;
+}
+
+bool RaggedGridSample3DPlugin::acceptsIntegerInput() const
+{
+    return false;
+}
+
+bool RaggedGridSample3DPlugin::isPointList(Dims const & /*dims*/) const
+{
+    return false;
 }
 
 // ---------------- Plugin Creator ----------------
@@ -405,6 +1365,17 @@ IPluginV3 *GridSample3DPluginCreator::createPlugin(AsciiChar const *name, Plugin
     int interpolationMode = 0;
     int paddingMode = 0;
     int alignCorners = 0;
+    GridSample3DGridKind gridKind = GridSample3DGridKind::Absolute;
+    // int8/uint8 input; the output parameters default to the per-tensor input ones
+    std::vector<float> inputScale{1.f};
+    std::vector<int32_t> inputZeroPoint{0};
+    const float *outputScale = nullptr;
+    const int32_t *outputZeroPoint = nullptr;
+    int quantizedOutput = 1;
+    const int32_t *tactic = nullptr;
+    GridSample3DBucketing bucketing = GridSample3DBucketing::Off;
+    int tileBounds = 0;
+    GridSample3DPointLayout pointLayout = GridSample3DPointLayout::NPC;
 
     if (fc && fc->nbFields > 0)
     {
@@ -426,16 +1397,80 @@ IPluginV3 *GridSample3DPluginCreator::createPlugin(AsciiChar const *name, Plugin
             {
                 alignCorners = *reinterpret_cast<const int *>(field_data);
             }
+            else if (!strcmp(field_name, "grid_kind"))
+            {
+                if (!parseGridKind(fields[i], gridKind))
+                {
+                    grid_sample_3d_log(GridSample3DLogSeverity::Error, "GridSample3D: unknown grid_kind");
+                    return nullptr;
+                }
+            }
+            else if (!strcmp(field_name, "input_scale") && fields[i].length > 0)
+            {
+                const float *values = static_cast<const float *>(field_data);
+                inputScale.assign(values, values + fields[i].length);
+            }
+            else if (!strcmp(field_name, "input_zero_point") && fields[i].length > 0)
+            {
+                const int32_t *values = static_cast<const int32_t *>(field_data);
+                inputZeroPoint.assign(values, values + fields[i].length);
+            }
+            else if (!strcmp(field_name, "output_scale"))
+            {
+                outputScale = static_cast<const float *>(field_data);
+            }
+            else if (!strcmp(field_name, "output_zero_point"))
+            {
+                outputZeroPoint = static_cast<const int32_t *>(field_data);
+            }
+            else if (!strcmp(field_name, "quantized_output"))
+            {
+                quantizedOutput = *reinterpret_cast<const int *>(field_data);
+            }
+            else if (!strcmp(field_name, "tactic") && fields[i].length == TACTIC_FIELD_LENGTH)
+            {
+                tactic = static_cast<const int32_t *>(field_data);
+            }
+            else if (!strcmp(field_name, "bucketing"))
+            {
+                if (!parseBucketing(fields[i], bucketing))
+                {
+                    grid_sample_3d_log(GridSample3DLogSeverity::Error, "GridSample3D: unknown bucketing");
+                    return nullptr;
+                }
+            }
+            else if (!strcmp(field_name, "tile_bounds"))
+            {
+                tileBounds = *reinterpret_cast<const int *>(field_data);
+            }
+            else if (!strcmp(field_name, "point_layout"))
+            {
+                if (!parsePointLayout(fields[i], pointLayout))
+                {
+                    grid_sample_3d_log(GridSample3DLogSeverity::Error, "GridSample3D: unknown point_layout");
+                    return nullptr;
+                }
+            }
         }
     }
 
-    std::cout << "paddingMode: " << paddingMode << std::endl;
-    std::cout << "interpolationMode: " << interpolationMode << std::endl;
+    grid_sample_3d_log(GridSample3DLogSeverity::Verbose, "GridSample3D: paddingMode %d, interpolationMode %d",
+                       paddingMode, interpolationMode);
 
     auto plugin = new GridSample3DPlugin(std::string(name),
                                          static_cast<bool>(alignCorners),
                                          static_cast<GridSample3DInterpolationMode>(interpolationMode),
-                                         static_cast<GridSample3DPaddingMode>(paddingMode));
+                                         static_cast<GridSample3DPaddingMode>(paddingMode),
+                                         gridKind);
+    plugin->setQuantization(inputScale, inputZeroPoint,
+                            outputScale ? *outputScale : inputScale[0],
+                            outputZeroPoint ? *outputZeroPoint : inputZeroPoint[0],
+                            quantizedOutput != 0);
+    GridSample3DTactic launchTactic = tactic != nullptr ? readTactic(tactic) : GridSample3DTactic();
+    launchTactic.bucketing = bucketing;
+    launchTactic.tileBounds = tileBounds != 0;
+    plugin->setLaunchTactic(launchTactic);
+    plugin->setPointLayout(pointLayout);
     plugin->setPluginNamespace(mNamespace.c_str());
     return plugin;
 }
@@ -450,28 +1485,270 @@ AsciiChar const *GridSample3DPluginCreator::getPluginNamespace() const noexcept
     return mNamespace.c_str();
 }
 
+// ---------------- Affine Plugin Creator ----------------
+
+AffineGridSample3DPluginCreator::AffineGridSample3DPluginCreator()
+{
+    setPluginNamespace(GRID_SAMPLER_PLUGIN_NAMESPACE);
+    if (mPluginAttributes.empty())
+    {
+        mPluginAttributes.emplace_back("interpolation_mode", nullptr, PluginFieldType::kINT32, 1);
+        mPluginAttributes.emplace_back("padding_mode", nullptr, PluginFieldType::kINT32, 1);
+        mPluginAttributes.emplace_back("align_corners", nullptr, PluginFieldType::kINT32, 1);
+        mPluginAttributes.emplace_back("output_size", nullptr, PluginFieldType::kINT32, 3);
+    }
+    mFC.nbFields = static_cast<int32_t>(mPluginAttributes.size());
+    mFC.fields = mPluginAttributes.data();
+}
+
+AffineGridSample3DPluginCreator::~AffineGridSample3DPluginCreator() noexcept {}
+
+AsciiChar const *AffineGridSample3DPluginCreator::getPluginName() const noexcept
+{
+    return AFFINE_GRID_SAMPLER_PLUGIN_NAME;
+}
+
+AsciiChar const *AffineGridSample3DPluginCreator::getPluginVersion() const noexcept
+{
+    return GRID_SAMPLER_PLUGIN_VERSION;
+}
+
+PluginFieldCollection const *AffineGridSample3DPluginCreator::getFieldNames() noexcept
+{
+    return &mFC;
+}
+
+IPluginV3 *AffineGridSample3DPluginCreator::createPlugin(AsciiChar const *name, PluginFieldCollection const *fc, TensorRTPhase /*phase*/) noexcept
+{
+    int interpolationMode = 0;
+    int paddingMode = 0;
+    int alignCorners = 0;
+    // output size D, H, W, as the spatial part of F.affine_grid's size argument
+    const int *outputSize = nullptr;
+    const int32_t *tactic = nullptr;
+    GridSample3DBucketing bucketing = GridSample3DBucketing::Off;
+    int tileBounds = 0;
+
+    if (fc && fc->nbFields > 0)
+    {
+        const PluginField *fields = fc->fields;
+        int nbFields = fc->nbFields;
+        for (int i = 0; i < nbFields; ++i)
+        {
+            const char *field_name = fields[i].name;
+            const void *field_data = fields[i].data;
+            if (!strcmp(field_name, "interpolation_mode"))
+            {
+                interpolationMode = *reinterpret_cast<const int *>(field_data);
+            }
+            else if (!strcmp(field_name, "padding_mode"))
+            {
+                paddingMode = *reinterpret_cast<const int *>(field_data);
+            }
+            else if (!strcmp(field_name, "align_corners"))
+            {
+                alignCorners = *reinterpret_cast<const int *>(field_data);
+            }
+            else if (!strcmp(field_name, "output_size") && fields[i].length == 3)
+            {
+                outputSize = reinterpret_cast<const int *>(field_data);
+            }
+            else if (!strcmp(field_name, "tactic") && fields[i].length == TACTIC_FIELD_LENGTH)
+            {
+                tactic = static_cast<const int32_t *>(field_data);
+            }
+            else if (!strcmp(field_name, "bucketing"))
+            {
+                if (!parseBucketing(fields[i], bucketing))
+                {
+                    grid_sample_3d_log(GridSample3DLogSeverity::Error, "AffineGridSample3D: unknown bucketing");
+                    return nullptr;
+                }
+            }
+            else if (!strcmp(field_name, "tile_bounds"))
+            {
+                tileBounds = *reinterpret_cast<const int *>(field_data);
+            }
+        }
+    }
+
+    if (outputSize == nullptr || outputSize[0] <= 0 || outputSize[1] <= 0 || outputSize[2] <= 0)
+    {
+        grid_sample_3d_log(GridSample3DLogSeverity::Error, "AffineGridSample3D: output_size (D, H, W) is required");
+        return nullptr;
+    }
+    // the LOD of mipmap sampling comes from the grid, which the fused affine kernels never materialize
+    if (interpolationMode == static_cast<int>(GridSample3DInterpolationMode::Mipmap))
+    {
+        grid_sample_3d_log(GridSample3DLogSeverity::Error, "AffineGridSample3D: mipmap interpolation needs an explicit grid");
+        return nullptr;
+    }
+
+    auto plugin = new AffineGridSample3DPlugin(std::string(name),
+                                               static_cast<bool>(alignCorners),
+                                               static_cast<GridSample3DInterpolationMode>(interpolationMode),
+                                               static_cast<GridSample3DPaddingMode>(paddingMode),
+                                               outputSize[0], outputSize[1], outputSize[2]);
+    GridSample3DTactic launchTactic = tactic != nullptr ? readTactic(tactic) : GridSample3DTactic();
+    launchTactic.bucketing = bucketing;
+    launchTactic.tileBounds = tileBounds != 0;
+    plugin->setLaunchTactic(launchTactic);
+    plugin->setPluginNamespace(mNamespace.c_str());
+    return plugin;
+}
+
+void AffineGridSample3DPluginCreator::setPluginNamespace(AsciiChar const *libNamespace) noexcept
+{
+    mNamespace = libNamespace ? libNamespace : "";
+}
+
+AsciiChar const *AffineGridSample3DPluginCreator::getPluginNamespace() const noexcept
+{
+    return mNamespace.c_str();
+}
+
+// ---------------- Ragged Plugin Creator ----------------
+
+RaggedGridSample3DPluginCreator::RaggedGridSample3DPluginCreator()
+{
+    setPluginNamespace(GRID_SAMPLER_PLUGIN_NAMESPACE);
+    if (mPluginAttributes.empty())
+    {
+        mPluginAttributes.emplace_back("interpolation_mode", nullptr, PluginFieldType::kINT32, 1);
+        mPluginAttributes.emplace_back("padding_mode", nullptr, PluginFieldType::kINT32, 1);
+        mPluginAttributes.emplace_back("align_corners", nullptr, PluginFieldType::kINT32, 1);
+    }
+    mFC.nbFields = static_cast<int32_t>(mPluginAttributes.size());
+    mFC.fields = mPluginAttributes.data();
+}
+
+RaggedGridSample3DPluginCreator::~RaggedGridSample3DPluginCreator() noexcept {}
+
+AsciiChar const *RaggedGridSample3DPluginCreator::getPluginName() const noexcept
+{
+    return RAGGED_GRID_SAMPLER_PLUGIN_NAME;
+}
+
+AsciiChar const *RaggedGridSample3DPluginCreator::getPluginVersion() const noexcept
+{
+    return GRID_SAMPLER_PLUGIN_VERSION;
+}
+
+PluginFieldCollection const *RaggedGridSample3DPluginCreator::getFieldNames() noexcept
+{
+    return &mFC;
+}
+
+IPluginV3 *RaggedGridSample3DPluginCreator::createPlugin(AsciiChar const *name, PluginFieldCollection const *fc, TensorRTPhase /*phase*/) noexcept
+{
+    int interpolationMode = 0;
+    int paddingMode = 0;
+    int alignCorners = 0;
+    const int32_t *tactic = nullptr;
+
+    if (fc && fc->nbFields > 0)
+    {
+        const PluginField *fields = fc->fields;
+        int nbFields = fc->nbFields;
+        for (int i = 0; i < nbFields; ++i)
+        {
+            const char *field_name = fields[i].name;
+            const void *field_data = fields[i].data;
+            if (!strcmp(field_name, "interpolation_mode"))
+            {
+                interpolationMode = *reinterpret_cast<const int *>(field_data);
+            }
+            else if (!strcmp(field_name, "padding_mode"))
+            {
+                paddingMode = *reinterpret_cast<const int *>(field_data);
+            }
+            else if (!strcmp(field_name, "align_corners"))
+            {
+                alignCorners = *reinterpret_cast<const int *>(field_data);
+            }
+            else if (!strcmp(field_name, "tactic") && fields[i].length == TACTIC_FIELD_LENGTH)
+            {
+                tactic = static_cast<const int32_t *>(field_data);
+            }
+        }
+    }
+
+    if (interpolationMode != static_cast<int>(GridSample3DInterpolationMode::Bilinear) &&
+        interpolationMode != static_cast<int>(GridSample3DInterpolationMode::Nearest))
+    {
+        grid_sample_3d_log(GridSample3DLogSeverity::Error, "RaggedGridSample3D: interpolation_mode must be bilinear or nearest");
+        return nullptr;
+    }
+
+    auto plugin = new RaggedGridSample3DPlugin(std::string(name),
+                                               static_cast<bool>(alignCorners),
+                                               static_cast<GridSample3DInterpolationMode>(interpolationMode),
+                                               static_cast<GridSample3DPaddingMode>(paddingMode));
+    plugin->setLaunchTactic(tactic != nullptr ? readTactic(tactic) : GridSample3DTactic());
+    plugin->setPluginNamespace(mNamespace.c_str());
+    return plugin;
+}
+
+void RaggedGridSample3DPluginCreator::setPluginNamespace(AsciiChar const *libNamespace) noexcept
+{
+    mNamespace = libNamespace ? libNamespace : "";
+}
+
+AsciiChar const *RaggedGridSample3DPluginCreator::getPluginNamespace() const noexcept
+{
+    return mNamespace.c_str();
+}
+
 // C-style plugin registration entry points (keep compatibility)
 extern "C" TENSORRTAPI IPluginCreatorInterface *const *getCreators(int32_t &nbCreators)
 {
-    nbCreators = 1;
+    nbCreators = 3;
     static GridSample3DPluginCreator sCreator;
-    static IPluginCreatorInterface *const kPLUGIN_CREATOR_LIST[] = {&sCreator};
+    static AffineGridSample3DPluginCreator sAffineCreator;
+    static RaggedGridSample3DPluginCreator sRaggedCreator;
+    static IPluginCreatorInterface *const kPLUGIN_CREATOR_LIST[] = {&sCreator, &sAffineCreator, &sRaggedCreator};
     return kPLUGIN_CREATOR_LIST;
 }
 
+static void forwardToLogger(GridSample3DLogSeverity severity, const char *message, void *user)
+{
+    ILogger::Severity level = ILogger::Severity::kVERBOSE;
+    switch (severity)
+    {
+    case GridSample3DLogSeverity::Error:
+        level = ILogger::Severity::kERROR;
+        break;
+    case GridSample3DLogSeverity::Warning:
+        level = ILogger::Severity::kWARNING;
+        break;
+    case GridSample3DLogSeverity::Info:
+        level = ILogger::Severity::kINFO;
+        break;
+    default:
+        break;
+    }
+    static_cast<ILogger *>(user)->log(level, message);
+}
+
+// library messages go to the TensorRT logger from here on
 extern "C" TENSORRTAPI void setLoggerFinder(nvinfer1::ILoggerFinder *finder)
 {
-    (void)finder;
+    ILogger *logger = finder != nullptr ? finder->findLogger() : nullptr;
+    grid_sample_3d_set_log_sink(logger != nullptr ? forwardToLogger : nullptr, logger);
 }
 
 // Legacy helper (some runtimes still call getPluginCreators)
 extern "C" TENSORRTAPI nvinfer1::IPluginCreatorV3One *const *getPluginCreators(int32_t &nbCreators)
 {
-    nbCreators = 1;
+    nbCreators = 3;
     static GridSample3DPluginCreator sCreator;
-    static nvinfer1::IPluginCreatorV3One *const kPLUGIN_CREATOR_LIST[] = {&sCreator};
+    static AffineGridSample3DPluginCreator sAffineCreator;
+    static RaggedGridSample3DPluginCreator sRaggedCreator;
+    static nvinfer1::IPluginCreatorV3One *const kPLUGIN_CREATOR_LIST[] = {&sCreator, &sAffineCreator, &sRaggedCreator};
     return kPLUGIN_CREATOR_LIST;
 }
 
 // Register with macro for static registration
 REGISTER_TENSORRT_PLUGIN(GridSample3DPluginCreator);
+REGISTER_TENSORRT_PLUGIN(AffineGridSample3DPluginCreator);
+REGISTER_TENSORRT_PLUGIN(RaggedGridSample3DPluginCreator);
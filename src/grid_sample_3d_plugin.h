@@ -35,12 +35,14 @@ namespace nvinfer1
                                bool alignCorners,
                                GridSample3DInterpolationMode interpolationMode,
                                GridSample3DPaddingMode paddingMode,
-                               nvinfer1::DataType dataType);
+                               nvinfer1::DataType dataType,
+                               GridSample3DGridKind gridKind = GridSample3DGridKind::Absolute);
 
             GridSample3DPlugin(const std::string name,
                                bool alignCorners,
                                GridSample3DInterpolationMode interpolationMode,
-                               GridSample3DPaddingMode paddingMode);
+                               GridSample3DPaddingMode paddingMode,
+                               GridSample3DGridKind gridKind = GridSample3DGridKind::Absolute);
 
             GridSample3DPlugin(const std::string name,
                                const void *buffer,
@@ -65,10 +67,14 @@ namespace nvinfer1
                                     int32_t nbInputs,
                                     DynamicPluginTensorDesc const *out,
                                     int32_t nbOutputs) noexcept override;
-            int32_t getWorkspaceSize(PluginTensorDesc const *inputs,
-                                     int32_t nbInputs,
-                                     PluginTensorDesc const *outputs,
-                                     int32_t nbOutputs) const noexcept;
+            // bucketed sampling needs the bucket order of the largest output, none otherwise
+            size_t getWorkspaceSize(DynamicPluginTensorDesc const *inputs,
+                                    int32_t nbInputs,
+                                    DynamicPluginTensorDesc const *outputs,
+                                    int32_t nbOutputs) const noexcept override;
+            // launch configurations TensorRT times at build time, ids 1..n of tacticCandidates()
+            int32_t getNbTactics() noexcept override;
+            int32_t getValidTactics(int32_t *tactics, int32_t nbTactics) noexcept override;
 
             // IPluginV3OneRuntime methods (runtime capabilities)
             int32_t onShapeChange(PluginTensorDesc const *in,
@@ -82,6 +88,7 @@ namespace nvinfer1
                             void *workspace,
                             cudaStream_t stream) noexcept override;
             IPluginV3 *attachToContext(IPluginResourceContext *context) noexcept override;
+            int32_t setTactic(int32_t tactic) noexcept override;
 
             // IPluginV3OneCore methods (core capabilities)
             const AsciiChar *getPluginName() const noexcept override;
@@ -94,7 +101,44 @@ namespace nvinfer1
 
             nvinfer1::PluginFieldCollection const *getFieldsToSerialize() noexcept override;
 
-        private:
+            // int8/uint8 input: dequantization parameters (one value, or one per channel), and
+            // whether the output is requantized with the output parameters or written as fp16
+            void setQuantization(std::vector<float> const &inputScale,
+                                 std::vector<int32_t> const &inputZeroPoint,
+                                 float outputScale,
+                                 int32_t outputZeroPoint,
+                                 bool quantizedOutput);
+            void setLaunchTactic(GridSample3DTactic const &tactic);
+            // output layout of a point-list grid (N, P, 3): (N, P, C) or (N, C, P)
+            void setPointLayout(GridSample3DPointLayout pointLayout);
+
+        protected:
+            // shape, type and layout of the sampled input (N, C, D, H, W)
+            void configureInput(Dims const &dims, DataType type, TensorFormat format);
+            // type and dims of the grid (N, D, H, W, 3), or of a point list (N, P, 3) sampled as a 1 x 1 x P grid
+            void configureGrid(Dims const &dims, DataType type);
+            // optional third input: dims of the output mask, nullptr without one
+            void configureMask(Dims const *dims);
+            // output voxels and channels tacticCandidates is sized for
+            void configureTacticSizes(DynamicPluginTensorDesc const &input, DynamicPluginTensorDesc const &output);
+            virtual GridSample3DCudaLauncher selectLauncher() const;
+            // int8/uint8 (quantized) and int32 (label map) inputs
+            virtual bool acceptsIntegerInput() const;
+            // whether a grid of these dims is a point list (N, P, 3); theta (N, 3, 4) of the affine plugin is not
+            virtual bool isPointList(Dims const &dims) const;
+            // bytes of the second input read by an enqueue, for the profiling counters
+            virtual size_t gridBytes() const;
+            bool isLabelMap() const;
+            DataType outputDataType(DataType inputType) const;
+            // picks mQuantizedLauncher for an int8/uint8 input of `channels` channels (-1 when not
+            // static); false when the per-channel parameters do not cover C
+            bool configureQuantization(int64_t channels);
+            // copies per-channel parameters to mDeviceChannelQuantization, once per setQuantization
+            void uploadChannelQuantization();
+            std::vector<GridSample3DTactic> tacticCandidates() const;
+            // C the candidates are listed for: 0 for the channels-last layouts
+            size_t tacticChannels() const;
+
             // internal parameters
             const std::string mLayerName;
             size_t mBatch;
@@ -104,7 +148,149 @@ namespace nvinfer1
             std::string mNameSpace;
             GridSample3DInterpolationMode mInterpolationMode;
             GridSample3DPaddingMode mPaddingMode;
+            GridSample3DGridKind mGridKind;
             nvinfer1::DataType mDataType;
+            // the grid (or theta) may be fp32 with a 16-bit input
+            nvinfer1::DataType mGridDataType;
+            GridSample3DLayout mLayout;
+            GridSample3DCudaLauncher mLauncher;
+            // chosen by setTactic while building, then restored from the "tactic" field; the
+            // bucketing mode and the bounds prepass come from the "bucketing" and "tile_bounds"
+            // fields and survive setTactic
+            GridSample3DTactic mTactic;
+            // enqueue passes the third input as the output mask (N, D_grid, H_grid, W_grid), or (N, P)
+            bool mMasked = false;
+            // the grid is a point list (N, P, 3); the "point_layout" field picks the output layout
+            bool mPoints = false;
+            GridSample3DPointLayout mPointLayout = GridSample3DPointLayout::NPC;
+            // from the opt shapes of the profile, SIZE_MAX (every candidate) while unknown; set by
+            // configurePlugin only, so a plugin restored from an engine is never sized
+            bool mTacticSized = false;
+            size_t mTacticVoxels = SIZE_MAX;
+            size_t mTacticChannels = SIZE_MAX;
+
+            // quantized input, see setQuantization; per-channel parameters are uploaded by
+            // setQuantization to mDeviceChannelQuantization (C scales, then C zero points), freed
+            // by the destructor
+            std::vector<float> mInputScale{1.f};
+            std::vector<int32_t> mInputZeroPoint{0};
+            float mOutputScale = 1.f;
+            int32_t mOutputZeroPoint = 0;
+            bool mQuantizedOutput = true;
+            GridSample3DQuantization mInputQuantization;
+            GridSample3DQuantization mOutputQuantization;
+            void *mDeviceChannelQuantization = nullptr;
+            size_t mChannelQuantizationCount = 0;
+            GridSample3DQuantizedCudaLauncher mQuantizedLauncher = nullptr;
+
+            // attributes reported by getFieldsToSerialize
+            int32_t mSerializedAttributes[9];
+            int32_t mSerializedTactic[6];
+            float mSerializedOutputScale;
+            std::vector<PluginField> mDataToSerialize;
+            PluginFieldCollection mFCToSerialize;
+        };
+
+        // Fused affine_grid + grid_sample: the second input is theta (N, 3, 4) instead of the grid,
+        // and the output size (D, H, W) is an attribute. Shares everything else with GridSample3DPlugin.
+        class AffineGridSample3DPlugin : public GridSample3DPlugin
+        {
+        public:
+            AffineGridSample3DPlugin(const std::string name,
+                                     size_t inputChannel,
+                                     size_t inputDepth,
+                                     size_t inputHeight,
+                                     size_t inputWidth,
+                                     size_t outputDepth,
+                                     size_t outputHeight,
+                                     size_t outputWidth,
+                                     bool alignCorners,
+                                     GridSample3DInterpolationMode interpolationMode,
+                                     GridSample3DPaddingMode paddingMode,
+                                     nvinfer1::DataType dataType);
+
+            AffineGridSample3DPlugin(const std::string name,
+                                     bool alignCorners,
+                                     GridSample3DInterpolationMode interpolationMode,
+                                     GridSample3DPaddingMode paddingMode,
+                                     size_t outputDepth,
+                                     size_t outputHeight,
+                                     size_t outputWidth);
+
+            IPluginV3 *clone() noexcept override;
+
+            int32_t getOutputShapes(DimsExprs const *inputs, int32_t nbInputs, DimsExprs const *shapeInputs, int32_t nbShapeInputs,
+                                    DimsExprs *outputs, int32_t nbOutputs, IExprBuilder &exprBuilder) noexcept override;
+            int32_t configurePlugin(DynamicPluginTensorDesc const *in,
+                                    int32_t nbInputs,
+                                    DynamicPluginTensorDesc const *out,
+                                    int32_t nbOutputs) noexcept override;
+            int32_t onShapeChange(PluginTensorDesc const *in,
+                                  int32_t nbInputs,
+                                  PluginTensorDesc const *out,
+                                  int32_t nbOutputs) noexcept override;
+
+            const AsciiChar *getPluginName() const noexcept override;
+            nvinfer1::PluginFieldCollection const *getFieldsToSerialize() noexcept override;
+
+        protected:
+            GridSample3DCudaLauncher selectLauncher() const override;
+            bool acceptsIntegerInput() const override;
+            bool isPointList(Dims const &dims) const override;
+            size_t gridBytes() const override;
+
+        private:
+            int32_t mSerializedOutputSize[3];
+        };
+
+        // Ragged batch of differently sized volumes in one enqueue: the inputs are the packed input
+        // (C, V_in), the packed grid (G, 3) and the item table (B, 8) int32 (GridSample3DRaggedItem),
+        // the output is (C, G). Float/half/bf16 volumes, absolute grids, linear formats.
+        class RaggedGridSample3DPlugin : public GridSample3DPlugin
+        {
+        public:
+            RaggedGridSample3DPlugin(const std::string name,
+                                     bool alignCorners,
+                                     GridSample3DInterpolationMode interpolationMode,
+                                     GridSample3DPaddingMode paddingMode);
+
+            IPluginV3 *clone() noexcept override;
+
+            int32_t getOutputShapes(DimsExprs const *inputs, int32_t nbInputs, DimsExprs const *shapeInputs, int32_t nbShapeInputs,
+                                    DimsExprs *outputs, int32_t nbOutputs, IExprBuilder &exprBuilder) noexcept override;
+            bool supportsFormatCombination(int32_t pos, DynamicPluginTensorDesc const *inOut, int32_t nbInputs, int32_t nbOutputs) noexcept override;
+            int32_t configurePlugin(DynamicPluginTensorDesc const *in,
+                                    int32_t nbInputs,
+                                    DynamicPluginTensorDesc const *out,
+                                    int32_t nbOutputs) noexcept override;
+            size_t getWorkspaceSize(DynamicPluginTensorDesc const *inputs,
+                                    int32_t nbInputs,
+                                    DynamicPluginTensorDesc const *outputs,
+                                    int32_t nbOutputs) const noexcept override;
+            int32_t onShapeChange(PluginTensorDesc const *in,
+                                  int32_t nbInputs,
+                                  PluginTensorDesc const *out,
+                                  int32_t nbOutputs) noexcept override;
+            int32_t enqueue(PluginTensorDesc const *inputDesc,
+                            PluginTensorDesc const *outputDesc,
+                            void const *const *inputs,
+                            void *const *outputs,
+                            void *workspace,
+                            cudaStream_t stream) noexcept override;
+
+            const AsciiChar *getPluginName() const noexcept override;
+
+        protected:
+            bool acceptsIntegerInput() const override;
+            bool isPointList(Dims const &dims) const override;
+
+        private:
+            // C, V_in, G and B from the packed input, grid and item table dims
+            void configureRagged(Dims const &input, DataType type, Dims const &grid, DataType gridType, Dims const &items);
+
+            // the packed input is kept as mInputChannel x mInputWidth and the grid as 1 x 1 x mGridWidth
+            size_t mItems = 0;
+            GridSample3DRaggedCudaLauncher mRaggedLauncher = nullptr;
         };
 
         class GridSample3DPluginCreator : public IPluginCreatorV3One
@@ -127,6 +313,46 @@ namespace nvinfer1
             static std::vector<PluginField> mPluginAttributes;
         };
 
+        class AffineGridSample3DPluginCreator : public IPluginCreatorV3One
+        {
+        public:
+            AffineGridSample3DPluginCreator();
+            ~AffineGridSample3DPluginCreator() noexcept override;
+
+            // IPluginCreatorV3One methods
+            IPluginV3 *createPlugin(AsciiChar const *name, PluginFieldCollection const *fc, TensorRTPhase phase) noexcept override;
+            PluginFieldCollection const *getFieldNames() noexcept override;
+            AsciiChar const *getPluginName() const noexcept override;
+            AsciiChar const *getPluginVersion() const noexcept override;
+            void setPluginNamespace(AsciiChar const *libNamespace) noexcept;
+            AsciiChar const *getPluginNamespace() const noexcept override;
+
+        private:
+            std::string mNamespace;
+            static PluginFieldCollection mFC;
+            static std::vector<PluginField> mPluginAttributes;
+        };
+
+        class RaggedGridSample3DPluginCreator : public IPluginCreatorV3One
+        {
+        public:
+            RaggedGridSample3DPluginCreator();
+            ~RaggedGridSample3DPluginCreator() noexcept override;
+
+            // IPluginCreatorV3One methods
+            IPluginV3 *createPlugin(AsciiChar const *name, PluginFieldCollection const *fc, TensorRTPhase phase) noexcept override;
+            PluginFieldCollection const *getFieldNames() noexcept override;
+            AsciiChar const *getPluginName() const noexcept override;
+            AsciiChar const *getPluginVersion() const noexcept override;
+            void setPluginNamespace(AsciiChar const *libNamespace) noexcept;
+            AsciiChar const *getPluginNamespace() const noexcept override;
+
+        private:
+            std::string mNamespace;
+            static PluginFieldCollection mFC;
+            static std::vector<PluginField> mPluginAttributes;
+        };
+
     } // namespace plugin
 } // namespace nvinfer1
 
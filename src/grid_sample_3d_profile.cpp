@@ -0,0 +1,279 @@
+#include "grid_sample_3d_profile.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+namespace
+{
+    // An enqueue whose events have not completed yet.
+    struct PendingCall {
+        cudaEvent_t start, stop;
+        GridSample3DProfileShape shape;
+        size_t bytesRead, bytesWritten;
+        int status;
+    };
+
+    // enqueues awaiting collection; past it the oldest is counted without its latency, so the
+    // queue stays bounded without waiting on the enqueue path
+    const size_t kMaxPending = 4096;
+
+    struct ProfileState {
+        std::atomic<bool> enabled{false};
+        std::atomic<uint64_t> taps{0};
+        std::atomic<uint64_t> outOfBoundsTaps{0};
+
+        std::mutex mutex;
+        GridSample3DProfileStats stats;
+        std::deque<PendingCall> pending;
+        std::vector<cudaEvent_t> events;   // completed events, reused
+
+        std::atomic<GridSample3DTraceBegin> traceBegin{nullptr};
+        std::atomic<GridSample3DTraceEnd> traceEnd{nullptr};
+        std::atomic<void*> traceUser{nullptr};
+
+        std::mutex logMutex;
+        GridSample3DLogSink logSink = nullptr;
+        void* logUser = nullptr;
+
+        ProfileState() {
+            std::memset(&stats, 0, sizeof(stats));
+            const char* env = std::getenv("GRID_SAMPLE_3D_PROFILE");
+            enabled = env != nullptr && std::atoi(env) > 0;
+        }
+    };
+
+    ProfileState& state() {
+        static ProfileState instance;
+        return instance;
+    }
+
+    bool same_shape(const GridSample3DProfileShape& a, const GridSample3DProfileShape& b) {
+        return a.N == b.N && a.C == b.C && a.D_in == b.D_in && a.H_in == b.H_in && a.W_in == b.W_in &&
+               a.D_grid == b.D_grid && a.H_grid == b.H_grid && a.W_grid == b.W_grid;
+    }
+
+    // state().mutex held
+    // `ms` < 0 counts the call without a latency
+    void record(ProfileState& s, const GridSample3DProfileShape& shape, size_t bytesRead, size_t bytesWritten,
+                double ms, int status) {
+        GridSample3DProfileStats& stats = s.stats;
+        stats.calls++;
+        stats.errors += status != 0;
+        if (ms < 0.0) {
+            stats.untimed++;
+        } else {
+            const double us = ms * 1e3;
+            const int bucket = us < 1.0 ? 0 : static_cast<int>(std::floor(std::log2(us))) + 1;
+            stats.latency[std::min(bucket, GRID_SAMPLE_3D_PROFILE_LATENCY_BUCKETS - 1)]++;
+            stats.totalMs += ms;
+            stats.maxMs = std::max(stats.maxMs, ms);
+        }
+        stats.bytesRead += bytesRead;
+        stats.bytesWritten += bytesWritten;
+        for (size_t i = 0; i < stats.numShapes; i++) {
+            if (same_shape(stats.shapes[i], shape)) {
+                stats.shapeCalls[i]++;
+                return;
+            }
+        }
+        if (stats.numShapes < GRID_SAMPLE_3D_PROFILE_SHAPES) {
+            stats.shapes[stats.numShapes] = shape;
+            stats.shapeCalls[stats.numShapes++] = 1;
+        } else {
+            stats.otherShapes++;
+        }
+    }
+
+    // records the pending enqueues, waiting for their events; only called by the snapshot and
+    // reset, never on the enqueue path. state().mutex held
+    void collect(ProfileState& s) {
+        while (!s.pending.empty()) {
+            PendingCall& call = s.pending.front();
+            float ms = 0.f;
+            const bool timed = cudaEventSynchronize(call.stop) == cudaSuccess &&
+                               cudaEventElapsedTime(&ms, call.start, call.stop) == cudaSuccess;
+            record(s, call.shape, call.bytesRead, call.bytesWritten, timed ? ms : -1.0, call.status);
+            s.events.push_back(call.start);
+            s.events.push_back(call.stop);
+            s.pending.pop_front();
+        }
+    }
+
+    // true while `stream` is being captured into a CUDA graph: events recorded there would time
+    // the capture, and querying them fails, so such calls go untimed
+    bool capturing(cudaStream_t stream) {
+        cudaStreamCaptureStatus status = cudaStreamCaptureStatusNone;
+        // an error means the legacy stream is blocked by a capture elsewhere
+        return cudaStreamIsCapturing(stream, &status) != cudaSuccess || status != cudaStreamCaptureStatusNone;
+    }
+
+    // state().mutex held
+    cudaEvent_t acquire_event(ProfileState& s) {
+        cudaEvent_t event = nullptr;
+        if (!s.events.empty()) {
+            event = s.events.back();
+            s.events.pop_back();
+        } else if (cudaEventCreate(&event) != cudaSuccess) {
+            return nullptr;
+        }
+        return event;
+    }
+
+    int64_t now_ns() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+} // namespace
+
+void grid_sample_3d_profile_enable(bool enabled) {
+    state().enabled = enabled;
+}
+
+bool grid_sample_3d_profile_enabled() {
+    return state().enabled.load(std::memory_order_relaxed);
+}
+
+void grid_sample_3d_profile_reset() {
+    ProfileState& s = state();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    collect(s);
+    std::memset(&s.stats, 0, sizeof(s.stats));
+    s.taps = 0;
+    s.outOfBoundsTaps = 0;
+}
+
+GridSample3DProfileStats grid_sample_3d_profile_snapshot() {
+    ProfileState& s = state();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    collect(s);
+    GridSample3DProfileStats stats = s.stats;
+    stats.taps = s.taps;
+    stats.outOfBoundsTaps = s.outOfBoundsTaps;
+    return stats;
+}
+
+void grid_sample_3d_set_trace_hooks(GridSample3DTraceBegin begin, GridSample3DTraceEnd end, void* user) {
+    ProfileState& s = state();
+    s.traceUser = user;
+    s.traceBegin = begin;
+    s.traceEnd = end;
+}
+
+void grid_sample_3d_set_log_sink(GridSample3DLogSink sink, void* user) {
+    ProfileState& s = state();
+    std::lock_guard<std::mutex> lock(s.logMutex);
+    s.logSink = sink;
+    s.logUser = user;
+}
+
+void grid_sample_3d_log(GridSample3DLogSeverity severity, const char* format, ...) {
+    char message[1024];
+    va_list args;
+    va_start(args, format);
+    std::vsnprintf(message, sizeof(message), format, args);
+    va_end(args);
+
+    ProfileState& s = state();
+    std::lock_guard<std::mutex> lock(s.logMutex);
+    if (s.logSink != nullptr) {
+        s.logSink(severity, message, s.logUser);
+    } else if (severity == GridSample3DLogSeverity::Error || severity == GridSample3DLogSeverity::Warning) {
+        std::fprintf(stderr, "%s\n", message);
+    }
+}
+
+void grid_sample_3d_profile_add_taps(size_t taps, size_t outOfBounds) {
+    ProfileState& s = state();
+    s.taps.fetch_add(taps, std::memory_order_relaxed);
+    s.outOfBoundsTaps.fetch_add(outOfBounds, std::memory_order_relaxed);
+}
+
+GridSample3DProfileScope::GridSample3DProfileScope(
+    const char* name, const GridSample3DProfileShape& shape, size_t bytesRead, size_t bytesWritten)
+    : mName(name), mShape(shape), mBytesRead(bytesRead), mBytesWritten(bytesWritten) {
+    begin();
+}
+
+GridSample3DProfileScope::GridSample3DProfileScope(
+    const char* name, const GridSample3DProfileShape& shape, size_t bytesRead, size_t bytesWritten,
+    cudaStream_t stream)
+    : mName(name), mShape(shape), mBytesRead(bytesRead), mBytesWritten(bytesWritten), mDevice(true),
+      mStream(stream) {
+    begin();
+}
+
+GridSample3DProfileScope::~GridSample3DProfileScope() {
+    if (!mFinished) {
+        finish(0);
+    }
+}
+
+void GridSample3DProfileScope::begin() {
+    ProfileState& s = state();
+    GridSample3DTraceBegin trace = s.traceBegin.load();
+    if (trace != nullptr) {
+        trace(mName, s.traceUser.load());
+    }
+    mEnabled = grid_sample_3d_profile_enabled();
+    if (!mEnabled) {
+        return;
+    }
+    if (mDevice) {
+        if (capturing(mStream)) {
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(s.mutex);
+            mStart = acquire_event(s);
+        }
+        if (mStart != nullptr) {
+            cudaEventRecord(mStart, mStream);
+        }
+    } else {
+        mStartNs = now_ns();
+    }
+}
+
+int GridSample3DProfileScope::finish(int status) {
+    mFinished = true;
+    ProfileState& s = state();
+    if (mEnabled) {
+        std::lock_guard<std::mutex> lock(s.mutex);
+        if (!mDevice) {
+            record(s, mShape, mBytesRead, mBytesWritten, (now_ns() - mStartNs) * 1e-6, status);
+        } else if (mStart == nullptr) {
+            record(s, mShape, mBytesRead, mBytesWritten, -1.0, status);
+        } else {
+            if (s.pending.size() >= kMaxPending) {
+                // the events of the oldest call are rerecorded later, its latency is dropped
+                const PendingCall& oldest = s.pending.front();
+                record(s, oldest.shape, oldest.bytesRead, oldest.bytesWritten, -1.0, oldest.status);
+                s.events.push_back(oldest.start);
+                s.events.push_back(oldest.stop);
+                s.pending.pop_front();
+            }
+            cudaEvent_t stop = acquire_event(s);
+            if (stop != nullptr) {
+                cudaEventRecord(stop, mStream);
+                s.pending.push_back(PendingCall{mStart, stop, mShape, mBytesRead, mBytesWritten, status});
+            } else {
+                s.events.push_back(mStart);
+                record(s, mShape, mBytesRead, mBytesWritten, -1.0, status);
+            }
+        }
+    }
+    GridSample3DTraceEnd trace = s.traceEnd.load();
+    if (trace != nullptr) {
+        trace(mName, s.traceUser.load());
+    }
+    return status;
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <cuda_runtime.h>
+
+// Instrumentation of the sampling calls: counters, trace ranges and logging.
+//
+// Counters are collected while profiling is enabled, by GRID_SAMPLE_3D_PROFILE=1 in the
+// environment or grid_sample_3d_profile_enable. Every plugin enqueue, CUDA call of the DLPack C
+// API and CPU backend call counts as one call. The latency of an enqueue is its device time,
+// measured with an event pair that grid_sample_3d_profile_snapshot waits for, so the enqueue path
+// never queries or synchronizes events; a CPU call is timed on the host. Enqueues on a stream
+// being captured into a CUDA graph are counted without a latency. Tap counts come from the CPU
+// backend only.
+
+// latency bucket k counts calls of [2^(k-1), 2^k) microseconds, bucket 0 those under 1 us, and
+// the last bucket every longer call
+#define GRID_SAMPLE_3D_PROFILE_LATENCY_BUCKETS 24
+// distinct shapes counted; calls of further shapes go to otherShapes
+#define GRID_SAMPLE_3D_PROFILE_SHAPES 16
+
+struct GridSample3DProfileShape {
+    size_t N, C, D_in, H_in, W_in;
+    size_t D_grid, H_grid, W_grid;
+};
+
+struct GridSample3DProfileStats {
+    uint64_t calls;
+    uint64_t errors;              // calls that returned a failure
+    uint64_t latency[GRID_SAMPLE_3D_PROFILE_LATENCY_BUCKETS];
+    uint64_t untimed;             // counted without a latency: captured, or pushed out of the timing queue
+    double totalMs;
+    double maxMs;
+    uint64_t bytesRead;           // input and grid (or theta), each read once
+    uint64_t bytesWritten;
+    uint64_t taps;                // gather taps (corners) computed by the CPU backend
+    uint64_t outOfBoundsTaps;     // of which fell outside the input
+    size_t numShapes;
+    GridSample3DProfileShape shapes[GRID_SAMPLE_3D_PROFILE_SHAPES];
+    uint64_t shapeCalls[GRID_SAMPLE_3D_PROFILE_SHAPES];
+    uint64_t otherShapes;
+};
+
+void grid_sample_3d_profile_enable(bool enabled);
+bool grid_sample_3d_profile_enabled();
+void grid_sample_3d_profile_reset();
+// waits for the pending enqueue timings, then copies the counters; not while capturing a stream
+GridSample3DProfileStats grid_sample_3d_profile_snapshot();
+
+// Trace ranges around every enqueue and CPU call, e.g. NVTX pushes and pops; `name` is the plugin
+// or entry point name. nullptr hooks disable tracing. Set them before sampling starts.
+typedef void (*GridSample3DTraceBegin)(const char* name, void* user);
+typedef void (*GridSample3DTraceEnd)(const char* name, void* user);
+void grid_sample_3d_set_trace_hooks(GridSample3DTraceBegin begin, GridSample3DTraceEnd end, void* user);
+
+// Messages of the library. The default sink prints errors and warnings to stderr; the plugin
+// library forwards to the TensorRT logger passed to setLoggerFinder.
+enum class GridSample3DLogSeverity { Error, Warning, Info, Verbose };
+typedef void (*GridSample3DLogSink)(GridSample3DLogSeverity severity, const char* message, void* user);
+// nullptr restores the default sink
+void grid_sample_3d_set_log_sink(GridSample3DLogSink sink, void* user);
+void grid_sample_3d_log(GridSample3DLogSeverity severity, const char* format, ...)
+#if defined(__GNUC__)
+    __attribute__((format(printf, 2, 3)))
+#endif
+    ;
+
+// One call: trace range, latency and traffic counters. The stream variant times the device work
+// queued on the stream between construction and finish(), the other one the host time. Only the
+// trace range is kept while profiling is disabled.
+class GridSample3DProfileScope {
+public:
+    GridSample3DProfileScope(const char* name, const GridSample3DProfileShape& shape,
+                             size_t bytesRead, size_t bytesWritten);
+    GridSample3DProfileScope(const char* name, const GridSample3DProfileShape& shape,
+                             size_t bytesRead, size_t bytesWritten, cudaStream_t stream);
+    // a scope left without finish() counts as a success
+    ~GridSample3DProfileScope();
+
+    GridSample3DProfileScope(const GridSample3DProfileScope&) = delete;
+    GridSample3DProfileScope& operator=(const GridSample3DProfileScope&) = delete;
+
+    // records the call with its status (0 on success) and returns the status
+    int finish(int status);
+
+private:
+    void begin();
+
+    const char* mName;
+    GridSample3DProfileShape mShape;
+    size_t mBytesRead, mBytesWritten;
+    bool mDevice = false;
+    cudaStream_t mStream = nullptr;
+    bool mEnabled = false;
+    bool mFinished = false;
+    int64_t mStartNs = 0;
+    cudaEvent_t mStart = nullptr;
+};
+
+// taps of a run of the CPU backend, `outOfBounds` of them outside the input
+void grid_sample_3d_profile_add_taps(size_t taps, size_t outOfBounds);
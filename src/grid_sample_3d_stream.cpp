@@ -0,0 +1,312 @@
+#include "grid_sample_3d.h"
+#include "grid_sample_3d.cuh"
+#include "grid_sample_3d_cpu.h"
+#include "grid_sample_3d_thread_pool.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstring>
+#include <future>
+
+#include <cuda_bf16.h>
+#include <cuda_fp16.h>
+
+using half = __half;
+using bfloat16 = __nv_bfloat16;
+
+namespace
+{
+    // Read-only mapping of the input file, released on scope exit.
+    class InputMapping {
+    public:
+        InputMapping(const char* path) {
+            int fd = ::open(path, O_RDONLY);
+            if (fd < 0) {
+                return;
+            }
+            struct stat st;
+            if (::fstat(fd, &st) == 0 && st.st_size > 0) {
+                void* mapping = ::mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+                if (mapping != MAP_FAILED) {
+                    mData = static_cast<const char*>(mapping);
+                    mSize = st.st_size;
+                    // slabs are read front to back, once per tile
+                    ::madvise(mapping, mSize, MADV_SEQUENTIAL);
+                }
+            }
+            ::close(fd);
+        }
+        ~InputMapping() {
+            if (mData != nullptr) {
+                ::munmap(const_cast<char*>(mData), mSize);
+            }
+        }
+        InputMapping(const InputMapping&) = delete;
+        InputMapping& operator=(const InputMapping&) = delete;
+
+        const char* data() const { return mData; }
+        size_t size() const { return mSize; }
+
+        // drops the pages of [offset, offset + bytes) from the process; the file keeps the data
+        void release(size_t offset, size_t bytes) const {
+            const size_t page = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+            const size_t begin = offset / page * page;
+            ::madvise(const_cast<char*>(mData) + begin, offset + bytes - begin, MADV_DONTNEED);
+        }
+
+    private:
+        const char* mData = nullptr;
+        size_t mSize = 0;
+    };
+
+    // Output depth slices [d_begin, d_end) of batch item n, read from input depths [z_begin, z_end).
+    struct StreamTile {
+        size_t n, d_begin, d_end;
+        int z_begin, z_end;
+    };
+
+    // Input depths [z_begin, z_end) reached by an in-bounds tap of the `count` voxels of an output
+    // slice; z_begin == z_end when every tap falls outside the input.
+    template <typename grid_t>
+    void slice_extent(
+        const grid_t* grid,
+        size_t count,
+        size_t D_in,
+        bool align_corners,
+        GridSample3DInterpolationMode interpolationMode,
+        GridSample3DPaddingMode paddingMode,
+        int& z_begin, int& z_end
+    ) {
+        const int depth = static_cast<int>(D_in);
+        int lo = INT_MAX;
+        int hi = INT_MIN;
+        auto reach = [&](int z) {
+            if (z >= 0 && z < depth) {
+                lo = std::min(lo, z);
+                hi = std::max(hi, z);
+            }
+        };
+        // same index arithmetic as the taps (grid_sample_3d_cpu_compute_taps); x and y are not
+        // checked, so a slab can hold a few depths that end up unused
+        for (size_t i = 0; i < count; i++) {
+            const float iz = compute_index(to_float(grid[3 * i + 2]), depth, paddingMode, align_corners);
+            if (interpolationMode == GridSample3DInterpolationMode::Nearest) {
+                reach(static_cast<int>(::roundf(iz)));
+            } else {
+                const int z0 = static_cast<int>(::floor(iz));
+                reach(z0);
+                reach(z0 + 1);
+            }
+        }
+        z_begin = lo <= hi ? lo : 0;
+        z_end = lo <= hi ? hi + 1 : 0;
+    }
+} // namespace
+
+template <typename scalar_t, typename grid_t>
+int grid_sample_3d_stream_cpu(
+    const char* inputPath,
+    size_t inputOffset,
+    const grid_t* grid,
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    size_t D_grid, size_t H_grid, size_t W_grid,
+    bool align_corners,
+    GridSample3DInterpolationMode interpolationMode,
+    GridSample3DPaddingMode paddingMode,
+    scalar_t* output,
+    size_t slabBytes,
+    GridSample3DStreamStats* stats
+) {
+    if (interpolationMode != GridSample3DInterpolationMode::Bilinear &&
+        interpolationMode != GridSample3DInterpolationMode::Nearest) {
+        return 1;
+    }
+    if (D_in > static_cast<size_t>(INT_MAX)) {
+        return 1;
+    }
+    // per extent: the product of input and output counts wraps for the volumes this path is for
+    for (size_t extent : {N, C, D_in, H_in, W_in, D_grid, H_grid, W_grid}) {
+        if (extent == 0) {
+            return 0;
+        }
+    }
+    const InputMapping mapping(inputPath);
+    const size_t input_stride_D = H_in * W_in;
+    const size_t input_bytes = N * C * D_in * input_stride_D * sizeof(scalar_t);
+    if (mapping.data() == nullptr || inputOffset + input_bytes > mapping.size()) {
+        return 1;
+    }
+
+    // depth extent of every output slice, then tiles of consecutive slices whose slab fits
+    const size_t slice_voxels = H_grid * W_grid;
+    std::vector<int> z_begin(N * D_grid), z_end(N * D_grid);
+    GridSample3DThreadPool::instance().parallelFor(N * D_grid, 1, [&](size_t begin, size_t end) {
+        for (size_t s = begin; s < end; s++) {
+            slice_extent(grid + s * slice_voxels * 3, slice_voxels, D_in, align_corners, interpolationMode,
+                         paddingMode, z_begin[s], z_end[s]);
+        }
+    });
+
+    // tap offsets are 32-bit within one channel of a slab
+    const size_t max_depth = std::min(slabBytes / (C * input_stride_D * sizeof(scalar_t)),
+                                      static_cast<size_t>(INT32_MAX) / input_stride_D);
+    std::vector<StreamTile> tiles;
+    for (size_t n = 0; n < N; n++) {
+        for (size_t d = 0; d < D_grid; d++) {
+            const size_t s = n * D_grid + d;
+            if (static_cast<size_t>(z_end[s] - z_begin[s]) > max_depth) {
+                return 1;
+            }
+            StreamTile* tile = tiles.empty() ? nullptr : &tiles.back();
+            if (tile != nullptr && tile->n == n) {
+                // empty slices join any tile, the others must keep the merged slab within the budget
+                const bool empty = z_begin[s] == z_end[s];
+                const bool tile_empty = tile->z_begin == tile->z_end;
+                const int merged_begin = empty ? tile->z_begin : tile_empty ? z_begin[s] : std::min(tile->z_begin, z_begin[s]);
+                const int merged_end = empty ? tile->z_end : tile_empty ? z_end[s] : std::max(tile->z_end, z_end[s]);
+                if (static_cast<size_t>(merged_end - merged_begin) <= max_depth) {
+                    tile->d_end = d + 1;
+                    tile->z_begin = merged_begin;
+                    tile->z_end = merged_end;
+                    continue;
+                }
+            }
+            tiles.push_back({n, d, d + 1, z_begin[s], z_end[s]});
+        }
+    }
+
+    // two slabs: the loader fills one while the pool samples the tile of the other
+    std::vector<scalar_t> slabs[2];
+    const char* input = mapping.data() + inputOffset;
+    auto load = [&](size_t t) {
+        const StreamTile& tile = tiles[t];
+        const size_t slab_voxels = (tile.z_end - tile.z_begin) * input_stride_D;
+        std::vector<scalar_t>& slab = slabs[t % 2];
+        slab.resize(C * slab_voxels);
+        for (size_t c = 0; c < C; c++) {
+            const size_t offset = ((tile.n * C + c) * D_in + tile.z_begin) * input_stride_D * sizeof(scalar_t);
+            std::memcpy(static_cast<void*>(slab.data() + c * slab_voxels), input + offset,
+                        slab_voxels * sizeof(scalar_t));
+            mapping.release(inputOffset + offset, slab_voxels * sizeof(scalar_t));
+        }
+    };
+
+    const size_t spatial = D_grid * slice_voxels;
+    GridSample3DStreamStats local_stats;
+    std::future<void> next = std::async(std::launch::async, load, 0);
+    for (size_t t = 0; t < tiles.size(); t++) {
+        next.get();
+        if (t + 1 < tiles.size()) {
+            next = std::async(std::launch::async, load, t + 1);
+        }
+
+        const StreamTile& tile = tiles[t];
+        const size_t slab_voxels = (tile.z_end - tile.z_begin) * input_stride_D;
+        const scalar_t* slab = slabs[t % 2].data();
+        const GridSample3DTapGeometry geometry{
+            static_cast<int>(D_in), static_cast<int>(H_in), static_cast<int>(W_in),
+            static_cast<int64_t>(input_stride_D), static_cast<int64_t>(W_in), 1,
+            align_corners, interpolationMode, paddingMode, tile.z_begin};
+
+        const size_t s_begin = tile.d_begin * slice_voxels;
+        const size_t s_count = (tile.d_end - tile.d_begin) * slice_voxels;
+        const size_t runs = (s_count + GRID_SAMPLE_3D_CPU_RUN - 1) / GRID_SAMPLE_3D_CPU_RUN;
+        GridSample3DThreadPool::instance().parallelFor(runs, 1, [&](size_t begin, size_t end) {
+            thread_local GridSample3DTaps taps;
+            for (size_t run = begin; run < end; run++) {
+                const size_t s = s_begin + run * GRID_SAMPLE_3D_CPU_RUN;
+                const size_t count = std::min<size_t>(GRID_SAMPLE_3D_CPU_RUN, s_begin + s_count - s);
+                grid_sample_3d_cpu_compute_run_taps(geometry, grid + (tile.n * spatial + s) * 3, count, taps);
+                for (size_t c = 0; c < C; c++) {
+                    grid_sample_3d_cpu_gather<scalar_t>(taps, slab + c * slab_voxels,
+                                                        output + (tile.n * C + c) * spatial + s);
+                }
+            }
+        });
+
+        local_stats.tiles++;
+        local_stats.bytesRead += C * slab_voxels * sizeof(scalar_t);
+        local_stats.maxSlabBytes = std::max(local_stats.maxSlabBytes, C * slab_voxels * sizeof(scalar_t));
+    }
+    if (stats != nullptr) {
+        *stats = local_stats;
+    }
+    return 0;
+}
+
+// template specialization
+template int grid_sample_3d_stream_cpu<float, float>(
+    const char* inputPath,
+    size_t inputOffset,
+    const float* grid,
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    size_t D_grid, size_t H_grid, size_t W_grid,
+    bool align_corners,
+    GridSample3DInterpolationMode interpolationMode,
+    GridSample3DPaddingMode paddingMode,
+    float* output,
+    size_t slabBytes,
+    GridSample3DStreamStats* stats
+);
+
+template int grid_sample_3d_stream_cpu<half, half>(
+    const char* inputPath,
+    size_t inputOffset,
+    const half* grid,
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    size_t D_grid, size_t H_grid, size_t W_grid,
+    bool align_corners,
+    GridSample3DInterpolationMode interpolationMode,
+    GridSample3DPaddingMode paddingMode,
+    half* output,
+    size_t slabBytes,
+    GridSample3DStreamStats* stats
+);
+
+template int grid_sample_3d_stream_cpu<bfloat16, bfloat16>(
+    const char* inputPath,
+    size_t inputOffset,
+    const bfloat16* grid,
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    size_t D_grid, size_t H_grid, size_t W_grid,
+    bool align_corners,
+    GridSample3DInterpolationMode interpolationMode,
+    GridSample3DPaddingMode paddingMode,
+    bfloat16* output,
+    size_t slabBytes,
+    GridSample3DStreamStats* stats
+);
+
+template int grid_sample_3d_stream_cpu<half, float>(
+    const char* inputPath,
+    size_t inputOffset,
+    const float* grid,
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    size_t D_grid, size_t H_grid, size_t W_grid,
+    bool align_corners,
+    GridSample3DInterpolationMode interpolationMode,
+    GridSample3DPaddingMode paddingMode,
+    half* output,
+    size_t slabBytes,
+    GridSample3DStreamStats* stats
+);
+
+template int grid_sample_3d_stream_cpu<bfloat16, float>(
+    const char* inputPath,
+    size_t inputOffset,
+    const float* grid,
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    size_t D_grid, size_t H_grid, size_t W_grid,
+    bool align_corners,
+    GridSample3DInterpolationMode interpolationMode,
+    GridSample3DPaddingMode paddingMode,
+    bfloat16* output,
+    size_t slabBytes,
+    GridSample3DStreamStats* stats
+);
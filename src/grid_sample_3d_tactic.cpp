@@ -0,0 +1,290 @@
+#include "grid_sample_3d.h"
+#include "grid_sample_3d.cuh"
+#include "grid_sample_3d_thread_pool.h"
+
+#include <algorithm>
+#include <chrono>
+
+#include <cuda_bf16.h>
+#include <cuda_fp16.h>
+
+using half = __half;
+using bfloat16 = __nv_bfloat16;
+
+std::vector<GridSample3DTactic> grid_sample_3d_tactic_candidates(GridSample3DBackend backend, size_t voxels, size_t C) {
+    const GridSample3DTactic base;
+    std::vector<GridSample3DTactic> candidates{base};
+    auto add = [&](const GridSample3DTactic& tactic) {
+        if (std::find(candidates.begin(), candidates.end(), tactic) == candidates.end()) {
+            candidates.push_back(tactic);
+        }
+    };
+
+    if (backend == GridSample3DBackend::CPU) {
+        // all pool threads, or half of them when memory bandwidth saturates first
+        const size_t threads = GridSample3DThreadPool::instance().size();
+        std::vector<int32_t> threadCounts{0};
+        if (threads > 1) {
+            threadCounts.push_back(static_cast<int32_t>(threads / 2));
+        }
+        for (int32_t tile : {64, 256, 1024}) {
+            // the previous (4x shorter) tile already covers the whole output
+            if (tile > 64 && static_cast<size_t>(tile / 4) >= voxels) {
+                continue;
+            }
+            for (int32_t numThreads : threadCounts) {
+                GridSample3DTactic tactic = base;
+                tactic.tileVoxels = tile;
+                tactic.numThreads = numThreads;
+                add(tactic);
+            }
+        }
+        for (GridSample3DTraversal traversal : {GridSample3DTraversal::Tiled, GridSample3DTraversal::Morton}) {
+            for (int32_t tile : {64, 256}) {
+                GridSample3DTactic tactic = base;
+                tactic.tileVoxels = tile;
+                tactic.traversal = traversal;
+                add(tactic);
+            }
+        }
+        return candidates;
+    }
+
+    // channel slices only pay off once there are enough channels to split
+    std::vector<int32_t> channelsPerThread{0};
+    if (C > 4) {
+        channelsPerThread.push_back(4);
+    }
+    if (C > 16) {
+        channelsPerThread.push_back(16);
+    }
+    for (int32_t block : {64, 128, 256, 512}) {
+        for (int32_t perThread : {1, 2, 4}) {
+            // skip configurations that leave most threads without a voxel
+            if (perThread > 1 && static_cast<size_t>(block) * perThread > voxels) {
+                continue;
+            }
+            for (int32_t channels : channelsPerThread) {
+                GridSample3DTactic tactic = base;
+                tactic.blockSize = block;
+                tactic.voxelsPerThread = perThread;
+                tactic.channelsPerThread = channels;
+                add(tactic);
+            }
+        }
+    }
+    for (GridSample3DTraversal traversal : {GridSample3DTraversal::Tiled, GridSample3DTraversal::Morton}) {
+        for (int32_t block : {128, 256}) {
+            for (int32_t channels : channelsPerThread) {
+                GridSample3DTactic tactic = base;
+                tactic.blockSize = block;
+                tactic.channelsPerThread = channels;
+                tactic.traversal = traversal;
+                add(tactic);
+            }
+        }
+    }
+    return candidates;
+}
+
+size_t grid_sample_3d_workspace_size(
+    const GridSample3DTactic& tactic,
+    size_t N, size_t D_in, size_t H_in, size_t W_in,
+    size_t D_grid, size_t H_grid, size_t W_grid
+) {
+    return GridSample3DWorkspace(tactic, N, D_in, H_in, W_in, D_grid, H_grid, W_grid).bytes;
+}
+
+size_t grid_sample_3d_mipmap_workspace_size(size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in) {
+    const GridSample3DMipPyramid pyramid(N * C, static_cast<int>(D_in), static_cast<int>(H_in), static_cast<int>(W_in));
+    return pyramid.offset[pyramid.levels] * sizeof(float);
+}
+
+template <typename grid_t>
+GridSample3DTileStats grid_sample_3d_tile_stats(
+    const grid_t* grid,
+    size_t N, size_t D_in, size_t H_in, size_t W_in,
+    size_t D_grid, size_t H_grid, size_t W_grid,
+    bool align_corners,
+    GridSample3DInterpolationMode interpolationMode,
+    GridSample3DPaddingMode paddingMode
+) {
+    GridSample3DTileStats stats;
+    const size_t voxels = N * D_grid * H_grid * W_grid;
+    for (size_t begin = 0; begin < voxels; begin += GRID_SAMPLE_3D_BOUNDS_TILE) {
+        GridSample3DIndexBox box;
+        for (size_t i = begin; i < std::min(voxels, begin + GRID_SAMPLE_3D_BOUNDS_TILE); i++) {
+            box.add(compute_index(to_float(grid[3 * i]), static_cast<int>(W_in), paddingMode, align_corners),
+                    compute_index(to_float(grid[3 * i + 1]), static_cast<int>(H_in), paddingMode, align_corners),
+                    compute_index(to_float(grid[3 * i + 2]), static_cast<int>(D_in), paddingMode, align_corners));
+        }
+        switch (box.classify(interpolationMode, static_cast<int>(W_in), static_cast<int>(H_in), static_cast<int>(D_in))) {
+            case GridSample3DTileClass::Outside:
+                stats.outside++;
+                break;
+            case GridSample3DTileClass::Inside:
+                stats.inside++;
+                break;
+            default:
+                stats.mixed++;
+        }
+    }
+    return stats;
+}
+
+bool grid_sample_3d_apply_tactic_id(int32_t id, bool sized, size_t voxels, size_t C, GridSample3DTactic& tactic) {
+    if (id <= 0 || !sized) {
+        return true;
+    }
+    const std::vector<GridSample3DTactic> candidates = grid_sample_3d_tactic_candidates(GridSample3DBackend::CUDA,
+                                                                                        voxels, C);
+    if (static_cast<size_t>(id) > candidates.size()) {
+        return false;
+    }
+    const GridSample3DBucketing bucketing = tactic.bucketing;
+    const bool tileBounds = tactic.tileBounds;
+    tactic = candidates[id - 1];
+    tactic.bucketing = bucketing;
+    tactic.tileBounds = tileBounds;
+    return true;
+}
+
+GridSample3DTactic grid_sample_3d_pick_tactic(
+    const std::vector<GridSample3DTactic>& candidates,
+    const std::function<float(const GridSample3DTactic&)>& measure,
+    int repeats
+) {
+    if (candidates.empty()) {
+        return GridSample3DTactic();
+    }
+    repeats = std::max(repeats, 1);
+    size_t best = 0;
+    float bestTime = -1.f;
+    std::vector<float> times(repeats);
+    for (size_t i = 0; i < candidates.size(); i++) {
+        bool failed = false;
+        for (int r = 0; r < repeats && !failed; r++) {
+            times[r] = measure(candidates[i]);
+            failed = times[r] < 0.f;
+        }
+        if (failed) {
+            continue;
+        }
+        std::nth_element(times.begin(), times.begin() + repeats / 2, times.end());
+        const float median = times[repeats / 2];
+        if (bestTime < 0.f || median < bestTime) {
+            best = i;
+            bestTime = median;
+        }
+    }
+    return candidates[best];
+}
+
+template <typename scalar_t, typename grid_t>
+GridSample3DTactic grid_sample_3d_cpu_autotune(
+    const scalar_t* input,
+    const grid_t* grid,
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    size_t D_grid, size_t H_grid, size_t W_grid,
+    bool align_corners,
+    GridSample3DInterpolationMode interpolationMode,
+    GridSample3DPaddingMode paddingMode,
+    scalar_t* output,
+    GridSample3DLayout layout,
+    GridSample3DGridKind gridKind
+) {
+    std::vector<GridSample3DTactic> candidates = grid_sample_3d_tactic_candidates(
+        GridSample3DBackend::CPU, N * D_grid * H_grid * W_grid, C);
+    return grid_sample_3d_pick_tactic(candidates, [&](const GridSample3DTactic& tactic) {
+        const auto start = std::chrono::steady_clock::now();
+        if (grid_sample_3d_cpu(input, grid, N, C, D_in, H_in, W_in, D_grid, H_grid, W_grid, align_corners,
+                               interpolationMode, paddingMode, output, layout, gridKind, tactic) != 0) {
+            return -1.f;
+        }
+        return std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+    });
+}
+
+// template specialization
+template GridSample3DTileStats grid_sample_3d_tile_stats<float>(
+    const float* grid,
+    size_t N, size_t D_in, size_t H_in, size_t W_in,
+    size_t D_grid, size_t H_grid, size_t W_grid,
+    bool align_corners,
+    GridSample3DInterpolationMode interpolationMode,
+    GridSample3DPaddingMode paddingMode
+);
+
+template GridSample3DTileStats grid_sample_3d_tile_stats<half>(
+    const half* grid,
+    size_t N, size_t D_in, size_t H_in, size_t W_in,
+    size_t D_grid, size_t H_grid, size_t W_grid,
+    bool align_corners,
+    GridSample3DInterpolationMode interpolationMode,
+    GridSample3DPaddingMode paddingMode
+);
+
+template GridSample3DTactic grid_sample_3d_cpu_autotune<float, float>(
+    const float* input,
+    const float* grid,
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    size_t D_grid, size_t H_grid, size_t W_grid,
+    bool align_corners,
+    GridSample3DInterpolationMode interpolationMode,
+    GridSample3DPaddingMode paddingMode,
+    float* output,
+    GridSample3DLayout layout,
+    GridSample3DGridKind gridKind
+);
+
+template GridSample3DTactic grid_sample_3d_cpu_autotune<half, half>(
+    const half* input,
+    const half* grid,
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    size_t D_grid, size_t H_grid, size_t W_grid,
+    bool align_corners,
+    GridSample3DInterpolationMode interpolationMode,
+    GridSample3DPaddingMode paddingMode,
+    half* output,
+    GridSample3DLayout layout,
+    GridSample3DGridKind gridKind
+);
+
+template GridSample3DTactic grid_sample_3d_cpu_autotune<bfloat16, bfloat16>(
+    const bfloat16* input,
+    const bfloat16* grid,
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    size_t D_grid, size_t H_grid, size_t W_grid,
+    bool align_corners,
+    GridSample3DInterpolationMode interpolationMode,
+    GridSample3DPaddingMode paddingMode,
+    bfloat16* output,
+    GridSample3DLayout layout,
+    GridSample3DGridKind gridKind
+);
+
+template GridSample3DTactic grid_sample_3d_cpu_autotune<half, float>(
+    const half* input,
+    const float* grid,
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    size_t D_grid, size_t H_grid, size_t W_grid,
+    bool align_corners,
+    GridSample3DInterpolationMode interpolationMode,
+    GridSample3DPaddingMode paddingMode,
+    half* output,
+    GridSample3DLayout layout,
+    GridSample3DGridKind gridKind
+);
+
+template GridSample3DTactic grid_sample_3d_cpu_autotune<bfloat16, float>(
+    const bfloat16* input,
+    const float* grid,
+    size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+    size_t D_grid, size_t H_grid, size_t W_grid,
+    bool align_corners,
+    GridSample3DInterpolationMode interpolationMode,
+    GridSample3DPaddingMode paddingMode,
+    bfloat16* output,
+    GridSample3DLayout layout,
+    GridSample3DGridKind gridKind
+);
@@ -0,0 +1,95 @@
+#include "grid_sample_3d_thread_pool.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+GridSample3DThreadPool::GridSample3DThreadPool(size_t numThreads) {
+    numThreads = std::max<size_t>(numThreads, 1);
+    for (size_t i = 1; i < numThreads; i++) {
+        mWorkers.emplace_back(&GridSample3DThreadPool::workerLoop, this);
+    }
+}
+
+GridSample3DThreadPool::~GridSample3DThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mStop = true;
+    }
+    mWakeCv.notify_all();
+    for (auto& worker : mWorkers) {
+        worker.join();
+    }
+}
+
+GridSample3DThreadPool& GridSample3DThreadPool::instance() {
+    static GridSample3DThreadPool pool([]() -> size_t {
+        const char* env = std::getenv("GRID_SAMPLE_3D_NUM_THREADS");
+        if (env && std::atoi(env) > 0) {
+            return static_cast<size_t>(std::atoi(env));
+        }
+        return std::max<unsigned>(std::thread::hardware_concurrency(), 1u);
+    }());
+    return pool;
+}
+
+void GridSample3DThreadPool::runChunks() {
+    for (;;) {
+        size_t begin = mNext.fetch_add(mChunk);
+        if (begin >= mCount) {
+            return;
+        }
+        (*mFn)(begin, std::min(begin + mChunk, mCount));
+    }
+}
+
+void GridSample3DThreadPool::workerLoop() {
+    size_t seenGeneration = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            mWakeCv.wait(lock, [&] { return mStop || mGeneration != seenGeneration; });
+            if (mStop) {
+                return;
+            }
+            seenGeneration = mGeneration;
+        }
+        runChunks();
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mFinished++;
+        }
+        mDoneCv.notify_one();
+    }
+}
+
+void GridSample3DThreadPool::parallelFor(size_t count, size_t grain, const std::function<void(size_t, size_t)>& fn) {
+    if (count == 0) {
+        return;
+    }
+    grain = std::max<size_t>(grain, 1);
+    if (mWorkers.empty() || count <= grain) {
+        fn(0, count);
+        return;
+    }
+
+    std::lock_guard<std::mutex> job(mJobMutex);
+    // a few chunks per thread so uneven rows still balance
+    size_t chunk = std::max(grain, (count + size() * 4 - 1) / (size() * 4));
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mFn = &fn;
+        mCount = count;
+        mChunk = chunk;
+        mNext.store(0);
+        mFinished = 0;
+        mGeneration++;
+    }
+    mWakeCv.notify_all();
+
+    runChunks();
+
+    std::unique_lock<std::mutex> lock(mMutex);
+    // every worker checks in for every generation, so none can straddle two jobs
+    mDoneCv.wait(lock, [&] { return mFinished == mWorkers.size(); });
+    mFn = nullptr;
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed-size fork/join pool used by the CPU backend.
+// The calling thread participates in every parallelFor, so a pool of size 1 has no workers.
+class GridSample3DThreadPool {
+public:
+    explicit GridSample3DThreadPool(size_t numThreads);
+    ~GridSample3DThreadPool();
+
+    GridSample3DThreadPool(const GridSample3DThreadPool&) = delete;
+    GridSample3DThreadPool& operator=(const GridSample3DThreadPool&) = delete;
+
+    // process-wide pool, sized by GRID_SAMPLE_3D_NUM_THREADS or the hardware concurrency
+    static GridSample3DThreadPool& instance();
+
+    size_t size() const { return mWorkers.size() + 1; }
+
+    // Runs fn(begin, end) over [0, count) in chunks of at least `grain` items and blocks until done.
+    void parallelFor(size_t count, size_t grain, const std::function<void(size_t, size_t)>& fn);
+
+private:
+    void workerLoop();
+    void runChunks();
+
+    std::vector<std::thread> mWorkers;
+    std::mutex mJobMutex;   // serializes concurrent parallelFor callers
+    std::mutex mMutex;
+    std::condition_variable mWakeCv;
+    std::condition_variable mDoneCv;
+
+    const std::function<void(size_t, size_t)>* mFn = nullptr;
+    size_t mCount = 0;
+    size_t mChunk = 0;
+    std::atomic<size_t> mNext{0};
+    size_t mFinished = 0;
+    size_t mGeneration = 0;
+    bool mStop = false;
+};
@@ -0,0 +1,1345 @@
+// Benchmark suite of the CPU and CUDA backends: sweeps shapes, sampling modes, data types and
+// backends, and reports median/p99 latency and the achieved bandwidth against a measured copy
+// roofline. Runs on the CPU backend alone when no GPU is present.
+//
+//   bench_grid_sample [--quick] [--production] [--traversal] [--bucketed] [--tile-bounds] [--mask]
+//                     [--points] [--mipmap] [--ragged] [--cpu-only] [--repeats R]
+//                     [--json FILE] [--fixture DIR]
+//
+// --quick keeps the smallest shape only, --production adds the N=8, C=64, 128^3 deployment
+// shape (about 4 GiB per fp32 tensor), --traversal compares the output traversals on a rotated
+// 256^3 volume, --bucketed compares output order with bucketed sampling on random grids,
+// --tile-bounds times the bounds prepass on a field-of-view crop, --mask times output masks
+// keeping 10% and 50% of the voxels, --points compares the (N, C, P) and (N, P, C) outputs of a
+// point-list query, --mipmap compares the error and cost of bilinear and mipmap minification,
+// --ragged compares per-study calls, a padded batch and a ragged batch of differently sized
+// studies, --json writes every measurement for regression tracking, --fixture adds the
+// input.npy/grid.npy pair of a golden set (test/generate_fixtures.py), read in place from the
+// mapped files.
+
+#include "grid_sample_3d.h"
+#include "grid_sample_3d.cuh"
+#include "grid_sample_3d_cpu.h"
+#include "grid_sample_3d_thread_pool.h"
+#include "fixture.h"
+
+#include <cuda_runtime.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace
+{
+    using half = __half;
+    using bfloat16 = __nv_bfloat16;
+
+    struct BenchShape {
+        const char* name;
+        size_t N, C, D_in, H_in, W_in;
+        size_t D_grid, H_grid, W_grid;
+
+        size_t inputCount() const { return N * C * D_in * H_in * W_in; }
+        size_t gridCount() const { return N * D_grid * H_grid * W_grid * 3; }
+        size_t outputCount() const { return N * C * D_grid * H_grid * W_grid; }
+    };
+
+    const BenchShape kShapes[] = {
+        {"small", 1, 4, 32, 32, 32, 32, 32, 32},
+        {"medium", 2, 16, 64, 64, 64, 64, 64, 64},
+        {"upsample", 1, 8, 32, 32, 32, 96, 96, 96},
+        {"downsample", 1, 8, 128, 128, 128, 48, 48, 48},
+    };
+
+    const BenchShape kProductionShape = {"production", 8, 64, 128, 128, 128, 128, 128, 128};
+
+    const GridSample3DInterpolationMode kInterpolationModes[] = {
+        GridSample3DInterpolationMode::Bilinear,
+        GridSample3DInterpolationMode::Nearest,
+    };
+
+    const GridSample3DPaddingMode kPaddingModes[] = {
+        GridSample3DPaddingMode::Zeros,
+        GridSample3DPaddingMode::Border,
+        GridSample3DPaddingMode::Reflection,
+    };
+
+    const char* interpolationName(GridSample3DInterpolationMode mode) {
+        if (mode == GridSample3DInterpolationMode::Mipmap) {
+            return "mipmap";
+        }
+        return mode == GridSample3DInterpolationMode::Nearest ? "nearest" : "bilinear";
+    }
+
+    const char* paddingName(GridSample3DPaddingMode mode) {
+        switch (mode) {
+            case GridSample3DPaddingMode::Border:
+                return "border";
+            case GridSample3DPaddingMode::Reflection:
+                return "reflection";
+            default:
+                return "zeros";
+        }
+    }
+
+    struct Options {
+        bool quick = false;
+        bool production = false;
+        bool traversal = false;
+        bool bucketed = false;
+        bool tileBounds = false;
+        bool mask = false;
+        bool points = false;
+        bool mipmap = false;
+        bool ragged = false;
+        bool cpuOnly = false;
+        int warmup = 2;
+        int repeats = 20;
+        const char* json = nullptr;
+        const char* fixture = nullptr;
+    };
+
+    struct Timing {
+        double median_ms = 0.0;
+        double p99_ms = 0.0;
+        int status = 0;
+    };
+
+    struct Result {
+        std::string backend, dtype, shape;
+        std::string traversal = "linear";
+        std::string bucketing = "off";
+        bool tileBounds = false;
+        double maskDensity = 1.0;   // fraction of output voxels the mask keeps
+        std::string pointLayout = "none";   // "ncp" or "npc" for point-list queries
+        double rmse = -1.0;   // error against a box-filtered reference, -1 when not measured
+        std::string batching = "dense";   // "per_item", "padded" or "ragged"
+        BenchShape dims;
+        GridSample3DInterpolationMode interpolation;
+        GridSample3DPaddingMode padding;
+        Timing timing;
+        double bytes;
+        double gbps;
+        double roofline_gbps;
+    };
+
+    Timing summarize(std::vector<double>& samples, int status) {
+        Timing timing;
+        timing.status = status;
+        if (samples.empty()) {
+            return timing;
+        }
+        std::sort(samples.begin(), samples.end());
+        const size_t n = samples.size();
+        timing.median_ms = n % 2 ? samples[n / 2] : 0.5 * (samples[n / 2 - 1] + samples[n / 2]);
+        // nearest-rank percentile
+        size_t rank = static_cast<size_t>(std::ceil(0.99 * n));
+        timing.p99_ms = samples[std::max<size_t>(rank, 1) - 1];
+        return timing;
+    }
+
+    template <typename Fn>
+    Timing timeCpu(const Options& options, Fn fn) {
+        int status = 0;
+        for (int i = 0; i < options.warmup; i++) {
+            status |= fn();
+        }
+        std::vector<double> samples;
+        for (int i = 0; i < options.repeats && status == 0; i++) {
+            auto start = std::chrono::steady_clock::now();
+            status |= fn();
+            auto stop = std::chrono::steady_clock::now();
+            samples.push_back(std::chrono::duration<double, std::milli>(stop - start).count());
+        }
+        return summarize(samples, status);
+    }
+
+    // one event pair per launch, so every sample is the device time of a single call
+    template <typename Fn>
+    Timing timeCuda(const Options& options, cudaStream_t stream, Fn fn) {
+        int status = 0;
+        for (int i = 0; i < options.warmup; i++) {
+            status |= fn();
+        }
+        cudaEvent_t start, stop;
+        cudaEventCreate(&start);
+        cudaEventCreate(&stop);
+        std::vector<double> samples;
+        for (int i = 0; i < options.repeats && status == 0; i++) {
+            cudaEventRecord(start, stream);
+            status |= fn();
+            cudaEventRecord(stop, stream);
+            cudaEventSynchronize(stop);
+            float ms = 0.f;
+            cudaEventElapsedTime(&ms, start, stop);
+            samples.push_back(ms);
+        }
+        status |= cudaStreamSynchronize(stream) != cudaSuccess;
+        cudaEventDestroy(start);
+        cudaEventDestroy(stop);
+        return summarize(samples, status);
+    }
+
+    // Roofline of each backend: the bandwidth of a plain copy through the same memory system
+    // (read + write bytes over time), on the CPU split over the backend's thread pool.
+    const size_t kRooflineBytes = size_t(256) << 20;
+
+    double cpuRooflineGbps(const Options& options) {
+        std::vector<char> src(kRooflineBytes, 1), dst(kRooflineBytes);
+        GridSample3DThreadPool& pool = GridSample3DThreadPool::instance();
+        Timing timing = timeCpu(options, [&]() {
+            pool.parallelFor(kRooflineBytes, size_t(1) << 20, [&](size_t begin, size_t end) {
+                std::memcpy(dst.data() + begin, src.data() + begin, end - begin);
+            });
+            return 0;
+        });
+        return 2.0 * kRooflineBytes / (timing.median_ms * 1e6);
+    }
+
+    double cudaRooflineGbps(const Options& options, cudaStream_t stream) {
+        void *src, *dst;
+        if (cudaMalloc(&src, kRooflineBytes) != cudaSuccess) {
+            return 0.0;
+        }
+        if (cudaMalloc(&dst, kRooflineBytes) != cudaSuccess) {
+            cudaFree(src);
+            return 0.0;
+        }
+        cudaMemsetAsync(src, 1, kRooflineBytes, stream);
+        Timing timing = timeCuda(options, stream, [&]() {
+            return cudaMemcpyAsync(dst, src, kRooflineBytes, cudaMemcpyDeviceToDevice, stream) != cudaSuccess;
+        });
+        cudaFree(src);
+        cudaFree(dst);
+        return timing.status ? 0.0 : 2.0 * kRooflineBytes / (timing.median_ms * 1e6);
+    }
+
+    // Compulsory traffic: grid read and output write once, and the input read at most once,
+    // or only the taps actually gathered when the output is smaller than the input.
+    double compulsoryBytes(const BenchShape& s, size_t elementSize, GridSample3DInterpolationMode interpolation) {
+        const double taps = interpolation == GridSample3DInterpolationMode::Nearest ? 1.0 : 8.0;
+        const double input = std::min<double>(s.inputCount(), taps * s.outputCount()) * elementSize;
+        return input + s.gridCount() * sizeof(float) + s.outputCount() * elementSize;
+    }
+
+    // Entry points of one data type, with an fp32 grid.
+    template <typename scalar_t>
+    struct Sampler {
+        static const char* name();
+
+        static int cpu(const scalar_t* input, const float* grid, const BenchShape& s,
+                       GridSample3DInterpolationMode interpolation, GridSample3DPaddingMode padding, scalar_t* output) {
+            return grid_sample_3d_cpu<scalar_t, float>(input, grid, s.N, s.C, s.D_in, s.H_in, s.W_in,
+                                                       s.D_grid, s.H_grid, s.W_grid, false, interpolation, padding, output);
+        }
+
+        static int cuda(const scalar_t* input, const float* grid, const BenchShape& s,
+                        GridSample3DInterpolationMode interpolation, GridSample3DPaddingMode padding, scalar_t* output,
+                        cudaStream_t stream) {
+            return grid_sample_3d_cuda<scalar_t, float>(input, grid, s.N, s.C, s.D_in, s.H_in, s.W_in,
+                                                        s.D_grid, s.H_grid, s.W_grid, false, interpolation, padding,
+                                                        output, stream);
+        }
+    };
+
+    template <> const char* Sampler<float>::name() { return "fp32"; }
+    template <> const char* Sampler<half>::name() { return "fp16"; }
+    template <> const char* Sampler<bfloat16>::name() { return "bf16"; }
+
+    // int8 volume requantized with the same per-tensor parameters
+    template <>
+    struct Sampler<int8_t> {
+        static GridSample3DQuantization quantization() {
+            GridSample3DQuantization q;
+            q.scale = 2.f / 255.f;
+            return q;
+        }
+
+        static const char* name() { return "int8"; }
+
+        static int cpu(const int8_t* input, const float* grid, const BenchShape& s,
+                       GridSample3DInterpolationMode interpolation, GridSample3DPaddingMode padding, int8_t* output) {
+            return grid_sample_3d_quantized_cpu<int8_t, int8_t, float>(
+                input, quantization(), grid, s.N, s.C, s.D_in, s.H_in, s.W_in, s.D_grid, s.H_grid, s.W_grid, false,
+                interpolation, padding, output, quantization());
+        }
+
+        static int cuda(const int8_t* input, const float* grid, const BenchShape& s,
+                        GridSample3DInterpolationMode interpolation, GridSample3DPaddingMode padding, int8_t* output,
+                        cudaStream_t stream) {
+            return grid_sample_3d_quantized_cuda<int8_t, int8_t, float>(
+                input, quantization(), grid, s.N, s.C, s.D_in, s.H_in, s.W_in, s.D_grid, s.H_grid, s.W_grid, false,
+                interpolation, padding, output, quantization(), stream);
+        }
+    };
+
+    template <typename scalar_t>
+    scalar_t fromUniform(float v) {
+        return from_float<scalar_t>(v);
+    }
+
+    template <>
+    int8_t fromUniform<int8_t>(float v) {
+        return quantize_value<int8_t>(v, Sampler<int8_t>::quantization(), 0);
+    }
+
+    struct Context {
+        Options options;
+        bool cuda = false;
+        cudaStream_t stream = nullptr;
+        double cpuRoofline = 0.0;
+        double cudaRoofline = 0.0;
+        std::vector<Result> results;
+    };
+
+    void record(Context& context, const char* backend, const char* dtype, const BenchShape& s, size_t elementSize,
+                GridSample3DInterpolationMode interpolation, GridSample3DPaddingMode padding, const Timing& timing,
+                double roofline) {
+        Result r;
+        r.backend = backend;
+        r.dtype = dtype;
+        r.shape = s.name;
+        r.dims = s;
+        r.interpolation = interpolation;
+        r.padding = padding;
+        r.timing = timing;
+        r.bytes = compulsoryBytes(s, elementSize, interpolation);
+        r.gbps = timing.median_ms > 0.0 ? r.bytes / (timing.median_ms * 1e6) : 0.0;
+        r.roofline_gbps = roofline;
+        printf("%-5s %-5s %-11s %-9s %-11s %10.3f %10.3f %9.1f %7.1f%%%s\n", backend, dtype, s.name,
+               interpolationName(interpolation), paddingName(padding), timing.median_ms, timing.p99_ms, r.gbps,
+               roofline > 0.0 ? 100.0 * r.gbps / roofline : 0.0, timing.status ? "  FAILED" : "");
+        context.results.push_back(r);
+    }
+
+    // The input volume as scalar_t: the fp32 fixture values in place, converted otherwise, or
+    // uniform noise when there is no fixture.
+    template <typename scalar_t>
+    const scalar_t* inputOf(const BenchShape& s, const float* values, std::vector<scalar_t>& storage) {
+        if (std::is_same<scalar_t, float>::value && values != nullptr) {
+            return reinterpret_cast<const scalar_t*>(values);
+        }
+        storage.resize(s.inputCount());
+        std::mt19937 rng(11);
+        std::uniform_real_distribution<float> dist(-1.f, 1.f);
+        for (size_t i = 0; i < storage.size(); i++) {
+            storage[i] = fromUniform<scalar_t>(values != nullptr ? values[i] : dist(rng));
+        }
+        return storage.data();
+    }
+
+    template <typename scalar_t>
+    void benchDataType(Context& context, const BenchShape& s, const float* grid, const float* d_grid,
+                       const float* values) {
+        using S = Sampler<scalar_t>;
+        std::vector<scalar_t> storage;
+        const scalar_t* input = inputOf(s, values, storage);
+        std::vector<scalar_t> output(s.outputCount());
+
+        scalar_t *d_input = nullptr, *d_output = nullptr;
+        bool cuda = context.cuda && d_grid != nullptr;
+        if (cuda) {
+            const size_t bytes = s.inputCount() * sizeof(scalar_t);
+            cuda = cudaMalloc(&d_input, bytes) == cudaSuccess &&
+                   cudaMalloc(&d_output, output.size() * sizeof(scalar_t)) == cudaSuccess &&
+                   cudaMemcpy(d_input, input, bytes, cudaMemcpyHostToDevice) == cudaSuccess;
+            if (!cuda) {
+                printf("cuda  %-5s %-11s skipped, out of device memory\n", S::name(), s.name);
+            }
+        }
+
+        for (auto interpolation : kInterpolationModes) {
+            for (auto padding : kPaddingModes) {
+                Timing cpu = timeCpu(context.options, [&]() {
+                    return S::cpu(input, grid, s, interpolation, padding, output.data());
+                });
+                record(context, "cpu", S::name(), s, sizeof(scalar_t), interpolation, padding, cpu, context.cpuRoofline);
+                if (cuda) {
+                    Timing gpu = timeCuda(context.options, context.stream, [&]() {
+                        return S::cuda(d_input, d_grid, s, interpolation, padding, d_output, context.stream);
+                    });
+                    record(context, "cuda", S::name(), s, sizeof(scalar_t), interpolation, padding, gpu,
+                           context.cudaRoofline);
+                }
+            }
+        }
+        cudaFree(d_input);
+        cudaFree(d_output);
+    }
+
+    // grid and values (fp32 input) are mapped fixture tensors, or nullptr for random data
+    void benchShape(Context& context, const BenchShape& s, const float* grid = nullptr, const float* values = nullptr) {
+        std::vector<float> storage;
+        if (grid == nullptr) {
+            storage.resize(s.gridCount());
+            std::mt19937 rng(7);
+            std::uniform_real_distribution<float> dist(-1.1f, 1.1f);
+            for (auto& v : storage) {
+                v = dist(rng);
+            }
+            grid = storage.data();
+        }
+        float* d_grid = nullptr;
+        if (context.cuda &&
+            (cudaMalloc(&d_grid, s.gridCount() * sizeof(float)) != cudaSuccess ||
+             cudaMemcpy(d_grid, grid, s.gridCount() * sizeof(float), cudaMemcpyHostToDevice) != cudaSuccess)) {
+            cudaFree(d_grid);
+            d_grid = nullptr;
+        }
+
+        benchDataType<float>(context, s, grid, d_grid, values);
+        benchDataType<half>(context, s, grid, d_grid, values);
+        benchDataType<bfloat16>(context, s, grid, d_grid, values);
+        benchDataType<int8_t>(context, s, grid, d_grid, values);
+        cudaFree(d_grid);
+    }
+
+    // Set-associative LRU cache of 64-byte lines, replaying an address stream to count misses.
+    class CacheModel {
+    public:
+        CacheModel(size_t bytes, size_t ways)
+            : mWays(ways), mSets(bytes / 64 / ways), mTags(mSets * ways, UINT64_MAX), mStamps(mSets * ways, 0) {}
+
+        void access(uint64_t address) {
+            const uint64_t line = address / 64;
+            const size_t set = static_cast<size_t>(line % mSets) * mWays;
+            size_t victim = set;
+            mClock++;
+            for (size_t i = set; i < set + mWays; i++) {
+                if (mTags[i] == line) {
+                    mStamps[i] = mClock;
+                    return;
+                }
+                if (mStamps[i] < mStamps[victim]) {
+                    victim = i;
+                }
+            }
+            mMisses++;
+            mTags[victim] = line;
+            mStamps[victim] = mClock;
+        }
+
+        uint64_t misses() const { return mMisses; }
+
+    private:
+        size_t mWays, mSets;
+        std::vector<uint64_t> mTags, mStamps;
+        uint64_t mClock = 0, mMisses = 0;
+    };
+
+    // Misses per output voxel of the single-channel fp32 input gathers of bilinear/zeros sampling,
+    // in the order `bricks` visits the output, through a 1 MiB 16-way cache (about a core's L2).
+    double simulatedMisses(const BenchShape& s, const float* grid, const GridSample3DBricks& bricks) {
+        CacheModel cache(size_t(1) << 20, 16);
+        size_t voxels = 0;
+        for (size_t i = 0; i < bricks.count(s.N); i++) {
+            size_t n, d, h, w;
+            if (!bricks.voxel(i, n, d, h, w)) {
+                continue;
+            }
+            const float* g = grid + (((n * s.D_grid + d) * s.H_grid + h) * s.W_grid + w) * 3;
+            float ix = compute_index<GridSample3DPaddingMode::Zeros, false>(g[0], static_cast<int>(s.W_in));
+            float iy = compute_index<GridSample3DPaddingMode::Zeros, false>(g[1], static_cast<int>(s.H_in));
+            float iz = compute_index<GridSample3DPaddingMode::Zeros, false>(g[2], static_cast<int>(s.D_in));
+            const int x0 = static_cast<int>(std::floor(ix)), y0 = static_cast<int>(std::floor(iy));
+            const int z0 = static_cast<int>(std::floor(iz));
+            for (int k = 0; k < 8; k++) {
+                const int x = x0 + (k & 1), y = y0 + (k >> 1 & 1), z = z0 + (k >> 2);
+                if (x >= 0 && x < static_cast<int>(s.W_in) && y >= 0 && y < static_cast<int>(s.H_in) && z >= 0 &&
+                    z < static_cast<int>(s.D_in)) {
+                    cache.access(((n * s.D_in + z) * s.H_in + y) * s.W_in * sizeof(float) + x * sizeof(float));
+                }
+            }
+            voxels++;
+        }
+        return static_cast<double>(cache.misses()) / voxels;
+    }
+
+    const char* traversalName(GridSample3DTraversal traversal) {
+        switch (traversal) {
+            case GridSample3DTraversal::Tiled:
+                return "tiled";
+            case GridSample3DTraversal::Morton:
+                return "morton";
+            default:
+                return "linear";
+        }
+    }
+
+    // Output traversals on a 256^3 volume sampled through a rotation (30 degrees about the
+    // diagonal), so a linear walk along W strides across input rows and slices. Reports the time
+    // of each backend and the simulated cache misses of the CPU order (rows of GRID_SAMPLE_3D_CPU_BRICK
+    // x GRID_SAMPLE_3D_CPU_BRICK bricks) and the CUDA order (4 x 8 x 8 bricks, by thread index).
+    void benchTraversal(Context& context) {
+        const BenchShape s = {"rotated256", 1, 2, 256, 256, 256, 256, 256, 256};
+        const float c = std::cos(0.5235988f), k = (1.f - c) / 3.f, r = std::sin(0.5235988f) / std::sqrt(3.f);
+        const float theta[12] = {c + k, k - r, k + r, 0.f, k + r, c + k, k - r, 0.f, k - r, k + r, c + k, 0.f};
+        std::vector<float> grid(s.gridCount());
+        for (size_t d = 0; d < s.D_grid; d++) {
+            for (size_t h = 0; h < s.H_grid; h++) {
+                for (size_t w = 0; w < s.W_grid; w++) {
+                    float* g = grid.data() + ((d * s.H_grid + h) * s.W_grid + w) * 3;
+                    affine_grid_coords(theta, affine_grid_base<false>(w, s.W_grid), affine_grid_base<false>(h, s.H_grid),
+                                       affine_grid_base<false>(d, s.D_grid), g[0], g[1], g[2]);
+                }
+            }
+        }
+        std::vector<float> storage;
+        const float* input = inputOf<float>(s, nullptr, storage);
+        std::vector<float> output(s.outputCount());
+
+        float *d_input = nullptr, *d_grid = nullptr, *d_output = nullptr;
+        bool cuda = context.cuda && cudaMalloc(&d_input, s.inputCount() * sizeof(float)) == cudaSuccess &&
+                    cudaMalloc(&d_grid, grid.size() * sizeof(float)) == cudaSuccess &&
+                    cudaMalloc(&d_output, output.size() * sizeof(float)) == cudaSuccess &&
+                    cudaMemcpy(d_input, input, s.inputCount() * sizeof(float), cudaMemcpyHostToDevice) == cudaSuccess &&
+                    cudaMemcpy(d_grid, grid.data(), grid.size() * sizeof(float), cudaMemcpyHostToDevice) == cudaSuccess;
+
+        const auto interpolation = GridSample3DInterpolationMode::Bilinear;
+        const auto padding = GridSample3DPaddingMode::Zeros;
+        printf("\n%-8s %12s %12s %16s %16s\n", "traverse", "cpu ms", "cuda ms", "cpu misses/vox", "cuda misses/vox");
+        for (auto traversal : {GridSample3DTraversal::Linear, GridSample3DTraversal::Tiled, GridSample3DTraversal::Morton}) {
+            GridSample3DTactic tactic;
+            tactic.traversal = traversal;
+            Timing cpu = timeCpu(context.options, [&]() {
+                return grid_sample_3d_cpu<float, float>(input, grid.data(), s.N, s.C, s.D_in, s.H_in, s.W_in, s.D_grid,
+                                                        s.H_grid, s.W_grid, false, interpolation, padding, output.data(),
+                                                        GridSample3DLayout::NCDHW, GridSample3DGridKind::Absolute, tactic);
+            });
+            Timing gpu;
+            if (cuda) {
+                gpu = timeCuda(context.options, context.stream, [&]() {
+                    return grid_sample_3d_cuda<float, float>(d_input, d_grid, s.N, s.C, s.D_in, s.H_in, s.W_in,
+                                                             s.D_grid, s.H_grid, s.W_grid, false, interpolation, padding,
+                                                             d_output, context.stream, GridSample3DLayout::NCDHW,
+                                                             GridSample3DGridKind::Absolute, tactic);
+                });
+            }
+            const double cpuMisses = simulatedMisses(
+                s, grid.data(), grid_sample_3d_bricks(traversal, s.D_grid, s.H_grid, s.W_grid, GRID_SAMPLE_3D_CPU_BRICK,
+                                                      GRID_SAMPLE_3D_CPU_BRICK, tactic.tileVoxels));
+            const double cudaMisses = simulatedMisses(
+                s, grid.data(), grid_sample_3d_bricks(traversal, s.D_grid, s.H_grid, s.W_grid, 4, 8, 8));
+            printf("%-8s %12.3f %12.3f %16.3f %16.3f%s\n", traversalName(traversal), cpu.median_ms,
+                   cuda ? gpu.median_ms : 0.0, cpuMisses, cudaMisses, cpu.status || gpu.status ? "  FAILED" : "");
+
+            for (int backend = 0; backend < (cuda ? 2 : 1); backend++) {
+                Result result;
+                result.backend = backend ? "cuda" : "cpu";
+                result.dtype = "fp32";
+                result.shape = s.name;
+                result.traversal = traversalName(traversal);
+                result.dims = s;
+                result.interpolation = interpolation;
+                result.padding = padding;
+                result.timing = backend ? gpu : cpu;
+                result.bytes = compulsoryBytes(s, sizeof(float), interpolation);
+                result.gbps = result.timing.median_ms > 0.0 ? result.bytes / (result.timing.median_ms * 1e6) : 0.0;
+                result.roofline_gbps = backend ? context.cudaRoofline : context.cpuRoofline;
+                context.results.push_back(result);
+            }
+        }
+        cudaFree(d_input);
+        cudaFree(d_grid);
+        cudaFree(d_output);
+    }
+
+    const char* bucketingName(GridSample3DBucketing bucketing) {
+        switch (bucketing) {
+            case GridSample3DBucketing::On:
+                return "on";
+            case GridSample3DBucketing::Auto:
+                return "auto";
+            default:
+                return "off";
+        }
+    }
+
+    // Bucketed sampling on random grids: 128^3 points drawn uniformly over a 256^3 volume, so
+    // neighbouring output voxels read unrelated input lines, and the same volume resampled through
+    // the identity, where Auto must keep output order. CUDA runs with the bucketing workspace.
+    void benchBucketed(Context& context) {
+        const BenchShape s = {"random256", 1, 2, 256, 256, 256, 128, 128, 128};
+        std::vector<float> random(s.gridCount()), identity(s.gridCount());
+        std::mt19937 rng(17);
+        std::uniform_real_distribution<float> dist(-1.f, 1.f);
+        for (float& v : random) {
+            v = dist(rng);
+        }
+        for (size_t d = 0; d < s.D_grid; d++) {
+            for (size_t h = 0; h < s.H_grid; h++) {
+                for (size_t w = 0; w < s.W_grid; w++) {
+                    float* g = identity.data() + ((d * s.H_grid + h) * s.W_grid + w) * 3;
+                    g[0] = affine_grid_base<false>(w, s.W_grid);
+                    g[1] = affine_grid_base<false>(h, s.H_grid);
+                    g[2] = affine_grid_base<false>(d, s.D_grid);
+                }
+            }
+        }
+        std::vector<float> storage;
+        const float* input = inputOf<float>(s, nullptr, storage);
+        std::vector<float> output(s.outputCount());
+
+        GridSample3DTactic bucketed;
+        bucketed.bucketing = GridSample3DBucketing::On;
+        const size_t workspaceBytes = grid_sample_3d_workspace_size(bucketed, s.N, s.D_in, s.H_in, s.W_in,
+                                                                    s.D_grid, s.H_grid, s.W_grid);
+        float *d_input = nullptr, *d_grid = nullptr, *d_output = nullptr;
+        void* d_workspace = nullptr;
+        bool cuda = context.cuda && cudaMalloc(&d_input, s.inputCount() * sizeof(float)) == cudaSuccess &&
+                    cudaMalloc(&d_grid, random.size() * sizeof(float)) == cudaSuccess &&
+                    cudaMalloc(&d_output, output.size() * sizeof(float)) == cudaSuccess &&
+                    cudaMalloc(&d_workspace, workspaceBytes) == cudaSuccess &&
+                    cudaMemcpy(d_input, input, s.inputCount() * sizeof(float), cudaMemcpyHostToDevice) == cudaSuccess;
+
+        const auto interpolation = GridSample3DInterpolationMode::Bilinear;
+        const auto padding = GridSample3DPaddingMode::Zeros;
+        printf("\n%-8s %-8s %12s %12s\n", "grid", "bucket", "cpu ms", "cuda ms");
+        for (const std::vector<float>* grid : {&random, &identity}) {
+            const char* gridName = grid == &random ? "random" : "identity";
+            if (cuda) {
+                cudaMemcpy(d_grid, grid->data(), grid->size() * sizeof(float), cudaMemcpyHostToDevice);
+            }
+            for (auto bucketing : {GridSample3DBucketing::Off, GridSample3DBucketing::On, GridSample3DBucketing::Auto}) {
+                GridSample3DTactic tactic;
+                tactic.bucketing = bucketing;
+                Timing cpu = timeCpu(context.options, [&]() {
+                    return grid_sample_3d_cpu<float, float>(input, grid->data(), s.N, s.C, s.D_in, s.H_in, s.W_in,
+                                                            s.D_grid, s.H_grid, s.W_grid, false, interpolation, padding,
+                                                            output.data(), GridSample3DLayout::NCDHW,
+                                                            GridSample3DGridKind::Absolute, tactic);
+                });
+                Timing gpu;
+                if (cuda) {
+                    gpu = timeCuda(context.options, context.stream, [&]() {
+                        return grid_sample_3d_cuda<float, float>(d_input, d_grid, s.N, s.C, s.D_in, s.H_in, s.W_in,
+                                                                 s.D_grid, s.H_grid, s.W_grid, false, interpolation,
+                                                                 padding, d_output, context.stream,
+                                                                 GridSample3DLayout::NCDHW,
+                                                                 GridSample3DGridKind::Absolute, tactic, d_workspace);
+                    });
+                }
+                printf("%-8s %-8s %12.3f %12.3f%s\n", gridName, bucketingName(bucketing), cpu.median_ms,
+                       cuda ? gpu.median_ms : 0.0, cpu.status || gpu.status ? "  FAILED" : "");
+
+                for (int backend = 0; backend < (cuda ? 2 : 1); backend++) {
+                    Result result;
+                    result.backend = backend ? "cuda" : "cpu";
+                    result.dtype = "fp32";
+                    result.shape = grid == &random ? "random256" : "identity256";
+                    result.bucketing = bucketingName(bucketing);
+                    result.dims = s;
+                    result.interpolation = interpolation;
+                    result.padding = padding;
+                    result.timing = backend ? gpu : cpu;
+                    result.bytes = compulsoryBytes(s, sizeof(float), interpolation);
+                    result.gbps = result.timing.median_ms > 0.0 ? result.bytes / (result.timing.median_ms * 1e6) : 0.0;
+                    result.roofline_gbps = backend ? context.cudaRoofline : context.cpuRoofline;
+                    context.results.push_back(result);
+                }
+            }
+        }
+        cudaFree(d_input);
+        cudaFree(d_grid);
+        cudaFree(d_output);
+        cudaFree(d_workspace);
+    }
+
+    // Bounds prepass on a field-of-view crop: an identity grid zoomed out by 1.6x, so the output
+    // shell samples outside the volume. Prints the tile classes next to the timings.
+    void benchTileBounds(Context& context) {
+        const BenchShape s = {"fov128", 1, 8, 128, 128, 128, 128, 128, 128};
+        std::vector<float> grid(s.gridCount());
+        for (size_t d = 0; d < s.D_grid; d++) {
+            for (size_t h = 0; h < s.H_grid; h++) {
+                for (size_t w = 0; w < s.W_grid; w++) {
+                    float* g = grid.data() + ((d * s.H_grid + h) * s.W_grid + w) * 3;
+                    g[0] = 1.6f * affine_grid_base<false>(w, s.W_grid);
+                    g[1] = 1.6f * affine_grid_base<false>(h, s.H_grid);
+                    g[2] = 1.6f * affine_grid_base<false>(d, s.D_grid);
+                }
+            }
+        }
+        std::vector<float> storage;
+        const float* input = inputOf<float>(s, nullptr, storage);
+        std::vector<float> output(s.outputCount());
+
+        GridSample3DTactic bounded;
+        bounded.tileBounds = true;
+        const size_t workspaceBytes = grid_sample_3d_workspace_size(bounded, s.N, s.D_in, s.H_in, s.W_in,
+                                                                    s.D_grid, s.H_grid, s.W_grid);
+        float *d_input = nullptr, *d_grid = nullptr, *d_output = nullptr;
+        void* d_workspace = nullptr;
+        bool cuda = context.cuda && cudaMalloc(&d_input, s.inputCount() * sizeof(float)) == cudaSuccess &&
+                    cudaMalloc(&d_grid, grid.size() * sizeof(float)) == cudaSuccess &&
+                    cudaMalloc(&d_output, output.size() * sizeof(float)) == cudaSuccess &&
+                    cudaMalloc(&d_workspace, workspaceBytes) == cudaSuccess &&
+                    cudaMemcpy(d_input, input, s.inputCount() * sizeof(float), cudaMemcpyHostToDevice) == cudaSuccess &&
+                    cudaMemcpy(d_grid, grid.data(), grid.size() * sizeof(float), cudaMemcpyHostToDevice) == cudaSuccess;
+
+        const auto padding = GridSample3DPaddingMode::Zeros;
+        printf("\n%-9s %-6s %8s %8s %8s %12s %12s\n", "interp", "bounds", "outside", "inside", "mixed", "cpu ms",
+               "cuda ms");
+        for (auto interpolation : {GridSample3DInterpolationMode::Bilinear, GridSample3DInterpolationMode::Nearest}) {
+            const GridSample3DTileStats tiles = grid_sample_3d_tile_stats<float>(
+                grid.data(), s.N, s.D_in, s.H_in, s.W_in, s.D_grid, s.H_grid, s.W_grid, false, interpolation, padding);
+            for (bool tileBounds : {false, true}) {
+                GridSample3DTactic tactic;
+                tactic.tileBounds = tileBounds;
+                Timing cpu = timeCpu(context.options, [&]() {
+                    return grid_sample_3d_cpu<float, float>(input, grid.data(), s.N, s.C, s.D_in, s.H_in, s.W_in,
+                                                            s.D_grid, s.H_grid, s.W_grid, false, interpolation, padding,
+                                                            output.data(), GridSample3DLayout::NCDHW,
+                                                            GridSample3DGridKind::Absolute, tactic);
+                });
+                Timing gpu;
+                if (cuda) {
+                    gpu = timeCuda(context.options, context.stream, [&]() {
+                        return grid_sample_3d_cuda<float, float>(d_input, d_grid, s.N, s.C, s.D_in, s.H_in, s.W_in,
+                                                                 s.D_grid, s.H_grid, s.W_grid, false, interpolation,
+                                                                 padding, d_output, context.stream,
+                                                                 GridSample3DLayout::NCDHW,
+                                                                 GridSample3DGridKind::Absolute, tactic, d_workspace);
+                    });
+                }
+                printf("%-9s %-6s %8zu %8zu %8zu %12.3f %12.3f%s\n", interpolationName(interpolation),
+                       tileBounds ? "on" : "off", tiles.outside, tiles.inside, tiles.mixed, cpu.median_ms,
+                       cuda ? gpu.median_ms : 0.0, cpu.status || gpu.status ? "  FAILED" : "");
+
+                for (int backend = 0; backend < (cuda ? 2 : 1); backend++) {
+                    Result result;
+                    result.backend = backend ? "cuda" : "cpu";
+                    result.dtype = "fp32";
+                    result.shape = s.name;
+                    result.tileBounds = tileBounds;
+                    result.dims = s;
+                    result.interpolation = interpolation;
+                    result.padding = padding;
+                    result.timing = backend ? gpu : cpu;
+                    result.bytes = compulsoryBytes(s, sizeof(float), interpolation);
+                    result.gbps = result.timing.median_ms > 0.0 ? result.bytes / (result.timing.median_ms * 1e6) : 0.0;
+                    result.roofline_gbps = backend ? context.cudaRoofline : context.cpuRoofline;
+                    context.results.push_back(result);
+                }
+            }
+        }
+        cudaFree(d_input);
+        cudaFree(d_grid);
+        cudaFree(d_output);
+        cudaFree(d_workspace);
+    }
+
+    // Output mask on a 128^3, C=16 resampling: no mask, then ball masks keeping about 10% and 50%
+    // of the output voxels, as an organ mask would.
+    void benchMask(Context& context) {
+        const BenchShape s = {"mask128", 1, 16, 128, 128, 128, 128, 128, 128};
+        std::vector<float> grid(s.gridCount());
+        std::mt19937 rng(19);
+        std::uniform_real_distribution<float> dist(-1.f, 1.f);
+        for (float& v : grid) {
+            v = dist(rng) * 0.02f;
+        }
+        for (size_t i = 0; i < s.N * s.D_grid * s.H_grid * s.W_grid; i++) {
+            grid[3 * i] += affine_grid_base<false>(i % s.W_grid, s.W_grid);
+            grid[3 * i + 1] += affine_grid_base<false>(i / s.W_grid % s.H_grid, s.H_grid);
+            grid[3 * i + 2] += affine_grid_base<false>(i / (s.W_grid * s.H_grid) % s.D_grid, s.D_grid);
+        }
+        std::vector<float> storage;
+        const float* input = inputOf<float>(s, nullptr, storage);
+        std::vector<float> output(s.outputCount());
+        std::vector<uint8_t> mask(s.N * s.D_grid * s.H_grid * s.W_grid);
+
+        float *d_input = nullptr, *d_grid = nullptr, *d_output = nullptr;
+        uint8_t* d_mask = nullptr;
+        bool cuda = context.cuda && cudaMalloc(&d_input, s.inputCount() * sizeof(float)) == cudaSuccess &&
+                    cudaMalloc(&d_grid, grid.size() * sizeof(float)) == cudaSuccess &&
+                    cudaMalloc(&d_output, output.size() * sizeof(float)) == cudaSuccess &&
+                    cudaMalloc(&d_mask, mask.size()) == cudaSuccess &&
+                    cudaMemcpy(d_input, input, s.inputCount() * sizeof(float), cudaMemcpyHostToDevice) == cudaSuccess &&
+                    cudaMemcpy(d_grid, grid.data(), grid.size() * sizeof(float), cudaMemcpyHostToDevice) == cudaSuccess;
+
+        const auto interpolation = GridSample3DInterpolationMode::Bilinear;
+        const auto padding = GridSample3DPaddingMode::Zeros;
+        printf("\n%-8s %12s %12s\n", "density", "cpu ms", "cuda ms");
+        // ball radii (in [-1, 1] units) covering 10% and 50% of the cube
+        for (float radius : {0.f, 0.576f, 0.985f}) {
+            size_t active = 0;
+            for (size_t i = 0; i < mask.size(); i++) {
+                const float x = affine_grid_base<false>(i % s.W_grid, s.W_grid);
+                const float y = affine_grid_base<false>(i / s.W_grid % s.H_grid, s.H_grid);
+                const float z = affine_grid_base<false>(i / (s.W_grid * s.H_grid) % s.D_grid, s.D_grid);
+                mask[i] = x * x + y * y + z * z < radius * radius;
+                active += mask[i];
+            }
+            const bool masked = radius > 0.f;
+            const double density = masked ? static_cast<double>(active) / mask.size() : 1.0;
+            if (cuda && masked) {
+                cudaMemcpy(d_mask, mask.data(), mask.size(), cudaMemcpyHostToDevice);
+            }
+            Timing cpu = timeCpu(context.options, [&]() {
+                return grid_sample_3d_cpu<float, float>(input, grid.data(), s.N, s.C, s.D_in, s.H_in, s.W_in,
+                                                        s.D_grid, s.H_grid, s.W_grid, false, interpolation, padding,
+                                                        output.data(), GridSample3DLayout::NCDHW,
+                                                        GridSample3DGridKind::Absolute, GridSample3DTactic(),
+                                                        masked ? mask.data() : nullptr);
+            });
+            Timing gpu;
+            if (cuda) {
+                gpu = timeCuda(context.options, context.stream, [&]() {
+                    return grid_sample_3d_cuda<float, float>(d_input, d_grid, s.N, s.C, s.D_in, s.H_in, s.W_in,
+                                                             s.D_grid, s.H_grid, s.W_grid, false, interpolation,
+                                                             padding, d_output, context.stream,
+                                                             GridSample3DLayout::NCDHW,
+                                                             GridSample3DGridKind::Absolute, GridSample3DTactic(),
+                                                             nullptr, masked ? d_mask : nullptr);
+                });
+            }
+            char label[16] = "none";
+            if (masked) {
+                snprintf(label, sizeof(label), "%.0f%%", density * 100.0);
+            }
+            printf("%-8s %12.3f %12.3f%s\n", label, cpu.median_ms, cuda ? gpu.median_ms : 0.0,
+                   cpu.status || gpu.status ? "  FAILED" : "");
+
+            for (int backend = 0; backend < (cuda ? 2 : 1); backend++) {
+                Result result;
+                result.backend = backend ? "cuda" : "cpu";
+                result.dtype = "fp32";
+                result.shape = s.name;
+                result.maskDensity = density;
+                result.dims = s;
+                result.interpolation = interpolation;
+                result.padding = padding;
+                result.timing = backend ? gpu : cpu;
+                result.bytes = compulsoryBytes(s, sizeof(float), interpolation);
+                result.gbps = result.timing.median_ms > 0.0 ? result.bytes / (result.timing.median_ms * 1e6) : 0.0;
+                result.roofline_gbps = backend ? context.cudaRoofline : context.cpuRoofline;
+                context.results.push_back(result);
+            }
+        }
+        cudaFree(d_input);
+        cudaFree(d_grid);
+        cudaFree(d_output);
+        cudaFree(d_mask);
+    }
+
+    // Point-list query of 2^18 random points into a 128^3, C=32 feature volume (a NeRF-style lookup):
+    // the (N, C, P) output of a 1 x 1 x P grid against the channels-contiguous (N, P, C) output.
+    void benchPoints(Context& context) {
+        const size_t P = size_t(1) << 18;
+        const BenchShape s = {"points128", 1, 32, 128, 128, 128, 1, 1, P};
+        std::vector<float> points(s.gridCount());
+        std::mt19937 rng(23);
+        std::uniform_real_distribution<float> dist(-1.f, 1.f);
+        for (float& v : points) {
+            v = dist(rng);
+        }
+        std::vector<float> storage;
+        const float* input = inputOf<float>(s, nullptr, storage);
+        std::vector<float> output(s.outputCount());
+
+        float *d_input = nullptr, *d_points = nullptr, *d_output = nullptr;
+        bool cuda = context.cuda && cudaMalloc(&d_input, s.inputCount() * sizeof(float)) == cudaSuccess &&
+                    cudaMalloc(&d_points, points.size() * sizeof(float)) == cudaSuccess &&
+                    cudaMalloc(&d_output, output.size() * sizeof(float)) == cudaSuccess &&
+                    cudaMemcpy(d_input, input, s.inputCount() * sizeof(float), cudaMemcpyHostToDevice) == cudaSuccess &&
+                    cudaMemcpy(d_points, points.data(), points.size() * sizeof(float), cudaMemcpyHostToDevice) == cudaSuccess;
+
+        const auto padding = GridSample3DPaddingMode::Zeros;
+        printf("\n%-9s %-6s %12s %12s\n", "interp", "layout", "cpu ms", "cuda ms");
+        for (auto interpolation : kInterpolationModes) {
+            for (auto pointLayout : {GridSample3DPointLayout::NCP, GridSample3DPointLayout::NPC}) {
+                const char* layoutName = pointLayout == GridSample3DPointLayout::NPC ? "npc" : "ncp";
+                Timing cpu = timeCpu(context.options, [&]() {
+                    return grid_sample_3d_points_cpu<float, float>(input, points.data(), s.N, s.C, s.D_in, s.H_in,
+                                                                   s.W_in, P, false, interpolation, padding,
+                                                                   output.data(), pointLayout);
+                });
+                Timing gpu;
+                if (cuda) {
+                    gpu = timeCuda(context.options, context.stream, [&]() {
+                        return grid_sample_3d_points_cuda<float, float>(d_input, d_points, s.N, s.C, s.D_in, s.H_in,
+                                                                        s.W_in, P, false, interpolation, padding,
+                                                                        d_output, context.stream, pointLayout);
+                    });
+                }
+                printf("%-9s %-6s %12.3f %12.3f%s\n", interpolationName(interpolation), layoutName, cpu.median_ms,
+                       cuda ? gpu.median_ms : 0.0, cpu.status || gpu.status ? "  FAILED" : "");
+
+                for (int backend = 0; backend < (cuda ? 2 : 1); backend++) {
+                    Result result;
+                    result.backend = backend ? "cuda" : "cpu";
+                    result.dtype = "fp32";
+                    result.shape = s.name;
+                    result.pointLayout = layoutName;
+                    result.dims = s;
+                    result.interpolation = interpolation;
+                    result.padding = padding;
+                    result.timing = backend ? gpu : cpu;
+                    result.bytes = compulsoryBytes(s, sizeof(float), interpolation);
+                    result.gbps = result.timing.median_ms > 0.0 ? result.bytes / (result.timing.median_ms * 1e6) : 0.0;
+                    result.roofline_gbps = backend ? context.cudaRoofline : context.cpuRoofline;
+                    context.results.push_back(result);
+                }
+            }
+        }
+        cudaFree(d_input);
+        cudaFree(d_points);
+        cudaFree(d_output);
+    }
+
+    // Quality against cost of minification: a 128^3 white-noise volume resampled 4x and 8x smaller by
+    // an identity grid, with the RMSE of each mode against the box average of the covered voxels.
+    // Trilinear sample of an S^3 channel at normalized (x, y, z), align_corners=False, coordinates
+    // clamped to the volume as with Border padding. Written independently of the library.
+    double sampleTrilinear(const float* channel, size_t S, const double q[3]) {
+        double index[3];
+        for (int k = 0; k < 3; k++) {
+            index[k] = std::min(std::max(((q[k] + 1.0) * S - 1.0) / 2.0, 0.0), static_cast<double>(S - 1));
+        }
+        const size_t x0 = static_cast<size_t>(index[0]), y0 = static_cast<size_t>(index[1]), z0 = static_cast<size_t>(index[2]);
+        const double fx = index[0] - x0, fy = index[1] - y0, fz = index[2] - z0;
+        double value = 0.0;
+        for (int corner = 0; corner < 8; corner++) {
+            const size_t x = std::min(x0 + (corner & 1), S - 1);
+            const size_t y = std::min(y0 + (corner >> 1 & 1), S - 1);
+            const size_t z = std::min(z0 + (corner >> 2), S - 1);
+            const double w = (corner & 1 ? fx : 1.0 - fx) * (corner >> 1 & 1 ? fy : 1.0 - fy) * (corner >> 2 ? fz : 1.0 - fz);
+            value += w * channel[(z * S + y) * S + x];
+        }
+        return value;
+    }
+
+    double rmseOf(const std::vector<float>& output, const std::vector<double>& reference) {
+        double error = 0.0;
+        for (size_t i = 0; i < output.size(); i++) {
+            error += (output[i] - reference[i]) * (output[i] - reference[i]);
+        }
+        return std::sqrt(error / output.size());
+    }
+
+    // Minification of noise by rotated, non-power-of-two grids: the output voxel footprints straddle
+    // input voxels and pyramid blocks, so neither a single mip level nor a block average matches.
+    // The reference low-passes each output voxel by averaging k^3 trilinear samples of the input
+    // over the voxel's rotated footprint (k = 2 * ceil(factor)), independent of the pyramid.
+    void benchMipmap(Context& context) {
+        const size_t S = 128, C = 4;
+        std::vector<float> input(C * S * S * S);
+        std::mt19937 rng(29);
+        std::uniform_real_distribution<float> dist(-1.f, 1.f);
+        for (float& v : input) {
+            v = dist(rng);
+        }
+        float *d_input = nullptr;
+        bool cuda = context.cuda && cudaMalloc(&d_input, input.size() * sizeof(float)) == cudaSuccess &&
+                    cudaMemcpy(d_input, input.data(), input.size() * sizeof(float), cudaMemcpyHostToDevice) == cudaSuccess;
+
+        // 25 degrees about z, then 15 degrees about x
+        const double a = 25.0 * M_PI / 180.0, b = 15.0 * M_PI / 180.0;
+        const double rotation[3][3] = {{std::cos(a), -std::sin(a), 0.0},
+                                       {std::cos(b) * std::sin(a), std::cos(b) * std::cos(a), -std::sin(b)},
+                                       {std::sin(b) * std::sin(a), std::sin(b) * std::cos(a), std::cos(b)}};
+
+        const auto padding = GridSample3DPaddingMode::Border;
+        printf("\n%-9s %-9s %10s %10s %12s %12s\n", "interp", "factor", "cpu rmse", "cuda rmse", "cpu ms", "cuda ms");
+        const struct {
+            const char* name;
+            size_t O;
+        } cases[] = {{"mip128/2.9r", 44}, {"mip128/5.3r", 24}};
+        for (const auto& minification : cases) {
+            const size_t O = minification.O;
+            const double factor = static_cast<double>(S) / O;
+            const BenchShape s = {minification.name, 1, C, S, S, S, O, O, O};
+            auto rotate = [&](const double p[3], double q[3]) {
+                for (int r = 0; r < 3; r++) {
+                    q[r] = rotation[r][0] * p[0] + rotation[r][1] * p[1] + rotation[r][2] * p[2];
+                }
+            };
+            // rotated output voxel centers of an O^3 grid over the same [-1, 1] extent
+            std::vector<float> grid(s.gridCount());
+            for (size_t i = 0; i < O * O * O; i++) {
+                const double p[3] = {(2.0 * (i % O) + 1.0) / O - 1.0, (2.0 * (i / O % O) + 1.0) / O - 1.0,
+                                     (2.0 * (i / (O * O)) + 1.0) / O - 1.0};
+                double q[3];
+                rotate(p, q);
+                for (int k = 0; k < 3; k++) {
+                    grid[3 * i + k] = static_cast<float>(q[k]);
+                }
+            }
+            const size_t k = 2 * static_cast<size_t>(std::ceil(factor));
+            std::vector<double> reference(s.outputCount(), 0.0);
+            GridSample3DThreadPool::instance().parallelFor(O * O * O, 1, [&](size_t begin, size_t end) {
+                for (size_t i = begin; i < end; i++) {
+                    const double center[3] = {(2.0 * (i % O) + 1.0) / O - 1.0, (2.0 * (i / O % O) + 1.0) / O - 1.0,
+                                              (2.0 * (i / (O * O)) + 1.0) / O - 1.0};
+                    for (size_t j = 0; j < k * k * k; j++) {
+                        const size_t sub[3] = {j % k, j / k % k, j / (k * k)};
+                        double p[3], q[3];
+                        for (int t = 0; t < 3; t++) {
+                            p[t] = center[t] + ((sub[t] + 0.5) / k - 0.5) * 2.0 / O;
+                        }
+                        rotate(p, q);
+                        for (size_t c = 0; c < C; c++) {
+                            reference[c * O * O * O + i] += sampleTrilinear(input.data() + c * S * S * S, S, q);
+                        }
+                    }
+                    for (size_t c = 0; c < C; c++) {
+                        reference[c * O * O * O + i] /= static_cast<double>(k * k * k);
+                    }
+                }
+            });
+
+            float *d_grid = nullptr, *d_output = nullptr;
+            const bool cudaShape = cuda && cudaMalloc(&d_grid, grid.size() * sizeof(float)) == cudaSuccess &&
+                                   cudaMalloc(&d_output, s.outputCount() * sizeof(float)) == cudaSuccess &&
+                                   cudaMemcpy(d_grid, grid.data(), grid.size() * sizeof(float), cudaMemcpyHostToDevice) == cudaSuccess;
+            std::vector<float> output(s.outputCount()), output_gpu(s.outputCount());
+            for (auto interpolation : {GridSample3DInterpolationMode::Bilinear, GridSample3DInterpolationMode::Mipmap}) {
+                Timing cpu = timeCpu(context.options, [&]() {
+                    return grid_sample_3d_cpu<float, float>(input.data(), grid.data(), s.N, C, S, S, S, O, O, O, false,
+                                                            interpolation, padding, output.data());
+                });
+                // each backend is scored on its own output
+                const double cpuRmse = rmseOf(output, reference);
+                double cudaRmse = 0.0;
+                Timing gpu;
+                if (cudaShape) {
+                    gpu = timeCuda(context.options, context.stream, [&]() {
+                        return grid_sample_3d_cuda<float, float>(d_input, d_grid, s.N, C, S, S, S, O, O, O, false,
+                                                                 interpolation, padding, d_output, context.stream);
+                    });
+                    cudaMemcpy(output_gpu.data(), d_output, output_gpu.size() * sizeof(float), cudaMemcpyDeviceToHost);
+                    cudaRmse = rmseOf(output_gpu, reference);
+                }
+                printf("%-9s %-9.2f %10.5f %10.5f %12.3f %12.3f%s\n", interpolationName(interpolation), factor, cpuRmse,
+                       cudaRmse, cpu.median_ms, cudaShape ? gpu.median_ms : 0.0, cpu.status || gpu.status ? "  FAILED" : "");
+
+                for (int backend = 0; backend < (cudaShape ? 2 : 1); backend++) {
+                    Result result;
+                    result.backend = backend ? "cuda" : "cpu";
+                    result.dtype = "fp32";
+                    result.shape = s.name;
+                    result.rmse = backend ? cudaRmse : cpuRmse;
+                    result.dims = s;
+                    result.interpolation = interpolation;
+                    result.padding = padding;
+                    result.timing = backend ? gpu : cpu;
+                    result.bytes = compulsoryBytes(s, sizeof(float), interpolation);
+                    result.gbps = result.timing.median_ms > 0.0 ? result.bytes / (result.timing.median_ms * 1e6) : 0.0;
+                    result.roofline_gbps = backend ? context.cudaRoofline : context.cpuRoofline;
+                    context.results.push_back(result);
+                }
+            }
+            cudaFree(d_grid);
+            cudaFree(d_output);
+        }
+        cudaFree(d_input);
+    }
+
+    // Ragged batching of `items` studies of extents in [min_extent, max_extent]: one call per
+    // study, one call on the batch padded to the largest shape, and one ragged call over the packed
+    // studies. Small studies show the per-call overhead the ragged call saves.
+    void benchRagged(Context& context, const char* name, size_t items, int32_t min_extent, int32_t max_extent) {
+        const size_t C = 8;
+        std::mt19937 rng(31);
+        std::uniform_int_distribution<int32_t> extent(min_extent, max_extent);
+        std::uniform_real_distribution<float> dist(-1.f, 1.f);
+        std::vector<GridSample3DRaggedItem> table(items);
+        BenchShape padded = {name, items, C, 0, 0, 0, 0, 0, 0};
+        for (GridSample3DRaggedItem& item : table) {
+            item.D_in = item.D_grid = extent(rng);
+            item.H_in = item.H_grid = extent(rng);
+            item.W_in = item.W_grid = extent(rng);
+            padded.D_in = padded.D_grid = std::max<size_t>(padded.D_in, item.D_in);
+            padded.H_in = padded.H_grid = std::max<size_t>(padded.H_in, item.H_in);
+            padded.W_in = padded.W_grid = std::max<size_t>(padded.W_in, item.W_in);
+        }
+        size_t V_in, G;
+        grid_sample_3d_ragged_pack(table.data(), table.size(), V_in, G);
+        std::vector<float> input(C * V_in), grid(G * 3), output(C * G);
+        for (float& v : input) {
+            v = dist(rng);
+        }
+        for (float& v : grid) {
+            v = dist(rng);
+        }
+        // per-study NCDHW copies for the per-study calls
+        std::vector<std::vector<float>> study_input(items), study_output(items);
+        for (size_t i = 0; i < items; i++) {
+            const size_t voxels = static_cast<size_t>(table[i].D_in) * table[i].H_in * table[i].W_in;
+            study_input[i].resize(C * voxels);
+            study_output[i].resize(C * voxels);
+            for (size_t c = 0; c < C; c++) {
+                std::copy_n(input.begin() + c * V_in + table[i].input_offset, voxels, study_input[i].begin() + c * voxels);
+            }
+        }
+        std::vector<float> padded_input(padded.inputCount()), padded_grid(padded.gridCount()), padded_output(padded.outputCount());
+        for (float& v : padded_grid) {
+            v = dist(rng);
+        }
+
+        const auto interpolation = GridSample3DInterpolationMode::Bilinear;
+        const auto padding = GridSample3DPaddingMode::Zeros;
+        const double bytes = (2.0 * C * G + C * V_in + 3.0 * G) * sizeof(float);
+        printf("\n%-9s %12s %12s   (%s: %zu studies of %d-%d^3, %zu threads, %.1f%% of the padded voxels used)\n",
+               "batching", "cpu ms", "cuda ms", name, items, min_extent, max_extent,
+               GridSample3DThreadPool::instance().size(),
+               100.0 * G / (items * padded.D_grid * padded.H_grid * padded.W_grid));
+
+        float *d_input = nullptr, *d_grid = nullptr, *d_output = nullptr, *d_padded_input = nullptr,
+              *d_padded_grid = nullptr, *d_padded_output = nullptr;
+        GridSample3DRaggedItem* d_table = nullptr;
+        bool cuda = context.cuda && cudaMalloc(&d_input, input.size() * sizeof(float)) == cudaSuccess &&
+                    cudaMalloc(&d_grid, grid.size() * sizeof(float)) == cudaSuccess &&
+                    cudaMalloc(&d_output, output.size() * sizeof(float)) == cudaSuccess &&
+                    cudaMalloc(&d_table, table.size() * sizeof(GridSample3DRaggedItem)) == cudaSuccess &&
+                    cudaMalloc(&d_padded_input, padded_input.size() * sizeof(float)) == cudaSuccess &&
+                    cudaMalloc(&d_padded_grid, padded_grid.size() * sizeof(float)) == cudaSuccess &&
+                    cudaMalloc(&d_padded_output, padded_output.size() * sizeof(float)) == cudaSuccess &&
+                    cudaMemcpy(d_input, input.data(), input.size() * sizeof(float), cudaMemcpyHostToDevice) == cudaSuccess &&
+                    cudaMemcpy(d_grid, grid.data(), grid.size() * sizeof(float), cudaMemcpyHostToDevice) == cudaSuccess &&
+                    cudaMemcpy(d_table, table.data(), table.size() * sizeof(GridSample3DRaggedItem), cudaMemcpyHostToDevice) == cudaSuccess &&
+                    cudaMemcpy(d_padded_grid, padded_grid.data(), padded_grid.size() * sizeof(float), cudaMemcpyHostToDevice) == cudaSuccess;
+
+        for (const char* batching : {"per_item", "padded", "ragged"}) {
+            Timing cpu, gpu;
+            if (!strcmp(batching, "per_item")) {
+                cpu = timeCpu(context.options, [&]() {
+                    int status = 0;
+                    for (size_t i = 0; i < items; i++) {
+                        const GridSample3DRaggedItem& t = table[i];
+                        status |= grid_sample_3d_cpu<float, float>(study_input[i].data(), grid.data() + 3 * t.grid_offset,
+                                                                   1, C, t.D_in, t.H_in, t.W_in, t.D_grid, t.H_grid,
+                                                                   t.W_grid, false, interpolation, padding,
+                                                                   study_output[i].data());
+                    }
+                    return status;
+                });
+                if (cuda) {
+                    // the packed buffers stand in for per-study tensors: same launches, same sizes
+                    gpu = timeCuda(context.options, context.stream, [&]() {
+                        int status = 0;
+                        for (size_t i = 0; i < items; i++) {
+                            const GridSample3DRaggedItem& t = table[i];
+                            status |= grid_sample_3d_cuda<float, float>(d_input + C * t.input_offset, d_grid + 3 * t.grid_offset,
+                                                                        1, C, t.D_in, t.H_in, t.W_in, t.D_grid, t.H_grid,
+                                                                        t.W_grid, false, interpolation, padding,
+                                                                        d_output + C * t.grid_offset, context.stream);
+                        }
+                        return status;
+                    });
+                }
+            } else if (!strcmp(batching, "padded")) {
+                const BenchShape& s = padded;
+                cpu = timeCpu(context.options, [&]() {
+                    return grid_sample_3d_cpu<float, float>(padded_input.data(), padded_grid.data(), s.N, C, s.D_in, s.H_in,
+                                                            s.W_in, s.D_grid, s.H_grid, s.W_grid, false, interpolation,
+                                                            padding, padded_output.data());
+                });
+                if (cuda) {
+                    gpu = timeCuda(context.options, context.stream, [&]() {
+                        return grid_sample_3d_cuda<float, float>(d_padded_input, d_padded_grid, s.N, C, s.D_in, s.H_in,
+                                                                 s.W_in, s.D_grid, s.H_grid, s.W_grid, false, interpolation,
+                                                                 padding, d_padded_output, context.stream);
+                    });
+                }
+            } else {
+                cpu = timeCpu(context.options, [&]() {
+                    return grid_sample_3d_ragged_cpu<float, float>(input.data(), grid.data(), table.data(), items, C, V_in,
+                                                                   G, false, interpolation, padding, output.data());
+                });
+                if (cuda) {
+                    gpu = timeCuda(context.options, context.stream, [&]() {
+                        return grid_sample_3d_ragged_cuda<float, float>(d_input, d_grid, d_table, items, C, V_in, G, false,
+                                                                        interpolation, padding, d_output, context.stream);
+                    });
+                }
+            }
+            printf("%-9s %12.3f %12.3f%s\n", batching, cpu.median_ms, cuda ? gpu.median_ms : 0.0,
+                   cpu.status || gpu.status ? "  FAILED" : "");
+
+            for (int backend = 0; backend < (cuda ? 2 : 1); backend++) {
+                Result result;
+                result.backend = backend ? "cuda" : "cpu";
+                result.dtype = "fp32";
+                result.shape = padded.name;
+                result.batching = batching;
+                result.dims = padded;
+                result.interpolation = interpolation;
+                result.padding = padding;
+                result.timing = backend ? gpu : cpu;
+                // the bytes of the studies themselves, so padding shows up as lost bandwidth
+                result.bytes = bytes;
+                result.gbps = result.timing.median_ms > 0.0 ? result.bytes / (result.timing.median_ms * 1e6) : 0.0;
+                result.roofline_gbps = backend ? context.cudaRoofline : context.cpuRoofline;
+                context.results.push_back(result);
+            }
+        }
+        cudaFree(d_input);
+        cudaFree(d_grid);
+        cudaFree(d_output);
+        cudaFree(d_table);
+        cudaFree(d_padded_input);
+        cudaFree(d_padded_grid);
+        cudaFree(d_padded_output);
+    }
+
+    bool writeJson(const Context& context, const char* path) {
+        FILE* f = fopen(path, "w");
+        if (f == nullptr) {
+            return false;
+        }
+        fprintf(f, "{\n  \"threads\": %zu,\n  \"repeats\": %d,\n", GridSample3DThreadPool::instance().size(),
+                context.options.repeats);
+        fprintf(f, "  \"roofline_gbps\": {\"cpu\": %.3f, \"cuda\": %.3f},\n", context.cpuRoofline,
+                context.cudaRoofline);
+        fprintf(f, "  \"results\": [\n");
+        for (size_t i = 0; i < context.results.size(); i++) {
+            const Result& r = context.results[i];
+            const BenchShape& s = r.dims;
+            fprintf(f,
+                    "    {\"backend\": \"%s\", \"dtype\": \"%s\", \"shape\": \"%s\", "
+                    "\"N\": %zu, \"C\": %zu, \"input\": [%zu, %zu, %zu], \"grid\": [%zu, %zu, %zu], "
+                    "\"traversal\": \"%s\", \"bucketing\": \"%s\", \"tile_bounds\": %s, \"mask_density\": %.3f, \"point_layout\": \"%s\", \"rmse\": %.6f, \"batching\": \"%s\", \"interpolation\": \"%s\", \"padding\": \"%s\", \"align_corners\": false, "
+                    "\"median_ms\": %.6f, \"p99_ms\": %.6f, \"bytes\": %.0f, \"gbps\": %.3f, "
+                    "\"roofline_gbps\": %.3f, \"status\": %d}%s\n",
+                    r.backend.c_str(), r.dtype.c_str(), r.shape.c_str(), s.N, s.C, s.D_in, s.H_in, s.W_in,
+                    s.D_grid, s.H_grid, s.W_grid, r.traversal.c_str(), r.bucketing.c_str(), r.tileBounds ? "true" : "false", r.maskDensity,
+                    r.pointLayout.c_str(), r.rmse, r.batching.c_str(),
+                    interpolationName(r.interpolation),
+                    paddingName(r.padding),
+                    r.timing.median_ms, r.timing.p99_ms, r.bytes, r.gbps, r.roofline_gbps, r.timing.status,
+                    i + 1 < context.results.size() ? "," : "");
+        }
+        fprintf(f, "  ]\n}\n");
+        return fclose(f) == 0;
+    }
+
+    bool parseOptions(int argc, char** argv, Options& options) {
+        for (int i = 1; i < argc; i++) {
+            if (!strcmp(argv[i], "--quick")) {
+                options.quick = true;
+            } else if (!strcmp(argv[i], "--production")) {
+                options.production = true;
+            } else if (!strcmp(argv[i], "--traversal")) {
+                options.traversal = true;
+            } else if (!strcmp(argv[i], "--bucketed")) {
+                options.bucketed = true;
+            } else if (!strcmp(argv[i], "--tile-bounds")) {
+                options.tileBounds = true;
+            } else if (!strcmp(argv[i], "--mask")) {
+                options.mask = true;
+            } else if (!strcmp(argv[i], "--points")) {
+                options.points = true;
+            } else if (!strcmp(argv[i], "--mipmap")) {
+                options.mipmap = true;
+            } else if (!strcmp(argv[i], "--ragged")) {
+                options.ragged = true;
+            } else if (!strcmp(argv[i], "--cpu-only")) {
+                options.cpuOnly = true;
+            } else if (!strcmp(argv[i], "--repeats") && i + 1 < argc) {
+                options.repeats = std::max(1, atoi(argv[++i]));
+            } else if (!strcmp(argv[i], "--json") && i + 1 < argc) {
+                options.json = argv[++i];
+            } else if (!strcmp(argv[i], "--fixture") && i + 1 < argc) {
+                options.fixture = argv[++i];
+            } else {
+                fprintf(stderr,
+                        "usage: %s [--quick] [--production] [--traversal] [--bucketed] [--tile-bounds] [--mask] [--points] [--mipmap] [--ragged] [--cpu-only] "
+                        "[--repeats R] "
+                        "[--json FILE] [--fixture DIR]\n",
+                        argv[0]);
+                return false;
+            }
+        }
+        return true;
+    }
+} // namespace
+
+int main(int argc, char** argv) {
+    Context context;
+    if (!parseOptions(argc, argv, context.options)) {
+        return 2;
+    }
+
+    int devices = 0;
+    context.cuda = !context.options.cpuOnly && cudaGetDeviceCount(&devices) == cudaSuccess && devices > 0;
+    if (context.cuda) {
+        cudaStreamCreate(&context.stream);
+        context.cudaRoofline = cudaRooflineGbps(context.options, context.stream);
+    } else {
+        printf("No CUDA device, CPU backend only\n");
+    }
+    context.cpuRoofline = cpuRooflineGbps(context.options);
+    printf("roofline: cpu %.1f GB/s (%zu threads), cuda %.1f GB/s\n", context.cpuRoofline,
+           GridSample3DThreadPool::instance().size(), context.cudaRoofline);
+
+    printf("%-5s %-5s %-11s %-9s %-11s %10s %10s %9s %8s\n", "back", "dtype", "shape", "interp", "padding",
+           "median ms", "p99 ms", "GB/s", "roofl.");
+    for (const BenchShape& s : kShapes) {
+        benchShape(context, s);
+        if (context.options.quick) {
+            break;
+        }
+    }
+    if (context.options.production) {
+        benchShape(context, kProductionShape);
+    }
+    if (context.options.traversal) {
+        benchTraversal(context);
+    }
+    if (context.options.bucketed) {
+        benchBucketed(context);
+    }
+    if (context.options.tileBounds) {
+        benchTileBounds(context);
+    }
+    if (context.options.mask) {
+        benchMask(context);
+    }
+    if (context.options.points) {
+        benchPoints(context);
+    }
+    if (context.options.mipmap) {
+        benchMipmap(context);
+    }
+    if (context.options.ragged) {
+        benchRagged(context, "ragged32", 32, 16, 48);
+        benchRagged(context, "ragged512", 512, 4, 12);
+    }
+    if (context.options.fixture != nullptr) {
+        const std::string dir = context.options.fixture;
+        FixtureTensor input = FixtureTensor::openNpy(dir + "/input.npy");
+        FixtureTensor grid = FixtureTensor::openNpy(dir + "/grid.npy");
+        const std::vector<size_t>& in = input.shape();
+        const std::vector<size_t>& out = grid.shape();
+        if (input.data<float>() == nullptr || grid.data<float>() == nullptr || in.size() != 5 || out.size() != 5 ||
+            out[0] != in[0] || out[4] != 3) {
+            fprintf(stderr, "%s: not an fp32 input.npy/grid.npy pair %s%s\n", context.options.fixture,
+                    input.error().c_str(), grid.error().c_str());
+            return 2;
+        }
+        const BenchShape s = {"fixture", in[0], in[1], in[2], in[3], in[4], out[1], out[2], out[3]};
+        benchShape(context, s, grid.data<float>(), input.data<float>());
+    }
+
+    int failures = 0;
+    for (const Result& r : context.results) {
+        failures += r.timing.status != 0;
+    }
+    if (context.options.json != nullptr && !writeJson(context, context.options.json)) {
+        fprintf(stderr, "cannot write %s\n", context.options.json);
+        failures++;
+    }
+    if (context.stream != nullptr) {
+        cudaStreamDestroy(context.stream);
+    }
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,265 @@
+#pragma once
+
+// Read-only tensors of the test fixtures, memory-mapped so tests and benchmarks use the data in
+// place. .npy files (format 1.0 to 3.0, little-endian, C order) carry their dtype and shape in
+// the header; raw files are plain little-endian arrays whose dtype and shape the caller gives.
+// Written by test/generate_fixtures.py.
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <initializer_list>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <cuda_fp16.h>
+
+enum class FixtureDType { F32, F16, I32, I8, U8 };
+
+inline size_t fixture_dtype_size(FixtureDType dtype) {
+    switch (dtype) {
+        case FixtureDType::F16:
+            return 2;
+        case FixtureDType::I8:
+        case FixtureDType::U8:
+            return 1;
+        default:
+            return 4;
+    }
+}
+
+template <typename T> struct FixtureDTypeOf;
+template <> struct FixtureDTypeOf<float> { static constexpr FixtureDType value = FixtureDType::F32; };
+template <> struct FixtureDTypeOf<__half> { static constexpr FixtureDType value = FixtureDType::F16; };
+template <> struct FixtureDTypeOf<int32_t> { static constexpr FixtureDType value = FixtureDType::I32; };
+template <> struct FixtureDTypeOf<int8_t> { static constexpr FixtureDType value = FixtureDType::I8; };
+template <> struct FixtureDTypeOf<uint8_t> { static constexpr FixtureDType value = FixtureDType::U8; };
+
+// Fixture directory: $GRID_SAMPLE_3D_FIXTURE_DIR, else the source tree's test/data as configured
+// by CMake, so the tests do not depend on the working directory.
+inline std::string fixture_path(const std::string& name) {
+    const char* dir = std::getenv("GRID_SAMPLE_3D_FIXTURE_DIR");
+#ifdef GRID_SAMPLE_3D_FIXTURE_DIR
+    if (dir == nullptr) {
+        dir = GRID_SAMPLE_3D_FIXTURE_DIR;
+    }
+#endif
+    return std::string(dir != nullptr ? dir : "../test/data") + "/" + name;
+}
+
+class FixtureTensor {
+public:
+    FixtureTensor() = default;
+    ~FixtureTensor() { unmap(); }
+
+    FixtureTensor(FixtureTensor&& other) noexcept { *this = std::move(other); }
+    FixtureTensor& operator=(FixtureTensor&& other) noexcept {
+        if (this != &other) {
+            unmap();
+            mMapping = std::exchange(other.mMapping, nullptr);
+            mMappingSize = std::exchange(other.mMappingSize, 0);
+            mData = std::exchange(other.mData, nullptr);
+            mDType = other.mDType;
+            mShape = std::move(other.mShape);
+            mError = std::move(other.mError);
+        }
+        return *this;
+    }
+    FixtureTensor(const FixtureTensor&) = delete;
+    FixtureTensor& operator=(const FixtureTensor&) = delete;
+
+    static FixtureTensor openNpy(const std::string& path) {
+        FixtureTensor tensor;
+        if (!tensor.map(path)) {
+            return tensor;
+        }
+        const char* bytes = static_cast<const char*>(tensor.mMapping);
+        if (tensor.mMappingSize < 10 || std::memcmp(bytes, "\x93NUMPY", 6) != 0) {
+            tensor.fail(path + ": not an .npy file");
+            return tensor;
+        }
+        const int major = static_cast<unsigned char>(bytes[6]);
+        size_t headerLength, headerOffset;
+        if (major == 1) {
+            headerLength = static_cast<unsigned char>(bytes[8]) | static_cast<unsigned char>(bytes[9]) << 8;
+            headerOffset = 10;
+        } else if ((major == 2 || major == 3) && tensor.mMappingSize >= 12) {
+            headerLength = 0;
+            for (int i = 3; i >= 0; i--) {
+                headerLength = headerLength << 8 | static_cast<unsigned char>(bytes[8 + i]);
+            }
+            headerOffset = 12;
+        } else {
+            tensor.fail(path + ": unsupported .npy version");
+            return tensor;
+        }
+        if (headerOffset + headerLength > tensor.mMappingSize) {
+            tensor.fail(path + ": truncated header");
+            return tensor;
+        }
+
+        const std::string header(bytes + headerOffset, headerLength);
+        std::string descr;
+        if (!parseDescr(header, descr) || !toDType(descr, tensor.mDType)) {
+            tensor.fail(path + ": unsupported dtype '" + descr + "'");
+            return tensor;
+        }
+        if (header.find("'fortran_order': False") == std::string::npos) {
+            tensor.fail(path + ": Fortran order is not supported");
+            return tensor;
+        }
+        if (!parseShape(header, tensor.mShape)) {
+            tensor.fail(path + ": cannot parse shape");
+            return tensor;
+        }
+        tensor.bind(path, headerOffset + headerLength);
+        return tensor;
+    }
+
+    static FixtureTensor openRaw(const std::string& path, FixtureDType dtype, std::initializer_list<size_t> shape) {
+        FixtureTensor tensor;
+        if (!tensor.map(path)) {
+            return tensor;
+        }
+        tensor.mDType = dtype;
+        tensor.mShape.assign(shape);
+        tensor.bind(path, 0);
+        return tensor;
+    }
+
+    bool valid() const { return mData != nullptr; }
+    const std::string& error() const { return mError; }
+
+    FixtureDType dtype() const { return mDType; }
+    const std::vector<size_t>& shape() const { return mShape; }
+
+    size_t count() const {
+        size_t n = 1;
+        for (size_t d : mShape) {
+            n *= d;
+        }
+        return n;
+    }
+
+    bool hasShape(std::initializer_list<size_t> shape) const {
+        return mShape.size() == shape.size() && std::equal(shape.begin(), shape.end(), mShape.begin());
+    }
+
+    // the mapped elements, nullptr when T is not the stored dtype
+    template <typename T>
+    const T* data() const {
+        return FixtureDTypeOf<T>::value == mDType ? static_cast<const T*>(mData) : nullptr;
+    }
+
+private:
+    bool map(const std::string& path) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            fail(path + ": cannot open");
+            return false;
+        }
+        struct stat st;
+        if (::fstat(fd, &st) != 0 || st.st_size == 0) {
+            ::close(fd);
+            fail(path + ": empty or unreadable");
+            return false;
+        }
+        void* mapping = ::mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (mapping == MAP_FAILED) {
+            fail(path + ": mmap failed");
+            return false;
+        }
+        mMapping = mapping;
+        mMappingSize = st.st_size;
+        return true;
+    }
+
+    void unmap() {
+        if (mMapping != nullptr) {
+            ::munmap(mMapping, mMappingSize);
+        }
+        mMapping = nullptr;
+        mMappingSize = 0;
+        mData = nullptr;
+    }
+
+    void fail(const std::string& error) {
+        unmap();
+        mError = error;
+    }
+
+    // the file must hold exactly the elements of the shape after the header
+    void bind(const std::string& path, size_t offset) {
+        if (mMappingSize - offset != count() * fixture_dtype_size(mDType)) {
+            fail(path + ": size does not match shape and dtype");
+            return;
+        }
+        mData = static_cast<const char*>(mMapping) + offset;
+    }
+
+    static bool parseDescr(const std::string& header, std::string& descr) {
+        size_t key = header.find("'descr'");
+        size_t begin = key == std::string::npos ? key : header.find('\'', key + 7);
+        size_t end = begin == std::string::npos ? begin : header.find('\'', begin + 1);
+        if (end == std::string::npos) {
+            return false;
+        }
+        descr = header.substr(begin + 1, end - begin - 1);
+        return true;
+    }
+
+    static bool toDType(const std::string& descr, FixtureDType& dtype) {
+        if (descr == "<f4") {
+            dtype = FixtureDType::F32;
+        } else if (descr == "<f2") {
+            dtype = FixtureDType::F16;
+        } else if (descr == "<i4") {
+            dtype = FixtureDType::I32;
+        } else if (descr == "|i1") {
+            dtype = FixtureDType::I8;
+        } else if (descr == "|u1") {
+            dtype = FixtureDType::U8;
+        } else {
+            return false;
+        }
+        return true;
+    }
+
+    static bool parseShape(const std::string& header, std::vector<size_t>& shape) {
+        size_t key = header.find("'shape'");
+        size_t begin = key == std::string::npos ? key : header.find('(', key);
+        size_t end = begin == std::string::npos ? begin : header.find(')', begin);
+        if (end == std::string::npos) {
+            return false;
+        }
+        shape.clear();
+        const char* p = header.c_str() + begin + 1;
+        const char* last = header.c_str() + end;
+        while (p < last) {
+            char* next;
+            unsigned long long d = std::strtoull(p, &next, 10);
+            if (next == p) {
+                p++;
+                continue;
+            }
+            shape.push_back(static_cast<size_t>(d));
+            p = next;
+        }
+        return true;
+    }
+
+    void* mMapping = nullptr;
+    size_t mMappingSize = 0;
+    const void* mData = nullptr;
+    FixtureDType mDType = FixtureDType::F32;
+    std::vector<size_t> mShape;
+    std::string mError;
+};
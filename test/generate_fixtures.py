@@ -0,0 +1,187 @@
+"""Writes the .npy fixtures read by test/test.cpp and bench_grid_sample (see test/fixture.h).
+
+    python3 test/generate_fixtures.py [--large] [--no-torch] [--set NAME] [--out DIR]
+
+A golden set is a directory test/data/golden/<name>/ holding input.npy (N, C, D, H, W),
+grid.npy (N, D_out, H_out, W_out, 3) and one output_<interp>_<padding>_<align>.npy per
+sampling mode, e.g. output_bilinear_zeros_0.npy. The "small" set (about 9 KB) is committed and
+checked on every test run; the others are written on demand. --large adds the production-sized
+set (N=8, C=64, 128^3, about 4 GiB per tensor). --no-torch computes the outputs with
+reference_grid_sample, a float32 port of ATen's CPU grid_sampler_3d, instead of F.grid_sample;
+it is slow, so pair it with --set. --set writes only the named set.
+"""
+
+import argparse
+import math
+import os
+import random
+import struct
+
+DATA_DIR = os.path.join(os.path.dirname(os.path.abspath(__file__)), "data")
+
+# name, input shape (N, C, D, H, W), output size (D, H, W)
+GOLDEN_SETS = [
+    ("multichannel", (2, 5, 12, 20, 24), (10, 16, 18)),
+    ("upsample", (1, 8, 16, 16, 16), (40, 40, 40)),
+    ("small", (1, 2, 4, 5, 6), (3, 4, 5)),
+]
+LARGE_SETS = [
+    ("production", (8, 64, 128, 128, 128), (128, 128, 128)),
+]
+INTERPOLATION_MODES = ["bilinear", "nearest"]
+PADDING_MODES = ["zeros", "border", "reflection"]
+
+
+def write_npy(path, data, shape, descr="<f4"):
+    """Writes raw little-endian bytes as an .npy 1.0 file, header padded to 64 bytes."""
+    shape_text = "({},)".format(shape[0]) if len(shape) == 1 else "({})".format(", ".join(map(str, shape)))
+    header = "{{'descr': '{}', 'fortran_order': False, 'shape': {}, }}".format(descr, shape_text)
+    padding = 64 - (10 + len(header) + 1) % 64
+    header = header + " " * (padding % 64) + "\n"
+    with open(path, "wb") as f:
+        f.write(b"\x93NUMPY\x01\x00")
+        f.write(struct.pack("<H", len(header)))
+        f.write(header.encode("latin1"))
+        f.write(data)
+
+
+def write_tensor(path, tensor):
+    tensor = tensor.contiguous().float().cpu()
+    write_npy(path, tensor.numpy().astype("<f4").tobytes(), tuple(tensor.shape))
+
+
+def f32(value):
+    """Rounds a Python float to float32."""
+    return struct.unpack("<f", struct.pack("<f", value))[0]
+
+
+def source_index(coord, size, padding, align_corners):
+    """grid_sampler_compute_source_index of ATen (GridSampler.h), in float32."""
+    if align_corners:
+        coord = f32(f32(f32(coord + 1) / 2) * (size - 1))
+    else:
+        coord = f32(f32(f32(f32(coord + 1) * size) - 1) / 2)
+    if padding == "border":
+        coord = min(size - 1, max(coord, 0.0))
+    elif padding == "reflection":
+        low, high = (0, 2 * (size - 1)) if align_corners else (-1, 2 * size - 1)
+        if low == high:
+            coord = 0.0
+        else:
+            minimum = low / 2
+            span = (high - low) / 2
+            coord = abs(f32(coord - minimum))
+            extra = f32(math.fmod(coord, span))
+            flips = math.floor(f32(coord / span))
+            coord = f32(extra + minimum) if flips % 2 == 0 else f32(f32(span - extra) + minimum)
+        coord = min(size - 1, max(coord, 0.0))
+    return coord
+
+
+def reference_grid_sample(inputs, grid, input_shape, output_size, interpolation, padding, align_corners):
+    """F.grid_sample of flat float32 lists, following grid_sampler_3d_cpu_impl corner by corner."""
+    n_size, c_size, d_in, h_in, w_in = input_shape
+    d_out, h_out, w_out = output_size
+    voxels = d_out * h_out * w_out
+    output = [0.0] * (n_size * c_size * voxels)
+
+    def value(n, c, z, y, x):
+        if 0 <= z < d_in and 0 <= y < h_in and 0 <= x < w_in:
+            return inputs[(((n * c_size + c) * d_in + z) * h_in + y) * w_in + x]
+        return 0.0
+
+    for n in range(n_size):
+        for v in range(voxels):
+            x, y, z = grid[3 * (n * voxels + v):3 * (n * voxels + v) + 3]
+            ix = source_index(x, w_in, padding, align_corners)
+            iy = source_index(y, h_in, padding, align_corners)
+            iz = source_index(z, d_in, padding, align_corners)
+            for c in range(c_size):
+                if interpolation == "nearest":
+                    # std::nearbyint rounds half to even, as round() does
+                    result = value(n, c, round(iz), round(iy), round(ix))
+                else:
+                    x0, y0, z0 = math.floor(ix), math.floor(iy), math.floor(iz)
+                    result = 0.0
+                    # tnw, tne, tsw, tse, bnw, bne, bsw, bse
+                    for dz in (0, 1):
+                        for dy in (0, 1):
+                            for dx in (0, 1):
+                                wx = f32(ix - x0) if dx else f32((x0 + 1) - ix)
+                                wy = f32(iy - y0) if dy else f32((y0 + 1) - iy)
+                                wz = f32(iz - z0) if dz else f32((z0 + 1) - iz)
+                                weight = f32(f32(wx * wy) * wz)
+                                result = f32(result + f32(value(n, c, z0 + dz, y0 + dy, x0 + dx) * weight))
+                output[(n * c_size + c) * voxels + v] = result
+    return output
+
+
+def write_floats(path, values, shape):
+    write_npy(path, struct.pack("<{}f".format(len(values)), *values), shape)
+
+
+def generate_reference_golden(name, input_shape, output_size, out_dir, seed):
+    generator = random.Random(seed)
+    n = input_shape[0]
+    inputs = [f32(generator.random() * 2 - 1) for _ in range(math.prod(input_shape))]
+    # slightly past [-1, 1] so every padding mode is exercised
+    grid = [f32((generator.random() * 2 - 1) * 1.1) for _ in range(n * math.prod(output_size) * 3)]
+
+    directory = os.path.join(out_dir, "golden", name)
+    os.makedirs(directory, exist_ok=True)
+    write_floats(os.path.join(directory, "input.npy"), inputs, input_shape)
+    write_floats(os.path.join(directory, "grid.npy"), grid, (n,) + tuple(output_size) + (3,))
+    for interpolation in INTERPOLATION_MODES:
+        for padding in PADDING_MODES:
+            for align_corners in (False, True):
+                output = reference_grid_sample(inputs, grid, input_shape, output_size, interpolation, padding,
+                                               align_corners)
+                file_name = "output_{}_{}_{}.npy".format(interpolation, padding, int(align_corners))
+                write_floats(os.path.join(directory, file_name), output,
+                             (n, input_shape[1]) + tuple(output_size))
+    print("wrote", directory)
+
+
+def generate_golden(name, input_shape, output_size, out_dir, seed):
+    import torch
+    import torch.nn.functional as F
+
+    generator = torch.Generator().manual_seed(seed)
+    n = input_shape[0]
+    inputs = torch.rand(input_shape, generator=generator) * 2 - 1
+    # slightly past [-1, 1] so every padding mode is exercised
+    grid = (torch.rand((n,) + tuple(output_size) + (3,), generator=generator) * 2 - 1) * 1.1
+
+    directory = os.path.join(out_dir, "golden", name)
+    os.makedirs(directory, exist_ok=True)
+    write_tensor(os.path.join(directory, "input.npy"), inputs)
+    write_tensor(os.path.join(directory, "grid.npy"), grid)
+    for interpolation in INTERPOLATION_MODES:
+        for padding in PADDING_MODES:
+            for align_corners in (False, True):
+                output = F.grid_sample(inputs, grid, mode=interpolation, padding_mode=padding,
+                                       align_corners=align_corners)
+                file_name = "output_{}_{}_{}.npy".format(interpolation, padding, int(align_corners))
+                write_tensor(os.path.join(directory, file_name), output)
+    print("wrote", directory)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--large", action="store_true", help="also write the production-sized golden set")
+    parser.add_argument("--out", default=DATA_DIR, help="output directory of the golden sets")
+    parser.add_argument("--seed", type=int, default=0)
+    parser.add_argument("--no-torch", action="store_true",
+                        help="compute the outputs with reference_grid_sample instead of F.grid_sample")
+
+    parser.add_argument("--set", help="write only the golden set of this name")
+    args = parser.parse_args()
+
+    generate = generate_reference_golden if args.no_torch else generate_golden
+    for index, (name, input_shape, output_size) in enumerate(GOLDEN_SETS + (LARGE_SETS if args.large else [])):
+        if args.set is None or args.set == name:
+            generate(name, input_shape, output_size, args.out, args.seed + index)
+
+
+if __name__ == "__main__":
+    main()
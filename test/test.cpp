@@ -1,38 +1,166 @@
 #include <stdlib.h>
-#include <fstream>
 #include <filesystem>
 #include <iostream>
+#include <algorithm>
 #include <assert.h>
 #include <math.h>
+#include <string.h>
+#include <random>
+#include <vector>
 
 #include <cuda_fp16.h>
+#include <cuda_bf16.h>
 #include <cuda_runtime.h>
 
 #include "grid_sample_3d.h"
+#include "grid_sample_3d.cuh"
+#include "grid_sample_3d_profile.h"
+#include "fixture.h"
+#include "grid_sample_3d_c_api.h"
 
 using half = __half;
+using bfloat16 = __nv_bfloat16;
 
-void readData(const char* filename, float* data) {
-    // todo read data from file line by line and store in data
-    std::ifstream file(filename);
-    if (!file.is_open()) {
-        std::cout << "file not found" << std::endl;
-        return;
+// maps the fp32 fixture <name>.npy (see fixture.h); nullptr when missing, malformed or of another shape
+const float* mapFixture(FixtureTensor& tensor, const std::string& name, std::initializer_list<size_t> shape) {
+    tensor = FixtureTensor::openNpy(fixture_path(name));
+    if (!tensor.valid()) {
+        std::cout << tensor.error() << std::endl;
+        return nullptr;
+    }
+    if (!tensor.hasShape(shape) || tensor.data<float>() == nullptr) {
+        std::cout << name << ": unexpected shape or dtype" << std::endl;
+        return nullptr;
+    }
+    return tensor.data<float>();
+}
+
+bool hasCudaDevice() {
+    int count = 0;
+    return cudaGetDeviceCount(&count) == cudaSuccess && count > 0;
+}
+
+void fillUniform(std::vector<float>& data, float low, float high, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> dist(low, high);
+    for (auto& v : data) {
+        v = dist(rng);
     }
+}
 
-    std::string line;
-    int i = 0;
-    while (std::getline(file, line)) {
-        data[i] = std::stof(line);
-        i++;
+float maxAbsDiff(const float* a, const float* b, size_t n) {
+    float max_diff = 0.f;
+    for (size_t i = 0; i < n; i++) {
+        max_diff = std::max(max_diff, std::fabs(a[i] - b[i]));
     }
+    return max_diff;
 }
 
-std::string getAbsolutionPath(const std::string relative_path) {
-    std::string absolute_path = std::filesystem::absolute(relative_path).string();
-    return absolute_path;
+// Straightforward scalar port of PyTorch's 3D grid_sample, used as the oracle for the host backends.
+float referenceComputeIndex(float coord, int size, GridSample3DPaddingMode padding, bool align_corners) {
+    float c = align_corners ? (coord + 1.f) / 2.f * (size - 1) : ((coord + 1.f) * size - 1.f) / 2.f;
+    if (padding == GridSample3DPaddingMode::Reflection) {
+        float low = align_corners ? 0.f : -0.5f;
+        float span = align_corners ? static_cast<float>(size - 1) : static_cast<float>(size);
+        if (span <= 0.f) {
+            c = 0.f;
+        } else {
+            c = std::fabs(c - low);
+            float extra = std::fmod(c, span);
+            int flips = static_cast<int>(std::floor(c / span));
+            c = (flips % 2 == 0) ? extra + low : span - extra + low;
+        }
+    }
+    if (padding != GridSample3DPaddingMode::Zeros) {
+        c = std::min(static_cast<float>(size - 1), std::max(c, 0.f));
+    }
+    return c;
+}
+
+void referenceGridSample3d(const float* input, const float* grid,
+                           size_t N, size_t C, size_t D_in, size_t H_in, size_t W_in,
+                           size_t D_grid, size_t H_grid, size_t W_grid,
+                           bool align_corners,
+                           GridSample3DInterpolationMode interpolation,
+                           GridSample3DPaddingMode padding,
+                           float* output) {
+    auto at = [&](size_t n, size_t c, int z, int y, int x) -> float {
+        if (x < 0 || y < 0 || z < 0 || x >= (int)W_in || y >= (int)H_in || z >= (int)D_in) {
+            return 0.f;
+        }
+        return input[(((n * C + c) * D_in + z) * H_in + y) * W_in + x];
+    };
+    for (size_t n = 0; n < N; n++)
+    for (size_t d = 0; d < D_grid; d++)
+    for (size_t h = 0; h < H_grid; h++)
+    for (size_t w = 0; w < W_grid; w++) {
+        const float* g = grid + (((n * D_grid + d) * H_grid + h) * W_grid + w) * 3;
+        float ix = referenceComputeIndex(g[0], (int)W_in, padding, align_corners);
+        float iy = referenceComputeIndex(g[1], (int)H_in, padding, align_corners);
+        float iz = referenceComputeIndex(g[2], (int)D_in, padding, align_corners);
+        for (size_t c = 0; c < C; c++) {
+            float value = 0.f;
+            if (interpolation == GridSample3DInterpolationMode::Nearest) {
+                value = at(n, c, (int)std::round(iz), (int)std::round(iy), (int)std::round(ix));
+            } else {
+                int x0 = (int)std::floor(ix), y0 = (int)std::floor(iy), z0 = (int)std::floor(iz);
+                float fx = ix - x0, fy = iy - y0, fz = iz - z0;
+                for (int dz = 0; dz < 2; dz++)
+                for (int dy = 0; dy < 2; dy++)
+                for (int dx = 0; dx < 2; dx++) {
+                    float weight = (dx ? fx : 1.f - fx) * (dy ? fy : 1.f - fy) * (dz ? fz : 1.f - fz);
+                    value += weight * at(n, c, z0 + dz, y0 + dy, x0 + dx);
+                }
+            }
+            output[(((n * C + c) * D_grid + d) * H_grid + h) * W_grid + w] = value;
+        }
+    }
+}
+
+// NCDHW -> N x spatial x pitch, channel padding left at 0
+template <typename T>
+std::vector<T> toChannelsLast(const std::vector<T>& data, size_t N, size_t C, size_t spatial, size_t pitch) {
+    std::vector<T> result(N * spatial * pitch, T(0));
+    for (size_t n = 0; n < N; n++)
+    for (size_t c = 0; c < C; c++)
+    for (size_t s = 0; s < spatial; s++) {
+        result[(n * spatial + s) * pitch + c] = data[(n * C + c) * spatial + s];
+    }
+    return result;
+}
+
+// F.affine_grid in double precision, PyTorch's linspace included
+std::vector<float> referenceAffineGrid(const float* theta, size_t N, size_t D, size_t H, size_t W, bool align_corners) {
+    auto base = [&](size_t i, size_t size) -> double {
+        if (size <= 1) {
+            return 0.0;
+        }
+        double v = -1.0 + 2.0 * i / (size - 1);
+        return align_corners ? v : v * (size - 1) / size;
+    };
+    std::vector<float> grid(N * D * H * W * 3);
+    for (size_t n = 0; n < N; n++)
+    for (size_t d = 0; d < D; d++)
+    for (size_t h = 0; h < H; h++)
+    for (size_t w = 0; w < W; w++) {
+        const float* t = theta + n * 12;
+        double b[4] = {base(w, W), base(h, H), base(d, D), 1.0};
+        for (int k = 0; k < 3; k++) {
+            double v = 0.0;
+            for (int j = 0; j < 4; j++) {
+                v += t[k * 4 + j] * b[j];
+            }
+            grid[(((n * D + d) * H + h) * W + w) * 3 + k] = static_cast<float>(v);
+        }
+    }
+    return grid;
 }
 
+const GridSample3DInterpolationMode kInterpolationModes[] = {
+    GridSample3DInterpolationMode::Bilinear, GridSample3DInterpolationMode::Nearest};
+const GridSample3DPaddingMode kPaddingModes[] = {
+    GridSample3DPaddingMode::Zeros, GridSample3DPaddingMode::Border, GridSample3DPaddingMode::Reflection};
+
 void testGridSample3dFloat16() {
     size_t N = 1;
     size_t C = 1;
@@ -53,21 +181,23 @@ void testGridSample3dFloat16() {
     auto output_number = N * C * D_grid * H_grid * W_grid;
     auto output_size = output_number * sizeof(half);
 
-    float* input_fp32 = (float*)malloc(input_number * sizeof(float));
-    float* grid_fp32 = (float*)malloc(grid_number * sizeof(float));
-    float* output_ref_fp32 = (float*)malloc(output_number * sizeof(float));
     float* output_fp32 = (float*)malloc(output_number * sizeof(float));
 
     half* input = (half*)malloc(input_size);
     half* grid = (half*)malloc(grid_size);
     half* output = (half*)malloc(output_size);
 
-    const std::string input_path = "../test/data/input.txt";
-    const std::string grid_path = "../test/data/grid.txt";
-    const std::string output_path = "../test/data/output.txt";
-    readData(getAbsolutionPath(input_path).c_str(), input_fp32);
-    readData(getAbsolutionPath(grid_path).c_str(), grid_fp32);
-    readData(getAbsolutionPath(output_path).c_str(), output_ref_fp32);
+    FixtureTensor input_fixture, grid_fixture, output_fixture;
+    const float* input_fp32 = mapFixture(input_fixture, "input.npy", {N, C, D_in, H_in, W_in});
+    const float* grid_fp32 = mapFixture(grid_fixture, "grid.npy", {N, D_grid, H_grid, W_grid, 3});
+    const float* output_ref_fp32 = mapFixture(output_fixture, "output.npy", {N, C, D_grid, H_grid, W_grid});
+    if (input_fp32 == nullptr || grid_fp32 == nullptr || output_ref_fp32 == nullptr) {
+        free(output_fp32);
+        free(input);
+        free(grid);
+        free(output);
+        return;
+    }
 
     float scale = 1.f;
 
@@ -100,27 +230,7 @@ void testGridSample3dFloat16() {
 
     cudaStream_t stream;
     cudaStreamCreate(&stream);
-    // warmup
-    printf("Warmup...\n");
-    for(int i = 0; i < 10; i++) {
-        grid_sample_3d_cuda<half>(
-                            d_input, 
-                            d_grid, 
-                            N, C, D_in, H_in, W_in,
-                            D_grid, H_grid, W_grid,
-                            false, 
-                            GridSample3DInterpolationMode::Bilinear, 
-                            GridSample3DPaddingMode::Zeros,
-                            d_output, 
-                            stream);
-    }
-
-    cudaEvent_t start, stop;
-    cudaEventCreate(&start);
-    cudaEventCreate(&stop);
-    cudaEventRecord(start, stream);
-
-    printf("Run...\n");
+    // timing lives in bench_grid_sample
     grid_sample_3d_cuda<half>(
                             d_input, 
                             d_grid, 
@@ -131,14 +241,7 @@ void testGridSample3dFloat16() {
                             GridSample3DPaddingMode::Zeros,
                             d_output, 
                             stream);
-
-    cudaEventRecord(stop, stream);
-
-    cudaEventSynchronize(stop);
-
-    float milliseconds = 0;
-    cudaEventElapsedTime(&milliseconds, start, stop);
-    printf("Time: %fms\n", milliseconds);                            
+    cudaStreamSynchronize(stream);
 
     cudaMemcpy(output, d_output, output_size, cudaMemcpyDeviceToHost);
 
@@ -171,10 +274,7 @@ void testGridSample3dFloat16() {
     free(input);
     free(grid);
     free(output);
-    free(input_fp32);
-    free(grid_fp32);
     free(output_fp32);
-    free(output_ref_fp32);
 
 
     printf("Done\n");
@@ -202,18 +302,15 @@ void testGridSample3dFloat32() {
     auto grid_size = grid_number * sizeof(float);
     auto output_number = N * C * D_grid * H_grid * W_grid;
     auto output_size = output_number * sizeof(float);
-    float* input = (float*)malloc(input_size);
-    float* grid = (float*)malloc(grid_size);
-    float* output_ref = (float*)malloc(output_size);
+    FixtureTensor input_fixture, grid_fixture, output_fixture;
+    const float* input = mapFixture(input_fixture, "input.npy", {N, C, D_in, H_in, W_in});
+    const float* grid = mapFixture(grid_fixture, "grid.npy", {N, D_grid, H_grid, W_grid, 3});
+    const float* output_ref = mapFixture(output_fixture, "output.npy", {N, C, D_grid, H_grid, W_grid});
+    if (input == nullptr || grid == nullptr || output_ref == nullptr) {
+        return;
+    }
     float* output = (float*)malloc(output_size);
 
-    const std::string input_path = "../test/data/input.txt";
-    const std::string grid_path = "../test/data/grid.txt";
-    const std::string output_path = "../test/data/output.txt";
-    readData(getAbsolutionPath(input_path).c_str(), input);
-    readData(getAbsolutionPath(grid_path).c_str(), grid);
-    readData(getAbsolutionPath(output_path).c_str(), output_ref);
-
     float* d_input;
     float* d_grid;
     float* d_output;
@@ -234,28 +331,7 @@ void testGridSample3dFloat32() {
 
     cudaStream_t stream;
     cudaStreamCreate(&stream);
-    // warmup
-    printf("Warmup...\n");
-    for(int i = 0; i < 10; i++) {
-        grid_sample_3d_cuda<float>(
-                            d_input, 
-                            d_grid, 
-                            N, C, D_in, H_in, W_in,
-                            D_grid, H_grid, W_grid,
-                            false, 
-                            GridSample3DInterpolationMode::Bilinear, 
-                            GridSample3DPaddingMode::Zeros,
-                            d_output, 
-                            stream);
-    }
-
-    cudaEvent_t start, stop;
-    cudaEventCreate(&start);
-    cudaEventCreate(&stop);
-
-    cudaEventRecord(start, stream);
-
-    printf("Run...\n");
+    // timing lives in bench_grid_sample
     grid_sample_3d_cuda<float>(
                             d_input, 
                             d_grid, 
@@ -266,14 +342,7 @@ void testGridSample3dFloat32() {
                             GridSample3DPaddingMode::Zeros,
                             d_output, 
                             stream);
-
-    cudaEventRecord(stop, stream);
-
-    cudaEventSynchronize(stop);
-
-    float milliseconds = 0;
-    cudaEventElapsedTime(&milliseconds, start, stop);
-    printf("Time: %fms\n", milliseconds);                            
+    cudaStreamSynchronize(stream);
 
     cudaMemcpy(output, d_output, output_size, cudaMemcpyDeviceToHost);
 
@@ -299,19 +368,2012 @@ void testGridSample3dFloat32() {
     cudaFree(d_grid);
     cudaFree(d_output);
 
-    free(input);
-    free(grid);
-    free(output_ref);
     free(output);
     printf("Done\n");
 }
 
+bool testGridSample3dCpuGolden() {
+    std::cout << "Test GridSample3dCpuGolden..." << std::endl;
+
+    size_t N = 1, C = 1, D_in = 16, H_in = 64, W_in = 64;
+    size_t D_grid = D_in, H_grid = H_in, W_grid = W_in;
+
+    FixtureTensor input_fixture, grid_fixture, output_fixture;
+    const float* input = mapFixture(input_fixture, "input.npy", {N, C, D_in, H_in, W_in});
+    const float* grid = mapFixture(grid_fixture, "grid.npy", {N, D_grid, H_grid, W_grid, 3});
+    const float* output_ref = mapFixture(output_fixture, "output.npy", {N, C, D_grid, H_grid, W_grid});
+    if (input == nullptr || grid == nullptr || output_ref == nullptr) {
+        return false;
+    }
+    std::vector<float> output(output_fixture.count());
+
+    int status = grid_sample_3d_cpu<float>(input, grid,
+                                           N, C, D_in, H_in, W_in,
+                                           D_grid, H_grid, W_grid,
+                                           false,
+                                           GridSample3DInterpolationMode::Bilinear,
+                                           GridSample3DPaddingMode::Zeros,
+                                           output.data());
+
+    float max_diff = maxAbsDiff(output.data(), output_ref, output.size());
+    printf("Max error: %f\n", max_diff);
+    return status == 0 && max_diff < 1e-4f;
+}
+
+// golden sets of generate_fixtures.py under test/data/golden: every sampling mode of a
+// multi-channel volume against F.grid_sample. The "small" set is committed and must be there; the
+// larger ones are checked when generated.
+bool testGridSample3dCpuGoldenSets() {
+    std::cout << "Test GridSample3dCpuGoldenSets..." << std::endl;
+
+    std::error_code error;
+    std::filesystem::directory_iterator sets(fixture_path("golden"), error);
+    if (error) {
+        std::cout << "  " << fixture_path("golden") << ": " << error.message() << std::endl;
+        return false;
+    }
+
+    bool ok = true;
+    bool small = false;
+    for (const auto& entry : sets) {
+        const std::string name = entry.path().filename().string();
+        small |= name == "small";
+        FixtureTensor input = FixtureTensor::openNpy((entry.path() / "input.npy").string());
+        FixtureTensor grid = FixtureTensor::openNpy((entry.path() / "grid.npy").string());
+        if (!input.valid() || !grid.valid() || input.shape().size() != 5 || grid.shape().size() != 5 ||
+            input.data<float>() == nullptr || grid.data<float>() == nullptr) {
+            std::cout << "  " << name << ": " << input.error() << grid.error() << " invalid set" << std::endl;
+            ok = false;
+            continue;
+        }
+        const std::vector<size_t>& in = input.shape();
+        const std::vector<size_t>& out = grid.shape();
+        std::vector<float> output(in[0] * in[1] * out[1] * out[2] * out[3]);
+
+        for (auto interpolation : kInterpolationModes) {
+            for (auto padding : kPaddingModes) {
+                for (bool align_corners : {false, true}) {
+                    static const char* paddingNames[] = {"zeros", "border", "reflection"};
+                    std::string file = std::string("output_") +
+                                       (interpolation == GridSample3DInterpolationMode::Nearest ? "nearest" : "bilinear") +
+                                       "_" + paddingNames[(int)padding] + "_" + (align_corners ? "1" : "0") + ".npy";
+                    FixtureTensor expected = FixtureTensor::openNpy((entry.path() / file).string());
+                    if (!expected.valid() || expected.count() != output.size() || expected.data<float>() == nullptr) {
+                        std::cout << "  " << name << "/" << file << ": missing or malformed" << std::endl;
+                        ok = false;
+                        continue;
+                    }
+                    int status = grid_sample_3d_cpu<float>(input.data<float>(), grid.data<float>(),
+                                                           in[0], in[1], in[2], in[3], in[4], out[1], out[2], out[3],
+                                                           align_corners, interpolation, padding, output.data());
+                    float max_diff = maxAbsDiff(output.data(), expected.data<float>(), output.size());
+                    bool pass = status == 0 && max_diff < 1e-4f;
+                    printf("  %s/%s max error %g %s\n", name.c_str(), file.c_str(), max_diff, pass ? "passed" : "FAILED");
+                    ok &= pass;
+                }
+            }
+        }
+    }
+    if (!small) {
+        std::cout << "  the committed golden set \"small\" is missing" << std::endl;
+    }
+    return ok && small;
+}
+
+bool testGridSample3dCpuModes() {
+    std::cout << "Test GridSample3dCpuModes..." << std::endl;
+
+    size_t N = 2, C = 5, D_in = 7, H_in = 9, W_in = 11;
+    size_t D_grid = 5, H_grid = 6, W_grid = 37;
+
+    std::vector<float> input(N * C * D_in * H_in * W_in);
+    std::vector<float> grid(N * D_grid * H_grid * W_grid * 3);
+    std::vector<float> output_ref(N * C * D_grid * H_grid * W_grid);
+    std::vector<float> output(output_ref.size());
+    fillUniform(input, -1.f, 1.f, 1);
+    fillUniform(grid, -1.3f, 1.3f, 2);
+
+    bool ok = true;
+    for (auto interpolation : kInterpolationModes) {
+        for (auto padding : kPaddingModes) {
+            for (bool align_corners : {false, true}) {
+                referenceGridSample3d(input.data(), grid.data(), N, C, D_in, H_in, W_in,
+                                      D_grid, H_grid, W_grid, align_corners, interpolation, padding,
+                                      output_ref.data());
+                int status = grid_sample_3d_cpu<float>(input.data(), grid.data(),
+                                                       N, C, D_in, H_in, W_in,
+                                                       D_grid, H_grid, W_grid,
+                                                       align_corners, interpolation, padding,
+                                                       output.data());
+                float max_diff = maxAbsDiff(output.data(), output_ref.data(), output.size());
+                bool pass = status == 0 && max_diff < 1e-5f;
+                printf("  interpolation=%d padding=%d align_corners=%d max error: %g %s\n",
+                       (int)interpolation, (int)padding, (int)align_corners, max_diff, pass ? "" : "FAILED");
+                ok &= pass;
+            }
+        }
+    }
+    return ok;
+}
+
+// diffs the CPU backend against the CUDA kernels on the same random problem
+bool testGridSample3dCpuVsCuda() {
+    std::cout << "Test GridSample3dCpuVsCuda..." << std::endl;
+
+    size_t N = 2, C = 4, D_in = 12, H_in = 20, W_in = 24;
+    size_t D_grid = 10, H_grid = 16, W_grid = 18;
+
+    std::vector<float> input(N * C * D_in * H_in * W_in);
+    std::vector<float> grid(N * D_grid * H_grid * W_grid * 3);
+    std::vector<float> output_cpu(N * C * D_grid * H_grid * W_grid);
+    std::vector<float> output_gpu(output_cpu.size());
+    fillUniform(input, -1.f, 1.f, 3);
+    fillUniform(grid, -1.1f, 1.1f, 4);
+
+    float *d_input, *d_grid, *d_output;
+    cudaMalloc(&d_input, input.size() * sizeof(float));
+    cudaMalloc(&d_grid, grid.size() * sizeof(float));
+    cudaMalloc(&d_output, output_gpu.size() * sizeof(float));
+    cudaMemcpy(d_input, input.data(), input.size() * sizeof(float), cudaMemcpyHostToDevice);
+    cudaMemcpy(d_grid, grid.data(), grid.size() * sizeof(float), cudaMemcpyHostToDevice);
+
+    bool ok = true;
+    for (auto interpolation : kInterpolationModes) {
+        for (auto padding : kPaddingModes) {
+            grid_sample_3d_cpu<float>(input.data(), grid.data(), N, C, D_in, H_in, W_in,
+                                      D_grid, H_grid, W_grid, false, interpolation, padding, output_cpu.data());
+            grid_sample_3d_cuda<float>(d_input, d_grid, N, C, D_in, H_in, W_in,
+                                       D_grid, H_grid, W_grid, false, interpolation, padding, d_output, 0);
+            cudaMemcpy(output_gpu.data(), d_output, output_gpu.size() * sizeof(float), cudaMemcpyDeviceToHost);
+            float max_diff = maxAbsDiff(output_cpu.data(), output_gpu.data(), output_cpu.size());
+            printf("  interpolation=%d padding=%d max error: %g\n", (int)interpolation, (int)padding, max_diff);
+            ok &= max_diff < 1e-4f;
+        }
+    }
+
+    // every autotuning candidate computes the same output
+    grid_sample_3d_cpu<float>(input.data(), grid.data(), N, C, D_in, H_in, W_in,
+                              D_grid, H_grid, W_grid, false, GridSample3DInterpolationMode::Bilinear,
+                              GridSample3DPaddingMode::Zeros, output_cpu.data());
+    for (const GridSample3DTactic& tactic : grid_sample_3d_tactic_candidates(GridSample3DBackend::CUDA,
+                                                                             N * D_grid * H_grid * W_grid, C)) {
+        cudaMemset(d_output, 0, output_gpu.size() * sizeof(float));
+        int status = grid_sample_3d_cuda<float>(d_input, d_grid, N, C, D_in, H_in, W_in,
+                                                D_grid, H_grid, W_grid, false, GridSample3DInterpolationMode::Bilinear,
+                                                GridSample3DPaddingMode::Zeros, d_output, 0,
+                                                GridSample3DLayout::NCDHW, GridSample3DGridKind::Absolute, tactic);
+        cudaMemcpy(output_gpu.data(), d_output, output_gpu.size() * sizeof(float), cudaMemcpyDeviceToHost);
+        float max_diff = maxAbsDiff(output_cpu.data(), output_gpu.data(), output_cpu.size());
+        if (status != 0 || max_diff >= 1e-4f) {
+            printf("  tactic block=%d voxels=%d channels=%d max error: %g FAILED\n", tactic.blockSize,
+                   tactic.voxelsPerThread, tactic.channelsPerThread, max_diff);
+            ok = false;
+        }
+    }
+
+    // bucketed sampling with a workspace, forced and through the Auto heuristic (random grid: on),
+    // and the bounds prepass alone and on top of bucketing and a Morton traversal
+    std::vector<GridSample3DTactic> workspaceTactics(5);
+    workspaceTactics[0].bucketing = GridSample3DBucketing::On;
+    workspaceTactics[1].bucketing = GridSample3DBucketing::Auto;
+    workspaceTactics[2].tileBounds = true;
+    workspaceTactics[3].tileBounds = true;
+    workspaceTactics[3].bucketing = GridSample3DBucketing::On;
+    workspaceTactics[4].tileBounds = true;
+    workspaceTactics[4].traversal = GridSample3DTraversal::Morton;
+    for (const GridSample3DTactic& tactic : workspaceTactics) {
+        void* d_workspace;
+        cudaMalloc(&d_workspace, grid_sample_3d_workspace_size(tactic, N, D_in, H_in, W_in, D_grid, H_grid, W_grid));
+        cudaMemset(d_output, 0, output_gpu.size() * sizeof(float));
+        int status = grid_sample_3d_cuda<float>(d_input, d_grid, N, C, D_in, H_in, W_in,
+                                                D_grid, H_grid, W_grid, false, GridSample3DInterpolationMode::Bilinear,
+                                                GridSample3DPaddingMode::Zeros, d_output, 0,
+                                                GridSample3DLayout::NCDHW, GridSample3DGridKind::Absolute, tactic,
+                                                d_workspace);
+        cudaMemcpy(output_gpu.data(), d_output, output_gpu.size() * sizeof(float), cudaMemcpyDeviceToHost);
+        float max_diff = maxAbsDiff(output_cpu.data(), output_gpu.data(), output_cpu.size());
+        printf("  bucketing=%d tileBounds=%d traversal=%d max error: %g\n", (int)tactic.bucketing,
+               (int)tactic.tileBounds, (int)tactic.traversal, max_diff);
+        ok &= status == 0 && max_diff < 1e-4f;
+        cudaFree(d_workspace);
+    }
+
+    // output mask: both backends zero the same voxels, also with the bounds prepass skipping them
+    std::vector<uint8_t> mask(N * D_grid * H_grid * W_grid);
+    for (size_t i = 0; i < mask.size(); i++) {
+        mask[i] = (i * 7919) % 10 < 3;
+    }
+    uint8_t* d_mask;
+    cudaMalloc(&d_mask, mask.size());
+    cudaMemcpy(d_mask, mask.data(), mask.size(), cudaMemcpyHostToDevice);
+    for (bool tileBounds : {false, true}) {
+        GridSample3DTactic tactic;
+        tactic.tileBounds = tileBounds;
+        void* d_workspace;
+        cudaMalloc(&d_workspace, grid_sample_3d_workspace_size(tactic, N, D_in, H_in, W_in, D_grid, H_grid, W_grid) + 1);
+        for (auto interpolation : kInterpolationModes) {
+            grid_sample_3d_cpu<float>(input.data(), grid.data(), N, C, D_in, H_in, W_in, D_grid, H_grid, W_grid, false,
+                                      interpolation, GridSample3DPaddingMode::Zeros, output_cpu.data(),
+                                      GridSample3DLayout::NCDHW, GridSample3DGridKind::Absolute, tactic, mask.data());
+            cudaMemset(d_output, 0x7f, output_gpu.size() * sizeof(float));
+            int status = grid_sample_3d_cuda<float>(d_input, d_grid, N, C, D_in, H_in, W_in, D_grid, H_grid, W_grid,
+                                                    false, interpolation, GridSample3DPaddingMode::Zeros, d_output, 0,
+                                                    GridSample3DLayout::NCDHW, GridSample3DGridKind::Absolute, tactic,
+                                                    d_workspace, d_mask);
+            cudaMemcpy(output_gpu.data(), d_output, output_gpu.size() * sizeof(float), cudaMemcpyDeviceToHost);
+            float max_diff = maxAbsDiff(output_cpu.data(), output_gpu.data(), output_cpu.size());
+            printf("  mask tileBounds=%d interpolation=%d max error: %g\n", (int)tileBounds, (int)interpolation,
+                   max_diff);
+            ok &= status == 0 && max_diff < 1e-4f;
+        }
+        cudaFree(d_workspace);
+    }
+    cudaFree(d_mask);
+
+    // point lists: the N x P x C kernel against the CPU, the grid read as N x P x 3 (P = D_grid * H_grid * W_grid)
+    {
+        const size_t P = D_grid * H_grid * W_grid;
+        for (auto pointLayout : {GridSample3DPointLayout::NPC, GridSample3DPointLayout::NCP}) {
+            for (auto interpolation : kInterpolationModes) {
+                grid_sample_3d_points_cpu<float>(input.data(), grid.data(), N, C, D_in, H_in, W_in, P, false,
+                                                 interpolation, GridSample3DPaddingMode::Zeros, output_cpu.data(),
+                                                 pointLayout);
+                cudaMemset(d_output, 0, output_gpu.size() * sizeof(float));
+                int status = grid_sample_3d_points_cuda<float>(d_input, d_grid, N, C, D_in, H_in, W_in, P, false,
+                                                               interpolation, GridSample3DPaddingMode::Zeros, d_output,
+                                                               0, pointLayout);
+                cudaMemcpy(output_gpu.data(), d_output, output_gpu.size() * sizeof(float), cudaMemcpyDeviceToHost);
+                float max_diff = maxAbsDiff(output_cpu.data(), output_gpu.data(), output_cpu.size());
+                printf("  points layout=%d interpolation=%d max error: %g\n", (int)pointLayout, (int)interpolation,
+                       max_diff);
+                ok &= status == 0 && max_diff < 1e-4f;
+            }
+        }
+    }
+
+    // mipmap sampling with the pyramid in a caller workspace and in a per-call allocation
+    {
+        void* d_workspace;
+        cudaMalloc(&d_workspace, grid_sample_3d_mipmap_workspace_size(N, C, D_in, H_in, W_in));
+        for (auto padding : kPaddingModes) {
+            grid_sample_3d_cpu<float>(input.data(), grid.data(), N, C, D_in, H_in, W_in, D_grid, H_grid, W_grid, false,
+                                      GridSample3DInterpolationMode::Mipmap, padding, output_cpu.data());
+            for (void* workspace : {static_cast<void*>(nullptr), d_workspace}) {
+                cudaMemset(d_output, 0, output_gpu.size() * sizeof(float));
+                int status = grid_sample_3d_mipmap_cuda<float>(d_input, d_grid, nullptr, N, C, D_in, H_in, W_in,
+                                                               D_grid, H_grid, W_grid, false, padding, d_output, 0,
+                                                               workspace);
+                cudaMemcpy(output_gpu.data(), d_output, output_gpu.size() * sizeof(float), cudaMemcpyDeviceToHost);
+                float max_diff = maxAbsDiff(output_cpu.data(), output_gpu.data(), output_cpu.size());
+                printf("  mipmap padding=%d workspace=%d max error: %g\n", (int)padding, workspace != nullptr, max_diff);
+                ok &= status == 0 && max_diff < 1e-4f;
+            }
+        }
+        cudaFree(d_workspace);
+    }
+
+    // ragged batch: the two batch items as items of different grid sizes, the table in device memory
+    {
+        std::vector<GridSample3DRaggedItem> items = {
+            {(int32_t)D_in, (int32_t)H_in, (int32_t)W_in, (int32_t)D_grid, (int32_t)H_grid, (int32_t)W_grid, 0, 0},
+            {(int32_t)D_in, (int32_t)H_in, (int32_t)W_in, 1, (int32_t)H_grid, (int32_t)W_grid, 0, 0}};
+        size_t V_in, G;
+        grid_sample_3d_ragged_pack(items.data(), items.size(), V_in, G);
+        // channel-major packing of the NCDHW input, the second item's grid is the first slice of batch item 1
+        std::vector<float> packed(C * V_in);
+        for (size_t c = 0; c < C; c++) {
+            for (size_t n = 0; n < N; n++) {
+                std::copy_n(input.begin() + (n * C + c) * D_in * H_in * W_in, D_in * H_in * W_in,
+                            packed.begin() + c * V_in + n * D_in * H_in * W_in);
+            }
+        }
+        std::vector<float> output_ragged_cpu(C * G), output_ragged_gpu(C * G);
+        GridSample3DRaggedItem* d_items;
+        float* d_packed;
+        cudaMalloc(&d_items, items.size() * sizeof(GridSample3DRaggedItem));
+        cudaMalloc(&d_packed, packed.size() * sizeof(float));
+        cudaMemcpy(d_items, items.data(), items.size() * sizeof(GridSample3DRaggedItem), cudaMemcpyHostToDevice);
+        cudaMemcpy(d_packed, packed.data(), packed.size() * sizeof(float), cudaMemcpyHostToDevice);
+        for (auto interpolation : kInterpolationModes) {
+            grid_sample_3d_ragged_cpu<float>(packed.data(), grid.data(), items.data(), items.size(), C, V_in, G, false,
+                                             interpolation, GridSample3DPaddingMode::Zeros, output_ragged_cpu.data());
+            int status = grid_sample_3d_ragged_cuda<float>(d_packed, d_grid, d_items, items.size(), C, V_in, G, false,
+                                                           interpolation, GridSample3DPaddingMode::Zeros, d_output, 0);
+            cudaMemcpy(output_ragged_gpu.data(), d_output, output_ragged_gpu.size() * sizeof(float), cudaMemcpyDeviceToHost);
+            float max_diff = maxAbsDiff(output_ragged_cpu.data(), output_ragged_gpu.data(), output_ragged_cpu.size());
+            printf("  ragged interpolation=%d max error: %g\n", (int)interpolation, max_diff);
+            ok &= status == 0 && max_diff < 1e-4f;
+        }
+        // a table leaving a gap in the grid zero-fills the output
+        std::vector<GridSample3DRaggedItem> gap = items;
+        gap.back().grid_offset += 1;
+        gap.back().W_grid -= 1;
+        cudaMemcpy(d_items, gap.data(), gap.size() * sizeof(GridSample3DRaggedItem), cudaMemcpyHostToDevice);
+        ok &= grid_sample_3d_ragged_cuda<float>(d_packed, d_grid, d_items, gap.size(), C, V_in, G, false,
+                                                GridSample3DInterpolationMode::Bilinear,
+                                                GridSample3DPaddingMode::Zeros, d_output, 0) == 0;
+        cudaMemcpy(output_ragged_gpu.data(), d_output, output_ragged_gpu.size() * sizeof(float), cudaMemcpyDeviceToHost);
+        ok &= std::all_of(output_ragged_gpu.begin(), output_ragged_gpu.end(), [](float v) { return v == 0.f; });
+        cudaFree(d_items);
+        cudaFree(d_packed);
+    }
+
+    // strided views: channels 1..C-1 of the input sampled into channels 0..C-2 of the output buffer
+    {
+        const GridSample3DStrides input_strides = grid_sample_3d_contiguous_strides(C, D_in, H_in, W_in);
+        const GridSample3DStrides output_strides = grid_sample_3d_contiguous_strides(C, D_grid, H_grid, W_grid);
+        const GridSample3DGridStrides grid_strides = grid_sample_3d_contiguous_grid_strides(D_grid, H_grid, W_grid);
+        const size_t input_offset = input_strides.C;
+        for (auto interpolation : kInterpolationModes) {
+            std::fill(output_cpu.begin(), output_cpu.end(), 0.f);
+            cudaMemset(d_output, 0, output_gpu.size() * sizeof(float));
+            grid_sample_3d_strided_cpu<float>(input.data() + input_offset, input_strides, grid.data(), grid_strides,
+                                              N, C - 1, D_in, H_in, W_in, D_grid, H_grid, W_grid, false, interpolation,
+                                              GridSample3DPaddingMode::Border, output_cpu.data(), output_strides);
+            int status = grid_sample_3d_strided_cuda<float>(d_input + input_offset, input_strides, d_grid, grid_strides,
+                                                            N, C - 1, D_in, H_in, W_in, D_grid, H_grid, W_grid, false,
+                                                            interpolation, GridSample3DPaddingMode::Border, d_output,
+                                                            output_strides, 0);
+            cudaMemcpy(output_gpu.data(), d_output, output_gpu.size() * sizeof(float), cudaMemcpyDeviceToHost);
+            float max_diff = maxAbsDiff(output_cpu.data(), output_gpu.data(), output_cpu.size());
+            printf("  strided interpolation=%d max error: %g\n", (int)interpolation, max_diff);
+            ok &= status == 0 && max_diff < 1e-4f;
+        }
+    }
+
+    // channels-last kernels, plain NDHWC (scalar channel loop) and NDHWC8 (16-byte packs)
+    for (auto layout : {GridSample3DLayout::NDHWC, GridSample3DLayout::NDHWC8}) {
+        size_t pitch = grid_sample_3d_channel_pitch(layout, C);
+        std::vector<float> input_cl = toChannelsLast(input, N, C, D_in * H_in * W_in, pitch);
+        std::vector<float> output_cl_cpu(N * D_grid * H_grid * W_grid * pitch);
+        std::vector<float> output_cl_gpu(output_cl_cpu.size());
+        float *d_input_cl, *d_output_cl;
+        cudaMalloc(&d_input_cl, input_cl.size() * sizeof(float));
+        cudaMalloc(&d_output_cl, output_cl_gpu.size() * sizeof(float));
+        cudaMemcpy(d_input_cl, input_cl.data(), input_cl.size() * sizeof(float), cudaMemcpyHostToDevice);
+        for (auto interpolation : kInterpolationModes) {
+            grid_sample_3d_cpu<float>(input_cl.data(), grid.data(), N, C, D_in, H_in, W_in,
+                                      D_grid, H_grid, W_grid, false, interpolation, GridSample3DPaddingMode::Zeros,
+                                      output_cl_cpu.data(), layout);
+            grid_sample_3d_cuda<float>(d_input_cl, d_grid, N, C, D_in, H_in, W_in,
+                                       D_grid, H_grid, W_grid, false, interpolation, GridSample3DPaddingMode::Zeros,
+                                       d_output_cl, 0, layout);
+            cudaMemcpy(output_cl_gpu.data(), d_output_cl, output_cl_gpu.size() * sizeof(float), cudaMemcpyDeviceToHost);
+            float max_diff = maxAbsDiff(output_cl_cpu.data(), output_cl_gpu.data(), output_cl_cpu.size());
+            printf("  layout=%d interpolation=%d max error: %g\n", (int)layout, (int)interpolation, max_diff);
+            ok &= max_diff < 1e-4f;
+        }
+        cudaFree(d_input_cl);
+        cudaFree(d_output_cl);
+    }
+
+    cudaFree(d_input);
+    cudaFree(d_grid);
+    cudaFree(d_output);
+    return ok;
+}
+
+// plan-apply must reproduce direct sampling bit for bit, including runs folded out as fully out of bounds
+bool testGridSample3dPlan() {
+    std::cout << "Test GridSample3dPlan..." << std::endl;
+
+    size_t N = 3, C = 4, D_in = 8, H_in = 10, W_in = 12;
+    size_t D_grid = 6, H_grid = 9, W_grid = 40;
+    size_t spatial = D_grid * H_grid * W_grid;
+
+    std::vector<float> input(N * C * D_in * H_in * W_in);
+    std::vector<float> grid(N * spatial * 3);
+    std::vector<float> output_direct(N * C * spatial);
+    std::vector<float> output_plan(output_direct.size());
+    fillUniform(input, -1.f, 1.f, 5);
+    fillUniform(grid, -1.5f, 1.5f, 6);
+    // the first slices of every grid look far outside the volume (a field-of-view crop)
+    for (size_t n = 0; n < N; n++) {
+        for (size_t s = 0; s < 2 * H_grid * W_grid; s++) {
+            grid[(n * spatial + s) * 3] = 4.f;
+        }
+    }
+
+    bool ok = true;
+    for (auto interpolation : kInterpolationModes) {
+        for (auto padding : kPaddingModes) {
+            for (bool align_corners : {false, true}) {
+                GridSample3DPlan* plan = grid_sample_3d_plan_create<float>(grid.data(), N, D_in, H_in, W_in,
+                                                                           D_grid, H_grid, W_grid,
+                                                                           align_corners, interpolation, padding);
+                int status = grid_sample_3d_plan_apply<float>(plan, input.data(), N, C, output_plan.data());
+                grid_sample_3d_cpu<float>(input.data(), grid.data(), N, C, D_in, H_in, W_in,
+                                          D_grid, H_grid, W_grid, align_corners, interpolation, padding,
+                                          output_direct.data());
+                bool pass = plan != nullptr && status == 0 &&
+                            memcmp(output_plan.data(), output_direct.data(), output_plan.size() * sizeof(float)) == 0;
+                printf("  interpolation=%d padding=%d align_corners=%d %s\n",
+                       (int)interpolation, (int)padding, (int)align_corners, pass ? "identical" : "FAILED");
+                ok &= pass;
+                grid_sample_3d_plan_destroy(plan);
+            }
+        }
+    }
+
+    // a plan over one grid is broadcast over the batch
+    std::vector<float> grid_repeated(grid.size());
+    for (size_t n = 0; n < N; n++) {
+        std::copy(grid.begin(), grid.begin() + spatial * 3, grid_repeated.begin() + n * spatial * 3);
+    }
+    GridSample3DPlan* plan = grid_sample_3d_plan_create<float>(grid.data(), 1, D_in, H_in, W_in,
+                                                               D_grid, H_grid, W_grid, false,
+                                                               GridSample3DInterpolationMode::Bilinear,
+                                                               GridSample3DPaddingMode::Zeros);
+    int status = grid_sample_3d_plan_apply<float>(plan, input.data(), N, C, output_plan.data());
+    grid_sample_3d_cpu<float>(input.data(), grid_repeated.data(), N, C, D_in, H_in, W_in,
+                              D_grid, H_grid, W_grid, false,
+                              GridSample3DInterpolationMode::Bilinear, GridSample3DPaddingMode::Zeros,
+                              output_direct.data());
+    bool pass = status == 0 && memcmp(output_plan.data(), output_direct.data(), output_plan.size() * sizeof(float)) == 0;
+    printf("  broadcast %s\n", pass ? "identical" : "FAILED");
+    grid_sample_3d_plan_destroy(plan);
+    return ok && pass;
+}
+
+// channels-last sampling must equal the NCDHW result bit for bit once transposed
+bool testGridSample3dCpuChannelsLast() {
+    std::cout << "Test GridSample3dCpuChannelsLast..." << std::endl;
+
+    size_t N = 2, C = 13, D_in = 6, H_in = 7, W_in = 9;
+    size_t D_grid = 4, H_grid = 5, W_grid = 21;
+    size_t spatial_in = D_in * H_in * W_in;
+    size_t spatial = D_grid * H_grid * W_grid;
+
+    std::vector<float> input(N * C * spatial_in);
+    std::vector<float> grid(N * spatial * 3);
+    std::vector<float> output(N * C * spatial);
+    fillUniform(input, -1.f, 1.f, 7);
+    fillUniform(grid, -1.2f, 1.2f, 8);
+
+    bool ok = true;
+    for (auto layout : {GridSample3DLayout::NDHWC, GridSample3DLayout::NDHWC8}) {
+        size_t pitch = grid_sample_3d_channel_pitch(layout, C);
+        std::vector<float> input_cl = toChannelsLast(input, N, C, spatial_in, pitch);
+        std::vector<float> output_cl(N * spatial * pitch, -1.f);
+        for (auto interpolation : kInterpolationModes) {
+            for (auto padding : kPaddingModes) {
+                grid_sample_3d_cpu<float>(input.data(), grid.data(), N, C, D_in, H_in, W_in,
+                                          D_grid, H_grid, W_grid, false, interpolation, padding, output.data());
+                int status = grid_sample_3d_cpu<float>(input_cl.data(), grid.data(), N, C, D_in, H_in, W_in,
+                                                       D_grid, H_grid, W_grid, false, interpolation, padding,
+                                                       output_cl.data(), layout);
+                std::vector<float> expected = toChannelsLast(output, N, C, spatial, pitch);
+                bool pass = status == 0 && memcmp(expected.data(), output_cl.data(), expected.size() * sizeof(float)) == 0;
+                printf("  layout=%d interpolation=%d padding=%d %s\n",
+                       (int)layout, (int)interpolation, (int)padding, pass ? "identical" : "FAILED");
+                ok &= pass;
+            }
+        }
+    }
+    return ok;
+}
+
+// the fused affine path must match sampling the materialized affine grid (up to FMA contraction
+// of the coordinate math, hence the tolerance)
+bool testGridSample3dAffineCpu() {
+    std::cout << "Test GridSample3dAffineCpu..." << std::endl;
+
+    size_t N = 2, C = 5, D_in = 7, H_in = 8, W_in = 9;
+    size_t D_out = 6, H_out = 10, W_out = 11;
+    size_t spatial = D_out * H_out * W_out;
+
+    std::vector<float> input(N * C * D_in * H_in * W_in);
+    std::vector<float> theta(N * 12);
+    std::vector<float> grid(N * spatial * 3);
+    std::vector<float> output_grid(N * C * spatial);
+    std::vector<float> output_affine(output_grid.size());
+    fillUniform(input, -1.f, 1.f, 9);
+    // a rotation-ish scaled transform with a shift that pushes part of the output out of the volume
+    fillUniform(theta, -0.4f, 0.4f, 10);
+    for (size_t n = 0; n < N; n++) {
+        theta[n * 12 + 0] += 1.1f;
+        theta[n * 12 + 5] += 0.9f;
+        theta[n * 12 + 10] += 1.2f;
+    }
+
+    bool ok = true;
+    for (bool align_corners : {false, true}) {
+        // materialize the grid with the coordinate helpers shared with the kernels
+        for (size_t n = 0; n < N; n++)
+        for (size_t d = 0; d < D_out; d++)
+        for (size_t h = 0; h < H_out; h++)
+        for (size_t w = 0; w < W_out; w++) {
+            float* g = grid.data() + (((n * D_out + d) * H_out + h) * W_out + w) * 3;
+            auto base = align_corners ? affine_grid_base<true> : affine_grid_base<false>;
+            affine_grid_coords(theta.data() + n * 12, base((int)w, (int)W_out), base((int)h, (int)H_out),
+                               base((int)d, (int)D_out), g[0], g[1], g[2]);
+        }
+        std::vector<float> expected_grid = referenceAffineGrid(theta.data(), N, D_out, H_out, W_out, align_corners);
+        float grid_diff = maxAbsDiff(grid.data(), expected_grid.data(), grid.size());
+        printf("  align_corners=%d affine_grid max diff %g\n", (int)align_corners, grid_diff);
+        ok &= grid_diff < 1e-5f;
+
+        for (auto interpolation : kInterpolationModes) {
+            for (auto padding : kPaddingModes) {
+                grid_sample_3d_cpu<float>(input.data(), grid.data(), N, C, D_in, H_in, W_in,
+                                          D_out, H_out, W_out, align_corners, interpolation, padding,
+                                          output_grid.data());
+                int status = grid_sample_3d_affine_cpu<float>(input.data(), theta.data(), N, C, D_in, H_in, W_in,
+                                                              D_out, H_out, W_out, align_corners, interpolation,
+                                                              padding, output_affine.data());
+                float max_diff = maxAbsDiff(output_grid.data(), output_affine.data(), output_grid.size());
+                bool pass = status == 0 && max_diff < 1e-5f;
+                printf("  interpolation=%d padding=%d align_corners=%d max diff %g %s\n",
+                       (int)interpolation, (int)padding, (int)align_corners, max_diff, pass ? "passed" : "FAILED");
+                ok &= pass;
+            }
+        }
+    }
+    return ok;
+}
+
+// a displacement grid must sample like the absolute grid it describes
+bool testGridSample3dCpuDisplacement() {
+    std::cout << "Test GridSample3dCpuDisplacement..." << std::endl;
+
+    size_t N = 2, C = 3, D_in = 6, H_in = 7, W_in = 9;
+    size_t D_out = 5, H_out = 7, W_out = 12;
+    size_t spatial = D_out * H_out * W_out;
+    size_t sizes_in[3] = {W_in, H_in, D_in};
+
+    std::vector<float> input(N * C * D_in * H_in * W_in);
+    std::vector<float> displacement(N * spatial * 3);
+    std::vector<float> grid(displacement.size());
+    std::vector<float> output_absolute(N * C * spatial);
+    std::vector<float> output_displacement(output_absolute.size());
+    fillUniform(input, -1.f, 1.f, 11);
+
+    bool ok = true;
+    for (auto kind : {GridSample3DGridKind::DisplacementVoxels, GridSample3DGridKind::DisplacementNormalized}) {
+        bool voxels = kind == GridSample3DGridKind::DisplacementVoxels;
+        fillUniform(displacement, voxels ? -2.f : -0.3f, voxels ? 2.f : 0.3f, 12);
+        for (bool align_corners : {false, true}) {
+            // identity + displacement as absolute normalized coordinates, in double
+            for (size_t n = 0; n < N; n++)
+            for (size_t d = 0; d < D_out; d++)
+            for (size_t h = 0; h < H_out; h++)
+            for (size_t w = 0; w < W_out; w++) {
+                size_t position[3] = {w, h, d};
+                size_t sizes_out[3] = {W_out, H_out, D_out};
+                size_t index = (((n * D_out + d) * H_out + h) * W_out + w) * 3;
+                for (int k = 0; k < 3; k++) {
+                    double size_in = static_cast<double>(sizes_in[k]);
+                    double size_out = static_cast<double>(sizes_out[k]);
+                    double identity = align_corners ? 2.0 * position[k] / (size_out - 1) - 1.0
+                                                    : (2.0 * position[k] + 1.0) / size_out - 1.0;
+                    double coordinate = identity + displacement[index + k];
+                    if (voxels) {
+                        double voxel = align_corners ? (identity + 1.0) / 2.0 * (size_in - 1)
+                                                     : ((identity + 1.0) * size_in - 1.0) / 2.0;
+                        voxel += displacement[index + k];
+                        coordinate = align_corners ? voxel * 2.0 / (size_in - 1) - 1.0
+                                                   : (2.0 * voxel + 1.0) / size_in - 1.0;
+                    }
+                    grid[index + k] = static_cast<float>(coordinate);
+                }
+            }
+            for (auto padding : kPaddingModes) {
+                grid_sample_3d_cpu<float>(input.data(), grid.data(), N, C, D_in, H_in, W_in,
+                                          D_out, H_out, W_out, align_corners,
+                                          GridSample3DInterpolationMode::Bilinear, padding, output_absolute.data());
+                int status = grid_sample_3d_cpu<float>(input.data(), displacement.data(), N, C, D_in, H_in, W_in,
+                                                       D_out, H_out, W_out, align_corners,
+                                                       GridSample3DInterpolationMode::Bilinear, padding,
+                                                       output_displacement.data(), GridSample3DLayout::NCDHW, kind);
+                float max_diff = maxAbsDiff(output_absolute.data(), output_displacement.data(), output_absolute.size());
+                bool pass = status == 0 && max_diff < 1e-4f;
+                printf("  kind=%d padding=%d align_corners=%d max diff %g %s\n",
+                       (int)kind, (int)padding, (int)align_corners, max_diff, pass ? "passed" : "FAILED");
+                ok &= pass;
+            }
+        }
+    }
+
+    // an integer voxel displacement is an exact shift when the output has the input size
+    const int shift[3] = {2, -1, 3};
+    size_t spatial_in = D_in * H_in * W_in;
+    std::vector<float> flow(N * spatial_in * 3);
+    for (size_t s = 0; s < N * spatial_in; s++) {
+        for (int k = 0; k < 3; k++) {
+            flow[s * 3 + k] = static_cast<float>(shift[k]);
+        }
+    }
+    std::vector<float> expected(N * C * spatial_in);
+    std::vector<float> output(expected.size());
+    for (size_t nc = 0; nc < N * C; nc++)
+    for (int d = 0; d < (int)D_in; d++)
+    for (int h = 0; h < (int)H_in; h++)
+    for (int w = 0; w < (int)W_in; w++) {
+        int x = w + shift[0], y = h + shift[1], z = d + shift[2];
+        bool inside = x >= 0 && x < (int)W_in && y >= 0 && y < (int)H_in && z >= 0 && z < (int)D_in;
+        expected[((nc * D_in + d) * H_in + h) * W_in + w] =
+            inside ? input[((nc * D_in + z) * H_in + y) * W_in + x] : 0.f;
+    }
+    for (auto interpolation : kInterpolationModes) {
+        for (bool align_corners : {false, true}) {
+            int status = grid_sample_3d_cpu<float>(input.data(), flow.data(), N, C, D_in, H_in, W_in,
+                                                   D_in, H_in, W_in, align_corners, interpolation,
+                                                   GridSample3DPaddingMode::Zeros, output.data(),
+                                                   GridSample3DLayout::NCDHW, GridSample3DGridKind::DisplacementVoxels);
+            bool pass = status == 0 && memcmp(expected.data(), output.data(), expected.size() * sizeof(float)) == 0;
+            printf("  integer shift interpolation=%d align_corners=%d %s\n",
+                   (int)interpolation, (int)align_corners, pass ? "identical" : "FAILED");
+            ok &= pass;
+        }
+    }
+    return ok;
+}
+
+template <typename scalar_t>
+std::vector<scalar_t> quantize(const std::vector<float>& data) {
+    std::vector<scalar_t> result(data.size());
+    for (size_t i = 0; i < data.size(); i++) {
+        result[i] = from_float<scalar_t>(data[i]);
+    }
+    return result;
+}
+
+template <typename scalar_t>
+std::vector<float> dequantize(const std::vector<scalar_t>& data) {
+    std::vector<float> result(data.size());
+    for (size_t i = 0; i < data.size(); i++) {
+        result[i] = to_float(data[i]);
+    }
+    return result;
+}
+
+// 16-bit volume sampled with an fp32 grid: the only error left is the rounding of the output,
+// compared to an fp32 run on the same (dequantized) volume.
+template <typename scalar_t>
+bool checkMixedPrecision(const char* name, float tolerance) {
+    size_t N = 2, C = 5, D_in = 7, H_in = 6, W_in = 9;
+    size_t D_grid = 4, H_grid = 5, W_grid = 8;
+    size_t spatial = D_grid * H_grid * W_grid;
+
+    std::vector<float> input(N * C * D_in * H_in * W_in);
+    std::vector<float> grid(N * spatial * 3);
+    std::vector<float> expected(N * C * spatial);
+    std::vector<scalar_t> output(expected.size());
+    fillUniform(input, -1.f, 1.f, 21);
+    fillUniform(grid, -1.1f, 1.1f, 22);
+    std::vector<scalar_t> input_q = quantize<scalar_t>(input);
+    std::vector<float> input_dq = dequantize(input_q);
+
+    bool ok = true;
+    for (auto interpolation : kInterpolationModes) {
+        for (auto padding : kPaddingModes) {
+            grid_sample_3d_cpu<float>(input_dq.data(), grid.data(), N, C, D_in, H_in, W_in,
+                                      D_grid, H_grid, W_grid, false, interpolation, padding, expected.data());
+            int status = grid_sample_3d_cpu<scalar_t>(input_q.data(), grid.data(), N, C, D_in, H_in, W_in,
+                                                      D_grid, H_grid, W_grid, false, interpolation, padding,
+                                                      output.data());
+            std::vector<float> actual = dequantize(output);
+            float max_diff = maxAbsDiff(expected.data(), actual.data(), expected.size());
+            bool pass = status == 0 && max_diff <= tolerance;
+            printf("  %s interpolation=%d padding=%d max diff %g %s\n",
+                   name, (int)interpolation, (int)padding, max_diff, pass ? "passed" : "FAILED");
+            ok &= pass;
+        }
+    }
+    return ok;
+}
+
+bool testGridSample3dCpuMixedPrecision() {
+    std::cout << "Test GridSample3dCpuMixedPrecision..." << std::endl;
+
+    // |output| <= 1, so half an ulp of the output type
+    bool ok = checkMixedPrecision<half>("fp16 volume, fp32 grid", 1.f / 4096);
+    ok &= checkMixedPrecision<bfloat16>("bf16 volume, fp32 grid", 1.f / 512);
+
+    // A 4096-voxel axis needs 12 fraction bits to address every voxel center: an fp32 grid picks
+    // each voxel back with nearest sampling, an fp16 grid (11 bits) cannot. Neighbouring voxels
+    // hold distinct values that are exact in fp16.
+    size_t W = 4096;
+    std::vector<float> ramp(W);
+    std::vector<float> centers(W * 3, 0.f);
+    for (size_t w = 0; w < W; w++) {
+        ramp[w] = static_cast<float>(w % 1024);
+        centers[w * 3] = static_cast<float>(2 * w + 1) / W - 1.f;
+    }
+    std::vector<half> ramp_q = quantize<half>(ramp);
+    std::vector<half> centers_q = quantize<half>(centers);
+    std::vector<half> output(W);
+    size_t misses_fp32 = 0, misses_fp16 = 0;
+
+    int status = grid_sample_3d_cpu<half>(ramp_q.data(), centers.data(), 1, 1, 1, 1, W, 1, 1, W, false,
+                                          GridSample3DInterpolationMode::Nearest, GridSample3DPaddingMode::Zeros,
+                                          output.data());
+    for (size_t w = 0; w < W; w++) {
+        misses_fp32 += to_float(output[w]) != ramp[w];
+    }
+    status |= grid_sample_3d_cpu<half>(ramp_q.data(), centers_q.data(), 1, 1, 1, 1, W, 1, 1, W, false,
+                                       GridSample3DInterpolationMode::Nearest, GridSample3DPaddingMode::Zeros,
+                                       output.data());
+    for (size_t w = 0; w < W; w++) {
+        misses_fp16 += to_float(output[w]) != ramp[w];
+    }
+    bool pass = status == 0 && misses_fp32 == 0 && misses_fp16 > 0;
+    printf("  %zu voxel centers: %zu missed with an fp32 grid, %zu with an fp16 grid %s\n",
+           W, misses_fp32, misses_fp16, pass ? "passed" : "FAILED");
+    return ok && pass;
+}
+
+// Quantized volume against the fp32 path on the unquantized volume. Interpolation weights sum to
+// at most 1, so the error budget is half an input step plus the rounding of the output:
+// half an output step when requantized, fp16 rounding otherwise.
+template <typename q_t>
+bool checkQuantized(const char* name, int32_t zero_point) {
+    size_t N = 2, C = 3, D_in = 6, H_in = 7, W_in = 5;
+    size_t D_grid = 4, H_grid = 6, W_grid = 7;
+    size_t volume = D_in * H_in * W_in;
+    size_t spatial = D_grid * H_grid * W_grid;
+
+    std::vector<float> input(N * C * volume);
+    std::vector<float> grid(N * spatial * 3);
+    std::vector<float> expected(N * C * spatial);
+    fillUniform(input, -1.f, 1.f, 31);
+    fillUniform(grid, -1.1f, 1.1f, 32);
+
+    // per channel: channel c spans [-(c + 1), c + 1]
+    std::vector<float> channel_scale(C);
+    std::vector<int32_t> channel_zero_point(C, zero_point);
+    for (size_t c = 0; c < C; c++) {
+        channel_scale[c] = 2.f * (c + 1) / 255.f;
+    }
+    GridSample3DQuantization quantization;
+    quantization.channelScale = channel_scale.data();
+    quantization.channelZeroPoint = channel_zero_point.data();
+
+    std::vector<q_t> input_q(input.size());
+    for (size_t n = 0; n < N; n++)
+    for (size_t c = 0; c < C; c++)
+    for (size_t i = 0; i < volume; i++) {
+        float& v = input[(n * C + c) * volume + i];
+        v *= c + 1;
+        input_q[(n * C + c) * volume + i] = quantize_value<q_t>(v, quantization, c);
+    }
+    const float step = channel_scale[C - 1];
+
+    std::vector<q_t> output_q(expected.size());
+    std::vector<half> output_h(expected.size());
+    bool ok = true;
+    for (auto interpolation : kInterpolationModes) {
+        for (auto padding : kPaddingModes) {
+            grid_sample_3d_cpu<float>(input.data(), grid.data(), N, C, D_in, H_in, W_in,
+                                      D_grid, H_grid, W_grid, false, interpolation, padding, expected.data());
+            int status = grid_sample_3d_quantized_cpu(input_q.data(), quantization, grid.data(), N, C, D_in, H_in, W_in,
+                                                      D_grid, H_grid, W_grid, false, interpolation, padding,
+                                                      output_q.data(), quantization);
+            status |= grid_sample_3d_quantized_cpu(input_q.data(), quantization, grid.data(), N, C, D_in, H_in, W_in,
+                                                   D_grid, H_grid, W_grid, false, interpolation, padding,
+                                                   output_h.data(), GridSample3DQuantization());
+            float error_q = 0.f, error_h = 0.f;
+            for (size_t i = 0; i < expected.size(); i++) {
+                size_t c = (i / spatial) % C;
+                error_q = std::max(error_q, std::fabs(dequantize_value(output_q[i], quantization, c) - expected[i]));
+                error_h = std::max(error_h, std::fabs(to_float(output_h[i]) - expected[i]));
+            }
+            // fp16 rounds |v| <= C with a relative error of 2^-11
+            bool pass = status == 0 && error_q <= step * 1.01f && error_h <= step * 0.505f + C / 2048.f;
+            printf("  %s interpolation=%d padding=%d max error requantized %g fp16 %g (step %g) %s\n",
+                   name, (int)interpolation, (int)padding, error_q, error_h, step, pass ? "passed" : "FAILED");
+            ok &= pass;
+        }
+    }
+    return ok;
+}
+
+bool testGridSample3dCpuQuantized() {
+    std::cout << "Test GridSample3dCpuQuantized..." << std::endl;
+    bool ok = checkQuantized<int8_t>("int8", 0);
+    ok &= checkQuantized<uint8_t>("uint8", 128);
+    return ok;
+}
+
+// label maps are copied exactly: same voxels as nearest sampling of the labels as float, every channel
+template <typename label_t>
+bool checkLabels(const char* name, int32_t first_label) {
+    size_t N = 2, C = 3, D_in = 6, H_in = 7, W_in = 5;
+    size_t D_grid = 4, H_grid = 6, W_grid = 7;
+    size_t volume = D_in * H_in * W_in;
+    size_t spatial = D_grid * H_grid * W_grid;
+
+    // distinct labels per channel so a kernel sampling the wrong channel shows up
+    std::vector<label_t> labels(N * C * volume);
+    std::vector<float> labels_f(labels.size());
+    std::mt19937 rng(41);
+    for (size_t i = 0; i < labels.size(); i++) {
+        size_t c = (i / volume) % C;
+        labels[i] = static_cast<label_t>(first_label + static_cast<int32_t>(c * 40 + rng() % 40));
+        labels_f[i] = static_cast<float>(labels[i]);
+    }
+    std::vector<float> grid(N * spatial * 3);
+    fillUniform(grid, -1.1f, 1.1f, 42);
+
+    std::vector<float> expected(N * C * spatial);
+    std::vector<label_t> output(expected.size());
+    bool ok = true;
+    for (auto padding : kPaddingModes) {
+        grid_sample_3d_cpu<float>(labels_f.data(), grid.data(), N, C, D_in, H_in, W_in, D_grid, H_grid, W_grid, false,
+                                  GridSample3DInterpolationMode::Nearest, padding, expected.data());
+        int status = grid_sample_3d_labels_cpu(labels.data(), grid.data(), N, C, D_in, H_in, W_in,
+                                               D_grid, H_grid, W_grid, false, padding, output.data());
+        size_t mismatches = 0;
+        for (size_t i = 0; i < expected.size(); i++) {
+            mismatches += static_cast<float>(output[i]) != expected[i];
+        }
+
+        // channels-last gives the same labels, padding channels zeroed
+        size_t pitch = grid_sample_3d_channel_pitch(GridSample3DLayout::NDHWC8, C);
+        std::vector<label_t> labels_cl = toChannelsLast(labels, N, C, volume, pitch);
+        std::vector<label_t> output_cl(N * spatial * pitch, label_t(1));
+        status |= grid_sample_3d_labels_cpu(labels_cl.data(), grid.data(), N, C, D_in, H_in, W_in,
+                                            D_grid, H_grid, W_grid, false, padding, output_cl.data(),
+                                            GridSample3DLayout::NDHWC8);
+        for (size_t n = 0; n < N; n++)
+        for (size_t i = 0; i < spatial; i++)
+        for (size_t c = 0; c < pitch; c++) {
+            label_t reference = c < C ? output[(n * C + c) * spatial + i] : label_t(0);
+            mismatches += output_cl[(n * spatial + i) * pitch + c] != reference;
+        }
+
+        bool pass = status == 0 && mismatches == 0;
+        printf("  %s padding=%d mismatches %zu %s\n", name, (int)padding, mismatches, pass ? "passed" : "FAILED");
+        ok &= pass;
+    }
+    return ok;
+}
+
+bool testGridSample3dCpuLabels() {
+    std::cout << "Test GridSample3dCpuLabels..." << std::endl;
+    bool ok = checkLabels<uint8_t>("uint8", 1);
+    ok &= checkLabels<int32_t>("int32", 100000);
+    return ok;
+}
+
+// tactic selection with synthetic timings, and the CPU candidates against the default tactic
+bool testGridSample3dTactics() {
+    std::cout << "Test GridSample3dTactics..." << std::endl;
+    bool ok = true;
+
+    std::vector<GridSample3DTactic> candidates = grid_sample_3d_tactic_candidates(GridSample3DBackend::CUDA, 1 << 20, 32);
+    ok &= candidates.size() > 1 && candidates.front() == GridSample3DTactic();
+    // 256-thread blocks are "fastest", 512 would be faster still but fails to launch
+    GridSample3DTactic best = grid_sample_3d_pick_tactic(candidates, [](const GridSample3DTactic& tactic) {
+        if (tactic.blockSize == 512) {
+            return -1.f;
+        }
+        return std::abs(tactic.blockSize - 256) + tactic.voxelsPerThread + tactic.channelsPerThread * 0.5f;
+    });
+    ok &= best.blockSize == 256 && best.voxelsPerThread == 1 && best.channelsPerThread == 0;
+    best = grid_sample_3d_pick_tactic(candidates, [](const GridSample3DTactic&) { return -1.f; });
+    ok &= best == candidates.front();
+    printf("  %zu CUDA candidates, selection %s\n", candidates.size(), ok ? "passed" : "FAILED");
+
+    // TensorRT's ids at build time (C = 3, so no channel slices) and on the plugin restored from the
+    // engine, whose sizes are unknown: every id keeps the tactic the build picked, although the
+    // same id indexes a different kernel of the unsized list
+    const size_t built_voxels = 2 * 16 * 16 * 16, built_channels = 3;
+    const std::vector<GridSample3DTactic> built = grid_sample_3d_tactic_candidates(GridSample3DBackend::CUDA,
+                                                                                   built_voxels, built_channels);
+    const std::vector<GridSample3DTactic> unsized = grid_sample_3d_tactic_candidates(GridSample3DBackend::CUDA,
+                                                                                     SIZE_MAX, SIZE_MAX);
+    bool ids_ok = built.size() > 3 && !(built[2] == unsized[2]);
+    for (int32_t id = 0; id <= static_cast<int32_t>(built.size()); id++) {
+        GridSample3DTactic picked;
+        picked.bucketing = GridSample3DBucketing::On;
+        ids_ok &= grid_sample_3d_apply_tactic_id(id, true, built_voxels, built_channels, picked);
+        ids_ok &= picked.bucketing == GridSample3DBucketing::On;
+        GridSample3DTactic restored = picked;
+        ids_ok &= grid_sample_3d_apply_tactic_id(id, false, SIZE_MAX, SIZE_MAX, restored) && restored == picked;
+    }
+    GridSample3DTactic past;
+    ids_ok &= !grid_sample_3d_apply_tactic_id(static_cast<int32_t>(built.size()) + 1, true, built_voxels,
+                                              built_channels, past);
+    printf("  tactic ids after deserialization %s\n", ids_ok ? "passed" : "FAILED");
+    ok &= ids_ok;
+
+    size_t N = 2, C = 3, D_in = 8, H_in = 9, W_in = 10;
+    size_t D_grid = 7, H_grid = 11, W_grid = 13;
+    std::vector<float> input(N * C * D_in * H_in * W_in);
+    std::vector<float> grid(N * D_grid * H_grid * W_grid * 3);
+    std::vector<float> output_ref(N * C * D_grid * H_grid * W_grid);
+    std::vector<float> output(output_ref.size());
+    fillUniform(input, -1.f, 1.f, 11);
+    fillUniform(grid, -1.1f, 1.1f, 12);
+
+    grid_sample_3d_cpu<float>(input.data(), grid.data(), N, C, D_in, H_in, W_in, D_grid, H_grid, W_grid,
+                              false, GridSample3DInterpolationMode::Bilinear, GridSample3DPaddingMode::Zeros,
+                              output_ref.data());
+    candidates = grid_sample_3d_tactic_candidates(GridSample3DBackend::CPU, N * D_grid * H_grid * W_grid, C);
+    ok &= candidates.front() == GridSample3DTactic();
+    for (const GridSample3DTactic& tactic : candidates) {
+        std::fill(output.begin(), output.end(), 0.f);
+        int status = grid_sample_3d_cpu<float>(input.data(), grid.data(), N, C, D_in, H_in, W_in,
+                                               D_grid, H_grid, W_grid, false, GridSample3DInterpolationMode::Bilinear,
+                                               GridSample3DPaddingMode::Zeros, output.data(), GridSample3DLayout::NCDHW,
+                                               GridSample3DGridKind::Absolute, tactic);
+        bool pass = status == 0 && maxAbsDiff(output.data(), output_ref.data(), output.size()) == 0.f;
+        printf("  tile=%d threads=%d traversal=%d %s\n", tactic.tileVoxels, tactic.numThreads, (int)tactic.traversal,
+               pass ? "passed" : "FAILED");
+        ok &= pass;
+    }
+
+    best = grid_sample_3d_cpu_autotune<float>(input.data(), grid.data(), N, C, D_in, H_in, W_in,
+                                              D_grid, H_grid, W_grid, false, GridSample3DInterpolationMode::Bilinear,
+                                              GridSample3DPaddingMode::Zeros, output.data());
+    ok &= std::find(candidates.begin(), candidates.end(), best) != candidates.end();
+    ok &= maxAbsDiff(output.data(), output_ref.data(), output.size()) == 0.f;
+    return ok;
+}
+
+// every traversal visits each output voxel exactly once, and the tiled CPU traversals match the
+// linear one bit for bit
+bool testGridSample3dTraversal() {
+    std::cout << "Test GridSample3dTraversal..." << std::endl;
+    bool ok = true;
+
+    const size_t N = 2, D = 5, H = 9, W = 19;
+    for (auto traversal : {GridSample3DTraversal::Linear, GridSample3DTraversal::Tiled, GridSample3DTraversal::Morton}) {
+        GridSample3DBricks bricks = grid_sample_3d_bricks(traversal, D, H, W, 4, 8, 8);
+        std::vector<int> visits(N * D * H * W, 0);
+        for (size_t i = 0; i < bricks.count(N); i++) {
+            size_t n, d, h, w;
+            if (bricks.voxel(i, n, d, h, w)) {
+                visits[((n * D + d) * H + h) * W + w]++;
+            }
+        }
+        bool pass = std::all_of(visits.begin(), visits.end(), [](int v) { return v == 1; });
+        printf("  traversal=%d %zu indices for %zu voxels %s\n", (int)traversal, bricks.count(N), visits.size(),
+               pass ? "passed" : "FAILED");
+        ok &= pass;
+    }
+
+    size_t C = 3, D_in = 8, H_in = 9, W_in = 10;
+    size_t pitch = grid_sample_3d_channel_pitch(GridSample3DLayout::NDHWC8, C);
+    std::vector<float> input(N * C * D_in * H_in * W_in);
+    std::vector<float> grid(N * D * H * W * 3);
+    fillUniform(input, -1.f, 1.f, 13);
+    fillUniform(grid, -1.1f, 1.1f, 14);
+    std::vector<float> input_cl = toChannelsLast(input, N, C, D_in * H_in * W_in, pitch);
+    std::vector<float> output_ref(N * D * H * W * pitch), output(output_ref.size());
+    grid_sample_3d_cpu<float>(input_cl.data(), grid.data(), N, C, D_in, H_in, W_in, D, H, W, true,
+                              GridSample3DInterpolationMode::Bilinear, GridSample3DPaddingMode::Border,
+                              output_ref.data(), GridSample3DLayout::NDHWC8);
+    for (auto traversal : {GridSample3DTraversal::Tiled, GridSample3DTraversal::Morton}) {
+        GridSample3DTactic tactic;
+        tactic.tileVoxels = 8;
+        tactic.traversal = traversal;
+        std::fill(output.begin(), output.end(), 0.f);
+        int status = grid_sample_3d_cpu<float>(input_cl.data(), grid.data(), N, C, D_in, H_in, W_in, D, H, W, true,
+                                               GridSample3DInterpolationMode::Bilinear, GridSample3DPaddingMode::Border,
+                                               output.data(), GridSample3DLayout::NDHWC8, GridSample3DGridKind::Absolute,
+                                               tactic);
+        bool pass = status == 0 && maxAbsDiff(output.data(), output_ref.data(), output.size()) == 0.f;
+        printf("  channels-last traversal=%d %s\n", (int)traversal, pass ? "passed" : "FAILED");
+        ok &= pass;
+    }
+    return ok;
+}
+
+// bucketed sampling only reorders the work: bit-identical to output order in every layout
+bool testGridSample3dBucketing() {
+    std::cout << "Test GridSample3dBucketing..." << std::endl;
+    bool ok = true;
+
+    const size_t N = 2, C = 3, D_in = 20, H_in = 18, W_in = 40;
+    const size_t D = 7, H = 9, W = 11;
+    std::vector<float> input(N * C * D_in * H_in * W_in);
+    std::vector<float> random_grid(N * D * H * W * 3);
+    fillUniform(input, -1.f, 1.f, 15);
+    fillUniform(random_grid, -1.1f, 1.1f, 16);
+    // smooth grid: a small rotation, whose buckets hold stretches of neighbouring voxels
+    std::vector<float> smooth_grid(random_grid.size());
+    for (size_t i = 0; i < N * D * H * W; i++) {
+        float x = 2.f * (i % W) / (W - 1) - 1.f;
+        float y = 2.f * (i / W % H) / (H - 1) - 1.f;
+        float z = 2.f * (i / (W * H) % D) / (D - 1) - 1.f;
+        smooth_grid[3 * i] = 0.98f * x - 0.17f * y;
+        smooth_grid[3 * i + 1] = 0.17f * x + 0.98f * y;
+        smooth_grid[3 * i + 2] = z;
+    }
+
+    for (const std::vector<float>* grid : {&random_grid, &smooth_grid}) {
+        for (auto layout : {GridSample3DLayout::NCDHW, GridSample3DLayout::NDHWC8}) {
+            const size_t pitch = layout == GridSample3DLayout::NCDHW ? C : grid_sample_3d_channel_pitch(layout, C);
+            std::vector<float> input_l = layout == GridSample3DLayout::NCDHW
+                ? input : toChannelsLast(input, N, C, D_in * H_in * W_in, pitch);
+            for (auto interpolation : kInterpolationModes) {
+                std::vector<float> output_ref(N * D * H * W * pitch), output(output_ref.size());
+                grid_sample_3d_cpu<float>(input_l.data(), grid->data(), N, C, D_in, H_in, W_in, D, H, W, false,
+                                          interpolation, GridSample3DPaddingMode::Zeros, output_ref.data(), layout);
+                for (auto bucketing : {GridSample3DBucketing::On, GridSample3DBucketing::Auto}) {
+                    GridSample3DTactic tactic;
+                    tactic.tileVoxels = 64;
+                    tactic.bucketing = bucketing;
+                    std::fill(output.begin(), output.end(), 0.f);
+                    int status = grid_sample_3d_cpu<float>(input_l.data(), grid->data(), N, C, D_in, H_in, W_in,
+                                                           D, H, W, false, interpolation, GridSample3DPaddingMode::Zeros,
+                                                           output.data(), layout, GridSample3DGridKind::Absolute, tactic);
+                    bool pass = status == 0 && maxAbsDiff(output.data(), output_ref.data(), output.size()) == 0.f;
+                    if (!pass) {
+                        printf("  %s grid layout=%d interpolation=%d bucketing=%d FAILED\n",
+                               grid == &random_grid ? "random" : "smooth", (int)layout, (int)interpolation,
+                               (int)bucketing);
+                    }
+                    ok &= pass;
+                }
+            }
+        }
+    }
+
+    // the workspace holds the flag, one offset per bucket and batch item, and the voxel order
+    size_t buckets = N * 2 * 2 * 3;
+    GridSample3DTactic bucketed;
+    bucketed.bucketing = GridSample3DBucketing::On;
+    size_t bytes = grid_sample_3d_workspace_size(bucketed, N, D_in, H_in, W_in, D, H, W);
+    bool pass = bytes >= 4 + buckets * 4 + N * D * H * W * 4;
+    printf("  workspace %zu bytes %s\n", bytes, pass ? "passed" : "FAILED");
+    ok &= pass;
+    return ok;
+}
+
+// the out-of-core sampler reads the input from a file in depth slabs and must match the in-memory result
+bool testGridSample3dStream() {
+    std::cout << "Test GridSample3dStream..." << std::endl;
+
+    const size_t N = 2, C = 3, D_in = 24, H_in = 10, W_in = 12;
+    const size_t D = 16, H = 7, W = 9;
+    const size_t header = 128;
+    std::vector<float> input(N * C * D_in * H_in * W_in);
+    fillUniform(input, -1.f, 1.f, 17);
+    // a tilted slab sweep: each output slice reaches a few input depths, the last two none at all
+    std::vector<float> grid(N * D * H * W * 3);
+    fillUniform(grid, -1.1f, 1.1f, 18);
+    for (size_t i = 0; i < N * D * H * W; i++) {
+        size_t d = i / (W * H) % D;
+        grid[3 * i + 2] = d + 2 < D ? 2.f * d / (D - 3) - 1.f + 0.05f * grid[3 * i + 1] : 1.5f;
+    }
+
+    // raw floats after a header, as in an .npy file
+    const std::string path = (std::filesystem::temp_directory_path() / "grid_sample_3d_stream_input.bin").string();
+    FILE* file = fopen(path.c_str(), "wb");
+    std::vector<char> padding(header, 0);
+    bool ok = file != nullptr && fwrite(padding.data(), 1, header, file) == header &&
+              fwrite(input.data(), sizeof(float), input.size(), file) == input.size();
+    if (file != nullptr) {
+        fclose(file);
+    }
+    if (!ok) {
+        printf("  cannot write %s FAILED\n", path.c_str());
+        return false;
+    }
+
+    // room for 6 input depths of every channel
+    const size_t slab_bytes = 6 * C * H_in * W_in * sizeof(float);
+    std::vector<float> output_ref(N * C * D * H * W), output(output_ref.size());
+    for (auto interpolation : kInterpolationModes) {
+        for (auto padding_mode : kPaddingModes) {
+            for (bool align_corners : {false, true}) {
+                grid_sample_3d_cpu<float>(input.data(), grid.data(), N, C, D_in, H_in, W_in, D, H, W, align_corners,
+                                          interpolation, padding_mode, output_ref.data());
+                std::fill(output.begin(), output.end(), -1.f);
+                GridSample3DStreamStats stats;
+                int status = grid_sample_3d_stream_cpu<float>(path.c_str(), header, grid.data(), N, C,
+                                                              D_in, H_in, W_in, D, H, W, align_corners,
+                                                              interpolation, padding_mode, output.data(),
+                                                              slab_bytes, &stats);
+                bool pass = status == 0 && stats.tiles > 2 * N && stats.maxSlabBytes <= slab_bytes &&
+                            memcmp(output.data(), output_ref.data(), output.size() * sizeof(float)) == 0;
+                printf("  interpolation=%d padding=%d align_corners=%d tiles=%zu %s\n",
+                       (int)interpolation, (int)padding_mode, (int)align_corners, stats.tiles,
+                       pass ? "identical" : "FAILED");
+                ok &= pass;
+            }
+        }
+    }
+
+    // an output slice that needs more input depths than the budget holds is an error
+    int status = grid_sample_3d_stream_cpu<float>(path.c_str(), header, grid.data(), N, C, D_in, H_in, W_in,
+                                                  D, H, W, false, GridSample3DInterpolationMode::Bilinear,
+                                                  GridSample3DPaddingMode::Zeros, output.data(),
+                                                  C * H_in * W_in * sizeof(float));
+    bool pass = status != 0;
+    printf("  budget below one slice %s\n", pass ? "rejected" : "FAILED");
+    ok &= pass;
+
+    // 2048^3 in and out: the input times output count wraps to 0, which must not read as an empty call
+    status = grid_sample_3d_stream_cpu<float>(path.c_str(), header, grid.data(), 1, 1, 2048, 2048, 2048,
+                                              2048, 2048, 2048, false, GridSample3DInterpolationMode::Bilinear,
+                                              GridSample3DPaddingMode::Zeros, output.data());
+    pass = status != 0;
+    printf("  input larger than the file %s\n", pass ? "rejected" : "FAILED");
+    ok &= pass;
+
+    std::filesystem::remove(path);
+    return ok;
+}
+
+// the bounds prepass only skips work: a zoomed-out field of view must sample bit-identically with and
+// without it, while its tile classes count the planes that fall outside the volume
+bool testGridSample3dTileBounds() {
+    std::cout << "Test GridSample3dTileBounds..." << std::endl;
+    bool ok = true;
+
+    const size_t N = 2, C = 3, D_in = 12, H_in = 14, W_in = 16;
+    const size_t D = 16, H = 16, W = 16;
+    std::vector<float> input(N * C * D_in * H_in * W_in);
+    fillUniform(input, -1.f, 1.f, 19);
+    auto zoom = [&](float scale) {
+        std::vector<float> grid(N * D * H * W * 3);
+        for (size_t i = 0; i < N * D * H * W; i++) {
+            grid[3 * i] = scale * (2.f * (i % W) + 1.f - W) / W;
+            grid[3 * i + 1] = scale * (2.f * (i / W % H) + 1.f - H) / H;
+            grid[3 * i + 2] = scale * (2.f * (i / (W * H) % D) + 1.f - D) / D;
+        }
+        return grid;
+    };
+    const std::vector<float> fov_grid = zoom(1.6f), crop_grid = zoom(0.5f);
+
+    GridSample3DTactic bounded;
+    bounded.tileVoxels = 64;
+    bounded.tileBounds = true;
+    for (auto layout : {GridSample3DLayout::NCDHW, GridSample3DLayout::NDHWC8}) {
+        const size_t pitch = layout == GridSample3DLayout::NCDHW ? C : grid_sample_3d_channel_pitch(layout, C);
+        std::vector<float> input_l = layout == GridSample3DLayout::NCDHW
+            ? input : toChannelsLast(input, N, C, D_in * H_in * W_in, pitch);
+        for (auto interpolation : kInterpolationModes) {
+            for (auto padding : kPaddingModes) {
+                for (bool align_corners : {false, true}) {
+                    std::vector<float> output_ref(N * D * H * W * pitch), output(output_ref.size(), -1.f);
+                    grid_sample_3d_cpu<float>(input_l.data(), fov_grid.data(), N, C, D_in, H_in, W_in, D, H, W,
+                                              align_corners, interpolation, padding, output_ref.data(), layout);
+                    int status = grid_sample_3d_cpu<float>(input_l.data(), fov_grid.data(), N, C, D_in, H_in, W_in,
+                                                           D, H, W, align_corners, interpolation, padding,
+                                                           output.data(), layout, GridSample3DGridKind::Absolute,
+                                                           bounded);
+                    bool pass = status == 0 &&
+                                memcmp(output.data(), output_ref.data(), output.size() * sizeof(float)) == 0;
+                    if (!pass) {
+                        printf("  layout=%d interpolation=%d padding=%d align_corners=%d FAILED\n", (int)layout,
+                               (int)interpolation, (int)padding, (int)align_corners);
+                    }
+                    ok &= pass;
+                }
+            }
+        }
+    }
+
+    // 16-bit volumes go through the converting gather
+    std::vector<half> input_h = quantize<half>(input);
+    std::vector<half> output_ref(N * C * D * H * W), output(output_ref.size());
+    grid_sample_3d_cpu<half>(input_h.data(), fov_grid.data(), N, C, D_in, H_in, W_in, D, H, W, false,
+                             GridSample3DInterpolationMode::Bilinear, GridSample3DPaddingMode::Zeros,
+                             output_ref.data());
+    int status = grid_sample_3d_cpu<half>(input_h.data(), fov_grid.data(), N, C, D_in, H_in, W_in, D, H, W, false,
+                                          GridSample3DInterpolationMode::Bilinear, GridSample3DPaddingMode::Zeros,
+                                          output.data(), GridSample3DLayout::NCDHW, GridSample3DGridKind::Absolute,
+                                          bounded);
+    bool pass = status == 0 && memcmp(output.data(), output_ref.data(), output.size() * sizeof(half)) == 0;
+    printf("  fp16 %s\n", pass ? "identical" : "FAILED");
+    ok &= pass;
+
+    // a tile is one 16x16 output plane: the outer planes of the zoomed-out view miss the volume in
+    // zeros padding, no plane is wholly inside, and the zoomed-in crop never leaves it. Border padding
+    // clamps onto the last voxel, whose upper bilinear corner still needs its bounds test.
+    const size_t tiles = N * D * H * W / GRID_SAMPLE_3D_BOUNDS_TILE;
+    for (auto interpolation : kInterpolationModes) {
+        GridSample3DTileStats fov = grid_sample_3d_tile_stats<float>(fov_grid.data(), N, D_in, H_in, W_in, D, H, W,
+                                                                     false, interpolation,
+                                                                     GridSample3DPaddingMode::Zeros);
+        GridSample3DTileStats border = grid_sample_3d_tile_stats<float>(fov_grid.data(), N, D_in, H_in, W_in,
+                                                                        D, H, W, false, interpolation,
+                                                                        GridSample3DPaddingMode::Border);
+        GridSample3DTileStats crop = grid_sample_3d_tile_stats<float>(crop_grid.data(), N, D_in, H_in, W_in,
+                                                                      D, H, W, false, interpolation,
+                                                                      GridSample3DPaddingMode::Zeros);
+        pass = fov.outside > 0 && fov.inside == 0 && fov.outside + fov.mixed == tiles &&
+               border.outside == 0 &&
+               (interpolation == GridSample3DInterpolationMode::Bilinear || border.inside == tiles) &&
+               crop.inside == tiles;
+        printf("  interpolation=%d tiles outside=%zu inside=%zu mixed=%zu %s\n", (int)interpolation, fov.outside,
+               fov.inside, fov.mixed, pass ? "passed" : "FAILED");
+        ok &= pass;
+    }
+
+    // one tile class per bounds tile of the CUDA bricks, after the bucketing workspace when both are on
+    GridSample3DTactic both = bounded;
+    both.bucketing = GridSample3DBucketing::On;
+    GridSample3DTactic bucketed;
+    bucketed.bucketing = GridSample3DBucketing::On;
+    size_t bytes = grid_sample_3d_workspace_size(bounded, N, D_in, H_in, W_in, D, H, W);
+    pass = bytes >= tiles && grid_sample_3d_workspace_size(GridSample3DTactic(), N, D_in, H_in, W_in, D, H, W) == 0 &&
+           grid_sample_3d_workspace_size(both, N, D_in, H_in, W_in, D, H, W) >=
+               grid_sample_3d_workspace_size(bucketed, N, D_in, H_in, W_in, D, H, W) + tiles;
+    printf("  workspace %zu bytes %s\n", bytes, pass ? "passed" : "FAILED");
+    ok &= pass;
+    return ok;
+}
+
+// masked-out voxels come out as zeros and every other voxel as without a mask, whatever the
+// traversal; the mask is a ball (whole runs switched off) with scattered holes (partial runs)
+bool testGridSample3dMask() {
+    std::cout << "Test GridSample3dMask..." << std::endl;
+    bool ok = true;
+
+    const size_t N = 2, C = 3, D_in = 10, H_in = 12, W_in = 14;
+    const size_t D = 12, H = 13, W = 40;
+    const size_t spatial = D * H * W;
+    std::vector<float> input(N * C * D_in * H_in * W_in);
+    std::vector<float> grid(N * spatial * 3);
+    fillUniform(input, -1.f, 1.f, 23);
+    fillUniform(grid, -1.1f, 1.1f, 24);
+    std::vector<uint8_t> mask(N * spatial);
+    for (size_t i = 0; i < mask.size(); i++) {
+        float x = 2.f * (i % W) / (W - 1) - 1.f;
+        float y = 2.f * (i / W % H) / (H - 1) - 1.f;
+        float z = 2.f * (i / (W * H) % D) / (D - 1) - 1.f;
+        mask[i] = x * x + y * y + z * z < 0.6f && i % 7 != 0;
+    }
+
+    std::vector<GridSample3DTactic> tactics(4);
+    tactics[1].tileVoxels = 64;
+    tactics[1].tileBounds = true;
+    tactics[2].traversal = GridSample3DTraversal::Tiled;
+    tactics[3].bucketing = GridSample3DBucketing::On;
+    for (auto layout : {GridSample3DLayout::NCDHW, GridSample3DLayout::NDHWC8}) {
+        const bool channels_last = layout != GridSample3DLayout::NCDHW;
+        const size_t pitch = channels_last ? grid_sample_3d_channel_pitch(layout, C) : C;
+        std::vector<float> input_l = channels_last ? toChannelsLast(input, N, C, D_in * H_in * W_in, pitch) : input;
+        for (auto interpolation : kInterpolationModes) {
+            for (auto padding : kPaddingModes) {
+                std::vector<float> expected(N * spatial * pitch), output(expected.size());
+                grid_sample_3d_cpu<float>(input_l.data(), grid.data(), N, C, D_in, H_in, W_in, D, H, W, false,
+                                          interpolation, padding, expected.data(), layout);
+                for (size_t i = 0; i < expected.size(); i++) {
+                    const size_t n = i / (spatial * pitch);
+                    const size_t v = channels_last ? i / pitch % spatial : i % spatial;
+                    if (!mask[n * spatial + v]) {
+                        expected[i] = 0.f;
+                    }
+                }
+                for (const GridSample3DTactic& tactic : tactics) {
+                    std::fill(output.begin(), output.end(), -1.f);
+                    int status = grid_sample_3d_cpu<float>(input_l.data(), grid.data(), N, C, D_in, H_in, W_in,
+                                                           D, H, W, false, interpolation, padding, output.data(),
+                                                           layout, GridSample3DGridKind::Absolute, tactic, mask.data());
+                    bool pass = status == 0 &&
+                                memcmp(output.data(), expected.data(), output.size() * sizeof(float)) == 0;
+                    if (!pass) {
+                        printf("  layout=%d interpolation=%d padding=%d traversal=%d bucketing=%d tileBounds=%d "
+                               "FAILED\n", (int)layout, (int)interpolation, (int)padding, (int)tactic.traversal,
+                               (int)tactic.bucketing, (int)tactic.tileBounds);
+                    }
+                    ok &= pass;
+                }
+            }
+        }
+    }
+
+    // label maps write label 0 where the mask is off
+    std::vector<int32_t> labels(N * C * D_in * H_in * W_in);
+    for (size_t i = 0; i < labels.size(); i++) {
+        labels[i] = static_cast<int32_t>(i % 5) + 1;
+    }
+    std::vector<int32_t> expected(N * C * spatial), output(expected.size(), -1);
+    int status = grid_sample_3d_labels_cpu(labels.data(), grid.data(), N, C, D_in, H_in, W_in, D, H, W, false,
+                                           GridSample3DPaddingMode::Border, expected.data());
+    status |= grid_sample_3d_labels_cpu(labels.data(), grid.data(), N, C, D_in, H_in, W_in, D, H, W, false,
+                                        GridSample3DPaddingMode::Border, output.data(), GridSample3DLayout::NCDHW,
+                                        GridSample3DGridKind::Absolute, GridSample3DTactic(), mask.data());
+    for (size_t i = 0; i < expected.size(); i++) {
+        if (!mask[i / (C * spatial) * spatial + i % spatial]) {
+            expected[i] = 0;
+        }
+    }
+    bool pass = status == 0 && output == expected;
+    printf("  %s\n", ok && pass ? "passed" : "FAILED");
+    ok &= pass;
+    return ok;
+}
+
+// point lists: N x C x P is the output of a 1 x 1 x P grid, N x P x C its transpose, bit for bit
+bool testGridSample3dPoints() {
+    std::cout << "Test GridSample3dPoints..." << std::endl;
+    bool ok = true;
+
+    const size_t N = 2, C = 5, D_in = 9, H_in = 11, W_in = 13, P = 1000;
+    std::vector<float> input(N * C * D_in * H_in * W_in);
+    std::vector<float> points(N * P * 3);
+    fillUniform(input, -1.f, 1.f, 25);
+    fillUniform(points, -1.1f, 1.1f, 26);
+    std::vector<uint8_t> mask(N * P);
+    for (size_t i = 0; i < mask.size(); i++) {
+        mask[i] = i % 3 != 0;
+    }
+    std::vector<half> input_h = quantize<half>(input), points_h = quantize<half>(points);
+
+    std::vector<GridSample3DTactic> tactics(2);
+    tactics[1].tileVoxels = 64;
+    for (auto interpolation : kInterpolationModes) {
+        for (auto padding : kPaddingModes) {
+            for (bool align : {false, true}) {
+                for (const uint8_t* m : {static_cast<const uint8_t*>(nullptr), static_cast<const uint8_t*>(mask.data())}) {
+                    std::vector<float> expected(N * C * P), ncp(expected.size()), npc(expected.size());
+                    int status = grid_sample_3d_cpu<float>(input.data(), points.data(), N, C, D_in, H_in, W_in, 1, 1, P,
+                                                           align, interpolation, padding, expected.data(),
+                                                           GridSample3DLayout::NCDHW, GridSample3DGridKind::Absolute,
+                                                           GridSample3DTactic(), m);
+                    bool pass = status == 0;
+                    for (const GridSample3DTactic& tactic : tactics) {
+                        status = grid_sample_3d_points_cpu<float>(input.data(), points.data(), N, C, D_in, H_in, W_in,
+                                                                  P, align, interpolation, padding, ncp.data(),
+                                                                  GridSample3DPointLayout::NCP, tactic, m);
+                        status |= grid_sample_3d_points_cpu<float>(input.data(), points.data(), N, C, D_in, H_in, W_in,
+                                                                   P, align, interpolation, padding, npc.data(),
+                                                                   GridSample3DPointLayout::NPC, tactic, m);
+                        pass &= status == 0 && ncp == expected;
+                        for (size_t i = 0; i < expected.size(); i++) {
+                            const size_t n = i / (C * P), c = i / P % C, p = i % P;
+                            pass &= memcmp(&npc[(n * P + p) * C + c], &expected[i], sizeof(float)) == 0;
+                        }
+                    }
+
+                    // fp16 volume with an fp16 point list
+                    std::vector<half> expected_h(N * C * P), npc_h(expected_h.size());
+                    status = grid_sample_3d_cpu<half>(input_h.data(), points_h.data(), N, C, D_in, H_in, W_in, 1, 1, P,
+                                                      align, interpolation, padding, expected_h.data(),
+                                                      GridSample3DLayout::NCDHW, GridSample3DGridKind::Absolute,
+                                                      GridSample3DTactic(), m);
+                    status |= grid_sample_3d_points_cpu<half>(input_h.data(), points_h.data(), N, C, D_in, H_in, W_in,
+                                                              P, align, interpolation, padding, npc_h.data(),
+                                                              GridSample3DPointLayout::NPC, GridSample3DTactic(), m);
+                    pass &= status == 0;
+                    for (size_t i = 0; i < expected_h.size(); i++) {
+                        const size_t n = i / (C * P), c = i / P % C, p = i % P;
+                        pass &= memcmp(&npc_h[(n * P + p) * C + c], &expected_h[i], sizeof(half)) == 0;
+                    }
+                    if (!pass) {
+                        printf("  interpolation=%d padding=%d align=%d mask=%d FAILED\n", (int)interpolation,
+                               (int)padding, (int)align, m != nullptr);
+                    }
+                    ok &= pass;
+                }
+            }
+        }
+    }
+    printf("  %s\n", ok ? "passed" : "FAILED");
+    return ok;
+}
+
+// Mipmap sampling: LOD 0 is bilinear sampling, a 2x identity downsample reads the 2 x 2 x 2 box
+// averages of level 1 and the coarsest level of a power-of-two volume is its mean.
+bool testGridSample3dMipmap() {
+    std::cout << "Test GridSample3dMipmap..." << std::endl;
+    bool ok = true;
+
+    const size_t N = 2, C = 3, S = 16, D_grid = 7, H_grid = 9, W_grid = 10;
+    const size_t spatial = D_grid * H_grid * W_grid;
+    std::vector<float> input(N * C * S * S * S);
+    std::vector<float> grid(N * spatial * 3);
+    fillUniform(input, -1.f, 1.f, 27);
+    fillUniform(grid, -1.1f, 1.1f, 28);
+    std::vector<float> zero_lod(N * spatial, 0.f), high_lod(N * spatial, 100.f);
+    std::vector<uint8_t> mask(N * spatial);
+    for (size_t i = 0; i < mask.size(); i++) {
+        mask[i] = i % 4 != 0;
+    }
+    GridSample3DTactic runs;
+    runs.tileVoxels = 64;
+
+    for (auto padding : kPaddingModes) {
+        for (bool align : {false, true}) {
+            std::vector<float> bilinear(N * C * spatial), lod0(bilinear.size()), jacobian(bilinear.size());
+            std::vector<float> direct(bilinear.size()), masked(bilinear.size());
+            int status = grid_sample_3d_cpu<float>(input.data(), grid.data(), N, C, S, S, S, D_grid, H_grid, W_grid,
+                                                   align, GridSample3DInterpolationMode::Bilinear, padding,
+                                                   bilinear.data());
+            status |= grid_sample_3d_mipmap_cpu<float>(input.data(), grid.data(), zero_lod.data(), N, C, S, S, S,
+                                                       D_grid, H_grid, W_grid, align, padding, lod0.data());
+            bool pass = status == 0 && maxAbsDiff(bilinear.data(), lod0.data(), bilinear.size()) < 1e-6f;
+
+            // the interpolation mode of grid_sample_3d_cpu reaches the same sampler
+            status = grid_sample_3d_cpu<float>(input.data(), grid.data(), N, C, S, S, S, D_grid, H_grid, W_grid,
+                                               align, GridSample3DInterpolationMode::Mipmap, padding, jacobian.data());
+            status |= grid_sample_3d_mipmap_cpu<float>(input.data(), grid.data(), nullptr, N, C, S, S, S,
+                                                       D_grid, H_grid, W_grid, align, padding, direct.data(), runs);
+            pass &= status == 0 && jacobian == direct;
+
+            status = grid_sample_3d_mipmap_cpu<float>(input.data(), grid.data(), nullptr, N, C, S, S, S,
+                                                      D_grid, H_grid, W_grid, align, padding, masked.data(),
+                                                      GridSample3DTactic(), mask.data());
+            for (size_t i = 0; i < masked.size(); i++) {
+                const size_t n = i / (C * spatial), s = i % spatial;
+                pass &= masked[i] == (mask[n * spatial + s] ? jacobian[i] : 0.f);
+            }
+            pass &= status == 0;
+            if (!pass) {
+                printf("  padding=%d align=%d FAILED\n", (int)padding, (int)align);
+            }
+            ok &= pass;
+        }
+    }
+
+    // identity grid at half the resolution: LOD 1, output voxel (d, h, w) on the box (2d, 2h, 2w)
+    {
+        const size_t O = S / 2;
+        const float identity[12] = {1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0};
+        std::vector<float> theta;
+        for (size_t n = 0; n < N; n++) {
+            theta.insert(theta.end(), identity, identity + 12);
+        }
+        std::vector<float> half_grid = referenceAffineGrid(theta.data(), N, O, O, O, false);
+        std::vector<float> output(N * C * O * O * O);
+        int status = grid_sample_3d_cpu<float>(input.data(), half_grid.data(), N, C, S, S, S, O, O, O, false,
+                                               GridSample3DInterpolationMode::Mipmap,
+                                               GridSample3DPaddingMode::Zeros, output.data());
+        float max_diff = 0.f;
+        for (size_t i = 0; i < output.size(); i++) {
+            const size_t nc = i / (O * O * O), d = i / (O * O) % O, h = i / O % O, w = i % O;
+            float sum = 0.f;
+            for (size_t k = 0; k < 8; k++) {
+                sum += input[((nc * S + 2 * d + (k >> 2)) * S + 2 * h + (k >> 1 & 1)) * S + 2 * w + (k & 1)];
+            }
+            max_diff = std::max(max_diff, std::abs(output[i] - sum / 8));
+        }
+        printf("  2x downsample max error vs box average: %g\n", max_diff);
+        ok &= status == 0 && max_diff < 1e-5f;
+    }
+
+    // past the coarsest level every sample is the slice mean
+    {
+        std::vector<float> output(N * C * spatial);
+        int status = grid_sample_3d_mipmap_cpu<float>(input.data(), grid.data(), high_lod.data(), N, C, S, S, S,
+                                                      D_grid, H_grid, W_grid, false, GridSample3DPaddingMode::Border,
+                                                      output.data());
+        float max_diff = 0.f;
+        for (size_t nc = 0; nc < N * C; nc++) {
+            double mean = 0.0;
+            for (size_t v = 0; v < S * S * S; v++) {
+                mean += input[nc * S * S * S + v];
+            }
+            mean /= S * S * S;
+            for (size_t s = 0; s < spatial; s++) {
+                max_diff = std::max(max_diff, std::abs(output[nc * spatial + s] - static_cast<float>(mean)));
+            }
+        }
+        printf("  coarsest level max error vs mean: %g\n", max_diff);
+        ok &= status == 0 && max_diff < 1e-5f;
+    }
+    printf("  %s\n", ok ? "passed" : "FAILED");
+    return ok;
+}
+
+// a ragged batch samples every item exactly like a batch of one of that item's shape
+bool testGridSample3dRagged() {
+    std::cout << "Test GridSample3dRagged..." << std::endl;
+    bool ok = true;
+
+    const size_t C = 3;
+    std::vector<GridSample3DRaggedItem> items = {
+        {9, 11, 13, 7, 8, 9, 0, 0},
+        {16, 6, 20, 12, 12, 4, 0, 0},
+        {5, 5, 5, 1, 30, 30, 0, 0},
+        {24, 18, 10, 5, 5, 5, 0, 0}};
+    size_t V_in, G;
+    ok &= grid_sample_3d_ragged_pack(items.data(), items.size(), V_in, G);
+    std::vector<float> input(C * V_in), grid(G * 3);
+    fillUniform(input, -1.f, 1.f, 30);
+    fillUniform(grid, -1.1f, 1.1f, 31);
+    std::vector<half> input_h = quantize<half>(input);
+
+    std::vector<GridSample3DTactic> tactics(2);
+    tactics[1].tileVoxels = 64;
+    for (auto interpolation : kInterpolationModes) {
+        for (auto padding : kPaddingModes) {
+            for (bool align : {false, true}) {
+                bool pass = true;
+                std::vector<float> expected(C * G);
+                std::vector<half> expected_h(C * G);
+                for (const GridSample3DRaggedItem& item : items) {
+                    const size_t voxels_in = static_cast<size_t>(item.D_in) * item.H_in * item.W_in;
+                    const size_t voxels = static_cast<size_t>(item.D_grid) * item.H_grid * item.W_grid;
+                    std::vector<float> volume(C * voxels_in), sampled(C * voxels);
+                    std::vector<half> volume_h(C * voxels_in), sampled_h(C * voxels);
+                    for (size_t c = 0; c < C; c++) {
+                        std::copy_n(input.begin() + c * V_in + item.input_offset, voxels_in, volume.begin() + c * voxels_in);
+                        std::copy_n(input_h.begin() + c * V_in + item.input_offset, voxels_in, volume_h.begin() + c * voxels_in);
+                    }
+                    int status = grid_sample_3d_cpu<float>(volume.data(), grid.data() + 3 * item.grid_offset, 1, C,
+                                                           item.D_in, item.H_in, item.W_in, item.D_grid, item.H_grid,
+                                                           item.W_grid, align, interpolation, padding, sampled.data());
+                    status |= grid_sample_3d_cpu<half, float>(volume_h.data(), grid.data() + 3 * item.grid_offset, 1, C,
+                                                              item.D_in, item.H_in, item.W_in, item.D_grid, item.H_grid,
+                                                              item.W_grid, align, interpolation, padding, sampled_h.data());
+                    pass &= status == 0;
+                    for (size_t c = 0; c < C; c++) {
+                        std::copy_n(sampled.begin() + c * voxels, voxels, expected.begin() + c * G + item.grid_offset);
+                        std::copy_n(sampled_h.begin() + c * voxels, voxels, expected_h.begin() + c * G + item.grid_offset);
+                    }
+                }
+                for (const GridSample3DTactic& tactic : tactics) {
+                    std::vector<float> output(C * G);
+                    std::vector<half> output_h(C * G);
+                    int status = grid_sample_3d_ragged_cpu<float>(input.data(), grid.data(), items.data(), items.size(),
+                                                                  C, V_in, G, align, interpolation, padding,
+                                                                  output.data(), tactic);
+                    status |= grid_sample_3d_ragged_cpu<half, float>(input_h.data(), grid.data(), items.data(),
+                                                                     items.size(), C, V_in, G, align, interpolation,
+                                                                     padding, output_h.data(), tactic);
+                    pass &= status == 0 && output == expected &&
+                            memcmp(output_h.data(), expected_h.data(), output_h.size() * sizeof(half)) == 0;
+                }
+                if (!pass) {
+                    printf("  interpolation=%d padding=%d align=%d FAILED\n", (int)interpolation, (int)padding,
+                           (int)align);
+                }
+                ok &= pass;
+            }
+        }
+    }
+
+    // an item reaching past the packed input is rejected
+    std::vector<GridSample3DRaggedItem> bad = items;
+    bad.back().input_offset += 1;
+    std::vector<float> output(C * G);
+    ok &= grid_sample_3d_ragged_cpu<float>(input.data(), grid.data(), bad.data(), bad.size(), C, V_in, G, false,
+                                           GridSample3DInterpolationMode::Bilinear, GridSample3DPaddingMode::Zeros,
+                                           output.data()) != 0;
+    // so are items out of grid_offset order, and packed tensors beyond the int32 offsets
+    bad = items;
+    std::swap(bad[1], bad[2]);
+    ok &= grid_sample_3d_ragged_cpu<float>(input.data(), grid.data(), bad.data(), bad.size(), C, V_in, G, false,
+                                           GridSample3DInterpolationMode::Bilinear, GridSample3DPaddingMode::Zeros,
+                                           output.data()) != 0;
+    const size_t too_large = static_cast<size_t>(INT32_MAX) + 1;
+    ok &= grid_sample_3d_ragged_cpu<float>(input.data(), grid.data(), items.data(), items.size(), C, too_large, G,
+                                           false, GridSample3DInterpolationMode::Bilinear,
+                                           GridSample3DPaddingMode::Zeros, output.data()) != 0;
+    printf("  %s\n", ok ? "passed" : "FAILED");
+    return ok;
+}
+
+bool testGridSample3dProfile() {
+    std::cout << "Test GridSample3dProfile..." << std::endl;
+    bool ok = true;
+
+    struct Trace {
+        int begins = 0, ends = 0;
+    } trace;
+    grid_sample_3d_set_trace_hooks([](const char*, void* user) { static_cast<Trace*>(user)->begins++; },
+                                   [](const char*, void* user) { static_cast<Trace*>(user)->ends++; }, &trace);
+    std::string logged;
+    grid_sample_3d_set_log_sink([](GridSample3DLogSeverity, const char* message, void* user) {
+        *static_cast<std::string*>(user) = message;
+    }, &logged);
+
+    const bool wasEnabled = grid_sample_3d_profile_enabled();
+    grid_sample_3d_profile_enable(true);
+    grid_sample_3d_profile_reset();
+
+    const size_t N = 2, C = 3, D = 6, H = 7, W = 8, D_out = 4, H_out = 5, W_out = 9;
+    const size_t voxels = N * D_out * H_out * W_out;
+    std::vector<float> input(N * C * D * H * W), grid(voxels * 3), output(N * C * D_out * H_out * W_out);
+    fillUniform(input, -1.f, 1.f, 50);
+    // every bilinear corner falls outside the input
+    std::fill(grid.begin(), grid.end(), 3.f);
+    ok &= grid_sample_3d_cpu<float>(input.data(), grid.data(), N, C, D, H, W, D_out, H_out, W_out, false,
+                                    GridSample3DInterpolationMode::Bilinear, GridSample3DPaddingMode::Zeros,
+                                    output.data()) == 0;
+    // every nearest tap falls inside, on a second shape
+    fillUniform(grid, -0.5f, 0.5f, 51);
+    ok &= grid_sample_3d_cpu<float>(input.data(), grid.data(), N, C, D, H, W, 1, 1, voxels / N, false,
+                                    GridSample3DInterpolationMode::Nearest, GridSample3DPaddingMode::Zeros,
+                                    output.data()) == 0;
+    // mipmap sampling needs NCDHW: counted as an error
+    ok &= grid_sample_3d_cpu<float>(input.data(), grid.data(), N, C, D, H, W, D_out, H_out, W_out, false,
+                                    GridSample3DInterpolationMode::Mipmap, GridSample3DPaddingMode::Zeros,
+                                    output.data(), GridSample3DLayout::NDHWC) != 0;
+    grid_sample_3d_log(GridSample3DLogSeverity::Warning, "profile test %d", 7);
+
+    GridSample3DProfileStats stats = grid_sample_3d_profile_snapshot();
+    uint64_t histogram = 0;
+    for (uint64_t count : stats.latency) {
+        histogram += count;
+    }
+    ok &= stats.calls == 3 && stats.errors == 1 && histogram == 3 && stats.totalMs > 0.0;
+    ok &= stats.bytesRead == 3 * (input.size() + grid.size()) * sizeof(float) &&
+          stats.bytesWritten == 3 * output.size() * sizeof(float);
+    ok &= stats.taps == voxels * 8 + voxels && stats.outOfBoundsTaps == voxels * 8;
+    ok &= stats.numShapes == 2 && stats.shapeCalls[0] == 2 && stats.shapeCalls[1] == 1 &&
+          stats.shapes[1].W_grid == voxels / N && stats.otherShapes == 0;
+    ok &= trace.begins == 3 && trace.ends == 3 && logged == "profile test 7";
+    printf("  %llu calls, %.1f%% of %llu taps out of bounds\n", (unsigned long long)stats.calls,
+           100.0 * stats.outOfBoundsTaps / std::max<uint64_t>(stats.taps, 1), (unsigned long long)stats.taps);
+
+    // nothing is counted while disabled, the trace ranges still run
+    grid_sample_3d_profile_enable(false);
+    ok &= grid_sample_3d_cpu<float>(input.data(), grid.data(), N, C, D, H, W, D_out, H_out, W_out, false,
+                                    GridSample3DInterpolationMode::Bilinear, GridSample3DPaddingMode::Zeros,
+                                    output.data()) == 0;
+    ok &= grid_sample_3d_profile_snapshot().calls == 3 && trace.ends == 4;
+
+    // an enqueue captured into a CUDA graph is counted without timing it
+    if (hasCudaDevice()) {
+        grid_sample_3d_profile_enable(true);
+        grid_sample_3d_profile_reset();
+        cudaStream_t stream;
+        cudaGraph_t graph = nullptr;
+        cudaStreamCreate(&stream);
+        ok &= cudaStreamBeginCapture(stream, cudaStreamCaptureModeThreadLocal) == cudaSuccess;
+        GridSample3DProfileScope("captured", GridSample3DProfileShape{N, C, D, H, W, D_out, H_out, W_out}, 0, 0, stream)
+            .finish(0);
+        ok &= cudaStreamEndCapture(stream, &graph) == cudaSuccess;
+        cudaGraphDestroy(graph);
+        cudaStreamDestroy(stream);
+        stats = grid_sample_3d_profile_snapshot();
+        ok &= stats.calls == 1 && stats.untimed == 1 && stats.totalMs == 0.0;
+        grid_sample_3d_profile_enable(false);
+    }
+
+    grid_sample_3d_profile_reset();
+    grid_sample_3d_profile_enable(wasEnabled);
+    grid_sample_3d_set_trace_hooks(nullptr, nullptr, nullptr);
+    grid_sample_3d_set_log_sink(nullptr, nullptr);
+    printf("  %s\n", ok ? "passed" : "FAILED");
+    return ok;
+}
+
+bool testGridSample3dIndexWidth() {
+    std::cout << "Test GridSample3dIndexWidth..." << std::endl;
+    bool ok = true;
+
+    // 32-bit index math up to INT32_MAX elements in every tensor and iteration space, 64-bit past it
+    const size_t limit = static_cast<size_t>(INT32_MAX);
+    ok &= grid_sample_3d_index_fits_32bit(1, 1, 1, 1, limit, 1, 1, 1, 1);
+    ok &= !grid_sample_3d_index_fits_32bit(1, 1, 1, 1, limit + 1, 1, 1, 1, 1);
+    ok &= grid_sample_3d_index_fits_32bit(1, 1, 1, 1, 1, 1, 1, limit / 3, limit / 3);
+    ok &= !grid_sample_3d_index_fits_32bit(1, 1, 1, 1, 1, 1, 1, limit / 3 + 1, limit / 3 + 1);
+    ok &= !grid_sample_3d_index_fits_32bit(1, 2, 1, 1, 1, 1, 1, limit / 3 + 1, limit / 3 + 1);
+    ok &= grid_sample_3d_index_fits_32bit(1, 1, 1, 1, 1, 1, 1, 1, limit);
+    ok &= !grid_sample_3d_index_fits_32bit(1, 1, 1, 1, 1, 1, 1, 1, limit + 1);
+    // production-like: the (2, 64, 256^3) output is 2^31 elements
+    ok &= grid_sample_3d_index_fits_32bit(2, 63, 128, 128, 128, 256, 256, 256, size_t(2) * 256 * 256 * 256);
+    ok &= !grid_sample_3d_index_fits_32bit(2, 64, 128, 128, 128, 256, 256, 256, size_t(2) * 256 * 256 * 256);
+
+    // the 32-bit voxel decomposition of the kernels matches the 64-bit one up to the last index
+    // that fits, and the 64-bit one stays exact past 2^32
+    std::mt19937_64 rng(5);
+    for (GridSample3DTraversal traversal : {GridSample3DTraversal::Linear, GridSample3DTraversal::Tiled,
+                                            GridSample3DTraversal::Morton}) {
+        // Morton pads every axis to a power of two bricks, 2047 would take it past INT32_MAX
+        const size_t W = traversal == GridSample3DTraversal::Morton ? 1024 : 2047;
+        const GridSample3DBricks bricks = grid_sample_3d_bricks(traversal, 1000, 1024, W, 4, 4, 32);
+        const size_t count = bricks.count(1);
+        std::vector<size_t> indices = {0, 1, W - 1, W, count / 2, count - 2, count - 1};
+        for (int i = 0; i < 64; i++) {
+            indices.push_back(rng() % count);
+        }
+        bool pass = count <= limit;
+        for (size_t i : indices) {
+            size_t n, d, h, w;
+            uint32_t n32, d32, h32, w32;
+            const bool valid = bricks.voxel<size_t>(i, n, d, h, w);
+            pass &= bricks.voxel<uint32_t>(static_cast<uint32_t>(i), n32, d32, h32, w32) == valid;
+            pass &= !valid || (n == n32 && d == d32 && h == h32 && w == w32 && n == 0);
+        }
+
+        // five batch items: indices past 2^32
+        const size_t batch = 5;
+        const size_t total = bricks.count(batch);
+        pass &= total > size_t(UINT32_MAX);
+        for (size_t i : {total - 1, size_t(UINT32_MAX) + 1, count + 5}) {
+            size_t n, d, h, w;
+            if (bricks.voxel<size_t>(i, n, d, h, w)) {
+                size_t n0, d0, h0, w0;
+                // the same position of batch item 0
+                pass &= bricks.voxel<size_t>(i - n * count, n0, d0, h0, w0) && n0 == 0 && d0 == d && h0 == h &&
+                        w0 == w && n < batch;
+            }
+        }
+        if (traversal == GridSample3DTraversal::Linear) {
+            size_t n, d, h, w;
+            pass &= bricks.voxel<size_t>(total - 1, n, d, h, w) && n == batch - 1 && d == 999 && h == 1023 && w == 2046;
+        }
+        if (!pass) {
+            printf("  traversal=%d FAILED\n", (int)traversal);
+        }
+        ok &= pass;
+    }
+    printf("  %s\n", ok ? "passed" : "FAILED");
+    return ok;
+}
+
+bool testGridSample3dStrided() {
+    std::cout << "Test GridSample3dStrided..." << std::endl;
+    bool ok = true;
+
+    const size_t N = 2, C = 3, D = 6, H = 7, W = 8;
+    const size_t D_out = 4, H_out = 5, W_out = 6;
+    const size_t spatial = D_out * H_out * W_out;
+
+    // channels 1..3 of a 5-channel input, and the same input channels-last
+    const size_t C_full = 5;
+    std::vector<float> input_full(N * C_full * D * H * W);
+    fillUniform(input_full, -1.f, 1.f, 61);
+    const float* input_slice = input_full.data() + D * H * W;
+    const GridSample3DStrides slice_strides{C_full * D * H * W, D * H * W, H * W, W, 1};
+    std::vector<float> input(N * C * D * H * W), input_last(input.size());
+    for (size_t n = 0; n < N; n++) {
+        for (size_t c = 0; c < C; c++) {
+            for (size_t v = 0; v < D * H * W; v++) {
+                input[(n * C + c) * D * H * W + v] = input_slice[n * slice_strides.N + c * slice_strides.C + v];
+                input_last[(n * D * H * W + v) * C + c] = input[(n * C + c) * D * H * W + v];
+            }
+        }
+    }
+    const GridSample3DStrides last_strides{D * H * W * C, 1, H * W * C, W * C, C};
+
+    // the grid as a contiguous N x D x H x W x 3 tensor and permuted to (N, 3, D, H, W)
+    std::vector<float> grid(N * spatial * 3), grid_permuted(grid.size());
+    fillUniform(grid, -1.1f, 1.1f, 62);
+    for (size_t n = 0; n < N; n++) {
+        for (size_t s = 0; s < spatial; s++) {
+            for (size_t k = 0; k < 3; k++) {
+                grid_permuted[(n * 3 + k) * spatial + s] = grid[(n * spatial + s) * 3 + k];
+            }
+        }
+    }
+    const GridSample3DGridStrides permuted_strides{3 * spatial, H_out * W_out, W_out, 1, spatial};
+
+    // the output view is channels 1..3, depths 1..4, widths 2..7 of a larger buffer
+    const size_t C_big = C + 1, D_big = D_out + 2, H_big = H_out + 1, W_big = W_out + 3;
+    const GridSample3DStrides big_strides{C_big * D_big * H_big * W_big, D_big * H_big * W_big, H_big * W_big, W_big, 1};
+    const size_t view_begin = big_strides.C + big_strides.D + 2;
+    const float untouched = 123.f;
+
+    for (int i = 0; i < 6; i++) {
+        const GridSample3DInterpolationMode interpolation = kInterpolationModes[i % 2];
+        const GridSample3DPaddingMode padding = kPaddingModes[i % 3];
+        const bool align = i % 4 == 0;
+        GridSample3DTactic tactic;
+        tactic.tileVoxels = 64;
+        tactic.tileBounds = i % 2 == 1;
+
+        std::vector<float> expected(N * C * spatial);
+        ok &= grid_sample_3d_cpu<float>(input.data(), grid.data(), N, C, D, H, W, D_out, H_out, W_out, align,
+                                        interpolation, padding, expected.data()) == 0;
+
+        // channel slice in, permuted grid, written into the sub-region
+        std::vector<float> big(N * big_strides.N, untouched);
+        ok &= grid_sample_3d_strided_cpu<float>(input_slice, slice_strides, grid_permuted.data(), permuted_strides,
+                                                N, C, D, H, W, D_out, H_out, W_out, align, interpolation, padding,
+                                                big.data() + view_begin, big_strides, tactic) == 0;
+        bool pass = true;
+        std::vector<bool> in_view(big.size(), false);
+        for (size_t n = 0; n < N; n++) {
+            for (size_t c = 0; c < C; c++) {
+                for (size_t s = 0; s < spatial; s++) {
+                    const size_t d = s / (H_out * W_out), h = s / W_out % H_out, w = s % W_out;
+                    const size_t o = view_begin + n * big_strides.N + c * big_strides.C + d * big_strides.D +
+                                     h * big_strides.H + w;
+                    in_view[o] = true;
+                    pass &= big[o] == expected[(n * C + c) * spatial + s];
+                }
+            }
+        }
+        for (size_t o = 0; o < big.size(); o++) {
+            pass &= in_view[o] || big[o] == untouched;
+        }
+
+        // channels-last input, contiguous grid and output
+        std::vector<float> output(expected.size());
+        ok &= grid_sample_3d_strided_cpu<float>(input_last.data(), last_strides, grid.data(),
+                                                grid_sample_3d_contiguous_grid_strides(D_out, H_out, W_out),
+                                                N, C, D, H, W, D_out, H_out, W_out, align, interpolation, padding,
+                                                output.data(), grid_sample_3d_contiguous_strides(C, D_out, H_out, W_out),
+                                                tactic) == 0;
+        pass &= output == expected;
+        if (!pass) {
+            printf("  interpolation=%d padding=%d align=%d FAILED\n", (int)interpolation, (int)padding, align);
+        }
+        ok &= pass;
+    }
+
+    // spans instead of element counts: a one-element-wide view with a huge stride needs 64-bit indices,
+    // and the CPU path rejects slices whose taps overflow 32 bits
+    const size_t limit = static_cast<size_t>(INT32_MAX);
+    const GridSample3DStrides dense = grid_sample_3d_contiguous_strides(1, 1, 1, 2);
+    const GridSample3DGridStrides dense_grid = grid_sample_3d_contiguous_grid_strides(1, 1, 1);
+    ok &= grid_sample_3d_strided_span(1, 1, 1, 1, 2, GridSample3DStrides{0, 0, 0, 0, limit - 1}) == limit;
+    ok &= grid_sample_3d_strided_index_fits_32bit(1, 1, 1, 1, 2, GridSample3DStrides{2, 2, 2, 2, limit - 1},
+                                                  1, 1, 1, dense_grid, dense, 1);
+    ok &= !grid_sample_3d_strided_index_fits_32bit(1, 1, 1, 1, 2, GridSample3DStrides{2, 2, 2, 2, limit},
+                                                   1, 1, 1, dense_grid, dense, 1);
+    ok &= !grid_sample_3d_strided_index_fits_32bit(1, 1, 1, 1, 1, dense, 1, 1, 1,
+                                                   GridSample3DGridStrides{3, 3, 3, 3, limit / 2 + 1}, dense, 1);
+    float out = 0.f;
+    ok &= grid_sample_3d_strided_cpu<float>(input.data(), GridSample3DStrides{0, 0, limit, 1, 1}, grid.data(), dense_grid,
+                                            1, 1, 2, 1, 1, 1, 1, 1, false, GridSample3DInterpolationMode::Bilinear,
+                                            GridSample3DPaddingMode::Zeros, &out, dense) == 1;
+
+    printf("  %s\n", ok ? "passed" : "FAILED");
+    return ok;
+}
+
+// A borrowed DLPack view of a host buffer; strides empty for a compact tensor. Counts deleter calls.
+struct DLPackView {
+    std::vector<int64_t> shape, strides;
+    DLManagedTensor managed;
+    static int deleted;
+
+    DLPackView(void* data, DLDataType dtype, std::vector<int64_t> shape_, std::vector<int64_t> strides_ = {},
+               uint64_t byte_offset = 0, DLDevice device = DLDevice{kDLCPU, 0})
+        : shape(std::move(shape_)), strides(std::move(strides_)) {
+        DLTensor& t = managed.dl_tensor;
+        t.data = data;
+        t.device = device;
+        t.ndim = static_cast<int32_t>(shape.size());
+        t.dtype = dtype;
+        t.shape = shape.data();
+        t.strides = strides.empty() ? nullptr : strides.data();
+        t.byte_offset = byte_offset;
+        managed.manager_ctx = nullptr;
+        managed.deleter = [](DLManagedTensor*) { deleted++; };
+    }
+    DLPackView(const DLPackView&) = delete;
+};
+int DLPackView::deleted = 0;
+
+bool testGridSample3dDlpack() {
+    std::cout << "Test GridSample3dDlpack..." << std::endl;
+    bool ok = grid_sample_3d_c_api_version() == GRID_SAMPLE_3D_C_API_VERSION;
+
+    const int64_t N = 2, C = 3, D = 5, H = 6, W = 7;
+    const int64_t D_out = 3, H_out = 4, W_out = 5;
+    const int64_t spatial = D_out * H_out * W_out;
+    const DLDataType f32{kDLFloat, 32, 1}, f16{kDLFloat, 16, 1};
+
+    // channels 1..3 of a 4-channel input through byte_offset, the grid stored as (N, 3, D, H, W)
+    std::vector<float> input_full(N * (C + 1) * D * H * W), grid(N * spatial * 3), grid_permuted(grid.size());
+    fillUniform(input_full, -1.f, 1.f, 71);
+    fillUniform(grid, -1.1f, 1.1f, 72);
+    for (int64_t n = 0; n < N; n++) {
+        for (int64_t v = 0; v < spatial; v++) {
+            for (int64_t k = 0; k < 3; k++) {
+                grid_permuted[(n * 3 + k) * spatial + v] = grid[(n * spatial + v) * 3 + k];
+            }
+        }
+    }
+    std::vector<float> input(N * C * D * H * W);
+    for (int64_t n = 0; n < N; n++) {
+        std::copy_n(input_full.begin() + (n * (C + 1) + 1) * D * H * W, C * D * H * W, input.begin() + n * C * D * H * W);
+    }
+
+    DLPackView input_view(input_full.data(), f32, {N, C, D, H, W}, {(C + 1) * D * H * W, D * H * W, H * W, W, 1},
+                          D * H * W * sizeof(float));
+    DLPackView grid_view(grid_permuted.data(), f32, {N, D_out, H_out, W_out, 3},
+                         {3 * spatial, H_out * W_out, W_out, 1, spatial});
+
+    for (auto interpolation : kInterpolationModes) {
+        for (auto padding : kPaddingModes) {
+            std::vector<float> expected(N * C * spatial);
+            ok &= grid_sample_3d_cpu<float>(input.data(), grid.data(), N, C, D, H, W, D_out, H_out, W_out, true,
+                                            interpolation, padding, expected.data()) == 0;
+
+            // the output is every other width of a (N, C, D_out, H_out, 2 * W_out) buffer
+            std::vector<float> wide(N * C * spatial * 2, -7.f);
+            DLPackView output_view(wide.data(), f32, {N, C, D_out, H_out, W_out},
+                                   {C * spatial * 2, spatial * 2, H_out * W_out * 2, W_out * 2, 2});
+            int status = grid_sample_3d_dlpack(&input_view.managed, &grid_view.managed, &output_view.managed,
+                                               (int32_t)interpolation, (int32_t)padding, 1, nullptr);
+            bool pass = status == GRID_SAMPLE_3D_STATUS_OK && grid_sample_3d_last_error()[0] == '\0';
+            for (size_t i = 0; i < wide.size(); i++) {
+                pass &= i % 2 == 1 ? wide[i] == -7.f : wide[i] == expected[i / 2];
+            }
+            if (!pass) {
+                printf("  interpolation=%d padding=%d FAILED\n", (int)interpolation, (int)padding);
+            }
+            ok &= pass;
+        }
+    }
+
+    // compact half tensors with an fp32 grid
+    {
+        std::vector<half> input_h = quantize<half>(input), output_h(N * C * spatial), expected_h(output_h.size());
+        ok &= grid_sample_3d_cpu<half, float>(input_h.data(), grid.data(), N, C, D, H, W, D_out, H_out, W_out, false,
+                                              GridSample3DInterpolationMode::Bilinear, GridSample3DPaddingMode::Zeros,
+                                              expected_h.data()) == 0;
+        DLPackView in(input_h.data(), f16, {N, C, D, H, W});
+        DLPackView g(grid.data(), f32, {N, D_out, H_out, W_out, 3});
+        DLPackView out(output_h.data(), f16, {N, C, D_out, H_out, W_out});
+        ok &= grid_sample_3d_dlpack(&in.managed, &g.managed, &out.managed, GRID_SAMPLE_3D_INTERPOLATION_BILINEAR,
+                                    GRID_SAMPLE_3D_PADDING_ZEROS, 0, nullptr) == GRID_SAMPLE_3D_STATUS_OK;
+        ok &= memcmp(output_h.data(), expected_h.data(), output_h.size() * sizeof(half)) == 0;
+    }
+
+    // rejected calls report a status and a message, and leave the output alone
+    int errors = 0;
+    grid_sample_3d_set_log_sink([](GridSample3DLogSeverity severity, const char*, void* user) {
+        *static_cast<int*>(user) += severity == GridSample3DLogSeverity::Error;
+    }, &errors);
+    std::vector<float> output(N * C * spatial, -7.f);
+    DLPackView output_view(output.data(), f32, {N, C, D_out, H_out, W_out});
+    DLPackView short_grid(grid.data(), f32, {N, D_out, H_out, W_out, 2});
+    DLPackView int_input(input.data(), DLDataType{kDLInt, 32, 1}, {N, C, D, H, W});
+    DLPackView rocm_input(input.data(), f32, {N, C, D, H, W}, {}, 0, DLDevice{kDLROCM, 0});
+    DLPackView rocm_grid(grid.data(), f32, {N, D_out, H_out, W_out, 3}, {}, 0, DLDevice{kDLROCM, 0});
+    DLPackView rocm_output(output.data(), f32, {N, C, D_out, H_out, W_out}, {}, 0, DLDevice{kDLROCM, 0});
+    DLPackView other_device(input.data(), f32, {N, C, D, H, W}, {}, 0, DLDevice{kDLCPU, 1});
+    DLPackView negative(input.data(), f32, {N, C, D, H, W}, {C * D * H * W, D * H * W, H * W, W, -1});
+    const int32_t bilinear = GRID_SAMPLE_3D_INTERPOLATION_BILINEAR, zeros = GRID_SAMPLE_3D_PADDING_ZEROS;
+    ok &= grid_sample_3d_dlpack(&input_view.managed, &short_grid.managed, &output_view.managed, bilinear, zeros, 0,
+                                nullptr) == GRID_SAMPLE_3D_STATUS_INVALID_ARGUMENT;
+    ok &= grid_sample_3d_dlpack(&int_input.managed, &grid_view.managed, &output_view.managed, bilinear, zeros, 0,
+                                nullptr) == GRID_SAMPLE_3D_STATUS_UNSUPPORTED;
+    ok &= grid_sample_3d_dlpack(&rocm_input.managed, &rocm_grid.managed, &rocm_output.managed, bilinear, zeros, 0,
+                                nullptr) == GRID_SAMPLE_3D_STATUS_UNSUPPORTED;
+    ok &= grid_sample_3d_dlpack(&other_device.managed, &grid_view.managed, &output_view.managed, bilinear, zeros, 0,
+                                nullptr) == GRID_SAMPLE_3D_STATUS_INVALID_ARGUMENT;
+    ok &= grid_sample_3d_dlpack(&negative.managed, &grid_view.managed, &output_view.managed, bilinear, zeros, 0,
+                                nullptr) == GRID_SAMPLE_3D_STATUS_INVALID_ARGUMENT;
+    ok &= grid_sample_3d_dlpack(&input_view.managed, &grid_view.managed, &output_view.managed, 2, zeros, 0,
+                                nullptr) == GRID_SAMPLE_3D_STATUS_UNSUPPORTED;
+    ok &= grid_sample_3d_dlpack(nullptr, &grid_view.managed, &output_view.managed, bilinear, zeros, 0,
+                                nullptr) == GRID_SAMPLE_3D_STATUS_INVALID_ARGUMENT;
+    ok &= strlen(grid_sample_3d_last_error()) > 0 && errors == 7;
+    grid_sample_3d_set_log_sink(nullptr, nullptr);
+    ok &= std::all_of(output.begin(), output.end(), [](float v) { return v == -7.f; });
+
+    // every tensor is borrowed
+    ok &= DLPackView::deleted == 0;
+
+    printf("  %s\n", ok ? "passed" : "FAILED");
+    return ok;
+}
 
 int main(int argc, char** argv) {
-    // testGridSample3dFloat16();
-    testGridSample3dFloat32();
-    
-    return 0;
+    int failures = 0;
+
+    if (hasCudaDevice()) {
+        // testGridSample3dFloat16();
+        testGridSample3dFloat32();
+        failures += !testGridSample3dCpuVsCuda();
+    } else {
+        std::cout << "No CUDA device, running host tests only" << std::endl;
+    }
+
+    failures += !testGridSample3dCpuGolden();
+    failures += !testGridSample3dCpuGoldenSets();
+    failures += !testGridSample3dCpuModes();
+    failures += !testGridSample3dPlan();
+    failures += !testGridSample3dCpuChannelsLast();
+    failures += !testGridSample3dAffineCpu();
+    failures += !testGridSample3dCpuDisplacement();
+    failures += !testGridSample3dCpuMixedPrecision();
+    failures += !testGridSample3dCpuQuantized();
+    failures += !testGridSample3dCpuLabels();
+    failures += !testGridSample3dTactics();
+    failures += !testGridSample3dTraversal();
+    failures += !testGridSample3dBucketing();
+    failures += !testGridSample3dStream();
+    failures += !testGridSample3dTileBounds();
+    failures += !testGridSample3dMask();
+    failures += !testGridSample3dPoints();
+    failures += !testGridSample3dMipmap();
+    failures += !testGridSample3dRagged();
+    failures += !testGridSample3dProfile();
+    failures += !testGridSample3dIndexWidth();
+    failures += !testGridSample3dStrided();
+    failures += !testGridSample3dDlpack();
+
+    printf("%d test(s) failed\n", failures);
+    return failures == 0 ? 0 : 1;
 
 }
 